@@ -29,20 +29,148 @@
 #ifndef __INC_GL_COMMDLG_
 #define __INC_GL_COMMDLG_
 
+#ifdef _WIN32
 #include <windows.h>
 #include <commdlg.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <cstring>
 #include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#ifdef _WIN32
 #include <Shlobj.h>
 
 // 链接对话框库，若使用非MSCV编译器，请添加编译参数-lcomdlg32 -lshell32
 #pragma comment(lib, "comdlg32.lib")
 #pragma comment(lib, "shell32.lib")
+#endif
+
+#pragma region 静态探针
+// sys/sdt.h格式的USDT探针，供bpftrace、perf和SystemTap使用，提供者为"gcommdlg"
+// 在跟踪器附加之前，探针只是一条nop，其ELF注记位于一个从不加载的节中。注记直接在此写出，因此不需要systemtap-sdt头文件
+//
+//   dialog__entry(const char* dialog), dialog__return(const char* dialog)
+//   transcode__begin(const char* direction, size_t inputBytes), transcode__end(const char* direction, size_t outputBytes)
+//   font__lookup(const char* foldedName, int hit), font__file__lookup(const wchar_t* name, int hit)
+//   cache__evict(const char* key, size_t bytes), cache__trim(unsigned long long targetBytes, unsigned long long usedBytes)
+//   enumerate__begin(const char* directory), enumerate__end(const char* directory, size_t matched, size_t subdirectories)
+
+#ifndef __GCOMMDLG_PROBES
+#if defined(__ELF__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__))
+#define __GCOMMDLG_PROBES 1  // 生成USDT探针，定义为0则不生成
+#else
+#define __GCOMMDLG_PROBES 0
+#endif
+#endif
+
+#if __GCOMMDLG_PROBES
+// 先是nop，然后是一条ELF注记，记录探针名称、地址以及如何读取每个参数（"大小@操作数"，负的大小表示有符号）
+#define __GCOMMDLG_PROBE_ASM(name, arguments)                                   \
+    "990: nop\n"                                                                \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                               \
+    ".balign 4\n"                                                               \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                          \
+    "991: .asciz \"stapsdt\"\n"                                                 \
+    "992: .balign 4\n"                                                          \
+    "993: .8byte 990b\n"                                                        \
+    ".8byte _.stapsdt.base\n"                                                   \
+    ".8byte 0\n"                                                                \
+    ".asciz \"gcommdlg\"\n"                                                     \
+    ".asciz \"" #name "\"\n"                                                    \
+    ".asciz \"" arguments "\"\n"                                                \
+    "994: .balign 4\n"                                                          \
+    ".popsection\n"                                                             \
+    ".ifndef _.stapsdt.base\n"                                                  \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"     \
+    ".weak _.stapsdt.base\n"                                                    \
+    ".hidden _.stapsdt.base\n"                                                  \
+    "_.stapsdt.base: .space 1\n"                                                \
+    ".size _.stapsdt.base, 1\n"                                                 \
+    ".popsection\n"                                                             \
+    ".endif\n"
+
+// 参数经过一元加号，使数组变为指针。大小写成相反的符号，因为%n会将其取负输出
+#define __GCOMMDLG_PROBE_SIZE(argument) \
+    ((std::is_signed<std::decay<decltype(+(argument))>::type>::value ? 1 : -1) * static_cast<int>(sizeof(+(argument))))
+
+#define __GCOMMDLG_PROBE1(name, a1) \
+    __asm__ __volatile__(__GCOMMDLG_PROBE_ASM(name, "%n0@%1") :: "n"(__GCOMMDLG_PROBE_SIZE(a1)), "nor"(+(a1)))
+#define __GCOMMDLG_PROBE2(name, a1, a2)                                                               \
+    __asm__ __volatile__(__GCOMMDLG_PROBE_ASM(name, "%n0@%1 %n2@%3")                                 \
+                         :: "n"(__GCOMMDLG_PROBE_SIZE(a1)), "nor"(+(a1)), "n"(__GCOMMDLG_PROBE_SIZE(a2)), "nor"(+(a2)))
+#define __GCOMMDLG_PROBE3(name, a1, a2, a3)                                                           \
+    __asm__ __volatile__(__GCOMMDLG_PROBE_ASM(name, "%n0@%1 %n2@%3 %n4@%5")                          \
+                         :: "n"(__GCOMMDLG_PROBE_SIZE(a1)), "nor"(+(a1)), "n"(__GCOMMDLG_PROBE_SIZE(a2)), "nor"(+(a2)), \
+                            "n"(__GCOMMDLG_PROBE_SIZE(a3)), "nor"(+(a3)))
+#else
+#define __GCOMMDLG_PROBE1(name, a1) ((void)0)
+#define __GCOMMDLG_PROBE2(name, a1, a2) ((void)0)
+#define __GCOMMDLG_PROBE3(name, a1, a2, a3) ((void)0)
+#endif
+
+namespace {
+
+    /**
+     * @brief 创建时触发dialog__entry，销毁时触发dialog__return，无论对话框函数如何返回
+     */
+    class dialogProbe {
+    public:
+        explicit dialogProbe(const char* dialog) : m_dialog(dialog) {
+            __GCOMMDLG_PROBE1(dialog__entry, m_dialog);
+        }
+
+        ~dialogProbe() {
+            __GCOMMDLG_PROBE1(dialog__return, m_dialog);
+        }
+
+        dialogProbe(const dialogProbe&) = delete;
+        dialogProbe& operator=(const dialogProbe&) = delete;
+
+    private:
+        const char* m_dialog;
+    };
+
+}
+
+#pragma endregion
 
 namespace {
+#ifdef _WIN32
     /**
      * @brief 将UTF8字符串转换为宽字符串
      * @param utf8 输入的UTF8字符串
@@ -51,6 +179,7 @@ namespace {
      */
     std::wstring utf8ToWide(const std::string& utf8) {
         if (utf8.empty()) return L"";
+        __GCOMMDLG_PROBE2(transcode__begin, "utf8-to-wide", utf8.size());
 
         int wideSize = MultiByteToWideChar(
             CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), 
@@ -70,6 +199,7 @@ namespace {
                 std::to_string(GetLastError()));
         }
 
+        __GCOMMDLG_PROBE2(transcode__end, "utf8-to-wide", wide.size() * sizeof(wchar_t));
         return wide;
     }
 
@@ -81,6 +211,7 @@ namespace {
      */
     std::string wideToUtf8(const std::wstring& wide) {
         if (wide.empty()) return "";
+        __GCOMMDLG_PROBE2(transcode__begin, "wide-to-utf8", wide.size() * sizeof(wchar_t));
 
         int utf8Size = WideCharToMultiByte(
             CP_UTF8, 0, wide.data(), static_cast<int>(wide.size()), 
@@ -100,9 +231,89 @@ namespace {
                 std::to_string(GetLastError()));
         }
 
+        __GCOMMDLG_PROBE2(transcode__end, "wide-to-utf8", utf8.size());
+        return utf8;
+    }
+#else
+    /**
+     * @brief 将UTF8字符串转换为宽字符串（在此平台上为UTF-32），与MultiByteToWideChar一样，非法序列会被替换为U+FFFD
+     * @param utf8 输入的UTF8字符串
+     * @return 转换后的宽字符串
+     */
+    std::wstring utf8ToWide(const std::string& utf8) {
+        __GCOMMDLG_PROBE2(transcode__begin, "utf8-to-wide", utf8.size());
+        std::wstring wide;
+        wide.reserve(utf8.size());
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(utf8.data());
+        const unsigned char* end = p + utf8.size();
+        while (p < end) {
+            unsigned long c = *p++;
+            if (c < 0x80) {
+                wide += static_cast<wchar_t>(c);
+                continue;
+            }
+
+            int extra;
+            unsigned long minimum;
+            if ((c & 0xE0) == 0xC0)      { extra = 1; c &= 0x1F; minimum = 0x80; }
+            else if ((c & 0xF0) == 0xE0) { extra = 2; c &= 0x0F; minimum = 0x800; }
+            else if ((c & 0xF8) == 0xF0) { extra = 3; c &= 0x07; minimum = 0x10000; }
+            else {
+                wide += static_cast<wchar_t>(0xFFFD);
+                continue;
+            }
+
+            int i = 0;
+            for (; i < extra && p < end && (*p & 0xC0) == 0x80; ++i) {
+                c = (c << 6) | (*p++ & 0x3F);
+            }
+            if (i < extra || c < minimum || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+                c = 0xFFFD;
+            }
+            wide += static_cast<wchar_t>(c);
+        }
+
+        __GCOMMDLG_PROBE2(transcode__end, "utf8-to-wide", wide.size() * sizeof(wchar_t));
+        return wide;
+    }
+
+    /**
+     * @brief 将宽字符串（在此平台上为UTF-32）转换为UTF8字符串
+     * @param wide 输入的宽字符串
+     * @return 转换后的UTF8字符串
+     */
+    std::string wideToUtf8(const std::wstring& wide) {
+        __GCOMMDLG_PROBE2(transcode__begin, "wide-to-utf8", wide.size() * sizeof(wchar_t));
+        std::string utf8;
+        utf8.reserve(wide.size());
+
+        for (wchar_t wc : wide) {
+            unsigned long c = static_cast<unsigned long>(wc);
+            if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) c = 0xFFFD;
+            if (c < 0x80) {
+                utf8 += static_cast<char>(c);
+            } else if (c < 0x800) {
+                utf8 += static_cast<char>(0xC0 | (c >> 6));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                utf8 += static_cast<char>(0xE0 | (c >> 12));
+                utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            } else {
+                utf8 += static_cast<char>(0xF0 | (c >> 18));
+                utf8 += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+
+        __GCOMMDLG_PROBE2(transcode__end, "wide-to-utf8", utf8.size());
         return utf8;
     }
+#endif
 
+#ifdef _WIN32
     /**
      * @brief 构建文件过滤器字符串（宽字符版）
      * @param filters 过滤器列表，每个元素格式为"描述|过滤模式"
@@ -272,9 +483,86 @@ namespace {
         if(try_lm.empty()){
             try_lm = FindFontFileCurrentUser(fontNameSubstring);
         }
+        __GCOMMDLG_PROBE2(font__file__lookup, fontNameSubstring.c_str(), static_cast<int>(!try_lm.empty()));
         return try_lm;
     }
+#endif
+
+}
+
+#ifdef _WIN32
+
+namespace {
+
+    /**
+     * @brief 通过lCustData与fileDialogHookProc共享的状态
+     */
+    struct fileDialogHookContext {
+        const std::function<void(const std::vector<std::string>&)>* onSelectionChange;
+        std::exception_ptr error;
+    };
+
+    /**
+     * @brief 读取资源管理器样式文件对话框中当前高亮的路径
+     * @param dialog 文件对话框窗口，即钩子对话框的父窗口
+     */
+    std::vector<std::string> getDialogSelection(HWND dialog) {
+        std::vector<std::string> selection;
+        LRESULT folderLength = SendMessageW(dialog, CDM_GETFOLDERPATH, 0, 0);
+        LRESULT specLength = SendMessageW(dialog, CDM_GETSPEC, 0, 0);
+        if (folderLength <= 0 || specLength <= 1) return selection;
+
+        std::vector<wchar_t> folder(folderLength), spec(specLength);
+        SendMessageW(dialog, CDM_GETFOLDERPATH, folder.size(), reinterpret_cast<LPARAM>(folder.data()));
+        SendMessageW(dialog, CDM_GETSPEC, spec.size(), reinterpret_cast<LPARAM>(spec.data()));
+        std::wstring directory = folder.data();
+        std::wstring names = spec.data();
+        if (!directory.empty() && directory.back() != L'\\') directory += L'\\';
+
+        // 单个文件名原样显示，多个文件名各自带引号："a.txt" "b.txt"
+        std::vector<std::wstring> parts;
+        if (names.find(L'"') == std::wstring::npos) {
+            parts.push_back(names);
+        } else {
+            size_t pos = 0;
+            while ((pos = names.find(L'"', pos)) != std::wstring::npos) {
+                size_t end = names.find(L'"', pos + 1);
+                if (end == std::wstring::npos) break;
+                parts.push_back(names.substr(pos + 1, end - pos - 1));
+                pos = end + 1;
+            }
+        }
+
+        for (const auto& name : parts) {
+            if (name.empty()) continue;
+            bool absolute = name.size() > 1 && (name[1] == L':' || (name[0] == L'\\' && name[1] == L'\\'));
+            selection.push_back(wideToUtf8(absolute ? name : directory + name));
+        }
+        return selection;
+    }
 
+    /**
+     * @brief 文件打开对话框的钩子过程，将CDN_SELCHANGE转发给onSelectionChange回调
+     */
+    UINT_PTR CALLBACK fileDialogHookProc(HWND hookDialog, UINT msg, WPARAM, LPARAM lParam) {
+        if (msg == WM_INITDIALOG) {
+            SetWindowLongPtrW(hookDialog, GWLP_USERDATA, reinterpret_cast<const OPENFILENAMEW*>(lParam)->lCustData);
+            return 0;
+        }
+
+        if (msg == WM_NOTIFY && reinterpret_cast<const NMHDR*>(lParam)->code == CDN_SELCHANGE) {
+            auto* context = reinterpret_cast<fileDialogHookContext*>(GetWindowLongPtrW(hookDialog, GWLP_USERDATA));
+            // 异常不能穿过对话框的消息循环，第一个异常会在对话框返回后重新抛出
+            if (context && !context->error) {
+                try {
+                    (*context->onSelectionChange)(getDialogSelection(GetParent(hookDialog)));
+                } catch (...) {
+                    context->error = std::current_exception();
+                }
+            }
+        }
+        return 0;
+    }
 }
 
 /**
@@ -288,15 +576,19 @@ namespace {
  * @param defaultFileName 默认显示的文件名（UTF8编码），为空则不设置
  * @param defaultExt 默认扩展名（无需带点，如"txt"），用户未输入扩展名时自动添加
  * @param parentHWND 文件打开对话框的父窗口句柄
+ * @param onSelectionChange 每当选择变化时在对话框线程中以高亮的路径（UTF8编码）调用，例如speculativeLoader::handler()。设置后对话框以启用钩子的资源管理器样式显示
  * @return 选中的文件路径（UTF8编码），用户取消时返回空字符串
  * @throw std::invalid_argument 过滤器格式错误时
  * @throw std::runtime_error 字符串转换失败或对话框调用出错时
+ * @throw 对话框关闭后重新抛出onSelectionChange抛出的第一个异常
  */
 std::string getOpenFileName(const std::vector<std::string>& filters,
                            const std::string& title = "",
                            const std::string& initialDir = "",
                            const std::string& defaultFileName = "",
-                           const std::string& defaultExt = "",HWND parentHWND = NULL) {
+                           const std::string& defaultExt = "",HWND parentHWND = NULL,
+                           const std::function<void(const std::vector<std::string>&)>& onSelectionChange = nullptr) {
+    dialogProbe probe("getOpenFileName");
     std::wstring filter = buildFilter(filters);
     std::wstring wtitle = utf8ToWide(title);
 
@@ -338,7 +630,18 @@ std::string getOpenFileName(const std::vector<std::string>& filters,
                 OFN_NOCHANGEDIR |
                 OFN_EXPLORER;
 
-    if (!GetOpenFileNameW(&ofn)) {
+    fileDialogHookContext hookContext = { &onSelectionChange, nullptr };
+    if (onSelectionChange) {
+        ofn.Flags |= OFN_ENABLEHOOK | OFN_ENABLESIZING;
+        ofn.lpfnHook = fileDialogHookProc;
+        ofn.lCustData = reinterpret_cast<LPARAM>(&hookContext);
+    }
+
+    BOOL accepted = GetOpenFileNameW(&ofn);
+    if (hookContext.error) {
+        std::rethrow_exception(hookContext.error);
+    }
+    if (!accepted) {
         DWORD err = CommDlgExtendedError();
         if (err != 0) {
             throw std::runtime_error("Open file dialog failed: " + std::to_string(err));
@@ -370,6 +673,7 @@ std::string getSaveFileName(const std::vector<std::string>& filters,
                            const std::string& initialDir = "",
                            const std::string& defaultFileName = "",
                            const std::string& defaultExt = "",HWND parentHWND = NULL) {
+    dialogProbe probe("getSaveFileName");
     std::wstring filter = buildFilter(filters);
     std::wstring wtitle = utf8ToWide(title);
 
@@ -434,16 +738,20 @@ std::string getSaveFileName(const std::vector<std::string>& filters,
  * @param defaultFileName 默认显示的文件名（UTF8编码），为空则不设置
  * @param defaultExt 默认扩展名（无需带点，如"txt"），用户未输入扩展名时自动添加
  * @param parentHWND 文件打开对话框的父窗口句柄
+ * @param onSelectionChange 每当选择变化时在对话框线程中以高亮的路径（UTF8编码）调用，例如speculativeLoader::handler()。设置后对话框以启用钩子的资源管理器样式显示
  * @return 选中的文件路径列表（UTF8编码），用户取消时返回空vector
  * @throw std::invalid_argument 过滤器格式错误时
  * @throw std::runtime_error 字符串转换失败或对话框调用出错时
+ * @throw 对话框关闭后重新抛出onSelectionChange抛出的第一个异常
  */
 std::vector<std::string> getOpenMultipleFileNames(const std::vector<std::string>& filters,
                            const std::string& title = "",
                            const std::string& initialDir = "",
                            const std::string& defaultFileName = "",
                            const std::string& defaultExt = "",
-                           HWND parentHWND = NULL) {
+                           HWND parentHWND = NULL,
+                           const std::function<void(const std::vector<std::string>&)>& onSelectionChange = nullptr) {
+    dialogProbe probe("getOpenMultipleFileNames");
     std::wstring filter = buildFilter(filters);
     std::wstring wtitle = utf8ToWide(title);
 
@@ -488,7 +796,18 @@ std::vector<std::string> getOpenMultipleFileNames(const std::vector<std::string>
                 OFN_EXPLORER |
                 OFN_ALLOWMULTISELECT;
 
-    if (!GetOpenFileNameW(&ofn)) {
+    fileDialogHookContext hookContext = { &onSelectionChange, nullptr };
+    if (onSelectionChange) {
+        ofn.Flags |= OFN_ENABLEHOOK | OFN_ENABLESIZING;
+        ofn.lpfnHook = fileDialogHookProc;
+        ofn.lCustData = reinterpret_cast<LPARAM>(&hookContext);
+    }
+
+    BOOL accepted = GetOpenFileNameW(&ofn);
+    if (hookContext.error) {
+        std::rethrow_exception(hookContext.error);
+    }
+    if (!accepted) {
         DWORD err = CommDlgExtendedError();
         if (err != 0) {
             throw std::runtime_error("Open file dialog failed: " + std::to_string(err));
@@ -529,6 +848,7 @@ std::vector<std::string> getOpenMultipleFileNames(const std::vector<std::string>
 std::string getOpenDirectoryName(const std::string& title = "",
                                 const std::string& initialDir = "",
                                 HWND parentHWND = NULL) {
+    dialogProbe probe("getOpenDirectoryName");
     std::wstring wtitle = utf8ToWide(title);
     
     std::wstring initialDirWide;
@@ -567,485 +887,10584 @@ std::string getOpenDirectoryName(const std::string& title = "",
     return wideToUtf8(directoryPath);
 }
 
-#ifndef SDL_pixels_h_
-
-struct SDL_Color{
-    unsigned char r;
-    unsigned char g;
-    unsigned char b;
-    unsigned char a;
-};
-
 #endif
 
+#pragma region 内存报告
+// 库所持有的缓存和全局变量的字节记账。每个缓存在添加和丢弃条目时记账，因此报告只需读取每个缓存的一组计数器
+
 /**
- * @brief 显示颜色选择对话框，让用户选择一个颜色
- * 
- * @param selectedColor 用户所选的颜色
- * @param hwndParent 颜色选择对话框的父窗口句柄
+ * @brief memoryReport涵盖的缓存和全局变量，按报告顺序
  */
-void chooseColor(SDL_Color& selectedColor, HWND hwndParent = NULL)
-{
-    static COLORREF customColors[16] = {0};
-    
-    CHOOSECOLORW cc = {0};
-    cc.lStructSize = sizeof(cc);
-    cc.hwndOwner = hwndParent;
-    cc.lpCustColors = customColors;
-    cc.Flags = CC_RGBINIT | CC_FULLOPEN;
-    
-    COLORREF initialColor = RGB(
-        selectedColor.r,
-        selectedColor.g,
-        selectedColor.b
-    );
-    cc.rgbResult = initialColor;
-	
-    if (!ChooseColorW(&cc))
-    {
-        DWORD err = CommDlgExtendedError();
-        if (err != 0) {
-            throw std::runtime_error("Choose color dialog failed: " + std::to_string(err));
-        }
-    }
-
-    selectedColor.r = GetRValue(cc.rgbResult);
-    selectedColor.g = GetGValue(cc.rgbResult);
-    selectedColor.b = GetBValue(cc.rgbResult);
-    selectedColor.a = 255;
-}
-
-struct chooseFontInfo{
-    std::string fontFaceName;
-    std::string fontPath;
-    int fontPointSize;
+enum memoryCache {
+    memoryArchiveIndexes,           // 压缩包的成员索引（listArchiveMembers、readArchiveMember）
+    memoryDirectoryListings,        // suggestSaveFileName的目录列表
+    memoryVolumeStates,             // 每个目录所在的卷和每个卷的可用空间（checkSaveSpace）
+    memoryFontSearchDirectories,    // 通过addFontSearchDirectory添加的目录
+    memoryFontIndexes,              // 存活的fontIndex对象的映像，包括getSystemFontIndex的映像
+    memoryMimeCaches,               // mimeDatabase对象映射的mime.cache文件
+    memoryIconThemes,               // iconResolver对象的主题目录列表
+    memoryIconImages,               // iconResolver对象缓存的图标
+    memorySpeculativeLoads,         // speculativeLoader对象已处理的路径
+    memoryCacheCount
 };
 
 /**
- * @brief 显示字体选择对话框，让用户选择系统上所安装的字体
- * 
- * @param cfi 输出参数，注意，不保证一定可以找到选择的字体的路径，但大概率可以找到。若没找到，fontPath为空字符串。
- * @param hwndParent 颜色选择对话框的父窗口句柄
+ * @brief 一个缓存或全局变量持有的内存
  */
-void chooseFont(chooseFontInfo& cfi, HWND hwndParent = NULL){
-    CHOOSEFONTW cf = {0};
-    LOGFONTW lf = {0};
-    cf.lStructSize = sizeof(CHOOSEFONTW);
-    cf.hwndOwner = hwndParent;
-    cf.lpLogFont = &lf;
-    cf.Flags = CF_SCREENFONTS | CF_NOVERTFONTS | CF_TTONLY;
-    if (!ChooseFontW(&cf)) {
-        DWORD err = CommDlgExtendedError();
-        if (err != 0) {
-            throw std::runtime_error("Choose font dialog failed: " + std::to_string(err));
-        }
-    }
-    cfi.fontFaceName = wideToUtf8(lf.lfFaceName);
-    cfi.fontPointSize = cf.iPointSize / 10;
-    cfi.fontPath = wideToUtf8(FindFontFile(lf.lfFaceName));
-}
-
-#pragma region 非Win32原生对话框
-//使用原始的方法轻量级实现一些commdlg.h没有实现的对话框，比如prompt
+struct memoryUsage {
+    const char* name;               // 例如"archive indexes"
+    unsigned long long bytes;       // 当前持有的字节数
+    unsigned long long entries;     // 当前持有的条目数
+    unsigned long long peakBytes;   // 迄今为止'bytes'的最高值
+    unsigned long long peakEntries; // 迄今为止'entries'的最高值
+};
 
-#define __GCOMMMDLG_IDC_PROMPT  1001  // 提示文本
-#define __GCOMMMDLG_IDC_INPUT   1002  // 输入框
-#define __GCOMMMDLG_IDOK        1003  // 确定按钮
-#define __GCOMMMDLG_IDCANCEL    1004  // 取消按钮
+namespace {
 
-namespace{
+    /**
+     * @brief 一个缓存的当前和峰值用量，无锁更新
+     */
+    class memoryCounter {
+    public:
+        void change(long long bytes, long long entries) {
+            raisePeak(m_peakBytes, m_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+            raisePeak(m_peakEntries, m_entries.fetch_add(entries, std::memory_order_relaxed) + entries);
+        }
 
-    WCHAR* g_inputText = nullptr;
-    std::wstring g_defalutContent;
-    std::wstring g_message;
-    bool g_did_confirm;
+        memoryUsage usage(const char* name) const {
+            memoryUsage usage;
+            usage.name = name;
+            usage.bytes = static_cast<unsigned long long>(std::max(0LL, m_bytes.load(std::memory_order_relaxed)));
+            usage.entries = static_cast<unsigned long long>(std::max(0LL, m_entries.load(std::memory_order_relaxed)));
+            usage.peakBytes = static_cast<unsigned long long>(m_peakBytes.load(std::memory_order_relaxed));
+            usage.peakEntries = static_cast<unsigned long long>(m_peakEntries.load(std::memory_order_relaxed));
+            return usage;
+        }
 
-    LRESULT CALLBACK PromptDialogProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lParam) {
-        
-        static HWND hStaticPrompt = NULL;
-        static HWND hEditInput = NULL;
-        static HWND hButtonOK = NULL;
-        static HWND hButtonCancel = NULL;
-        static HBRUSH hDefaultBrush = CreateSolidBrush(RGB(240, 240, 240)); 
-        
-        switch (msg) {
-            case WM_CREATE: {
-                
-                HFONT hFont = CreateFontW(
-                    24, 0, 0, 0, FW_NORMAL, 
-                    FALSE, FALSE, FALSE, DEFAULT_CHARSET,
-                    OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-                    CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_DONTCARE,
-                    L"微软雅黑"
-                );
-                
-                hStaticPrompt = CreateWindowExW(
-                    0,
-                    L"STATIC",
-                    g_message.c_str(),
-                    WS_CHILD | WS_VISIBLE | SS_LEFT,
-                    20, 20, 260, 25,
-                    hDlg,
-                    (HMENU)__GCOMMMDLG_IDC_PROMPT,
-                    ((LPCREATESTRUCTW)lParam)->hInstance,
-                    NULL
-                );
-                
-                hEditInput = CreateWindowExW(
-                    WS_EX_CLIENTEDGE,  // 使用3D边框
-                    L"EDIT",
-                    g_defalutContent.c_str(),
-                    WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
-                    20, 50, 360, 30,
-                    hDlg,
-                    (HMENU)__GCOMMMDLG_IDC_INPUT,
-                    ((LPCREATESTRUCTW)lParam)->hInstance,
-                    NULL
-                );
-                
-                hButtonOK = CreateWindowExW(
-                    0,
-                    L"BUTTON",
-                    L"确定",
-                    WS_CHILD | WS_VISIBLE | BS_DEFPUSHBUTTON,
-                    120, 95, 80, 30,
-                    hDlg,
-                    (HMENU)__GCOMMMDLG_IDOK,
-                    ((LPCREATESTRUCTW)lParam)->hInstance,
-                    NULL
-                );
-                
-                hButtonCancel = CreateWindowExW(
-                    0,
-                    L"BUTTON",
-                    L"取消",
-                    WS_CHILD | WS_VISIBLE,
-                    220, 95, 80, 30,
-                    hDlg,
-                    (HMENU)__GCOMMMDLG_IDCANCEL,
-                    ((LPCREATESTRUCTW)lParam)->hInstance,
-                    NULL
-                );
-                
-                if (hFont) {
-                    SendMessage(hStaticPrompt, WM_SETFONT, (WPARAM)hFont, TRUE);
-                    SendMessage(hEditInput, WM_SETFONT, (WPARAM)hFont, TRUE);
-                    SendMessage(hButtonOK, WM_SETFONT, (WPARAM)hFont, TRUE);
-                    SendMessage(hButtonCancel, WM_SETFONT, (WPARAM)hFont, TRUE);
-                }
-                
-                return 0;
+    private:
+        static void raisePeak(std::atomic<long long>& peak, long long value) {
+            long long seen = peak.load(std::memory_order_relaxed);
+            while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
             }
+        }
 
-            case WM_SIZE: {
-                int clientWidth = LOWORD(lParam);
-                int clientHeight = HIWORD(lParam);
-                
-                if (hStaticPrompt) {
-                    SetWindowPos(hStaticPrompt, NULL, 
-                        20, 20, 
-                        clientWidth - 40, 25, 
-                        SWP_NOZORDER);
-                }
-                
-                if (hEditInput) {
-                    SetWindowPos(hEditInput, NULL, 
-                        20, 55, 
-                        clientWidth - 40, 30, 
-                        SWP_NOZORDER);
-                }
-                
-                if (hButtonOK && hButtonCancel) {
-                    int buttonWidth = 80;
-                    int buttonHeight = 30;
-                    int buttonY = clientHeight - buttonHeight - 15;
-                    int totalButtonWidth = buttonWidth * 2 + 20;
-                    int startX = (clientWidth - totalButtonWidth) / 2;
-                    
-                    SetWindowPos(hButtonOK, NULL, 
-                        startX, buttonY, 
-                        buttonWidth, buttonHeight, 
-                        SWP_NOZORDER);
-                    
-                    SetWindowPos(hButtonCancel, NULL, 
-                        startX + buttonWidth + 20, buttonY, 
-                        buttonWidth, buttonHeight, 
-                        SWP_NOZORDER);
-                }
-                return 0;
-            }
+        std::atomic<long long> m_bytes{0};
+        std::atomic<long long> m_entries{0};
+        std::atomic<long long> m_peakBytes{0};
+        std::atomic<long long> m_peakEntries{0};
+    };
 
-            case WM_COMMAND: {
-                if (LOWORD(wParam) == __GCOMMMDLG_IDOK) {
-                    WCHAR buffer[256] = {0};
-                    GetDlgItemTextW(hDlg, __GCOMMMDLG_IDC_INPUT, buffer, 256);
-                    wcscpy(g_inputText, buffer);
-                    g_did_confirm = true;
-                    DestroyWindow(hDlg);
-                }
-                else if (LOWORD(wParam) == __GCOMMMDLG_IDCANCEL) {
-                    wcscpy(g_inputText, L"");
-                    g_did_confirm = false;
-                    DestroyWindow(hDlg);
-                }
-                return 0;
-            }
+    memoryCounter g_memoryCounters[memoryCacheCount];
 
-            case WM_CLOSE:
-                wcscpy(g_inputText, L"");
-                g_did_confirm = false;
-                DestroyWindow(hDlg);
-                return 0;
+    const char* const g_memoryCacheNames[memoryCacheCount] = {
+        "archive indexes", "directory listings", "volume states", "font search directories", "font indexes",
+        "MIME caches", "icon themes", "icon images", "speculative loads"
+    };
 
-            case WM_CTLCOLOREDIT: {
-                HDC hdc = (HDC)wParam;
-                SetBkColor(hdc, RGB(240, 240, 240));
-                SetTextColor(hdc,RGB(0, 0, 0));
-                return (LRESULT)hDefaultBrush;
-            }
+    const size_t g_hashNodeOverhead = 2 * sizeof(void*);  // 哈希表节点中值以外的字节数（链接、缓存的哈希值）
 
-            case WM_CTLCOLORSTATIC: {
-                HDC hdc = (HDC)wParam;
-                SetBkColor(hdc, RGB(240, 240, 240));
-                SetTextColor(hdc,RGB(0, 0, 0));
-                return (LRESULT)hDefaultBrush;
-            }
+    /**
+     * @brief 将持有内存的变化记入一个缓存，负值表示释放
+     */
+    void chargeMemory(memoryCache cache, long long bytes, long long entries) {
+        g_memoryCounters[cache].change(bytes, entries);
+    }
 
-            case WM_CTLCOLORBTN: {
-                HDC hdc = (HDC)wParam;
-                SetBkColor(hdc, RGB(240, 240, 240));
-                SetTextColor(hdc,RGB(0, 0, 0));
-                return (LRESULT)hDefaultBrush;
+    /**
+     * @brief 包装一个缓冲区，只要返回指针的任一副本存活，'bytes'就作为一个条目记入'cache'
+     */
+    std::shared_ptr<const unsigned char> chargedBuffer(memoryCache cache, std::shared_ptr<const unsigned char> buffer, size_t bytes) {
+        struct charge {
+            charge(memoryCache target, std::shared_ptr<const unsigned char> held, size_t size)
+                : cache(target), buffer(std::move(held)), bytes(static_cast<long long>(size)) {
+                chargeMemory(cache, bytes, 1);
             }
-
-            case WM_DESTROY: {
-                PostQuitMessage(0);
-                return 0;
+            ~charge() {
+                chargeMemory(cache, -bytes, -1);
             }
+            memoryCache cache;
+            std::shared_ptr<const unsigned char> buffer;
+            long long bytes;
+        };
+        const unsigned char* data = buffer.get();
+        return std::shared_ptr<const unsigned char>(std::make_shared<charge>(cache, std::move(buffer), bytes), data);
+    }
 
-            case WM_ERASEBKGND: {
-                HDC hdc = (HDC)wParam;
-                RECT rect;
-                GetClientRect(hDlg, &rect);
-                FillRect(hdc, &rect, hDefaultBrush);
-                return TRUE;
-            }
+    // 值在自身之外拥有的字节数，按容量计算。不包括分配器开销
+    template <typename T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value, size_t>::type heapBytes(const T&) {
+        return 0;
+    }
+    template <typename C> size_t heapBytes(const std::basic_string<C>& text);
+    template <typename T> size_t heapBytes(const std::vector<T>& items);
+    template <typename K, typename V, typename H, typename E, typename A> size_t heapBytes(const std::unordered_map<K, V, H, E, A>& table);
+    template <typename K, typename H, typename E, typename A> size_t heapBytes(const std::unordered_set<K, H, E, A>& table);
 
-            default:
-                return DefWindowProcW(hDlg, msg, wParam, lParam);
-        }
+    template <typename C>
+    size_t heapBytes(const std::basic_string<C>& text) {
+        // 短字符串存储在对象内部
+        uintptr_t object = reinterpret_cast<uintptr_t>(&text);
+        uintptr_t data = reinterpret_cast<uintptr_t>(text.data());
+        return data >= object && data < object + sizeof(text) ? 0 : (text.capacity() + 1) * sizeof(C);
     }
-}
 
-/**
- * @brief 显示输入对话框，用于让用户输入一段字符串
- * 
- * @param title 输入对话框的标题
- * @param message 输入对话框内显示的提示文本
- * @param output 输出用户输入的内容
- * @param defaultContent 输入栏内的默认内容
- * @param hParent 输入对话框的父窗口句柄
- * @return 用户是否确认了输入
- */
-bool promptDialog(std::string title,std::string message,std::string& output,std::string defaultContent = "",HWND hParent = NULL) {
-    
-    WNDCLASSEXW wc = {0};
-    wc.cbSize        = sizeof(WNDCLASSEXW);
-    wc.lpfnWndProc   = PromptDialogProc;
-    wc.hInstance     = GetModuleHandleW(NULL);
-    wc.lpszClassName = L"PromptDialogClass";
-    wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-    wc.style         = CS_HREDRAW | CS_VREDRAW;
-
-    RegisterClassExW(&wc);
-
-    int targetWidth = GetSystemMetrics(SM_CXSCREEN);
-    int targetHeight = GetSystemMetrics(SM_CYSCREEN);
-
-    int x = targetWidth / 2 - 400 / 2,y = targetHeight / 2 - 180 / 2;
-
-    g_inputText = new wchar_t[256];
-    g_message = utf8ToWide(message);
-    g_defalutContent = utf8ToWide(defaultContent);
-
-    HWND hDlg = CreateWindowExW(
-        0,
-        L"PromptDialogClass",
-        utf8ToWide(title).c_str(),
-        WS_POPUP | WS_CAPTION | WS_SYSMENU | DS_MODALFRAME/* | WS_SIZEBOX*/,
-        x, y, 400, 180,
-        hParent,
-        NULL,
-        GetModuleHandleW(NULL),
-        NULL
-    );
+    template <typename T>
+    size_t heapBytes(const std::vector<T>& items) {
+        size_t bytes = items.capacity() * sizeof(T);
+        for (const auto& item : items) bytes += heapBytes(item);
+        return bytes;
+    }
 
-    if (hDlg) {
-        ShowWindow(hDlg, SW_SHOW);
-        UpdateWindow(hDlg);
+    template <typename K, typename V, typename H, typename E, typename A>
+    size_t heapBytes(const std::unordered_map<K, V, H, E, A>& table) {
+        size_t bytes = table.bucket_count() * sizeof(void*) + table.size() * (sizeof(typename std::unordered_map<K, V, H, E, A>::value_type) + g_hashNodeOverhead);
+        for (const auto& entry : table) bytes += heapBytes(entry.first) + heapBytes(entry.second);
+        return bytes;
+    }
 
-        MSG msg;
-        
-        while (GetMessageW(&msg, NULL, 0, 0)) {
-            TranslateMessage(&msg);
-            DispatchMessageW(&msg);
-        }
+    template <typename K, typename H, typename E, typename A>
+    size_t heapBytes(const std::unordered_set<K, H, E, A>& table) {
+        size_t bytes = table.bucket_count() * sizeof(void*) + table.size() * (sizeof(K) + g_hashNodeOverhead);
+        for (const auto& key : table) bytes += heapBytes(key);
+        return bytes;
     }
 
-    UnregisterClassW(L"PromptDialogClass", GetModuleHandleW(NULL));
+    /**
+     * @brief 哈希表桶数组的字节数
+     */
+    template <typename Table>
+    size_t bucketBytes(const Table& table) {
+        return table.bucket_count() * sizeof(void*);
+    }
 
-    if(!g_did_confirm){
-        output = "";
-        return false;
+    /**
+     * @brief 持有'key'的一个哈希表节点的字节数，不计映射值拥有的内存
+     */
+    template <typename Table>
+    size_t hashNodeBytes(const Table&, const typename Table::key_type& key) {
+        return sizeof(typename Table::value_type) + g_hashNodeOverhead + heapBytes(key);
     }
 
-    output = wideToUtf8(g_inputText);
-    delete[] g_inputText;
-    return true;
 }
 
-#define __GCOMMMDLG_BTN_START 2000  // 选项按钮起始ID
-
-#define __GCOMMDLG_MSGBOX_BTN_WIDTH 100
+/**
+ * @brief 库的缓存和全局变量持有的内存，例如由长时间运行的进程轮询，在增长时报警
+ *
+ * 每个缓存在添加或丢弃条目时记账，因此无论缓存多大，报告的开销都只是每个缓存读取一次。
+ * 字节数按容器容量和对象大小计算，不含分配器开销；映射的文件（mime.cache、进程间共享的字体索引）
+ * 按映射大小计算。对象拥有的缓存（mimeDatabase、iconResolver等）按存活对象求和。
+ * @return 每个memoryCache一项，按枚举顺序
+ */
+std::vector<memoryUsage> memoryReport() {
+    std::vector<memoryUsage> report;
+    report.reserve(memoryCacheCount);
+    for (int cache = 0; cache < memoryCacheCount; ++cache) {
+        report.push_back(g_memoryCounters[cache].usage(g_memoryCacheNames[cache]));
+    }
+    return report;
+}
 
-namespace {
+#pragma endregion
 
-    std::vector<std::pair<int, std::wstring>> g_options;
-    std::wstring g_msgContent;
-    std::wstring g_boxTitle;
-    int g_selectedId = 0;
+#pragma region 缓存预算
+// 对库和应用程序的缓存施加统一的字节上限。超出上限时，在所有缓存中一并淘汰每字节重新计算代价最低、最久未使用的条目
 
-    LRESULT CALLBACK MessageBoxDialogProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lParam) {
-        
-        static HWND hStaticMsg = NULL;
-        static std::vector<HWND> hButtons;
-        static HBRUSH hDefaultBrush = CreateSolidBrush(RGB(240, 240, 240));
-        static HFONT hFont = NULL;
+#ifndef __GCOMMDLG_CACHE_BUDGET
+#define __GCOMMDLG_CACHE_BUDGET  (128ull * 1024 * 1024)  // 受预算约束的缓存的默认字节上限，0表示不限制
+#endif
+#ifndef __GCOMMDLG_PRESSURE_KEEP
+#define __GCOMMDLG_PRESSURE_KEEP 50                      // 每次系统报告内存压力时保留的预算字节百分比
+#endif
+
+class budgetedCache;
+
+namespace {
+
+    /**
+     * @brief 一个缓存条目的预算记录
+     */
+    struct budgetEntry {
+        size_t bytes;
+        double credit;      // 每字节的重新计算秒数
+        double priority;    // 最后一次使用时的淘汰下限 + credit，优先级最低的先被淘汰
+        uint64_t stamp;     // 最后一次存储或使用
+        uint64_t queued;    // 该条目在淘汰队列中的项的戳
+    };
+
+    /**
+     * @brief 淘汰队列中的项，条目再次被使用时延迟替换
+     */
+    struct budgetQueueItem {
+        double priority;
+        uint64_t stamp;
+        budgetedCache* cache;
+        std::string key;
+
+        bool operator<(const budgetQueueItem& other) const {
+            return priority > other.priority;   // 让std::priority_queue把最低优先级放在顶部
+        }
+    };
+
+    /**
+     * @brief 缓存预算的状态。条目按GreedyDual-Size淘汰：每次淘汰都把下限提高到被淘汰条目的
+     * 优先级，因此不再被使用的条目即使计算代价很高，最终也会老化淘汰
+     */
+    struct cacheBudgetState {
+        std::mutex mutex;
+        std::recursive_mutex evicting;  // evictEntry运行期间持有，使budgetLeave可以等待它
+        std::unordered_map<budgetedCache*, std::unordered_map<std::string, budgetEntry>> caches;
+        std::priority_queue<budgetQueueItem> queue;
+        size_t entryCount = 0;
+        double floor = 0;
+        uint64_t stamp = 0;
+        std::atomic<unsigned long long> used{0};
+        std::atomic<unsigned long long> limit{__GCOMMDLG_CACHE_BUDGET};
+    };
+
+    cacheBudgetState g_cacheBudget;
+
+    /**
+     * @brief 过期项多于条目时重建淘汰队列，调用时必须持有g_cacheBudget.mutex
+     */
+    void compactBudgetQueue() {
+        if (g_cacheBudget.queue.size() <= 2 * g_cacheBudget.entryCount + 1024) return;
+        std::priority_queue<budgetQueueItem> queue;
+        for (auto& cache : g_cacheBudget.caches) {
+            for (auto& entry : cache.second) {
+                entry.second.queued = entry.second.stamp;
+                queue.push(budgetQueueItem{entry.second.priority, entry.second.stamp, cache.first, entry.first});
+            }
+        }
+        g_cacheBudget.queue.swap(queue);
+    }
+
+    /**
+     * @brief 从预算中移除下一个要淘汰的条目，调用时必须持有g_cacheBudget.mutex
+     * @param bytes 接收该条目计入的大小
+     * @return 是否有条目
+     */
+    bool takeBudgetVictim(budgetedCache*& cache, std::string& key, size_t& bytes) {
+        auto& queue = g_cacheBudget.queue;
+        while (!queue.empty()) {
+            budgetQueueItem item = queue.top();
+            queue.pop();
+            auto owner = g_cacheBudget.caches.find(item.cache);
+            if (owner == g_cacheBudget.caches.end()) continue;
+            auto it = owner->second.find(item.key);
+            if (it == owner->second.end() || it->second.queued != item.stamp) continue;
+
+            budgetEntry& entry = it->second;
+            if (entry.stamp != item.stamp) {
+                // 入队后被使用过，按当前优先级重新入队
+                entry.queued = entry.stamp;
+                item.priority = entry.priority;
+                item.stamp = entry.stamp;
+                queue.push(std::move(item));
+                continue;
+            }
+
+            g_cacheBudget.floor = std::max(g_cacheBudget.floor, entry.priority);
+            g_cacheBudget.used -= entry.bytes;
+            --g_cacheBudget.entryCount;
+            bytes = static_cast<size_t>(entry.bytes);
+            owner->second.erase(it);
+            cache = item.cache;
+            key = std::move(item.key);
+            return true;
+        }
+        return false;
+    }
+
+    void trimCacheBudget(unsigned long long targetBytes);
+
+}
+
+/**
+ * @brief 条目计入全局缓存预算（参见setCacheBudget）的缓存的基类
+ *
+ * 缓存用budgetStore报告添加的每个条目，用budgetUse报告每次命中，用budgetDrop报告自行移除的每个条目。
+ * 当所有缓存的预算字节数超过上限，或系统报告内存压力（参见watchMemoryPressure）时，预算在所有缓存中
+ * 挑选条目，每字节重新计算代价最低、最久未使用的优先，并通过evictEntry逐个移除。
+ * 库的压缩包索引、目录列表、系统字体索引和iconResolver的图标都以这种方式受预算约束。
+ *
+ * evictEntry可能获取缓存自己的锁，因此budgetStore从不淘汰：释放该锁后调用enforceCacheBudget。
+ * 派生类在析构函数中首先调用budgetLeave，这样淘汰不会触及析构到一半的缓存。
+ */
+class budgetedCache {
+public:
+    budgetedCache() = default;
+    budgetedCache(const budgetedCache&) = delete;
+    budgetedCache& operator=(const budgetedCache&) = delete;
+
+    virtual ~budgetedCache() {
+        budgetLeave();
+    }
+
+    /**
+     * @brief 添加一个条目，或替换键相同的条目
+     * @param key 条目键，在此缓存内唯一
+     * @param bytes 条目持有的字节数
+     * @param cost 重新计算该条目所需的秒数
+     */
+    void budgetStore(const std::string& key, size_t bytes, double cost) {
+        std::lock_guard<std::mutex> lock(g_cacheBudget.mutex);
+        double credit = cost / static_cast<double>(std::max<size_t>(bytes, 1));
+        uint64_t stamp = ++g_cacheBudget.stamp;
+        auto inserted = g_cacheBudget.caches[this].emplace(key, budgetEntry{bytes, credit, g_cacheBudget.floor + credit, stamp, stamp});
+        budgetEntry& entry = inserted.first->second;
+        if (inserted.second) {
+            ++g_cacheBudget.entryCount;
+            g_cacheBudget.queue.push(budgetQueueItem{entry.priority, stamp, this, key});
+        } else {
+            g_cacheBudget.used -= entry.bytes;
+            entry.bytes = bytes;
+            entry.credit = credit;
+            entry.priority = g_cacheBudget.floor + credit;
+            entry.stamp = stamp;
+        }
+        g_cacheBudget.used += bytes;
+    }
+
+    /**
+     * @brief 将条目标记为已使用，预算已将其淘汰时忽略
+     */
+    void budgetUse(const std::string& key) {
+        std::lock_guard<std::mutex> lock(g_cacheBudget.mutex);
+        auto owner = g_cacheBudget.caches.find(this);
+        if (owner == g_cacheBudget.caches.end()) return;
+        auto it = owner->second.find(key);
+        if (it == owner->second.end()) return;
+        it->second.priority = g_cacheBudget.floor + it->second.credit;
+        it->second.stamp = ++g_cacheBudget.stamp;
+    }
+
+    /**
+     * @brief 移除缓存自行丢弃的条目
+     */
+    void budgetDrop(const std::string& key) {
+        std::lock_guard<std::mutex> lock(g_cacheBudget.mutex);
+        auto owner = g_cacheBudget.caches.find(this);
+        if (owner == g_cacheBudget.caches.end()) return;
+        auto it = owner->second.find(key);
+        if (it == owner->second.end()) return;
+        g_cacheBudget.used -= it->second.bytes;
+        --g_cacheBudget.entryCount;
+        owner->second.erase(it);
+        compactBudgetQueue();
+    }
+
+    /**
+     * @brief 从预算中移除此缓存的所有条目，并等待进行中的淘汰
+     */
+    void budgetLeave() {
+        std::lock_guard<std::recursive_mutex> evicting(g_cacheBudget.evicting);
+        std::lock_guard<std::mutex> lock(g_cacheBudget.mutex);
+        auto owner = g_cacheBudget.caches.find(this);
+        if (owner == g_cacheBudget.caches.end()) return;
+        for (const auto& entry : owner->second) g_cacheBudget.used -= entry.second.bytes;
+        g_cacheBudget.entryCount -= owner->second.size();
+        g_cacheBudget.caches.erase(owner);
+        compactBudgetQueue();
+    }
+
+    /**
+     * @brief 移除预算选中的条目。调用时不持有预算的锁；该键可能已不存在
+     */
+    virtual void evictEntry(const std::string& key) = 0;
+};
+
+namespace {
+
+    /**
+     * @brief 淘汰条目，直到预算字节数不超过'targetBytes'
+     */
+    void trimCacheBudget(unsigned long long targetBytes) {
+        std::lock_guard<std::recursive_mutex> evicting(g_cacheBudget.evicting);
+        __GCOMMDLG_PROBE2(cache__trim, targetBytes, static_cast<unsigned long long>(g_cacheBudget.used));
+        while (g_cacheBudget.used > targetBytes) {
+            budgetedCache* cache;
+            std::string key;
+            size_t bytes;
+            {
+                std::lock_guard<std::mutex> lock(g_cacheBudget.mutex);
+                if (!takeBudgetVictim(cache, key, bytes)) return;
+            }
+            __GCOMMDLG_PROBE2(cache__evict, key.c_str(), bytes);
+            cache->evictEntry(key);
+        }
+    }
+
+    /**
+     * @brief 在系统报告内存压力时淘汰缓存条目的后台线程：
+     * Linux上为PSI触发器，Windows上为低内存资源通知
+     */
+    class memoryPressureWatch {
+    public:
+        ~memoryPressureWatch() {
+            stop();
+        }
+
+        bool start() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_thread.joinable()) {
+                if (!m_ended) return true;
+                // 线程已自行退出（例如poll出错），此时没有任何监视，重新开始
+                reap();
+            }
+            m_ended = false;
+#ifdef _WIN32
+            m_low = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+            m_stop = CreateEventW(NULL, TRUE, FALSE, NULL);
+            if (!m_low || !m_stop) {
+                closeHandles();
+                return false;
+            }
+            m_thread = std::thread([this] {
+                HANDLE handles[2] = {m_stop, m_low};
+                while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+                    relieve();
+                    // 内存不足期间通知一直处于有信号状态，一秒后再检查
+                    if (WaitForSingleObject(m_stop, 1000) == WAIT_OBJECT_0) break;
+                }
+                m_ended = true;
+            });
+            return true;
+#elif defined(__linux__)
+            // 任务在2秒内因内存停顿150毫秒时唤醒，2秒是非特权进程可用的最短窗口
+            static const char trigger[] = "some 150000 2000000";
+            int pressure = open("/proc/pressure/memory", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (pressure < 0) return false;
+            if (write(pressure, trigger, sizeof(trigger)) < 0 || pipe(m_wake) != 0) {
+                close(pressure);
+                return false;
+            }
+            m_thread = std::thread([this, pressure] {
+                pollfd fds[2] = {{pressure, POLLPRI, 0}, {m_wake[0], POLLIN, 0}};
+                while (true) {
+                    if (poll(fds, 2, -1) < 0) {
+                        if (errno == EINTR) continue;
+                        break;
+                    }
+                    if (fds[1].revents || (fds[0].revents & (POLLERR | POLLNVAL))) break;
+                    if (fds[0].revents & POLLPRI) relieve();
+                }
+                close(pressure);
+                m_ended = true;
+            });
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        void stop() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_thread.joinable()) return;
+#ifdef _WIN32
+            SetEvent(m_stop);
+#elif defined(__linux__)
+            char byte = 0;
+            while (write(m_wake[1], &byte, 1) < 0 && errno == EINTR) {
+            }
+#endif
+            reap();
+        }
+
+    private:
+        /**
+         * @brief 等待已退出或已被要求退出的线程结束，并释放start()创建的资源
+         */
+        void reap() {
+            m_thread.join();
+#ifdef _WIN32
+            closeHandles();
+#elif defined(__linux__)
+            close(m_wake[0]);
+            close(m_wake[1]);
+#endif
+        }
+
+        static void relieve() {
+            trimCacheBudget(g_cacheBudget.used / 100 * __GCOMMDLG_PRESSURE_KEEP);
+        }
+
+#ifdef _WIN32
+        void closeHandles() {
+            if (m_low) CloseHandle(m_low);
+            if (m_stop) CloseHandle(m_stop);
+            m_low = m_stop = NULL;
+        }
+
+        HANDLE m_low = NULL;
+        HANDLE m_stop = NULL;
+#elif defined(__linux__)
+        int m_wake[2] = {-1, -1};
+#endif
+        std::mutex m_mutex;
+        std::thread m_thread;
+        std::atomic<bool> m_ended{false};   // 线程停止监视时设置
+    };
+
+    memoryPressureWatch g_memoryPressureWatch;
+
+}
+
+/**
+ * @brief 设置受预算约束的缓存（参见budgetedCache）的字节上限，超出时立即淘汰
+ * @param bytes 新的上限，0表示不限制。默认值为__GCOMMDLG_CACHE_BUDGET
+ */
+void setCacheBudget(unsigned long long bytes) {
+    g_cacheBudget.limit = bytes;
+    if (bytes) trimCacheBudget(bytes);
+}
+
+/**
+ * @brief 所有受预算约束的缓存的条目持有的字节数
+ */
+unsigned long long budgetedCacheBytes() {
+    return g_cacheBudget.used;
+}
+
+/**
+ * @brief 淘汰受预算约束的缓存条目，直到它们持有不超过'targetBytes'字节，例如在应用程序最小化时
+ * @param targetBytes 保留的字节数，0表示清空受预算约束的缓存
+ */
+void trimCaches(unsigned long long targetBytes = 0) {
+    trimCacheBudget(targetBytes);
+}
+
+/**
+ * @brief 受预算约束的缓存超过上限时淘汰条目。由缓存在调用budgetedCache::budgetStore
+ * 并释放自己的锁之后调用
+ */
+void enforceCacheBudget() {
+    unsigned long long limit = g_cacheBudget.limit;
+    if (limit && g_cacheBudget.used > limit) trimCacheBudget(limit);
+}
+
+/**
+ * @brief 启动或停止一个后台线程，每当系统报告内存压力时淘汰受预算约束的缓存条目，
+ * 每次保留__GCOMMDLG_PRESSURE_KEEP百分比的预算字节
+ *
+ * 压力信号在Linux上来自/proc/pressure/memory上的PSI触发器（内核4.20，非特权进程需要6.5），
+ * 在Windows上来自低内存资源通知。
+ * @param enable 是否监视
+ * @return 系统是否提供压力信号，停止时总是返回true
+ */
+bool watchMemoryPressure(bool enable = true) {
+    if (!enable) {
+        g_memoryPressureWatch.stop();
+        return true;
+    }
+    return g_memoryPressureWatch.start();
+}
+
+#pragma endregion
+
+#pragma region 性能计数器
+// 围绕一段代码的硬件计数器，使基准测试不仅能看出内核变慢了，还能看出为什么变慢
+
+/**
+ * @brief 一次测量的墙钟时间和硬件计数，来自measureIterations时为每次迭代的值。
+ * 系统不提供的计数器为-1
+ */
+struct perfCounterSample {
+    double seconds = 0;
+    double cycles = -1;
+    double instructions = -1;
+    double branchMisses = -1;
+    double cacheMisses = -1;    // 末级缓存未命中
+
+    /**
+     * @brief 每周期指令数，任一计数缺失时为0
+     */
+    double instructionsPerCycle() const {
+        return cycles > 0 && instructions >= 0 ? instructions / cycles : 0;
+    }
+};
+
+/**
+ * @brief 统计调用线程在start和stop之间的周期数、指令数、分支预测失败数和缓存未命中数
+ *
+ * 在Linux上，计数器作为一个perf_event_open组打开，仅统计用户空间，因此它们同时运行，其比值
+ * （IPC、每条指令的未命中数）有意义；与PMU的其他使用者分时复用的计数会按比例放大到完整时间。
+ * 非特权使用需要kernel.perf_event_paranoid不高于2，这是大多数发行版的默认值。在其他平台、没有PMU的
+ * 容器中以及paranoid设置禁止时，只测量墙钟时间。
+ */
+class perfCounters {
+public:
+    perfCounters() {
+#ifdef __linux__
+        static const uint64_t events[4] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                           PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < 4; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = events[i];
+            attr.disabled = m_leader < 0 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, PERF_FLAG_FD_CLOEXEC));
+            if (fd < 0) continue;
+            if (m_leader < 0) m_leader = fd;
+            m_events[m_count] = i;
+            m_fds[m_count++] = fd;
+        }
+#endif
+    }
+
+    ~perfCounters() {
+#ifdef __linux__
+        for (int i = 0; i < m_count; ++i) close(m_fds[i]);
+#endif
+    }
+
+    perfCounters(const perfCounters&) = delete;
+    perfCounters& operator=(const perfCounters&) = delete;
+
+    /**
+     * @brief 是否有任何硬件计数器可以打开
+     */
+    bool available() const {
+        return m_count > 0;
+    }
+
+    /**
+     * @brief 重置计数并开始计数
+     */
+    void start() {
+#ifdef __linux__
+        if (m_leader >= 0) {
+            ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+        m_started = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief 停止计数
+     * @return 自start以来的计数
+     */
+    perfCounterSample stop() {
+        perfCounterSample sample;
+        sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_started).count();
+#ifdef __linux__
+        if (m_leader < 0) return sample;
+        ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // nr、启用时间、运行时间，然后按计数器加入组的顺序每个计数器一个值
+        uint64_t values[3 + 4];
+        if (read(m_leader, values, sizeof(values)) < static_cast<ssize_t>(3 * sizeof(uint64_t)) || values[2] == 0) return sample;
+        double scale = static_cast<double>(values[1]) / static_cast<double>(values[2]);
+        double* counts[4] = {&sample.cycles, &sample.instructions, &sample.branchMisses, &sample.cacheMisses};
+        for (int i = 0; i < m_count && static_cast<uint64_t>(i) < values[0]; ++i) {
+            *counts[m_events[i]] = static_cast<double>(values[3 + i]) * scale;
+        }
+#endif
+        return sample;
+    }
+
+private:
+#ifdef __linux__
+    int m_fds[4] = {-1, -1, -1, -1};
+    int m_events[4] = {0, 0, 0, 0};     // 每个已打开计数器在perfCounterSample中的顺序索引
+    int m_leader = -1;
+#endif
+    int m_count = 0;
+    std::chrono::steady_clock::time_point m_started;
+};
+
+/**
+ * @brief 在多次迭代中测量一段代码，例如一次过滤器转换或字体匹配
+ *
+ * 代码先不计时运行一次，因此第一次运行的缺页、延迟初始化和冷缓存不会计入，
+ * 然后在perfCounters的start和stop之间运行'iterations'次。
+ * @param body 要测量的代码
+ * @param iterations 测量的运行次数
+ * @return 除以'iterations'后的墙钟时间和硬件计数
+ * @throw std::invalid_argument 当'iterations'为0时抛出
+ */
+perfCounterSample measureIterations(const std::function<void()>& body, size_t iterations = 1) {
+    if (iterations == 0) {
+        throw std::invalid_argument("At least one iteration must be measured");
+    }
+    body();
+
+    perfCounters counters;
+    counters.start();
+    for (size_t i = 0; i < iterations; ++i) body();
+    perfCounterSample sample = counters.stop();
+
+    double runs = static_cast<double>(iterations);
+    sample.seconds /= runs;
+    for (double* count : {&sample.cycles, &sample.instructions, &sample.branchMisses, &sample.cacheMisses}) {
+        if (*count >= 0) *count /= runs;
+    }
+    return sample;
+}
+
+#pragma endregion
+
+#pragma region 任务调度器
+// 库中后台工作（字体扫描、重复文件哈希、选择展开、预读和推测加载）共用的一个线程池，
+// 使并行的各子系统加起来的线程数不会超过核心数。宿主程序也可以换用自己的执行器
+
+#ifndef __GCOMMDLG_TASK_THREADS
+#define __GCOMMDLG_TASK_THREADS 0  // 内置调度器的线程数，0表示每个CPU核心一个再减去一个，留给等待并协助执行的调用者
+#endif
+
+/**
+ * @brief 任务排队所在的通道
+ */
+enum taskPriority {
+    taskInteractive,    // 用户正在等待的工作，例如展开选中的文件夹
+    taskBackground,     // 可能需要一段时间的工作，例如扫描字体或计算文件哈希
+    taskIdle            // 推测性的工作，仅在没有其他任务排队时运行，且同一时间只由一个池线程运行
+};
+
+/**
+ * @brief 运行库中的任务，可通过setTaskExecutor替换为宿主程序自己的线程池
+ */
+class taskExecutor {
+public:
+    virtual ~taskExecutor() = default;
+
+    /**
+     * @brief 在任意线程上立即或稍后运行'task'一次。不得抛出异常，任务本身从不抛出异常
+     * @param task 要运行的任务
+     * @param priority 任务的通道，没有通道的执行器可以忽略
+     */
+    virtual void execute(std::function<void()> task, taskPriority priority) = 0;
+
+    /**
+     * @brief 执行器并行运行的任务数，用于决定将工作拆分为多少个任务
+     */
+    virtual unsigned concurrency() const = 0;
+};
+
+namespace {
+
+    /**
+     * @brief 内置执行器：每个工作线程有一个用于交互和后台通道的双端队列，每条通道有一个共享队列
+     * 存放从其他线程排队的任务，另有一个共享的空闲队列
+     *
+     * 工作线程逐条通道先取自己最新的任务，再取从外部排队的最早任务，然后窃取其他工作线程最早的任务，
+     * 因此任务派生的任务会留在派生它们的核心上，直到另一个核心没有工作可做。
+     */
+    class workStealingPool : public taskExecutor {
+    public:
+        explicit workStealingPool(unsigned threadCount) {
+            for (unsigned i = 0; i < threadCount; ++i) {
+                m_workers.emplace_back(new worker);
+            }
+            for (unsigned i = 0; i < threadCount; ++i) {
+                m_threads.emplace_back([this, i] { work(i); });
+            }
+        }
+
+        /**
+         * @brief 运行所有排队的任务，然后停止线程。不得在这些线程之一上调用，见 destroy
+         */
+        ~workStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (auto& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+        workStealingPool(const workStealingPool&) = delete;
+        workStealingPool& operator=(const workStealingPool&) = delete;
+
+        /**
+         * @brief 线程池的删除器。最后一个引用由它自己的任务释放时，改由新线程而不是工作线程自身来等待各线程结束
+         */
+        static void destroy(workStealingPool* pool) {
+            if (t_pool == pool) {
+                std::thread([pool] { delete pool; }).detach();
+            } else {
+                delete pool;
+            }
+        }
+
+        void execute(std::function<void()> task, taskPriority priority) override {
+            if (priority != taskIdle && t_pool == this) {
+                worker& self = *m_workers[t_worker];
+                std::lock_guard<std::mutex> lock(self.mutex);
+                self.lanes[priority].push_back(std::move(task));
+                ++m_queued;
+                task = nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (task) {
+                m_injected[priority].push_back(std::move(task));
+                if (priority != taskIdle) ++m_queued;
+            }
+            if (m_sleeping > 0) m_wake.notify_one();
+        }
+
+        unsigned concurrency() const override {
+            return static_cast<unsigned>(m_threads.size());
+        }
+
+    private:
+        struct worker {
+            std::mutex mutex;
+            std::deque<std::function<void()>> lanes[2];    // 此工作线程排队的交互和后台任务
+        };
+
+        void work(unsigned index) {
+            t_pool = this;
+            t_worker = index;
+            while (true) {
+                std::function<void()> task;
+                bool idle = false;
+                if (!take(index, task, idle)) {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    if (runnable()) continue;
+                    if (m_stop && (m_injected[taskIdle].empty() || m_idleRunning > 0)) return;
+                    ++m_sleeping;
+                    m_wake.wait(lock);
+                    --m_sleeping;
+                    continue;
+                }
+
+                try {
+                    task();
+                } catch (...) {
+                }
+                task = nullptr;
+
+                if (idle) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    --m_idleRunning;
+                    if (m_sleeping > 0 && (m_stop || !m_injected[taskIdle].empty())) m_wake.notify_all();
+                }
+            }
+        }
+
+        bool take(unsigned index, std::function<void()>& task, bool& idle) {
+            size_t count = m_workers.size();
+            for (int lane = taskInteractive; m_queued > 0 && lane <= taskBackground; ++lane) {
+                {
+                    worker& self = *m_workers[index];
+                    std::lock_guard<std::mutex> lock(self.mutex);
+                    if (!self.lanes[lane].empty()) {
+                        task = std::move(self.lanes[lane].back());
+                        self.lanes[lane].pop_back();
+                        --m_queued;
+                        return true;
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_injected[lane].empty()) {
+                        task = std::move(m_injected[lane].front());
+                        m_injected[lane].pop_front();
+                        --m_queued;
+                        return true;
+                    }
+                }
+                for (size_t i = 1; i < count; ++i) {
+                    worker& victim = *m_workers[(index + i) % count];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.lanes[lane].empty()) {
+                        task = std::move(victim.lanes[lane].front());
+                        victim.lanes[lane].pop_front();
+                        --m_queued;
+                        return true;
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_queued == 0 && m_idleRunning == 0 && !m_injected[taskIdle].empty()) {
+                task = std::move(m_injected[taskIdle].front());
+                m_injected[taskIdle].pop_front();
+                ++m_idleRunning;
+                idle = true;
+                return true;
+            }
+            return false;
+        }
+
+        // 调用时必须持有m_mutex
+        bool runnable() const {
+            return m_queued > 0 || (m_idleRunning == 0 && !m_injected[taskIdle].empty());
+        }
+
+        static thread_local workStealingPool* t_pool;
+        static thread_local unsigned t_worker;
+
+        std::vector<std::unique_ptr<worker>> m_workers;
+        std::vector<std::thread> m_threads;
+        std::atomic<size_t> m_queued{0};                    // 尚未被取走的交互和后台任务
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::deque<std::function<void()>> m_injected[3];   // 从池外排队的任务，以及所有空闲任务
+        unsigned m_idleRunning = 0;
+        unsigned m_sleeping = 0;
+        bool m_stop = false;
+    };
+
+    thread_local workStealingPool* workStealingPool::t_pool = nullptr;
+    thread_local unsigned workStealingPool::t_worker = 0;
+
+    struct taskSchedulerState {
+        std::mutex mutex;
+        std::shared_ptr<taskExecutor> host;     // 由setTaskExecutor设置
+        std::shared_ptr<taskExecutor> pool;     // 内置线程池，首次使用时启动
+        unsigned threads = __GCOMMDLG_TASK_THREADS;
+    };
+    taskSchedulerState g_taskScheduler;
+
+    std::shared_ptr<taskExecutor> currentTaskExecutor() {
+        std::lock_guard<std::mutex> lock(g_taskScheduler.mutex);
+        if (g_taskScheduler.host) return g_taskScheduler.host;
+        if (!g_taskScheduler.pool) {
+            unsigned threads = g_taskScheduler.threads;
+            if (threads == 0) threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+            g_taskScheduler.pool = std::shared_ptr<workStealingPool>(new workStealingPool(threads), workStealingPool::destroy);
+        }
+        return g_taskScheduler.pool;
+    }
+
+}
+
+/**
+ * @brief 一起等待和取消的任务，例如一个selectionExpander的遍历任务
+ *
+ * 调用wait时尚未开始的任务会在等待的线程上运行，因此等待从不依赖执行器有空闲线程，
+ * 即使执行器繁忙或等待的线程正是它自己的线程。
+ */
+class taskGroup {
+public:
+    taskGroup() : m_state(std::make_shared<state>()) {}
+
+    /**
+     * @brief 取消尚未开始的任务，并等待正在运行的任务
+     */
+    ~taskGroup() {
+        cancel();
+        finish();
+    }
+
+    taskGroup(const taskGroup&) = delete;
+    taskGroup& operator=(const taskGroup&) = delete;
+
+    /**
+     * @brief 将任务排入当前执行器
+     * @param task 要运行的任务，其抛出的异常由wait重新抛出
+     * @param priority 任务排队所在的通道
+     */
+    void run(std::function<void()> task, taskPriority priority = taskBackground) {
+        auto entry = std::make_shared<pendingTask>();
+        entry->body = std::move(task);
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            m_state->unstarted.push_back(entry);
+            ++m_state->pending;
+        }
+        std::shared_ptr<state> group = m_state;
+        currentTaskExecutor()->execute([group, entry] { runTask(*group, *entry); }, priority);
+    }
+
+    /**
+     * @brief 跳过尚未开始的任务。正在运行的任务可以检查cancelled()以提前停止
+     */
+    void cancel() {
+        m_state->cancelled = true;
+    }
+
+    bool cancelled() const {
+        return m_state->cancelled;
+    }
+
+    /**
+     * @brief 等待所有任务完成或被跳过，尚未开始的任务在调用线程上运行
+     * @throw 重新抛出任务抛出的第一个异常
+     */
+    void wait() {
+        finish();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            std::swap(error, m_state->error);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    struct pendingTask {
+        std::atomic<bool> claimed{false};   // 由先运行它的一方设置，执行器或等待的线程
+        std::function<void()> body;
+    };
+
+    struct state {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::deque<std::shared_ptr<pendingTask>> unstarted;
+        size_t pending = 0;
+        std::atomic<bool> cancelled{false};
+        std::exception_ptr error;
+    };
+
+    static void runTask(state& group, pendingTask& task) {
+        if (task.claimed.exchange(true)) return;
+        if (!group.cancelled) {
+            try {
+                task.body();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(group.mutex);
+                if (!group.error) group.error = std::current_exception();
+            }
+        }
+        task.body = nullptr;
+
+        std::lock_guard<std::mutex> lock(group.mutex);
+        while (!group.unstarted.empty() && group.unstarted.front()->claimed) {
+            group.unstarted.pop_front();
+        }
+        if (--group.pending == 0) group.done.notify_all();
+    }
+
+    void finish() {
+        while (true) {
+            std::shared_ptr<pendingTask> task;
+            {
+                std::unique_lock<std::mutex> lock(m_state->mutex);
+                while (!task && !m_state->unstarted.empty()) {
+                    if (!m_state->unstarted.back()->claimed) task = m_state->unstarted.back();
+                    m_state->unstarted.pop_back();
+                }
+                if (!task) {
+                    m_state->done.wait(lock, [this] { return m_state->pending == 0; });
+                    return;
+                }
+            }
+            runTask(*m_state, *task);
+        }
+    }
+
+    std::shared_ptr<state> m_state;
+};
+
+/**
+ * @brief 在宿主程序的执行器上运行库中的任务，而不是内置线程池
+ *
+ * @param executor 要使用的执行器，nullptr表示恢复使用内置线程池
+ *
+ * @note 已排队的任务留在其排队的执行器上，内置线程池在其排队的任务运行完后停止
+ */
+void setTaskExecutor(std::shared_ptr<taskExecutor> executor) {
+    std::shared_ptr<taskExecutor> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_taskScheduler.mutex);
+        g_taskScheduler.host = std::move(executor);
+        if (g_taskScheduler.host) std::swap(previous, g_taskScheduler.pool);
+    }
+}
+
+/**
+ * @brief 设置内置线程池的线程数，线程池在下次使用时以该线程数重新启动
+ *
+ * @param threadCount 线程数，0表示每个CPU核心一个再减去一个
+ *
+ * @note 等待当前线程池中排队的任务；若在其任务中调用，旧线程池在后台运行完排队任务后停止
+ */
+void setTaskThreads(unsigned threadCount) {
+    std::shared_ptr<taskExecutor> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_taskScheduler.mutex);
+        g_taskScheduler.threads = threadCount;
+        std::swap(previous, g_taskScheduler.pool);
+    }
+}
+
+/**
+ * @brief 当前执行器并行运行的任务数
+ */
+unsigned taskConcurrency() {
+    return std::max(1u, currentTaskExecutor()->concurrency());
+}
+
+#pragma endregion
+
+#pragma region 压缩包索引
+// tar / tar.gz 压缩包的成员索引。每个压缩包只扫描一次并缓存索引，gzip压缩包还会额外记录deflate重启检查点，读取成员时无需从头解压
+
+#ifndef __GCOMMDLG_GZ_CHECKPOINT_SPAN
+#define __GCOMMDLG_GZ_CHECKPOINT_SPAN (4 * 1024 * 1024)  // 两个gzip检查点之间的最小解压后距离
+#endif
+#ifndef __GCOMMDLG_ARCHIVE_IO_CHUNK
+#define __GCOMMDLG_ARCHIVE_IO_CHUNK   65536              // 读取压缩包时使用的缓冲区大小
+#endif
+
+/**
+ * @brief 压缩包中一个成员的信息
+ */
+struct archiveMemberInfo {
+    std::string name;           // 压缩包内的路径（UTF8编码，以'/'分隔）
+    unsigned long long size;    // 解压后的字节数
+    bool isDirectory;
+};
+
+namespace {
+
+    /**
+     * @brief 以二进制读取方式打开文件
+     * @param path 文件路径（UTF8编码）
+     * @return 文件句柄，无法打开或不是普通文件时返回nullptr
+     */
+    FILE* openFileForRead(const std::string& path) {
+#ifdef _WIN32
+        return _wfopen(utf8ToWide(path).c_str(), L"rb");
+#else
+        // 普通的open会在FIFO上阻塞到出现写入方为止，因此在读取前拒绝管道和设备
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOCTTY);
+        if (fd < 0) return nullptr;
+        FILE* file = nullptr;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+            file = fdopen(fd, "rb");
+        }
+        if (!file) close(fd);
+        return file;
+#endif
+    }
+
+    /**
+     * @brief 以64位偏移在文件中定位
+     * @return 成功时返回0，与fseek相同
+     */
+    int seekFile(FILE* file, long long offset, int origin) {
+#ifdef _WIN32
+        return _fseeki64(file, offset, origin);
+#else
+        return fseeko(file, static_cast<off_t>(offset), origin);
+#endif
+    }
+
+    /**
+     * @brief 获取文件大小和最后写入时间，用于判断缓存的索引是否过期
+     * @param path 文件路径（UTF8编码）
+     * @param size 输出的文件大小
+     * @param stamp 输出的最后写入时间
+     * @return 文件是否存在
+     */
+    bool getFileStamp(const std::string& path, unsigned long long& size, unsigned long long& stamp) {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExW(utf8ToWide(path).c_str(), GetFileExInfoStandard, &data)) {
+            return false;
+        }
+        size = (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        stamp = (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                data.ftLastWriteTime.dwLowDateTime;
+#else
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            return false;
+        }
+        size = static_cast<unsigned long long>(st.st_size);
+#ifdef __APPLE__
+        stamp = static_cast<unsigned long long>(st.st_mtimespec.tv_sec) * 1000000000ull + st.st_mtimespec.tv_nsec;
+#else
+        stamp = static_cast<unsigned long long>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+#endif
+#endif
+        return true;
+    }
+
+    const unsigned short g_inflateLengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    const unsigned char g_inflateLengthExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    const unsigned short g_inflateDistBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    const unsigned char g_inflateDistExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+
+    /**
+     * @brief 用一段数据更新CRC-32（gzip多项式）
+     */
+    uint32_t updateCrc32(uint32_t crc, const unsigned char* data, size_t size) {
+        static const std::vector<uint32_t> table = [] {
+            std::vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    /**
+     * @brief 范式哈夫曼表，不超过9位的编码只需一次查表
+     */
+    struct inflateHuffman {
+        unsigned short counts[16];
+        unsigned short symbols[288];
+        unsigned short fast[1 << 9];    // (编码长度 << 9) | 符号，编码超过9位时为0
+    };
+
+    /**
+     * @brief 根据编码长度构建哈夫曼表
+     * @throw std::runtime_error 编码超额订阅时抛出
+     */
+    void buildInflateHuffman(inflateHuffman& h, const unsigned char* lengths, int count) {
+        std::memset(h.counts, 0, sizeof(h.counts));
+        std::memset(h.fast, 0, sizeof(h.fast));
+        for (int s = 0; s < count; ++s) h.counts[lengths[s]]++;
+
+        int left = 1;
+        for (int len = 1; len < 16; ++len) {
+            left = (left << 1) - h.counts[len];
+            if (left < 0) {
+                throw std::runtime_error("Invalid deflate stream: over-subscribed Huffman code");
+            }
+        }
+
+        unsigned short offsets[16] = {0};
+        for (int len = 1; len < 15; ++len) offsets[len + 1] = offsets[len] + h.counts[len];
+        for (int s = 0; s < count; ++s) {
+            if (lengths[s] != 0) h.symbols[offsets[lengths[s]]++] = static_cast<unsigned short>(s);
+        }
+
+        int code = 0;
+        int index = 0;
+        for (int len = 1; len <= 9; ++len) {
+            for (int i = 0; i < h.counts[len]; ++i) {
+                unsigned reversed = 0;
+                for (int b = 0; b < len; ++b) {
+                    reversed |= ((static_cast<unsigned>(code + i) >> b) & 1u) << (len - 1 - b);
+                }
+                unsigned short entry = static_cast<unsigned short>((len << 9) | h.symbols[index + i]);
+                for (unsigned fill = reversed; fill < (1u << 9); fill += 1u << len) {
+                    h.fast[fill] = entry;
+                }
+            }
+            index += h.counts[len];
+            code = (code + h.counts[len]) << 1;
+        }
+    }
+
+    /**
+     * @brief 按deflate的位序（低位在前）逐位读取文件或内存块
+     */
+    class deflateBitReader {
+    public:
+        explicit deflateBitReader(FILE* file) : m_file(file), m_buffer(__GCOMMDLG_ARCHIVE_IO_CHUNK) {}
+
+        deflateBitReader(const unsigned char* data, size_t size) : m_file(nullptr), m_data(data), m_bufferEnd(size) {}
+
+        /**
+         * @brief 从文件开头起已消耗的位数
+         */
+        unsigned long long bitPosition() const {
+            return (m_bufferBase + m_bufferPos) * 8 - m_bitCount;
+        }
+
+        void seekBits(unsigned long long bitPosition) {
+            unsigned long long byteOffset = bitPosition / 8;
+            if (seekFile(m_file, static_cast<long long>(byteOffset), SEEK_SET) != 0) {
+                throw std::runtime_error("Failed to seek in archive");
+            }
+            m_bufferBase = byteOffset;
+            m_bufferPos = m_bufferEnd = 0;
+            m_bitBuffer = 0;
+            m_bitCount = 0;
+            if (bitPosition % 8) bits(static_cast<int>(bitPosition % 8));
+        }
+
+        unsigned bits(int need) {
+            while (m_bitCount < need) {
+                int byte = nextByte();
+                if (byte < 0) throw std::runtime_error("Unexpected end of gzip stream");
+                m_bitBuffer |= static_cast<unsigned long long>(byte) << m_bitCount;
+                m_bitCount += 8;
+            }
+            unsigned value = static_cast<unsigned>(m_bitBuffer & ((1ull << need) - 1));
+            m_bitBuffer >>= need;
+            m_bitCount -= need;
+            return value;
+        }
+
+        void alignToByte() {
+            m_bitBuffer >>= m_bitCount % 8;
+            m_bitCount -= m_bitCount % 8;
+        }
+
+        bool atEnd() {
+            if (m_bitCount > 0) return false;
+            int byte = nextByte();
+            if (byte < 0) return true;
+            m_bitBuffer = static_cast<unsigned long long>(byte);
+            m_bitCount = 8;
+            return false;
+        }
+
+        int decode(const inflateHuffman& h) {
+            while (m_bitCount <= 56) {
+                int byte = nextByte();
+                if (byte < 0) break;
+                m_bitBuffer |= static_cast<unsigned long long>(byte) << m_bitCount;
+                m_bitCount += 8;
+            }
+            if (m_bitCount >= 9) {
+                unsigned short entry = h.fast[m_bitBuffer & 0x1FF];
+                if (entry != 0) {
+                    m_bitBuffer >>= entry >> 9;
+                    m_bitCount -= entry >> 9;
+                    return entry & 0x1FF;
+                }
+            }
+
+            int code = 0, first = 0, index = 0;
+            for (int len = 1; len < 16; ++len) {
+                code |= static_cast<int>(bits(1));
+                int count = h.counts[len];
+                if (code - count < first) {
+                    return h.symbols[index + (code - first)];
+                }
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+            throw std::runtime_error("Invalid deflate stream: bad Huffman code");
+        }
+
+    private:
+        int nextByte() {
+            if (m_bufferPos == m_bufferEnd) {
+                if (!m_file) return -1;
+                m_bufferBase += m_bufferEnd;
+                m_bufferPos = 0;
+                m_bufferEnd = fread(m_buffer.data(), 1, m_buffer.size(), m_file);
+                m_data = m_buffer.data();
+                if (m_bufferEnd == 0) return -1;
+            }
+            return m_data[m_bufferPos++];
+        }
+
+        FILE* m_file;
+        std::vector<unsigned char> m_buffer;
+        const unsigned char* m_data = nullptr;  // 读文件时指向m_buffer，读内存时指向内存块本身
+        unsigned long long m_bufferBase = 0;
+        size_t m_bufferPos = 0;
+        size_t m_bufferEnd = 0;
+        unsigned long long m_bitBuffer = 0;
+        int m_bitCount = 0;
+    };
+
+    /**
+     * @brief 构建固定Huffman块的码表（RFC 1951 3.2.6）
+     */
+    void buildFixedInflateTables(inflateHuffman& lengthCode, inflateHuffman& distCode) {
+        unsigned char lengths[288];
+        int s = 0;
+        for (; s < 144; ++s) lengths[s] = 8;
+        for (; s < 256; ++s) lengths[s] = 9;
+        for (; s < 280; ++s) lengths[s] = 7;
+        for (; s < 288; ++s) lengths[s] = 8;
+        buildInflateHuffman(lengthCode, lengths, 288);
+        for (s = 0; s < 30; ++s) lengths[s] = 5;
+        buildInflateHuffman(distCode, lengths, 30);
+    }
+
+    /**
+     * @brief 读取动态Huffman块的码长（RFC 1951 3.2.7）并构建码表
+     * @throw std::runtime_error 码长无效时抛出
+     */
+    void readDynamicInflateTables(deflateBitReader& reader, inflateHuffman& lengthCode, inflateHuffman& distCode) {
+        static const unsigned char order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        unsigned char lengths[320] = {0};
+
+        int lengthCount = static_cast<int>(reader.bits(5)) + 257;
+        int distCount = static_cast<int>(reader.bits(5)) + 1;
+        int codeCount = static_cast<int>(reader.bits(4)) + 4;
+        if (lengthCount > 286 || distCount > 30) {
+            throw std::runtime_error("Invalid deflate stream: bad code counts");
+        }
+
+        for (int i = 0; i < codeCount; ++i) lengths[order[i]] = static_cast<unsigned char>(reader.bits(3));
+        inflateHuffman codeLengthCode;
+        buildInflateHuffman(codeLengthCode, lengths, 19);
+
+        int index = 0;
+        while (index < lengthCount + distCount) {
+            int symbol = reader.decode(codeLengthCode);
+            if (symbol < 16) {
+                lengths[index++] = static_cast<unsigned char>(symbol);
+                continue;
+            }
+            unsigned char repeatLength = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (index == 0) throw std::runtime_error("Invalid deflate stream: repeat with no first length");
+                repeatLength = lengths[index - 1];
+                repeat = 3 + static_cast<int>(reader.bits(2));
+            } else if (symbol == 17) {
+                repeat = 3 + static_cast<int>(reader.bits(3));
+            } else {
+                repeat = 11 + static_cast<int>(reader.bits(7));
+            }
+            if (index + repeat > lengthCount + distCount) {
+                throw std::runtime_error("Invalid deflate stream: too many code lengths");
+            }
+            while (repeat--) lengths[index++] = repeatLength;
+        }
+        if (lengths[256] == 0) {
+            throw std::runtime_error("Invalid deflate stream: missing end-of-block code");
+        }
+
+        buildInflateHuffman(lengthCode, lengths, lengthCount);
+        buildInflateHuffman(distCode, lengths + lengthCount, distCount);
+    }
+
+    /**
+     * @brief gzip流中的重启点，位于deflate块边界
+     */
+    struct gzipCheckpoint {
+        unsigned long long bitPosition;     // 压缩数据中的位置（以位计）
+        unsigned long long outPosition;     // 解压后的位置
+        std::vector<unsigned char> window;  // 此位置之前最多32KB的输出
+    };
+
+    /**
+     * @brief 流式gzip解码器（RFC 1951/1952），可以记录检查点并从检查点恢复。支持多个gzip成员首尾相接。
+     */
+    class gzipInflater {
+    public:
+        explicit gzipInflater(FILE* file) : m_reader(file), m_window(32768) {}
+
+        /**
+         * @brief 在距上一个检查点至少'span'字节后的每个块边界记录检查点
+         */
+        void recordCheckpoints(std::vector<gzipCheckpoint>* checkpoints, unsigned long long span) {
+            m_checkpoints = checkpoints;
+            m_checkpointSpan = span;
+        }
+
+        /**
+         * @brief 从检查点恢复解码，之后不再校验当前成员的尾部
+         */
+        void restart(const gzipCheckpoint& checkpoint) {
+            m_reader.seekBits(checkpoint.bitPosition);
+            std::copy(checkpoint.window.begin(), checkpoint.window.end(), m_window.begin());
+            m_windowPos = checkpoint.window.size();
+            m_windowFill = checkpoint.window.size();
+            m_totalOut = checkpoint.outPosition;
+            m_lastCheckpointOut = checkpoint.outPosition;
+            m_lastBlock = false;
+            m_verifyTrailer = false;
+            m_state = stateBlockStart;
+        }
+
+        unsigned long long totalOut() const { return m_totalOut; }
+
+        /**
+         * @brief 最多解压'capacity'字节
+         * @return 写入的字节数，整个文件解码完毕后返回0
+         * @throw std::runtime_error 数据流损坏时抛出
+         */
+        size_t read(unsigned char* out, size_t capacity) {
+            size_t produced = 0;
+            size_t crcFrom = 0;
+            while (produced < capacity && m_state != stateDone) {
+                switch (m_state) {
+                    case stateHeader:
+                        m_state = readMemberHeader() ? stateBlockStart : stateDone;
+                        break;
+                    case stateBlockStart:
+                        beginBlock();
+                        break;
+                    case stateStored:
+                        while (m_storedLeft > 0 && produced < capacity) {
+                            emit(out, produced, static_cast<unsigned char>(m_reader.bits(8)));
+                            --m_storedLeft;
+                        }
+                        if (m_storedLeft == 0) m_state = stateBlockStart;
+                        break;
+                    case stateCopy:
+                        while (m_copyLeft > 0 && produced < capacity) {
+                            emit(out, produced, m_window[(m_windowPos - m_copyDistance) & 0x7FFF]);
+                            --m_copyLeft;
+                        }
+                        if (m_copyLeft == 0) m_state = stateCodes;
+                        break;
+                    case stateCodes:
+                        decodeCodes(out, produced, capacity);
+                        break;
+                    case stateTrailer:
+                        updateMemberCrc(out, crcFrom, produced);
+                        readMemberTrailer();
+                        break;
+                    default:
+                        break;
+                }
+            }
+            updateMemberCrc(out, crcFrom, produced);
+            return produced;
+        }
+
+    private:
+        enum inflateState {
+            stateHeader, stateBlockStart, stateStored, stateCodes, stateCopy, stateTrailer, stateDone
+        };
+
+        void emit(unsigned char* out, size_t& produced, unsigned char byte) {
+            out[produced++] = byte;
+            m_window[m_windowPos & 0x7FFF] = byte;
+            ++m_windowPos;
+            if (m_windowFill < 32768) ++m_windowFill;
+            ++m_totalOut;
+        }
+
+        void updateMemberCrc(const unsigned char* out, size_t& from, size_t to) {
+            if (m_verifyTrailer) m_crc = updateCrc32(m_crc, out + from, to - from);
+            from = to;
+        }
+
+        unsigned readByte() { return m_reader.bits(8); }
+
+        bool readMemberHeader() {
+            if (m_reader.atEnd()) {
+                if (m_membersRead == 0) throw std::runtime_error("Not a gzip file");
+                return false;
+            }
+            unsigned id1 = readByte();
+            if (m_membersRead > 0 && (id1 != 0x1F || m_reader.atEnd())) return false;
+            unsigned id2 = readByte();
+            if (id1 != 0x1F || id2 != 0x8B) {
+                if (m_membersRead == 0) throw std::runtime_error("Not a gzip file");
+                return false;
+            }
+            if (readByte() != 8) throw std::runtime_error("Unsupported gzip compression method");
+            unsigned flags = readByte();
+            for (int i = 0; i < 6; ++i) readByte();                 // MTIME、XFL、OS
+            if (flags & 0x04) {                                     // FEXTRA
+                unsigned extraLen = readByte();
+                extraLen |= readByte() << 8;
+                while (extraLen--) readByte();
+            }
+            if (flags & 0x08) while (readByte() != 0) {}            // FNAME
+            if (flags & 0x10) while (readByte() != 0) {}            // FCOMMENT
+            if (flags & 0x02) { readByte(); readByte(); }           // FHCRC
+
+            ++m_membersRead;
+            m_memberOut = m_totalOut;
+            m_windowFill = 0;
+            m_crc = 0;
+            m_verifyTrailer = true;
+            m_lastBlock = false;
+            return true;
+        }
+
+        void readMemberTrailer() {
+            m_reader.alignToByte();
+            uint32_t crc = 0, size = 0;
+            for (int i = 0; i < 4; ++i) crc |= static_cast<uint32_t>(readByte()) << (8 * i);
+            for (int i = 0; i < 4; ++i) size |= static_cast<uint32_t>(readByte()) << (8 * i);
+            if (m_verifyTrailer) {
+                if (crc != m_crc || size != static_cast<uint32_t>(m_totalOut - m_memberOut)) {
+                    throw std::runtime_error("gzip data is corrupt: checksum mismatch");
+                }
+            }
+            m_state = stateHeader;
+        }
+
+        void beginBlock() {
+            if (m_lastBlock) {
+                m_state = stateTrailer;
+                return;
+            }
+            if (m_checkpoints && m_totalOut - m_lastCheckpointOut >= m_checkpointSpan) {
+                gzipCheckpoint checkpoint;
+                checkpoint.bitPosition = m_reader.bitPosition();
+                checkpoint.outPosition = m_totalOut;
+                checkpoint.window.resize(m_windowFill);
+                for (size_t i = 0; i < m_windowFill; ++i) {
+                    checkpoint.window[i] = m_window[(m_windowPos - m_windowFill + i) & 0x7FFF];
+                }
+                m_checkpoints->push_back(std::move(checkpoint));
+                m_lastCheckpointOut = m_totalOut;
+            }
+
+            m_lastBlock = m_reader.bits(1) != 0;
+            unsigned type = m_reader.bits(2);
+            if (type == 0) {
+                m_reader.alignToByte();
+                unsigned len = m_reader.bits(16);
+                unsigned nlen = m_reader.bits(16);
+                if ((len ^ 0xFFFF) != nlen) {
+                    throw std::runtime_error("Invalid deflate stream: stored block length mismatch");
+                }
+                m_storedLeft = len;
+                m_state = stateStored;
+            } else if (type == 1) {
+                buildFixedTables();
+                m_lengthCode = &m_fixedLength;
+                m_distCode = &m_fixedDist;
+                m_state = stateCodes;
+            } else if (type == 2) {
+                buildDynamicTables();
+                m_lengthCode = &m_dynamicLength;
+                m_distCode = &m_dynamicDist;
+                m_state = stateCodes;
+            } else {
+                throw std::runtime_error("Invalid deflate stream: bad block type");
+            }
+        }
+
+        void buildFixedTables() {
+            if (m_fixedReady) return;
+            buildFixedInflateTables(m_fixedLength, m_fixedDist);
+            m_fixedReady = true;
+        }
+
+        void buildDynamicTables() {
+            readDynamicInflateTables(m_reader, m_dynamicLength, m_dynamicDist);
+        }
+
+        void decodeCodes(unsigned char* out, size_t& produced, size_t capacity) {
+            while (produced < capacity) {
+                int symbol = m_reader.decode(*m_lengthCode);
+                if (symbol < 256) {
+                    emit(out, produced, static_cast<unsigned char>(symbol));
+                    continue;
+                }
+                if (symbol == 256) {
+                    m_state = stateBlockStart;
+                    return;
+                }
+                symbol -= 257;
+                if (symbol >= 29) throw std::runtime_error("Invalid deflate stream: bad length symbol");
+                unsigned length = g_inflateLengthBase[symbol] + m_reader.bits(g_inflateLengthExtra[symbol]);
+                int distSymbol = m_reader.decode(*m_distCode);
+                if (distSymbol >= 30) throw std::runtime_error("Invalid deflate stream: bad distance symbol");
+                unsigned distance = g_inflateDistBase[distSymbol] + m_reader.bits(g_inflateDistExtra[distSymbol]);
+                if (distance > m_windowFill) {
+                    throw std::runtime_error("Invalid deflate stream: distance too far back");
+                }
+                m_copyLeft = length;
+                m_copyDistance = distance;
+                m_state = stateCopy;
+                return;
+            }
+        }
+
+        deflateBitReader m_reader;
+        std::vector<unsigned char> m_window;
+        size_t m_windowPos = 0;
+        size_t m_windowFill = 0;
+        unsigned long long m_totalOut = 0;
+        unsigned long long m_memberOut = 0;
+        int m_membersRead = 0;
+        uint32_t m_crc = 0;
+        bool m_verifyTrailer = true;
+        bool m_lastBlock = false;
+        inflateState m_state = stateHeader;
+
+        unsigned m_storedLeft = 0;
+        unsigned m_copyLeft = 0;
+        unsigned m_copyDistance = 0;
+
+        bool m_fixedReady = false;
+        inflateHuffman m_fixedLength, m_fixedDist;
+        inflateHuffman m_dynamicLength, m_dynamicDist;
+        const inflateHuffman* m_lengthCode = nullptr;
+        const inflateHuffman* m_distCode = nullptr;
+
+        std::vector<gzipCheckpoint>* m_checkpoints = nullptr;
+        unsigned long long m_checkpointSpan = 0;
+        unsigned long long m_lastCheckpointOut = 0;
+    };
+
+    /**
+     * @brief 未压缩tar文件的顺序字节源
+     */
+    class tarFileSource {
+    public:
+        explicit tarFileSource(FILE* file) : m_file(file) {}
+        size_t read(unsigned char* out, size_t size) { return fread(out, 1, size, m_file); }
+        void skip(unsigned long long size) {
+            if (seekFile(m_file, static_cast<long long>(size), SEEK_CUR) != 0) {
+                throw std::runtime_error("Failed to seek in archive");
+            }
+        }
+    private:
+        FILE* m_file;
+    };
+
+    /**
+     * @brief gzip压缩的tar文件的顺序字节源
+     */
+    class tarGzipSource {
+    public:
+        explicit tarGzipSource(gzipInflater& inflater) : m_inflater(inflater), m_scratch(__GCOMMDLG_ARCHIVE_IO_CHUNK) {}
+        size_t read(unsigned char* out, size_t size) {
+            size_t total = 0;
+            while (total < size) {
+                size_t got = m_inflater.read(out + total, size - total);
+                if (got == 0) break;
+                total += got;
+            }
+            return total;
+        }
+        void skip(unsigned long long size) {
+            while (size > 0) {
+                size_t step = static_cast<size_t>(std::min<unsigned long long>(size, m_scratch.size()));
+                size_t got = read(m_scratch.data(), step);
+                if (got == 0) throw std::runtime_error("Unexpected end of archive");
+                size -= got;
+            }
+        }
+    private:
+        gzipInflater& m_inflater;
+        std::vector<unsigned char> m_scratch;
+    };
+
+    /**
+     * @brief 一个压缩包的缓存索引
+     */
+    struct archiveIndex {
+        unsigned long long fileSize = 0;
+        unsigned long long fileStamp = 0;
+        bool gzip = false;
+        std::vector<archiveMemberInfo> members;
+        std::vector<unsigned long long> dataOffsets;            // 每个成员的数据在未压缩tar流中的偏移
+        std::unordered_map<std::string, size_t> memberLookup;
+        std::vector<gzipCheckpoint> checkpoints;
+    };
+
+    std::unordered_map<std::string, std::shared_ptr<archiveIndex>> g_archiveIndexes;
+    std::mutex g_archiveIndexMutex;
+
+    /**
+     * @brief 缓存的压缩包索引及其表节点持有的字节数
+     */
+    size_t archiveIndexBytes(const std::string& archivePath, const archiveIndex& index) {
+        size_t bytes = hashNodeBytes(g_archiveIndexes, archivePath) + sizeof(archiveIndex) +
+                       index.members.capacity() * sizeof(archiveMemberInfo) + heapBytes(index.dataOffsets) +
+                       heapBytes(index.memberLookup) + index.checkpoints.capacity() * sizeof(gzipCheckpoint);
+        for (const auto& member : index.members) bytes += heapBytes(member.name);
+        for (const auto& checkpoint : index.checkpoints) bytes += heapBytes(checkpoint.window);
+        return bytes;
+    }
+
+    /**
+     * @brief 将压缩包索引作为缓存预算中的一个缓存，以压缩包路径为键
+     */
+    class archiveIndexBudget : public budgetedCache {
+    public:
+        ~archiveIndexBudget() {
+            budgetLeave();
+        }
+
+        void evictEntry(const std::string& archivePath) override {
+            std::lock_guard<std::mutex> lock(g_archiveIndexMutex);
+            auto it = g_archiveIndexes.find(archivePath);
+            if (it == g_archiveIndexes.end()) return;
+            chargeMemory(memoryArchiveIndexes, -static_cast<long long>(archiveIndexBytes(archivePath, *it->second)), -1);
+            g_archiveIndexes.erase(it);
+        }
+    };
+
+    archiveIndexBudget g_archiveIndexBudget;
+
+    /**
+     * @brief 解析tar头中的数值字段（八进制，最高位置位时为base-256）
+     */
+    unsigned long long parseTarNumber(const unsigned char* field, size_t size) {
+        unsigned long long value = 0;
+        if (field[0] & 0x80) {
+            for (size_t i = 1; i < size; ++i) value = (value << 8) | field[i];
+            return value;
+        }
+        size_t i = 0;
+        while (i < size && (field[i] == ' ' || field[i] == '\0')) ++i;
+        for (; i < size && field[i] >= '0' && field[i] <= '7'; ++i) {
+            value = (value << 3) | static_cast<unsigned long long>(field[i] - '0');
+        }
+        return value;
+    }
+
+    std::string tarHeaderString(const unsigned char* field, size_t size) {
+        size_t len = 0;
+        while (len < size && field[len] != '\0') ++len;
+        return std::string(reinterpret_cast<const char*>(field), len);
+    }
+
+    /**
+     * @brief 读取PAX扩展头中影响索引的"key=value"记录
+     */
+    void parsePaxRecords(const std::string& records, std::string& path, unsigned long long& size, bool& hasSize) {
+        size_t pos = 0;
+        while (pos < records.size()) {
+            size_t space = records.find(' ', pos);
+            if (space == std::string::npos) break;
+            unsigned long long recordLen = std::strtoull(records.c_str() + pos, nullptr, 10);
+            if (recordLen == 0 || pos + recordLen > records.size()) break;
+            std::string record = records.substr(space + 1, pos + recordLen - space - 2);
+            size_t eq = record.find('=');
+            if (eq != std::string::npos) {
+                std::string key = record.substr(0, eq);
+                if (key == "path") {
+                    path = record.substr(eq + 1);
+                } else if (key == "size") {
+                    size = std::strtoull(record.c_str() + eq + 1, nullptr, 10);
+                    hasSize = true;
+                }
+            }
+            pos += static_cast<size_t>(recordLen);
+        }
+    }
+
+    /**
+     * @brief 遍历tar流的头部并填充索引的成员列表
+     * @throw std::runtime_error 头部损坏时抛出
+     */
+    template <typename Source>
+    void scanTarMembers(Source& source, archiveIndex& index) {
+        unsigned char header[512];
+        unsigned long long position = 0;
+        std::string longName;
+        std::string paxPath;
+        unsigned long long paxSize = 0;
+        bool paxHasSize = false;
+
+        auto readPayload = [&](unsigned long long size) {
+            std::string payload(static_cast<size_t>(size), '\0');
+            if (size > 0 && source.read(reinterpret_cast<unsigned char*>(&payload[0]), payload.size()) != payload.size()) {
+                throw std::runtime_error("Unexpected end of archive");
+            }
+            unsigned long long padding = (512 - size % 512) % 512;
+            source.skip(padding);
+            position += size + padding;
+            return payload;
+        };
+
+        while (source.read(header, 512) == 512) {
+            position += 512;
+
+            bool zeroBlock = true;
+            for (int i = 0; i < 512 && zeroBlock; ++i) zeroBlock = header[i] == 0;
+            if (zeroBlock) break;
+
+            unsigned long long checksum = parseTarNumber(header + 148, 8);
+            unsigned long long sum = 0;
+            for (int i = 0; i < 512; ++i) sum += (i >= 148 && i < 156) ? ' ' : header[i];
+            if (sum != checksum) {
+                throw std::runtime_error("Invalid tar header checksum at offset " + std::to_string(position - 512));
+            }
+
+            char type = static_cast<char>(header[156]);
+            unsigned long long size = parseTarNumber(header + 124, 12);
+
+            if (type == 'L') {
+                longName = readPayload(size);
+                longName.resize(strlen(longName.c_str()));
+                continue;
+            }
+            if (type == 'x') {
+                parsePaxRecords(readPayload(size), paxPath, paxSize, paxHasSize);
+                continue;
+            }
+            if (type == 'g' || type == 'K') {
+                readPayload(size);
+                continue;
+            }
+
+            std::string name;
+            if (!paxPath.empty()) {
+                name = paxPath;
+            } else if (!longName.empty()) {
+                name = longName;
+            } else {
+                name = tarHeaderString(header, 100);
+                if (std::memcmp(header + 257, "ustar", 5) == 0) {
+                    std::string prefix = tarHeaderString(header + 345, 155);
+                    if (!prefix.empty()) name = prefix + "/" + name;
+                }
+            }
+            if (paxHasSize) size = paxSize;
+            longName.clear();
+            paxPath.clear();
+            paxHasSize = false;
+
+            bool isDirectory = type == '5';
+            if (type == '0' || type == '\0' || type == '7' || isDirectory) {
+                while (name.size() > 1 && name.back() == '/') name.pop_back();
+                archiveMemberInfo member;
+                member.name = name;
+                member.size = isDirectory ? 0 : size;
+                member.isDirectory = isDirectory;
+                index.memberLookup[name] = index.members.size();
+                index.members.push_back(member);
+                index.dataOffsets.push_back(position);
+            }
+
+            // 链接和设备条目即使设置了大小字段也不带数据
+            if (type == '1' || type == '2' || type == '3' || type == '4' || isDirectory) size = 0;
+            unsigned long long padded = (size + 511) / 512 * 512;
+            source.skip(padded);
+            position += padded;
+        }
+    }
+
+    /**
+     * @brief 扫描一遍压缩包以构建索引
+     * @throw std::runtime_error 压缩包无法打开或已损坏时抛出
+     */
+    std::shared_ptr<archiveIndex> buildArchiveIndex(const std::string& archivePath) {
+        FILE* file = openFileForRead(archivePath);
+        if (!file) {
+            throw std::runtime_error("Failed to open archive: " + archivePath);
+        }
+
+        auto index = std::make_shared<archiveIndex>();
+        try {
+            unsigned char magic[2] = {0};
+            index->gzip = fread(magic, 1, 2, file) == 2 && magic[0] == 0x1F && magic[1] == 0x8B;
+            seekFile(file, 0, SEEK_SET);
+
+            if (index->gzip) {
+                gzipInflater inflater(file);
+                inflater.recordCheckpoints(&index->checkpoints, __GCOMMDLG_GZ_CHECKPOINT_SPAN);
+                tarGzipSource source(inflater);
+                scanTarMembers(source, *index);
+            } else {
+                tarFileSource source(file);
+                scanTarMembers(source, *index);
+            }
+        } catch (...) {
+            fclose(file);
+            throw;
+        }
+
+        fclose(file);
+        return index;
+    }
+
+    /**
+     * @brief 返回压缩包的缓存索引，若文件自上次扫描后有改动则重新构建
+     * @throw std::runtime_error 压缩包无法打开或已损坏时抛出
+     */
+    std::shared_ptr<archiveIndex> getArchiveIndex(const std::string& archivePath) {
+        unsigned long long size = 0, stamp = 0;
+        if (!getFileStamp(archivePath, size, stamp)) {
+            throw std::runtime_error("Archive not found: " + archivePath);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_archiveIndexMutex);
+            auto it = g_archiveIndexes.find(archivePath);
+            if (it != g_archiveIndexes.end() && it->second->fileSize == size && it->second->fileStamp == stamp) {
+                g_archiveIndexBudget.budgetUse(archivePath);
+                return it->second;
+            }
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        std::shared_ptr<archiveIndex> index = buildArchiveIndex(archivePath);
+        index->fileSize = size;
+        index->fileStamp = stamp;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        {
+            std::lock_guard<std::mutex> lock(g_archiveIndexMutex);
+            size_t buckets = bucketBytes(g_archiveIndexes);
+            std::shared_ptr<archiveIndex>& cached = g_archiveIndexes[archivePath];
+            long long bytes = static_cast<long long>(archiveIndexBytes(archivePath, *index) + bucketBytes(g_archiveIndexes)) -
+                              static_cast<long long>(buckets + (cached ? archiveIndexBytes(archivePath, *cached) : 0));
+            chargeMemory(memoryArchiveIndexes, bytes, cached ? 0 : 1);
+            cached = index;
+            g_archiveIndexBudget.budgetStore(archivePath, archiveIndexBytes(archivePath, *index), seconds);
+        }
+        enforceCacheBudget();
+        return index;
+    }
+}
+
+/**
+ * @brief 列出tar或tar.gz压缩包的成员（格式根据文件内容识别）
+ *
+ * @param archivePath 压缩包路径（UTF8编码），例如getOpenFileName返回的路径
+ * @return 按压缩包内顺序排列的所有文件和目录成员
+ * @throw std::runtime_error 压缩包无法打开或已损坏时抛出
+ *
+ * @note 首次调用会扫描整个压缩包，之后在压缩包文件改动前均直接使用缓存的索引
+ */
+std::vector<archiveMemberInfo> listArchiveMembers(const std::string& archivePath) {
+    return getArchiveIndex(archivePath)->members;
+}
+
+/**
+ * @brief 读取tar或tar.gz压缩包中一个成员的内容
+ *
+ * @param archivePath 压缩包路径（UTF8编码）
+ * @param memberName 成员在压缩包内的路径，即listArchiveMembers返回的路径
+ * @param offset 从成员内的哪个偏移开始读取
+ * @param length 最多读取的字节数，默认读到成员末尾
+ * @return 成员数据
+ * @throw std::invalid_argument 成员不存在或是目录时抛出
+ * @throw std::runtime_error 压缩包无法打开或已损坏时抛出
+ *
+ * @note 对gzip压缩包，解压从成员之前最近的检查点开始，而不是从文件开头开始
+ */
+std::vector<unsigned char> readArchiveMember(const std::string& archivePath,
+                                             const std::string& memberName,
+                                             unsigned long long offset = 0,
+                                             unsigned long long length = ~0ull) {
+    std::shared_ptr<archiveIndex> index = getArchiveIndex(archivePath);
+
+    auto it = index->memberLookup.find(memberName);
+    if (it == index->memberLookup.end() || index->members[it->second].isDirectory) {
+        throw std::invalid_argument("No such file in archive: " + memberName);
+    }
+
+    const archiveMemberInfo& member = index->members[it->second];
+    if (offset >= member.size) return {};
+    length = std::min(length, member.size - offset);
+    unsigned long long start = index->dataOffsets[it->second] + offset;
+
+    std::vector<unsigned char> data(static_cast<size_t>(length));
+    if (length == 0) return data;
+
+    FILE* file = openFileForRead(archivePath);
+    if (!file) {
+        throw std::runtime_error("Failed to open archive: " + archivePath);
+    }
+
+    try {
+        if (!index->gzip) {
+            if (seekFile(file, static_cast<long long>(start), SEEK_SET) != 0 ||
+                fread(data.data(), 1, data.size(), file) != data.size()) {
+                throw std::runtime_error("Unexpected end of archive");
+            }
+        } else {
+            gzipInflater inflater(file);
+            auto checkpoint = std::upper_bound(
+                index->checkpoints.begin(), index->checkpoints.end(), start,
+                [](unsigned long long pos, const gzipCheckpoint& cp) { return pos < cp.outPosition; }
+            );
+            if (checkpoint != index->checkpoints.begin()) {
+                inflater.restart(*(checkpoint - 1));
+            }
+
+            tarGzipSource source(inflater);
+            source.skip(start - inflater.totalOut());
+            if (source.read(data.data(), data.size()) != data.size()) {
+                throw std::runtime_error("Unexpected end of archive");
+            }
+        }
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+
+    fclose(file);
+    return data;
+}
+
+#pragma endregion
+
+#pragma region 保存文件名建议
+// 根据目标目录的缓存列表，给出一个不与已有文件冲突的文件名
+
+/**
+ * @brief suggestSaveFileName为冲突的文件名编号的方式
+ */
+enum saveNameStyle {
+    saveNameParenthesized,  // "export.csv" -> "export (2).csv"、"export (3).csv"……
+    saveNameSequence        // "export_007.csv" -> "export_008.csv"，"export.csv" -> "export_001.csv"
+};
+
+namespace {
+
+    /**
+     * @brief 在Windows上折叠文件名的大小写以便不区分大小写地比较，方式与FindFontFile比较字体名相同。其他平台的文件名区分大小写，保持原样
+     */
+    std::wstring foldFileName(std::wstring name) {
+#ifdef _WIN32
+        for (auto& c : name) c = towlower(c);
+#endif
+        return name;
+    }
+
+    /**
+     * @brief 用本平台的分隔符将文件名拼接到目录路径后
+     */
+    std::wstring joinPath(const std::wstring& directory, const std::wstring& name) {
+#ifdef _WIN32
+        const wchar_t separator = L'\\';
+#else
+        const wchar_t separator = L'/';
+#endif
+        if (directory.empty()) return name;
+        if (directory.back() == L'/' || directory.back() == separator) return directory + name;
+        return directory + separator + name;
+    }
+
+    /**
+     * @brief 检查文件或目录是否存在
+     */
+    bool pathExists(const std::wstring& path) {
+#ifdef _WIN32
+        return GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+        struct stat st;
+        return stat(wideToUtf8(path).c_str(), &st) == 0;
+#endif
+    }
+
+    /**
+     * @brief 获取当前工作目录
+     * @throw std::runtime_error 无法获取目录时抛出
+     */
+    std::wstring currentDirectoryWide() {
+#ifdef _WIN32
+        WCHAR currentDir[MAX_PATH];
+        DWORD length = GetCurrentDirectoryW(MAX_PATH, currentDir);
+        if (length == 0 || length >= MAX_PATH) {
+            throw std::runtime_error("Failed to get current directory: " + std::to_string(GetLastError()));
+        }
+        return currentDir;
+#else
+        char currentDir[4096];
+        if (!getcwd(currentDir, sizeof(currentDir))) {
+            throw std::runtime_error("Failed to get current directory: " + std::to_string(errno));
+        }
+        return utf8ToWide(currentDir);
+#endif
+    }
+
+    /**
+     * @brief 将文件名拆分为主干和扩展名（扩展名保留点号，开头的点号属于主干）
+     */
+    void splitFileName(const std::wstring& name, std::wstring& stem, std::wstring& ext) {
+        size_t dot = name.rfind(L'.');
+        if (dot == std::wstring::npos || dot == 0) {
+            stem = name;
+            ext.clear();
+        } else {
+            stem = name.substr(0, dot);
+            ext = name.substr(dot);
+        }
+    }
+
+    /**
+     * @brief 识别主干末尾的"base (N)"形式
+     * @return 主干是否带编号，仅在带编号时才设置base和number
+     */
+    bool parseParenthesizedNumber(const std::wstring& stem, size_t& baseLength, unsigned long long& number) {
+        if (stem.size() < 4 || stem.back() != L')') return false;
+        size_t open = stem.rfind(L" (");
+        if (open == std::wstring::npos || open + 3 > stem.size() - 1) return false;
+        size_t digits = stem.size() - 1 - (open + 2);
+        if (digits > 18) return false;
+        number = 0;
+        for (size_t i = open + 2; i < stem.size() - 1; ++i) {
+            if (stem[i] < L'0' || stem[i] > L'9') return false;
+            number = number * 10 + static_cast<unsigned long long>(stem[i] - L'0');
+        }
+        baseLength = open;
+        return true;
+    }
+
+    /**
+     * @brief 识别主干末尾的数字，例如"scan_0042"
+     * @return 主干是否以数字结尾，仅在此情况下才设置base、width和number
+     */
+    bool parseSequenceNumber(const std::wstring& stem, size_t& baseLength, size_t& width, unsigned long long& number) {
+        size_t start = stem.size();
+        while (start > 0 && stem[start - 1] >= L'0' && stem[start - 1] <= L'9') --start;
+        width = stem.size() - start;
+        if (width == 0 || width > 18) return false;
+        number = 0;
+        for (size_t i = start; i < stem.size(); ++i) {
+            number = number * 10 + static_cast<unsigned long long>(stem[i] - L'0');
+        }
+        baseLength = start;
+        return true;
+    }
+
+    /**
+     * @brief 目录中一组带编号文件名已使用的最大编号
+     */
+    struct numberedNameFamily {
+        unsigned long long highest = 0;
+        size_t width = 0;
+    };
+
+    /**
+     * @brief 一个目录的缓存列表
+     */
+    struct directoryListing {
+        unsigned long long stamp = 0;
+        std::vector<std::wstring> names;
+        std::unordered_set<std::wstring> foldedNames;
+        std::unordered_map<std::wstring, numberedNameFamily> families;     // 键：折叠后的base + '/' + 折叠后的扩展名 + '/' + 编号方式
+    };
+
+    std::unordered_map<std::wstring, std::shared_ptr<directoryListing>> g_directoryListings;
+    std::mutex g_directoryListingMutex;
+
+    /**
+     * @brief 缓存的目录列表及其表节点持有的字节数
+     */
+    size_t directoryListingBytes(const std::wstring& key, const directoryListing& listing) {
+        return hashNodeBytes(g_directoryListings, key) + sizeof(directoryListing) + heapBytes(listing.names) +
+               heapBytes(listing.foldedNames) + heapBytes(listing.families);
+    }
+
+    /**
+     * @brief 将目录列表作为缓存预算中的一个缓存，以折叠后目录的字节为键
+     */
+    class directoryListingBudget : public budgetedCache {
+    public:
+        ~directoryListingBudget() {
+            budgetLeave();
+        }
+
+        static std::string budgetKey(const std::wstring& key) {
+            return std::string(reinterpret_cast<const char*>(key.data()), key.size() * sizeof(wchar_t));
+        }
+
+        void evictEntry(const std::string& budgetKey) override {
+            std::wstring key(budgetKey.size() / sizeof(wchar_t), L'\0');
+            if (!key.empty()) std::memcpy(&key[0], budgetKey.data(), key.size() * sizeof(wchar_t));
+            std::lock_guard<std::mutex> lock(g_directoryListingMutex);
+            auto it = g_directoryListings.find(key);
+            if (it == g_directoryListings.end()) return;
+            chargeMemory(memoryDirectoryListings, -static_cast<long long>(directoryListingBytes(key, *it->second)), -1);
+            g_directoryListings.erase(it);
+        }
+    };
+
+    directoryListingBudget g_directoryListingBudget;
+
+    std::wstring numberedFamilyKey(const std::wstring& base, const std::wstring& ext, saveNameStyle style) {
+        return base + L'/' + ext + (style == saveNameParenthesized ? L"/p" : L"/s");
+    }
+
+    /**
+     * @brief 读取目录中所有条目的名称
+     * @throw std::runtime_error 无法列出目录内容时抛出
+     */
+    std::vector<std::wstring> readDirectoryNames(const std::wstring& directory) {
+        std::vector<std::wstring> names;
+#ifdef _WIN32
+        std::wstring pattern = joinPath(directory, L"*");
+
+        WIN32_FIND_DATAW data;
+        HANDLE hFind = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data,
+                                        FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+        if (hFind == INVALID_HANDLE_VALUE) {
+            DWORD err = GetLastError();
+            if (err == ERROR_FILE_NOT_FOUND) return names;
+            throw std::runtime_error("Failed to list directory: " + std::to_string(err));
+        }
+
+        do {
+            if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) continue;
+            names.emplace_back(data.cFileName);
+        } while (FindNextFileW(hFind, &data));
+
+        FindClose(hFind);
+#else
+        DIR* dir = opendir(wideToUtf8(directory).c_str());
+        if (!dir) {
+            if (errno == ENOENT) return names;
+            throw std::runtime_error("Failed to list directory: " + std::to_string(errno));
+        }
+
+        while (struct dirent* entry = readdir(dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            names.push_back(utf8ToWide(entry->d_name));
+        }
+
+        closedir(dir);
+#endif
+        return names;
+    }
+
+    /**
+     * @brief 列出目录内容并构建文件名建议所用的查找结构
+     */
+    std::shared_ptr<directoryListing> buildDirectoryListing(const std::wstring& directory) {
+        auto listing = std::make_shared<directoryListing>();
+        listing->names = readDirectoryNames(directory);
+        listing->foldedNames.reserve(listing->names.size());
+
+        std::wstring stem, ext;
+        for (const auto& name : listing->names) {
+            std::wstring folded = foldFileName(name);
+            splitFileName(folded, stem, ext);
+            listing->foldedNames.insert(std::move(folded));
+
+            size_t baseLength = 0, width = 0;
+            unsigned long long number = 0;
+            if (parseParenthesizedNumber(stem, baseLength, number)) {
+                auto& family = listing->families[numberedFamilyKey(stem.substr(0, baseLength), ext, saveNameParenthesized)];
+                family.highest = std::max(family.highest, number);
+            }
+            if (parseSequenceNumber(stem, baseLength, width, number)) {
+                auto& family = listing->families[numberedFamilyKey(stem.substr(0, baseLength), ext, saveNameSequence)];
+                if (number >= family.highest) {
+                    family.highest = number;
+                    family.width = std::max(family.width, width);
+                }
+            }
+        }
+        return listing;
+    }
+
+    /**
+     * @brief 返回目录的缓存列表，目录被修改过时重新读取
+     * @param forceRefresh 即使缓存列表看起来是最新的也重新读取目录
+     */
+    std::shared_ptr<directoryListing> getDirectoryListing(const std::wstring& directory, bool forceRefresh = false) {
+        unsigned long long size = 0, stamp = 0;
+        if (!getFileStamp(wideToUtf8(directory), size, stamp)) {
+            throw std::runtime_error("Directory not found: " + wideToUtf8(directory));
+        }
+
+        std::wstring key = foldFileName(directory);
+        if (!forceRefresh) {
+            std::lock_guard<std::mutex> lock(g_directoryListingMutex);
+            auto it = g_directoryListings.find(key);
+            if (it != g_directoryListings.end() && it->second->stamp == stamp) {
+                g_directoryListingBudget.budgetUse(directoryListingBudget::budgetKey(key));
+                return it->second;
+            }
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        std::shared_ptr<directoryListing> listing = buildDirectoryListing(directory);
+        listing->stamp = stamp;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        {
+            std::lock_guard<std::mutex> lock(g_directoryListingMutex);
+            size_t buckets = bucketBytes(g_directoryListings);
+            std::shared_ptr<directoryListing>& cached = g_directoryListings[key];
+            long long bytes = static_cast<long long>(directoryListingBytes(key, *listing) + bucketBytes(g_directoryListings)) -
+                              static_cast<long long>(buckets + (cached ? directoryListingBytes(key, *cached) : 0));
+            chargeMemory(memoryDirectoryListings, bytes, cached ? 0 : 1);
+            cached = listing;
+            g_directoryListingBudget.budgetStore(directoryListingBudget::budgetKey(key), directoryListingBytes(key, *listing), seconds);
+        }
+        enforceCacheBudget();
+        return listing;
+    }
+
+    /**
+     * @brief 只通过列表中的哈希查找，在'fileName'所属的文件名组中选出第一个空闲的名称
+     */
+    std::wstring pickFreeName(const directoryListing& listing, const std::wstring& fileName, saveNameStyle style) {
+        if (listing.foldedNames.find(foldFileName(fileName)) == listing.foldedNames.end()) {
+            return fileName;
+        }
+
+        std::wstring stem, ext;
+        splitFileName(fileName, stem, ext);
+        std::wstring foldedStem = foldFileName(stem);
+        std::wstring foldedExt = foldFileName(ext);
+
+        size_t baseLength = stem.size();
+        size_t width = 0;
+        unsigned long long number = 0;
+        std::wstring separator;
+        if (style == saveNameParenthesized) {
+            parseParenthesizedNumber(foldedStem, baseLength, number);
+        } else if (!parseSequenceNumber(foldedStem, baseLength, width, number)) {
+            separator = L"_";
+            width = 3;
+        }
+
+        std::wstring base = stem.substr(0, baseLength) + separator;
+        unsigned long long next = std::max<unsigned long long>(number, style == saveNameParenthesized ? 1 : 0) + 1;
+        auto family = listing.families.find(numberedFamilyKey(foldFileName(base), foldedExt, style));
+        if (family != listing.families.end()) {
+            next = std::max(next, family->second.highest + 1);
+            width = std::max(width, family->second.width);
+        }
+
+        while (true) {
+            std::wstring digits = std::to_wstring(next);
+            if (digits.size() < width) digits.insert(0, width - digits.size(), L'0');
+            std::wstring candidate = style == saveNameParenthesized
+                ? base + L" (" + digits + L")" + ext
+                : base + digits + ext;
+            if (listing.foldedNames.find(foldFileName(candidate)) == listing.foldedNames.end()) {
+                return candidate;
+            }
+            ++next;
+        }
+    }
+}
+
+/**
+ * @brief 建议一个目录中尚不存在的文件名，可直接作为getSaveFileName的defaultFileName
+ *
+ * @param directory 目标目录（UTF8编码），为空则使用当前工作目录
+ * @param fileName 期望的文件名，不含目录（UTF8编码），例如"export.csv"
+ * @param style 期望的文件名已被占用时使用的编号方式
+ * @return 若fileName空闲则返回其本身，否则返回下一个空闲的带编号文件名（UTF8编码）
+ * @throw std::runtime_error 字符串转换失败或无法列出目录内容时抛出
+ *
+ * @note 目录列表会被缓存，只在目录的修改时间变化时才重新读取，因此重复建议只需哈希查找。编号从已使用的最大编号之后继续，因此即使目录中有大量带编号的文件也只需探测一次。
+ */
+std::string suggestSaveFileName(const std::string& directory,
+                                const std::string& fileName,
+                                saveNameStyle style = saveNameParenthesized) {
+    if (fileName.empty()) return "";
+
+    std::wstring directoryWide = directory.empty() ? currentDirectoryWide() : utf8ToWide(directory);
+
+    std::wstring fileNameWide = utf8ToWide(fileName);
+    std::shared_ptr<directoryListing> listing = getDirectoryListing(directoryWide);
+    std::wstring suggestion = pickFreeName(*listing, fileNameWide, style);
+
+    // 目录时间戳精度内新建的文件可能不在列表中，因此在磁盘上确认一次
+    if (pathExists(joinPath(directoryWide, suggestion))) {
+        listing = getDirectoryListing(directoryWide, true);
+        suggestion = pickFreeName(*listing, fileNameWide, style);
+    }
+
+    return wideToUtf8(suggestion);
+}
+
+#pragma endregion
+
+#pragma region 卷空间
+// 保存目标所在卷的剩余空间（按卷缓存），以及在该卷上写入文件所需时间的估计
+
+#ifndef __GCOMMDLG_VOLUME_SPACE_TTL_MS
+#define __GCOMMDLG_VOLUME_SPACE_TTL_MS   2000                    // 缓存的剩余空间在重新查询卷之前的有效时长
+#endif
+#ifndef __GCOMMDLG_VOLUME_SPACE_MARGIN
+#define __GCOMMDLG_VOLUME_SPACE_MARGIN   (256ull * 1024 * 1024)  // 保存后应保留的剩余空间，少于此值时报告为空间不足预警
+#endif
+#ifndef __GCOMMDLG_THROUGHPUT_MIN_SAMPLE
+#define __GCOMMDLG_THROUGHPUT_MIN_SAMPLE (16ull * 1024 * 1024)   // 计入吞吐量样本的最小写入量
+#endif
+#ifndef __GCOMMDLG_VOLUME_DIRECTORIES
+#define __GCOMMDLG_VOLUME_DIRECTORIES    256                     // 记住所在卷的目录数，达到此数量时清空该映射
+#endif
+
+/**
+ * @brief 卷的空间信息
+ */
+struct volumeSpaceInfo {
+    unsigned long long freeBytes = 0;   // 当前用户可用的字节数
+    unsigned long long totalBytes = 0;
+    double bytesPerSecond = 0;          // atomicFileWriter在该卷上观测到的写入吞吐量，尚未测量时为0
+};
+
+/**
+ * @brief checkSaveSpace的结果
+ */
+enum saveSpaceStatus {
+    saveSpaceOk,
+    saveSpaceLow,           // 文件能放下，但剩余空间将少于__GCOMMDLG_VOLUME_SPACE_MARGIN
+    saveSpaceInsufficient   // 文件放不下
+};
+
+namespace {
+
+    /**
+     * @brief 一个卷的缓存状态
+     */
+    struct volumeState {
+        std::string queryPath;                          // 卷上一个已存在的目录，用于空间查询
+        bool valid = false;
+        std::chrono::steady_clock::time_point queried;
+        unsigned long long freeBytes = 0;
+        unsigned long long totalBytes = 0;
+        double bytesPerSecond = 0;
+    };
+
+    std::unordered_map<std::string, std::string> g_volumeOfDirectory;     // 目录 -> 卷键
+    std::unordered_map<std::string, volumeState> g_volumeStates;          // 卷键 -> 状态
+    std::mutex g_volumeMutex;
+
+    /**
+     * @brief 路径中的目录部分（包含末尾的分隔符），单纯的文件名返回""
+     */
+    std::string directoryOfPath(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    }
+
+    /**
+     * @brief 查找目录所在的卷，向上查找到最近的已存在的祖先目录
+     * @param key 输出的卷键
+     * @param queryPath 输出的卷上已存在的目录
+     * @return 是否能确定卷
+     */
+    bool resolveVolume(const std::string& directory, std::string& key, std::string& queryPath) {
+#ifdef _WIN32
+        WCHAR volumePath[MAX_PATH];
+        std::wstring directoryWide = directory.empty() ? L"." : utf8ToWide(directory);
+        if (!GetVolumePathNameW(directoryWide.c_str(), volumePath, MAX_PATH)) {
+            return false;
+        }
+        key = wideToUtf8(volumePath);
+        queryPath = key;
+        return true;
+#else
+        std::string current = directory.empty() ? "." : directory;
+        struct stat st;
+        while (stat(current.c_str(), &st) != 0) {
+            while (current.size() > 1 && current.back() == '/') current.pop_back();
+            size_t slash = current.find_last_of('/');
+            if (slash == std::string::npos) {
+                current = ".";
+            } else {
+                current = current.substr(0, slash == 0 ? 1 : slash);
+            }
+            if (stat(current.c_str(), &st) == 0) break;
+            if (current == "." || current == "/") return false;
+        }
+        key = std::to_string(static_cast<unsigned long long>(st.st_dev));
+        queryPath = current;
+        return true;
+#endif
+    }
+
+    /**
+     * @brief 返回'path'所在卷的缓存状态，调用时必须持有g_volumeMutex
+     * @return 卷状态，无法确定卷时返回nullptr
+     */
+    volumeState* lookupVolume(const std::string& path) {
+        std::string directory = directoryOfPath(path);
+        auto it = g_volumeOfDirectory.find(directory);
+        if (it == g_volumeOfDirectory.end()) {
+            std::string key, queryPath;
+            if (!resolveVolume(directory, key, queryPath)) return nullptr;
+            if (g_volumeOfDirectory.size() >= __GCOMMDLG_VOLUME_DIRECTORIES) {
+                // 重新解析一个目录只需一次stat，全部遗忘比跟踪各条目的时间更省
+                size_t forgotten = bucketBytes(g_volumeOfDirectory);
+                for (const auto& entry : g_volumeOfDirectory) {
+                    forgotten += hashNodeBytes(g_volumeOfDirectory, entry.first) + heapBytes(entry.second);
+                }
+                long long entries = static_cast<long long>(g_volumeOfDirectory.size());
+                std::unordered_map<std::string, std::string>().swap(g_volumeOfDirectory);
+                chargeMemory(memoryVolumeStates, -static_cast<long long>(forgotten), -entries);
+            }
+            size_t buckets = bucketBytes(g_volumeOfDirectory) + bucketBytes(g_volumeStates);
+            size_t volumes = g_volumeStates.size();
+            it = g_volumeOfDirectory.emplace(directory, key).first;
+            volumeState& state = g_volumeStates[key];
+            if (state.queryPath.empty()) state.queryPath = queryPath;
+
+            bool newVolume = g_volumeStates.size() != volumes;
+            size_t bytes = hashNodeBytes(g_volumeOfDirectory, directory) + heapBytes(it->second) +
+                           (newVolume ? hashNodeBytes(g_volumeStates, key) + heapBytes(state.queryPath) : 0);
+            chargeMemory(memoryVolumeStates,
+                         static_cast<long long>(bytes + bucketBytes(g_volumeOfDirectory) + bucketBytes(g_volumeStates)) - static_cast<long long>(buckets),
+                         newVolume ? 2 : 1);
+        }
+        return &g_volumeStates[it->second];
+    }
+
+    /**
+     * @brief 查询卷的剩余空间和总空间
+     * @throw std::runtime_error 查询失败时抛出
+     */
+    void queryVolumeSpace(volumeState& state) {
+#ifdef _WIN32
+        ULARGE_INTEGER available, total;
+        if (!GetDiskFreeSpaceExW(utf8ToWide(state.queryPath).c_str(), &available, &total, NULL)) {
+            throw std::runtime_error("Failed to query free space: " + std::to_string(GetLastError()));
+        }
+        state.freeBytes = available.QuadPart;
+        state.totalBytes = total.QuadPart;
+#else
+        struct statvfs fs;
+        if (statvfs(state.queryPath.c_str(), &fs) != 0) {
+            throw std::runtime_error("Failed to query free space: " + std::to_string(errno));
+        }
+        state.freeBytes = static_cast<unsigned long long>(fs.f_bavail) * fs.f_frsize;
+        state.totalBytes = static_cast<unsigned long long>(fs.f_blocks) * fs.f_frsize;
+#endif
+        state.queried = std::chrono::steady_clock::now();
+        state.valid = true;
+    }
+
+    /**
+     * @brief 将一次完成的写入计入其所在卷的吞吐量估计，并将缓存的剩余空间标记为过期
+     */
+    void recordWriteThroughput(const std::string& path, unsigned long long bytes, double seconds) {
+        std::lock_guard<std::mutex> lock(g_volumeMutex);
+        volumeState* state = lookupVolume(path);
+        if (!state) return;
+        state->valid = false;
+
+        if (bytes < __GCOMMDLG_THROUGHPUT_MIN_SAMPLE || seconds <= 0) return;
+        double sample = static_cast<double>(bytes) / seconds;
+        state->bytesPerSecond = state->bytesPerSecond == 0 ? sample : state->bytesPerSecond * 0.7 + sample * 0.3;
+    }
+}
+
+/**
+ * @brief 获取文件将要保存到的卷的剩余空间
+ *
+ * @param path 保存目标路径（UTF8编码），例如getSaveFileName返回的路径。文件本身不必存在
+ * @param forceRefresh 即使缓存值仍然有效也重新查询卷
+ * @return 卷的空间信息
+ * @throw std::runtime_error 无法确定或查询卷时抛出
+ *
+ * @note 结果按卷缓存__GCOMMDLG_VOLUME_SPACE_TTL_MS毫秒，因此重复调用（例如用户编辑文件名时）只需一次哈希查找
+ */
+volumeSpaceInfo getVolumeSpace(const std::string& path, bool forceRefresh = false) {
+    std::lock_guard<std::mutex> lock(g_volumeMutex);
+    volumeState* state = lookupVolume(path);
+    if (!state) {
+        throw std::runtime_error("Failed to determine volume of: " + path);
+    }
+
+    if (forceRefresh || !state->valid ||
+        std::chrono::steady_clock::now() - state->queried > std::chrono::milliseconds(__GCOMMDLG_VOLUME_SPACE_TTL_MS)) {
+        queryVolumeSpace(*state);
+    }
+
+    volumeSpaceInfo info;
+    info.freeBytes = state->freeBytes;
+    info.totalBytes = state->totalBytes;
+    info.bytesPerSecond = state->bytesPerSecond;
+    return info;
+}
+
+/**
+ * @brief 检查给定大小的文件能否放入将要保存到的卷
+ *
+ * @param path 保存目标路径（UTF8编码）
+ * @param expectedSize 将要写入的文件字节数
+ * @param estimatedSeconds 不为nullptr时，接收根据观测吞吐量估计的写入秒数，尚未测量吞吐量时为-1
+ * @return 文件是否能放下
+ * @throw std::runtime_error 无法确定或查询卷时抛出
+ *
+ * @note atomicFileWriter在commit()之前会保留旧文件，因此替换已有文件同样需要expectedSize字节的剩余空间。缓存值显示空间不足时会在返回前重新查询
+ */
+saveSpaceStatus checkSaveSpace(const std::string& path, unsigned long long expectedSize, double* estimatedSeconds = nullptr) {
+    volumeSpaceInfo info = getVolumeSpace(path);
+    if (expectedSize > info.freeBytes) {
+        info = getVolumeSpace(path, true);
+    }
+
+    if (estimatedSeconds) {
+        *estimatedSeconds = info.bytesPerSecond > 0 ? static_cast<double>(expectedSize) / info.bytesPerSecond : -1;
+    }
+
+    if (expectedSize > info.freeBytes) return saveSpaceInsufficient;
+    if (info.freeBytes - expectedSize < __GCOMMDLG_VOLUME_SPACE_MARGIN) return saveSpaceLow;
+    return saveSpaceOk;
+}
+
+#pragma endregion
+
+#pragma region 原子文件写入
+// 先写入同目录下的临时文件，提交时再重命名覆盖目标文件，因此目标文件不会出现写了一半的数据
+
+#ifndef __GCOMMDLG_WRITER_CHUNK
+#define __GCOMMDLG_WRITER_CHUNK        (1024 * 1024)  // 每次向文件系统发出的写入大小
+#endif
+#ifndef __GCOMMDLG_WRITER_ALIGN
+#define __GCOMMDLG_WRITER_ALIGN        4096           // 写缓冲区的对齐
+#endif
+#ifndef __GCOMMDLG_WRITER_DIRTY_CHUNKS
+#define __GCOMMDLG_WRITER_DIRTY_CHUNKS 8              // write()等待最早的块之前允许同时回写的块数（Linux）
+#endif
+
+/**
+ * @brief 崩溃安全的文件写入器，目标路径例如getSaveFileName返回的路径
+ *
+ * 数据写入目标旁边的临时文件，该文件按预期大小预分配空间，并以按块对齐的大块写入填充。
+ * 在Linux上每写完一块就请求内核开始回写，因此commit()中的最终刷新只需等待末尾部分。
+ * commit()将数据刷新到磁盘并把临时文件重命名覆盖目标文件，因此崩溃后目标文件要么是旧内容，要么是完整的新内容。
+ * 若写入器在未调用commit()的情况下被销毁，临时文件会被删除。
+ */
+class atomicFileWriter {
+public:
+    /**
+     * @param targetPath 最终文件路径（UTF8编码）
+     * @param expectedSize 预期的最终字节数，用于预分配磁盘空间。未知时为0
+     * @param mode POSIX系统上文件的权限位，例如私有数据用0600。为0时保留被替换文件的权限，新文件则为0666去掉umask。Windows上忽略
+     * @throw std::runtime_error 无法创建临时文件，或卷上没有expectedSize字节的空间时抛出
+     */
+    explicit atomicFileWriter(const std::string& targetPath, unsigned long long expectedSize = 0, unsigned mode = 0)
+        : m_targetPath(targetPath),
+          m_storage(__GCOMMDLG_WRITER_CHUNK + __GCOMMDLG_WRITER_ALIGN) {
+        size_t misalignment = reinterpret_cast<uintptr_t>(m_storage.data()) % __GCOMMDLG_WRITER_ALIGN;
+        m_buffer = m_storage.data() + (misalignment ? __GCOMMDLG_WRITER_ALIGN - misalignment : 0);
+
+        static std::atomic<unsigned> counter(0);
+        size_t slash = targetPath.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? "" : targetPath.substr(0, slash + 1);
+        std::string name = slash == std::string::npos ? targetPath : targetPath.substr(slash + 1);
+        if (name.empty()) {
+            throw std::invalid_argument("Target path has no file name: " + targetPath);
+        }
+
+#ifdef _WIN32
+        (void)mode;
+        m_tempPath = directory + "." + name + "." + std::to_string(GetCurrentProcessId()) + "-" +
+                     std::to_string(counter++) + ".tmp";
+        m_file = CreateFileW(utf8ToWide(m_tempPath).c_str(), GENERIC_WRITE, 0, NULL, CREATE_NEW,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Failed to create temporary file: " + std::to_string(GetLastError()));
+        }
+        m_open = true;
+
+        if (expectedSize > 0) {
+            FILE_ALLOCATION_INFO allocation;
+            allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(expectedSize);
+            if (!SetFileInformationByHandle(m_file, FileAllocationInfo, &allocation, sizeof(allocation)) &&
+                GetLastError() == ERROR_DISK_FULL) {
+                discard();
+                throw std::runtime_error("Not enough disk space for " + std::to_string(expectedSize) + " bytes");
+            }
+        }
+#else
+        m_tempPath = directory + "." + name + "." + std::to_string(getpid()) + "-" +
+                     std::to_string(counter++) + ".tmp";
+        m_file = open(m_tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, static_cast<mode_t>(mode ? mode : 0666));
+        if (m_file < 0) {
+            throw std::runtime_error("Failed to create temporary file: " + std::to_string(errno));
+        }
+        m_open = true;
+
+        // 使用指定的权限，或保留被替换文件的权限
+        struct stat st;
+        if (mode) {
+            fchmod(m_file, static_cast<mode_t>(mode & 07777));
+        } else if (stat(targetPath.c_str(), &st) == 0) {
+            fchmod(m_file, st.st_mode & 07777);
+        }
+
+#ifdef __linux__
+        if (expectedSize > 0 &&
+            fallocate(m_file, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(expectedSize)) != 0 &&
+            (errno == ENOSPC || errno == EFBIG)) {
+            discard();
+            throw std::runtime_error("Not enough disk space for " + std::to_string(expectedSize) + " bytes");
+        }
+#endif
+#endif
+    }
+
+    ~atomicFileWriter() {
+        discard();
+    }
+
+    atomicFileWriter(const atomicFileWriter&) = delete;
+    atomicFileWriter& operator=(const atomicFileWriter&) = delete;
+
+    /**
+     * @brief 向文件追加数据
+     * @throw std::runtime_error 写入失败，或写入器已提交或已丢弃时抛出
+     */
+    void write(const void* data, size_t size) {
+        if (!m_open) {
+            throw std::runtime_error("Writer is already committed or discarded");
+        }
+
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        while (size > 0) {
+            // 没有待写数据时整块直接绕过缓冲区写入，两种方式下文件偏移都保持按块对齐
+            if (m_bufferUsed == 0 && size >= __GCOMMDLG_WRITER_CHUNK) {
+                size_t direct = size - size % __GCOMMDLG_WRITER_CHUNK;
+                writeChunks(bytes, direct);
+                bytes += direct;
+                size -= direct;
+                continue;
+            }
+
+            size_t count = std::min(size, static_cast<size_t>(__GCOMMDLG_WRITER_CHUNK) - m_bufferUsed);
+            std::memcpy(m_buffer + m_bufferUsed, bytes, count);
+            m_bufferUsed += count;
+            bytes += count;
+            size -= count;
+
+            if (m_bufferUsed == __GCOMMDLG_WRITER_CHUNK) {
+                writeChunks(m_buffer, m_bufferUsed);
+                m_bufferUsed = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief 将所有数据刷新到磁盘并原子地替换目标文件
+     * @throw std::runtime_error 刷新或重命名失败时抛出，此时临时文件会被删除
+     */
+    void commit() {
+        if (!m_open) {
+            throw std::runtime_error("Writer is already committed or discarded");
+        }
+
+        try {
+            if (m_bufferUsed > 0) {
+                writeChunks(m_buffer, m_bufferUsed);
+                m_bufferUsed = 0;
+            }
+            auto flushStarted = std::chrono::steady_clock::now();
+
+#ifdef _WIN32
+            if (!FlushFileBuffers(m_file)) {
+                throw std::runtime_error("Failed to flush file: " + std::to_string(GetLastError()));
+            }
+            CloseHandle(m_file);
+            m_open = false;
+
+            if (!MoveFileExW(utf8ToWide(m_tempPath).c_str(), utf8ToWide(m_targetPath).c_str(),
+                             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+                throw std::runtime_error("Failed to replace target file: " + std::to_string(GetLastError()));
+            }
+#else
+            // 归还超出实际大小的预分配空间
+            if (ftruncate(m_file, static_cast<off_t>(m_written)) != 0) {
+                throw std::runtime_error("Failed to truncate file: " + std::to_string(errno));
+            }
+#ifdef __linux__
+            if (fdatasync(m_file) != 0) {
+#else
+            if (fsync(m_file) != 0) {
+#endif
+                throw std::runtime_error("Failed to flush file: " + std::to_string(errno));
+            }
+            close(m_file);
+            m_open = false;
+
+            if (rename(m_tempPath.c_str(), m_targetPath.c_str()) != 0) {
+                throw std::runtime_error("Failed to replace target file: " + std::to_string(errno));
+            }
+
+            // 同时持久化目录项
+            size_t slash = m_targetPath.find_last_of('/');
+            std::string directory = slash == std::string::npos ? "." : m_targetPath.substr(0, slash + 1);
+            int dirFd = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+            if (dirFd >= 0) {
+                fsync(dirFd);
+                close(dirFd);
+            }
+#endif
+            m_ioSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - flushStarted).count();
+        } catch (...) {
+            discard();
+            throw;
+        }
+
+        m_committed = true;
+        recordWriteThroughput(m_targetPath, m_written, m_ioSeconds);
+    }
+
+    /**
+     * @brief 放弃文件并删除临时文件，目标文件保持不变。commit()之后调用不做任何事
+     */
+    void discard() {
+        if (m_committed) return;
+#ifdef _WIN32
+        if (m_open) CloseHandle(m_file);
+        m_open = false;
+        if (!m_tempPath.empty()) DeleteFileW(utf8ToWide(m_tempPath).c_str());
+#else
+        if (m_open) close(m_file);
+        m_open = false;
+        if (!m_tempPath.empty()) unlink(m_tempPath.c_str());
+#endif
+        m_tempPath.clear();
+    }
+
+    /**
+     * @brief 目前为止传给write()的字节数
+     */
+    unsigned long long bytesWritten() const {
+        return m_written + m_bufferUsed;
+    }
+
+private:
+    void writeChunks(const unsigned char* data, size_t size) {
+        auto started = std::chrono::steady_clock::now();
+        while (size > 0) {
+            size_t count = std::min(size, static_cast<size_t>(__GCOMMDLG_WRITER_CHUNK));
+#ifdef _WIN32
+            DWORD done = 0;
+            if (!WriteFile(m_file, data, static_cast<DWORD>(count), &done, NULL) || done != count) {
+                throw std::runtime_error("Failed to write file: " + std::to_string(GetLastError()));
+            }
+#else
+            size_t done = 0;
+            while (done < count) {
+                ssize_t result = ::write(m_file, data + done, count - done);
+                if (result < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error("Failed to write file: " + std::to_string(errno));
+                }
+                done += static_cast<size_t>(result);
+            }
+#ifdef __linux__
+            // 立即开始回写本块并等待较早的一块，使脏数据不会在页缓存中堆积
+            sync_file_range(m_file, static_cast<off_t>(m_written), static_cast<off_t>(count), SYNC_FILE_RANGE_WRITE);
+            unsigned long long window = static_cast<unsigned long long>(__GCOMMDLG_WRITER_CHUNK) * __GCOMMDLG_WRITER_DIRTY_CHUNKS;
+            if (m_written >= window) {
+                sync_file_range(m_file, static_cast<off_t>(m_written - window), __GCOMMDLG_WRITER_CHUNK,
+                                SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+            }
+#endif
+#endif
+            m_written += count;
+            data += count;
+            size -= count;
+        }
+        m_ioSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    std::string m_targetPath;
+    std::string m_tempPath;
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+#else
+    int m_file = -1;
+#endif
+    bool m_open = false;
+    bool m_committed = false;
+    std::vector<unsigned char> m_storage;
+    unsigned char* m_buffer = nullptr;
+    size_t m_bufferUsed = 0;
+    unsigned long long m_written = 0;
+    double m_ioSeconds = 0;     // 写入、刷新和重命名所花的时间，不含调用方在两次写入之间花费的时间
+};
+
+/**
+ * @brief 将整个缓冲区原子地写入文件，参见atomicFileWriter
+ *
+ * @param targetPath 最终文件路径（UTF8编码）
+ * @param data 要写入的数据
+ * @param size 字节数
+ * @param mode POSIX系统上文件的权限位，例如私有数据用0600。为0时保留被替换文件的权限，新文件则为0666去掉umask。Windows上忽略
+ * @throw std::runtime_error 无法写入文件时抛出，此时目标文件保持不变
+ */
+void writeFileAtomically(const std::string& targetPath, const void* data, size_t size, unsigned mode = 0) {
+    atomicFileWriter writer(targetPath, size, mode);
+    writer.write(data, size);
+    writer.commit();
+}
+
+#pragma endregion
+
+#pragma region 重复文件检测
+// 在一组选中的文件（例如getOpenMultipleFileNames的结果）中查找内容相同的文件，并尽可能少地读取字节
+
+#ifndef __GCOMMDLG_DUPLICATE_EDGE
+#define __GCOMMDLG_DUPLICATE_EDGE    (64 * 1024)  // 第二阶段中对每个文件开头和结尾分别计算哈希的字节数
+#endif
+#ifndef __GCOMMDLG_DUPLICATE_THREADS
+#define __GCOMMDLG_DUPLICATE_THREADS 8            // 调用者未指定数量时哈希任务数的上限
+#endif
+
+namespace {
+
+    /**
+     * @brief 流式XXH64，一种快速的非加密64位哈希
+     */
+    class xxHash64 {
+    public:
+        explicit xxHash64(uint64_t seed = 0) {
+            m_lanes[0] = seed + s_prime1 + s_prime2;
+            m_lanes[1] = seed + s_prime2;
+            m_lanes[2] = seed;
+            m_lanes[3] = seed - s_prime1;
+            m_seed = seed;
+        }
+
+        void update(const unsigned char* data, size_t size) {
+            m_total += size;
+            if (m_pending + size < 32) {
+                std::memcpy(m_buffer + m_pending, data, size);
+                m_pending += size;
+                return;
+            }
+
+            if (m_pending > 0) {
+                size_t fill = 32 - m_pending;
+                std::memcpy(m_buffer + m_pending, data, fill);
+                consumeStripe(m_buffer);
+                data += fill;
+                size -= fill;
+                m_pending = 0;
+            }
+
+            while (size >= 32) {
+                consumeStripe(data);
+                data += 32;
+                size -= 32;
+            }
+
+            std::memcpy(m_buffer, data, size);
+            m_pending = size;
+        }
+
+        uint64_t digest() const {
+            uint64_t hash;
+            if (m_total >= 32) {
+                hash = rotate(m_lanes[0], 1) + rotate(m_lanes[1], 7) + rotate(m_lanes[2], 12) + rotate(m_lanes[3], 18);
+                for (int i = 0; i < 4; ++i) {
+                    hash ^= round(0, m_lanes[i]);
+                    hash = hash * s_prime1 + s_prime4;
+                }
+            } else {
+                hash = m_seed + s_prime5;
+            }
+            hash += m_total;
+
+            const unsigned char* p = m_buffer;
+            size_t left = m_pending;
+            for (; left >= 8; p += 8, left -= 8) {
+                hash ^= round(0, read64(p));
+                hash = rotate(hash, 27) * s_prime1 + s_prime4;
+            }
+            if (left >= 4) {
+                uint32_t word;
+                std::memcpy(&word, p, 4);
+                hash ^= static_cast<uint64_t>(word) * s_prime1;
+                hash = rotate(hash, 23) * s_prime2 + s_prime3;
+                p += 4;
+                left -= 4;
+            }
+            for (; left > 0; ++p, --left) {
+                hash ^= *p * s_prime5;
+                hash = rotate(hash, 11) * s_prime1;
+            }
+
+            hash ^= hash >> 33;
+            hash *= s_prime2;
+            hash ^= hash >> 29;
+            hash *= s_prime3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+    private:
+        static const uint64_t s_prime1 = 11400714785074694791ull;
+        static const uint64_t s_prime2 = 14029467366897019727ull;
+        static const uint64_t s_prime3 = 1609587929392839161ull;
+        static const uint64_t s_prime4 = 9650029242287828579ull;
+        static const uint64_t s_prime5 = 2870177450012600261ull;
+
+        static uint64_t rotate(uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        static uint64_t read64(const unsigned char* p) {
+            uint64_t value;
+            std::memcpy(&value, p, 8);
+            return value;
+        }
+
+        static uint64_t round(uint64_t lane, uint64_t input) {
+            lane += input * s_prime2;
+            return rotate(lane, 31) * s_prime1;
+        }
+
+        void consumeStripe(const unsigned char* p) {
+            for (int i = 0; i < 4; ++i) {
+                m_lanes[i] = round(m_lanes[i], read64(p + i * 8));
+            }
+        }
+
+        uint64_t m_lanes[4];
+        uint64_t m_seed = 0;
+        uint64_t m_total = 0;
+        unsigned char m_buffer[32];
+        size_t m_pending = 0;
+    };
+
+    /**
+     * @brief 将已打开文件中的一段字节计入'hash'
+     * @return 是否读取了整个范围
+     */
+    bool hashFileRange(FILE* file, unsigned long long offset, unsigned long long length,
+                       xxHash64& hash, std::vector<unsigned char>& buffer) {
+        if (seekFile(file, static_cast<long long>(offset), SEEK_SET) != 0) return false;
+        while (length > 0) {
+            size_t count = static_cast<size_t>(std::min<unsigned long long>(length, buffer.size()));
+            if (fread(buffer.data(), 1, count, file) != count) return false;
+            hash.update(buffer.data(), count);
+            length -= count;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 仍可能互为重复的一组文件
+     */
+    struct duplicateCandidates {
+        std::vector<size_t> files;     // 在路径列表中的下标
+        size_t remaining = 0;          // 当前阶段哈希尚未算出的文件数
+        bool fullStage = false;        // false：计算首尾的哈希，true：计算中间部分的哈希
+    };
+
+    /**
+     * @brief 一次findDuplicateFiles调用的共享状态
+     */
+    class duplicateSearch {
+    public:
+        duplicateSearch(const std::vector<std::string>& paths,
+                        const std::function<void(const std::vector<std::string>&)>& onGroup)
+            : m_paths(paths), m_onGroup(onGroup),
+              m_sizes(paths.size()), m_edgeHashes(paths.size()), m_middleHashes(paths.size()),
+              m_readable(paths.size(), 1) {}
+
+        void run(unsigned threadCount) {
+            // 第一阶段：只有大小相同的文件才可能相同
+            std::unordered_map<unsigned long long, std::vector<size_t>> bySize;
+            for (size_t i = 0; i < m_paths.size(); ++i) {
+                unsigned long long stamp = 0;
+                if (getFileStamp(m_paths[i], m_sizes[i], stamp)) {
+                    bySize[m_sizes[i]].push_back(i);
+                }
+            }
+
+            std::vector<std::vector<size_t>> confirmed;
+            for (auto& group : bySize) {
+                if (group.second.size() < 2) continue;
+                if (group.first == 0) {
+                    confirmed.push_back(std::move(group.second));
+                } else {
+                    enqueue(std::move(group.second), false);
+                }
+            }
+            emit(confirmed);
+
+            taskGroup workers;
+            for (unsigned i = 0; i < threadCount; ++i) {
+                workers.run([this] { work(); }, taskBackground);
+            }
+            workers.wait();
+
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+        }
+
+    private:
+        struct task {
+            std::shared_ptr<duplicateCandidates> candidates;
+            size_t file;
+        };
+
+        // 调用时必须持有m_mutex，或在工作线程启动之前调用
+        void enqueue(std::vector<size_t> files, bool fullStage) {
+            auto candidates = std::make_shared<duplicateCandidates>();
+            candidates->files = std::move(files);
+            candidates->remaining = candidates->files.size();
+            candidates->fullStage = fullStage;
+            for (size_t file : candidates->files) {
+                m_tasks.push_back(task{candidates, file});
+            }
+        }
+
+        void work() {
+            std::vector<unsigned char> buffer(__GCOMMDLG_DUPLICATE_EDGE);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                m_wake.wait(lock, [this] { return !m_tasks.empty() || m_running == 0 || m_error; });
+                if (m_error || m_tasks.empty()) break;
+
+                task current = m_tasks.front();
+                m_tasks.pop_front();
+                ++m_running;
+                lock.unlock();
+
+                try {
+                    hashFile(current, buffer);
+                } catch (...) {
+                    lock.lock();
+                    if (!m_error) m_error = std::current_exception();
+                    --m_running;
+                    m_wake.notify_all();
+                    break;
+                }
+
+                lock.lock();
+                --m_running;
+                m_wake.notify_all();
+            }
+        }
+
+        void hashFile(const task& current, std::vector<unsigned char>& buffer) {
+            size_t index = current.file;
+            unsigned long long size = m_sizes[index];
+            unsigned long long edge = __GCOMMDLG_DUPLICATE_EDGE;
+            bool readable = false;
+            uint64_t digest = 0;
+
+            FILE* file = openFileForRead(m_paths[index]);
+            if (file) {
+                setvbuf(file, NULL, _IONBF, 0);
+                xxHash64 hash;
+                if (!current.candidates->fullStage) {
+                    // 小文件在这里计算完整哈希，大文件只计算首尾
+                    readable = size <= 2 * edge
+                        ? hashFileRange(file, 0, size, hash, buffer)
+                        : hashFileRange(file, 0, edge, hash, buffer) && hashFileRange(file, size - edge, edge, hash, buffer);
+                } else {
+                    readable = hashFileRange(file, edge, size - 2 * edge, hash, buffer);
+                }
+                digest = hash.digest();
+                fclose(file);
+            }
+
+            std::vector<std::vector<size_t>> confirmed;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!readable) {
+                    m_readable[index] = 0;
+                } else if (current.candidates->fullStage) {
+                    m_middleHashes[index] = digest;
+                } else {
+                    m_edgeHashes[index] = digest;
+                }
+
+                if (--current.candidates->remaining == 0) {
+                    resolve(*current.candidates, confirmed);
+                }
+            }
+            emit(confirmed);
+        }
+
+        // 按哈希拆分已完成的候选组，调用时必须持有m_mutex
+        void resolve(const duplicateCandidates& candidates, std::vector<std::vector<size_t>>& confirmed) {
+            const std::vector<uint64_t>& hashes = candidates.fullStage ? m_middleHashes : m_edgeHashes;
+            std::unordered_map<uint64_t, std::vector<size_t>> byHash;
+            for (size_t file : candidates.files) {
+                if (m_readable[file]) byHash[hashes[file]].push_back(file);
+            }
+
+            for (auto& group : byHash) {
+                if (group.second.size() < 2) continue;
+                if (candidates.fullStage || m_sizes[group.second.front()] <= 2ull * __GCOMMDLG_DUPLICATE_EDGE) {
+                    confirmed.push_back(std::move(group.second));
+                } else {
+                    enqueue(std::move(group.second), true);
+                }
+            }
+        }
+
+        void emit(const std::vector<std::vector<size_t>>& groups) {
+            if (groups.empty()) return;
+            std::lock_guard<std::mutex> lock(m_callbackMutex);
+            for (const auto& group : groups) {
+                std::vector<std::string> names;
+                names.reserve(group.size());
+                for (size_t file : group) names.push_back(m_paths[file]);
+                m_onGroup(names);
+            }
+        }
+
+        const std::vector<std::string>& m_paths;
+        const std::function<void(const std::vector<std::string>&)>& m_onGroup;
+        std::vector<unsigned long long> m_sizes;
+        std::vector<uint64_t> m_edgeHashes;
+        std::vector<uint64_t> m_middleHashes;
+        std::vector<char> m_readable;
+
+        std::mutex m_mutex;
+        std::mutex m_callbackMutex;
+        std::condition_variable m_wake;
+        std::deque<task> m_tasks;
+        size_t m_running = 0;
+        std::exception_ptr m_error;
+    };
+}
+
+/**
+ * @brief 查找内容相同的文件组，每组一经确认立即报告
+ *
+ * 文件先按大小分组，再按开头和结尾各__GCOMMDLG_DUPLICATE_EDGE字节的哈希分组，只有仍在同一组中的文件
+ * 才会由任务调度器上的并行任务计算完整哈希。文件通过64位XXH64哈希比较，而不是逐字节比较。
+ *
+ * @param paths 文件路径（UTF8编码），例如getOpenMultipleFileNames的结果
+ * @param onGroup 每组两个或以上相同的文件调用一次，不会并发调用。各组的顺序不确定
+ * @param threadCount 哈希任务数，0表示任务调度器每个线程一个，最多__GCOMMDLG_DUPLICATE_THREADS个
+ * @throw 重新抛出onGroup抛出的第一个异常，此时放弃剩余的工作
+ *
+ * @note 不存在或无法读取的文件会被跳过。列出两次的路径会被报告为与自身重复
+ */
+void findDuplicateFiles(const std::vector<std::string>& paths,
+                        const std::function<void(const std::vector<std::string>&)>& onGroup,
+                        unsigned threadCount = 0) {
+    if (threadCount == 0) {
+        threadCount = std::min<unsigned>(taskConcurrency(), __GCOMMDLG_DUPLICATE_THREADS);
+    }
+    duplicateSearch search(paths, onGroup);
+    search.run(threadCount);
+}
+
+/**
+ * @brief 查找内容相同的文件组，参见接受回调的重载
+ *
+ * @param paths 文件路径（UTF8编码）
+ * @return 两个或以上相同文件组成的组，每组内按'paths'中的顺序排列
+ */
+std::vector<std::vector<std::string>> findDuplicateFiles(const std::vector<std::string>& paths) {
+    std::unordered_map<std::string, size_t> order;
+    for (size_t i = 0; i < paths.size(); ++i) order.emplace(paths[i], i);
+
+    std::vector<std::vector<std::string>> groups;
+    findDuplicateFiles(paths, [&groups](const std::vector<std::string>& group) {
+        groups.push_back(group);
+    });
+
+    for (auto& group : groups) {
+        std::sort(group.begin(), group.end(), [&order](const std::string& a, const std::string& b) {
+            return order[a] < order[b];
+        });
+    }
+    std::sort(groups.begin(), groups.end(), [&order](const std::vector<std::string>& a, const std::vector<std::string>& b) {
+        return order[a.front()] < order[b.front()];
+    });
+    return groups;
+}
+
+#pragma endregion
+
+#pragma region 预读
+// 请求操作系统开始把选中的文件读入文件缓存，使磁盘I/O与调用者接下来的工作重叠
+
+#ifndef __GCOMMDLG_PREFETCH_BUDGET
+#define __GCOMMDLG_PREFETCH_BUDGET (256ull * 1024 * 1024)  // prefetchFiles默认请求系统预读的字节数
+#endif
+
+/**
+ * @brief prefetchFiles的结果
+ */
+struct prefetchReport {
+    size_t files = 0;                 // 已发出预读提示的文件数
+    unsigned long long bytes = 0;     // 预读提示覆盖的字节数
+    double seconds = 0;               // 发出预读提示所用的时间
+};
+
+namespace {
+
+    /**
+     * @brief 为文件的前'length'字节发出预读提示
+     * @return 预读提示覆盖的字节数，文件无法打开、为空或不是普通文件时返回0
+     */
+    unsigned long long prefetchFileHead(const std::string& path, unsigned long long length) {
+#ifdef _WIN32
+        // PrefetchVirtualMemory自Windows 8起才有，动态查找以便旧系统直接跳过预读提示
+        struct memoryRange { void* address; SIZE_T size; };
+        typedef BOOL(WINAPI* prefetchFunction)(HANDLE, ULONG_PTR, memoryRange*, ULONG);
+        static const prefetchFunction prefetch = reinterpret_cast<prefetchFunction>(
+            GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+        if (!prefetch) return 0;
+
+        HANDLE file = CreateFileW(utf8ToWide(path).c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return 0;
+
+        unsigned long long covered = 0;
+        LARGE_INTEGER size;
+        if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            covered = std::min<unsigned long long>(length, static_cast<unsigned long long>(size.QuadPart));
+            HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping) {
+                void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(covered));
+                if (view) {
+                    // 读取请求异步排队，视图取消映射后这些页面仍保留在文件缓存中
+                    memoryRange range = { view, static_cast<SIZE_T>(covered) };
+                    if (!prefetch(GetCurrentProcess(), 1, &range, 0)) covered = 0;
+                    UnmapViewOfFile(view);
+                } else {
+                    covered = 0;
+                }
+                CloseHandle(mapping);
+            } else {
+                covered = 0;
+            }
+        }
+        CloseHandle(file);
+        return covered;
+#else
+        // FIFO会使open阻塞到出现写入方为止，设备从不预读
+        int file = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOCTTY);
+        if (file < 0) return 0;
+
+        unsigned long long covered = 0;
+        struct stat st;
+        if (fstat(file, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            covered = std::min<unsigned long long>(length, static_cast<unsigned long long>(st.st_size));
+#ifdef __APPLE__
+            struct radvisory advice;
+            advice.ra_offset = 0;
+            advice.ra_count = static_cast<int>(std::min<unsigned long long>(covered, 0x7FFFFFFF));
+            if (fcntl(file, F_RDADVISE, &advice) != 0) covered = 0;
+#else
+            if (posix_fadvise(file, 0, static_cast<off_t>(covered), POSIX_FADV_WILLNEED) != 0) covered = 0;
+#endif
+        }
+        close(file);
+        return covered;
+#endif
+    }
+}
+
+/**
+ * @brief 请求系统将选中的文件预读到文件缓存中，例如在getOpenMultipleFileNames返回后立即调用
+ *
+ * 按'paths'的顺序发出预读提示，直到覆盖'byteBudget'字节，最后一个文件可能只覆盖一部分。
+ * 预读提示只是将读取排队（Linux上用posix_fadvise，macOS上用F_RDADVISE，Windows 8及以上用PrefetchVirtualMemory），
+ * 因此调用会在数据到达之前就返回，之后打开这些文件时数据已在缓存中。
+ *
+ * @param paths 文件路径（UTF8编码）
+ * @param byteBudget 所有文件合计最多预读的字节数
+ * @return 覆盖的文件数和字节数，以及发出预读提示所用的时间
+ *
+ * @note 无法打开的文件以及不是普通文件的路径（管道、设备等）会被跳过。若要在任务调度器的任务中发出预读提示，请使用prefetchFilesAsync
+ */
+prefetchReport prefetchFiles(const std::vector<std::string>& paths,
+                             unsigned long long byteBudget = __GCOMMDLG_PREFETCH_BUDGET) {
+    auto start = std::chrono::steady_clock::now();
+    prefetchReport report;
+    for (const auto& path : paths) {
+        if (report.bytes >= byteBudget) break;
+        unsigned long long covered = prefetchFileHead(path, byteBudget - report.bytes);
+        if (covered > 0) {
+            ++report.files;
+            report.bytes += covered;
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+/**
+ * @brief 在任务调度器上以交互任务运行prefetchFiles，使调用者可以立即开始处理第一个文件
+ *
+ * @param paths 文件路径（UTF8编码），在调用返回前被复制
+ * @param byteBudget 所有文件合计最多预读的字节数
+ * @return 所有预读提示发出后持有结果的future
+ */
+std::future<prefetchReport> prefetchFilesAsync(const std::vector<std::string>& paths,
+                                               unsigned long long byteBudget = __GCOMMDLG_PREFETCH_BUDGET) {
+    auto task = std::make_shared<std::packaged_task<prefetchReport()>>([paths, byteBudget] {
+        return prefetchFiles(paths, byteBudget);
+    });
+    std::future<prefetchReport> report = task->get_future();
+    currentTaskExecutor()->execute([task] { (*task)(); }, taskInteractive);
+    return report;
+}
+
+#pragma endregion
+
+#pragma region 推测性加载
+// 在用户仍在打开对话框中选择文件时预热文件
+
+/**
+ * @brief 在任务调度器的空闲通道中加载高亮的文件，由getOpenFileName / getOpenMultipleFileNames的onSelectionChange回调驱动
+ *
+ * 每个路径最多加载一次，默认只发出预读提示（参见prefetchFiles），也可以由应用程序提供的回调加载，
+ * 回调可以解析文件并保存结果。较新的选择会替换较旧选择中尚未加载的路径。
+ */
+class speculativeLoader {
+public:
+    /**
+     * @param load 对每个新高亮的路径在空闲任务中逐个调用，为nullptr时只预读文件
+     * @param byteBudget 'load'为nullptr时所有路径合计最多预读的字节数
+     */
+    explicit speculativeLoader(std::function<void(const std::string&)> load = nullptr,
+                               unsigned long long byteBudget = __GCOMMDLG_PREFETCH_BUDGET)
+        : m_load(std::move(load)), m_budget(byteBudget) {}
+
+    ~speculativeLoader() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_tasks.cancel();
+        m_tasks.wait();
+        chargeMemory(memorySpeculativeLoads, -static_cast<long long>(m_loadedBytes), -static_cast<long long>(m_loaded.size()));
+    }
+
+    speculativeLoader(const speculativeLoader&) = delete;
+    speculativeLoader& operator=(const speculativeLoader&) = delete;
+
+    /**
+     * @brief 将当前高亮的路径加入队列并立即返回
+     * @param selection 高亮的路径（UTF8编码）
+     */
+    void select(const std::vector<std::string>& selection) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.clear();
+            for (const auto& path : selection) {
+                if (m_loaded.find(path) == m_loaded.end()) m_pending.push_back(path);
+            }
+            if (m_pending.empty() || m_scheduled) return;
+            m_scheduled = true;
+        }
+        // 在锁外排队，执行器可能会立即运行该任务
+        m_tasks.run([this] { run(); }, taskIdle);
+    }
+
+    /**
+     * @brief 可作为onSelectionChange传入的回调，加载器的生命周期必须长于对话框调用
+     */
+    std::function<void(const std::vector<std::string>&)> handler() {
+        return [this](const std::vector<std::string>& selection) { select(selection); };
+    }
+
+    /**
+     * @brief 目前为止已加载或正在加载的路径数
+     */
+    size_t loadedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_loaded.size();
+    }
+
+private:
+    // 加载待处理的路径直到全部完成，下一次选择会排入新的任务
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            if (m_stop || m_pending.empty()) {
+                m_scheduled = false;
+                return;
+            }
+
+            std::string path = std::move(m_pending.front());
+            m_pending.pop_front();
+            size_t buckets = bucketBytes(m_loaded);
+            auto inserted = m_loaded.insert(path);
+            if (!inserted.second) continue;
+            size_t bytes = hashNodeBytes(m_loaded, *inserted.first) + bucketBytes(m_loaded) - buckets;
+            m_loadedBytes += bytes;
+            chargeMemory(memorySpeculativeLoads, static_cast<long long>(bytes), 1);
+            lock.unlock();
+
+            if (m_load) {
+                // 这些工作是推测性的，出错的文件会在对话框返回后的正式加载中报告
+                try {
+                    m_load(path);
+                } catch (...) {
+                }
+            } else if (m_used < m_budget) {
+                m_used += prefetchFileHead(path, m_budget - m_used);
+            }
+
+            lock.lock();
+        }
+    }
+
+    std::function<void(const std::string&)> m_load;
+    unsigned long long m_budget;
+    unsigned long long m_used = 0;
+
+    mutable std::mutex m_mutex;
+    std::deque<std::string> m_pending;
+    std::unordered_set<std::string> m_loaded;
+    size_t m_loadedBytes = 0;   // 已记入memorySpeculativeLoads
+    bool m_scheduled = false;   // 是否有任务在排队或运行
+    bool m_stop = false;
+    taskGroup m_tasks;
+};
+
+#pragma endregion
+
+#pragma region 拖放与粘贴的路径
+// 将拖放、剪贴板和粘贴文本产生的路径列表转换为与getOpenMultipleFileNames返回值相同的列表
+
+namespace {
+
+    int hexDigitValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    /**
+     * @brief 将[begin, end)解码%XX转义后追加到'out'，格式错误的转义按原样保留
+     */
+    void appendPercentDecoded(std::string& out, const char* begin, const char* end) {
+        while (begin < end) {
+            // 没有转义的连续部分一次性复制，C库中的memchr是向量化实现的
+            const char* percent = static_cast<const char*>(std::memchr(begin, '%', end - begin));
+            if (!percent) {
+                out.append(begin, end);
+                return;
+            }
+            out.append(begin, percent);
+
+            int high = end - percent >= 3 ? hexDigitValue(percent[1]) : -1;
+            int low = high >= 0 ? hexDigitValue(percent[2]) : -1;
+            if (low >= 0) {
+                out += static_cast<char>((high << 4) | low);
+                begin = percent + 3;
+            } else {
+                out += '%';
+                begin = percent + 1;
+            }
+        }
+    }
+
+    bool startsWithFileScheme(const char* begin, const char* end) {
+        static const char scheme[] = "file:";
+        if (end - begin < 5) return false;
+        for (int i = 0; i < 5; ++i) {
+            char c = begin[i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != scheme[i]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 将文件URI（"file:///C:/a%20b.txt"、"file://localhost/tmp/x"、"file:/tmp/x"）转换为本地路径
+     * @return URI是否指向本地文件，仅在此情况下'path'有效
+     */
+    bool fileUriToPath(const char* begin, const char* end, std::string& path) {
+        if (!startsWithFileScheme(begin, end)) return false;
+        const char* p = begin + 5;
+
+        std::string host;
+        if (end - p >= 2 && p[0] == '/' && p[1] == '/') {
+            p += 2;
+            const char* slash = static_cast<const char*>(std::memchr(p, '/', end - p));
+            if (!slash) return false;
+            host.assign(p, slash);
+            p = slash;
+        }
+        if (host == "localhost") host.clear();
+
+        path.clear();
+        appendPercentDecoded(path, p, end);
+        if (path.empty() || path[0] != '/') return false;
+
+#ifdef _WIN32
+        // "/C:/dir/file" -> "C:\dir\file"，带主机名时转换为UNC路径"\\host\share\file"
+        if (path.size() >= 3 && path[2] == ':') path.erase(0, 1);
+        std::replace(path.begin(), path.end(), '/', '\\');
+        if (!host.empty()) path = "\\\\" + host + path;
+#else
+        // 其他主机上的文件无法通过本地路径打开
+        if (!host.empty()) return false;
+#endif
+        return true;
+    }
+
+    /**
+     * @brief 对文本的每一行调用f(begin, end)，不含换行符（LF或CRLF）
+     */
+    template <typename Function>
+    void forEachLine(const std::string& text, Function f) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        while (p < end) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* lineEnd = newline ? newline : end;
+            f(p, lineEnd > p && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd);
+            p = newline ? newline + 1 : end;
+        }
+    }
+
+    /**
+     * @brief 将小端UTF-16字符串以UTF8追加，未配对的代理项变为U+FFFD
+     */
+    void appendUtf16AsUtf8(std::string& out, const unsigned char* data, size_t units) {
+        for (size_t i = 0; i < units; ++i) {
+            uint32_t c = data[i * 2] | (data[i * 2 + 1] << 8);
+            if (c < 0x80) {
+                out += static_cast<char>(c);
+                continue;
+            }
+            if (c >= 0xD800 && c <= 0xDBFF && i + 1 < units) {
+                uint32_t next = data[i * 2 + 2] | (data[i * 2 + 3] << 8);
+                if (next >= 0xDC00 && next <= 0xDFFF) {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (next - 0xDC00);
+                    ++i;
+                }
+            }
+            if (c >= 0xD800 && c <= 0xDFFF) c = 0xFFFD;
+
+            if (c < 0x800) {
+                out += static_cast<char>(0xC0 | (c >> 6));
+            } else if (c < 0x10000) {
+                out += static_cast<char>(0xE0 | (c >> 12));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (c >> 18));
+                out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            }
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+}
+
+/**
+ * @brief 解析从拖放或剪贴板收到的CF_HDROP数据块（DROPFILES头后跟以两个NUL结尾的文件列表）
+ *
+ * @param data 数据块起始地址，例如对WM_DROPFILES的HDROP或GetClipboardData(CF_HDROP)调用GlobalLock的结果
+ * @param size 数据块的字节数，例如同一句柄的GlobalSize
+ * @return 按列表顺序排列的文件路径（UTF8编码）
+ * @throw std::invalid_argument 头部被截断或指向数据块之外时抛出
+ *
+ * @note 宽字符和ANSI列表均可接受，ANSI列表在Windows上按当前代码页解码，在其他平台上按UTF8解码
+ */
+std::vector<std::string> parseDroppedFiles(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const size_t headerSize = 20;   // DWORD pFiles, POINT pt, BOOL fNC, BOOL fWide
+    if (!bytes || size < headerSize) {
+        throw std::invalid_argument("Drop data is too small");
+    }
+
+    uint32_t offset = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    bool wide = (bytes[16] | bytes[17] | bytes[18] | bytes[19]) != 0;
+    if (offset < headerSize || offset > size) {
+        throw std::invalid_argument("Drop data has an invalid file list offset");
+    }
+
+    std::vector<std::string> paths;
+    const unsigned char* p = bytes + offset;
+    const unsigned char* end = bytes + size;
+    if (wide) {
+        while (end - p >= 2) {
+            const unsigned char* start = p;
+            while (end - p >= 2 && (p[0] | p[1]) != 0) p += 2;
+            if (p == start) break;
+            std::string path;
+            appendUtf16AsUtf8(path, start, (p - start) / 2);
+            paths.push_back(std::move(path));
+            p += 2;
+        }
+    } else {
+        while (p < end && *p != 0) {
+            const unsigned char* terminator = static_cast<const unsigned char*>(std::memchr(p, 0, end - p));
+            const unsigned char* stop = terminator ? terminator : end;
+            std::string path(reinterpret_cast<const char*>(p), stop - p);
+#ifdef _WIN32
+            int length = MultiByteToWideChar(CP_ACP, 0, path.data(), static_cast<int>(path.size()), NULL, 0);
+            std::wstring widePath(length, L'\0');
+            MultiByteToWideChar(CP_ACP, 0, path.data(), static_cast<int>(path.size()), &widePath[0], length);
+            path = wideToUtf8(widePath);
+#endif
+            paths.push_back(std::move(path));
+            p = terminator ? terminator + 1 : end;
+        }
+    }
+    return paths;
+}
+
+/**
+ * @brief 解析文件管理器在拖放和复制时提供的text/uri-list（RFC 2483）
+ *
+ * @param text 列表（UTF8编码），每行一个URI
+ * @return 按列表顺序排列的本地文件路径（UTF8编码），百分号转义已解码
+ *
+ * @note 注释行和不指向本地文件的URI（其他协议、其他主机）会被跳过
+ */
+std::vector<std::string> parseUriList(const std::string& text) {
+    std::vector<std::string> paths;
+    std::string path;
+    forEachLine(text, [&](const char* begin, const char* end) {
+        if (begin == end || *begin == '#') return;
+        if (fileUriToPath(begin, end, path)) paths.push_back(path);
+    });
+    return paths;
+}
+
+/**
+ * @brief 解析以纯文本粘贴的路径，每行一个
+ *
+ * @param text 粘贴的文本（UTF8编码）
+ * @return 按文本顺序排列的文件路径（UTF8编码）
+ *
+ * @note 去除两端的空白和引号（例如"复制为路径"添加的引号），file:// URI会被转换为路径，空行会被跳过
+ */
+std::vector<std::string> parsePastedPaths(const std::string& text) {
+    std::vector<std::string> paths;
+    std::string path;
+    forEachLine(text, [&](const char* begin, const char* end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+        if (end - begin >= 2 && (*begin == '"' || *begin == '\'') && end[-1] == *begin) {
+            ++begin;
+            --end;
+        }
+        if (begin == end) return;
+
+        if (fileUriToPath(begin, end, path)) {
+            paths.push_back(path);
+        } else if (!startsWithFileScheme(begin, end)) {
+            paths.emplace_back(begin, end);
+        }
+    });
+    return paths;
+}
+
+#pragma endregion
+
+#pragma region 选择展开
+// 将选中的目录递归展开为符合对话框过滤器的文件，并行遍历并以流的方式输出结果
+
+#ifndef __GCOMMDLG_EXPAND_THREADS
+#define __GCOMMDLG_EXPAND_THREADS  8     // 调用者未指定数量时遍历任务数的上限
+#endif
+#ifndef __GCOMMDLG_EXPAND_CAPACITY
+#define __GCOMMDLG_EXPAND_CAPACITY 4096  // 遍历线程等待消费者之前默认缓冲的匹配路径数
+#endif
+
+/**
+ * @brief 生产者与消费者线程之间的固定容量队列，队列满时生产者阻塞
+ */
+template <typename T>
+class boundedChannel {
+public:
+    explicit boundedChannel(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+    /**
+     * @brief 添加一项，通道满时等待
+     * @return 通道已关闭时返回false，此时该项被丢弃
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed) return false;
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 取出最早的一项，通道为空时等待
+     * @return 通道关闭且已取空后返回false
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty()) return false;
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 不等待，取出最早的一项
+     * @return 通道为空时返回false
+     */
+    bool tryPop(T& item) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.empty()) return false;
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 唤醒所有等待的线程，之后的push会失败，pop会取完剩余的项
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+private:
+    size_t m_capacity;
+    std::deque<T> m_items;
+    bool m_closed = false;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+};
+
+/**
+ * @brief 由"*.png;*.jpg"这样的对话框过滤模式编译而成的文件名匹配器，与对话框一样不区分大小写
+ */
+class fileFilterMatcher {
+public:
+    /**
+     * @param filters 与传给对话框的格式相同的"描述|模式"过滤器，或单纯的模式。所有模式合并使用
+     */
+    explicit fileFilterMatcher(const std::vector<std::string>& filters) {
+        for (const auto& filter : filters) {
+            size_t pipe = filter.find('|');
+            std::string patterns = pipe == std::string::npos ? filter : filter.substr(pipe + 1);
+            size_t start = 0;
+            while (start <= patterns.size()) {
+                size_t end = patterns.find(';', start);
+                if (end == std::string::npos) end = patterns.size();
+                addPattern(patterns.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+        if (filters.empty()) m_matchAll = true;
+    }
+
+    /**
+     * @brief 检查文件名（不含目录）是否匹配这些模式
+     */
+    bool matches(const std::string& name) const {
+        if (m_matchAll) return true;
+        std::string folded = foldAscii(name);
+
+        size_t dot = folded.rfind('.');
+        if (dot != std::string::npos && m_extensions.count(folded.substr(dot + 1))) return true;
+
+        for (const auto& pattern : m_globs) {
+            if (globMatch(pattern, folded)) return true;
+        }
+        return false;
+    }
+
+private:
+    static std::string foldAscii(std::string text) {
+        for (auto& c : text) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return text;
+    }
+
+    void addPattern(std::string pattern) {
+        size_t first = pattern.find_first_not_of(' ');
+        if (first == std::string::npos) return;
+        pattern = foldAscii(pattern.substr(first, pattern.find_last_not_of(' ') - first + 1));
+
+        // "*"和"*.*"匹配所有文件名，"*.ext"通过哈希查找匹配，其他模式交给通配符匹配器
+        if (pattern == "*" || pattern == "*.*") {
+            m_matchAll = true;
+        } else if (pattern.size() > 2 && pattern[0] == '*' && pattern[1] == '.' &&
+                   pattern.find_first_of("*?.", 2) == std::string::npos) {
+            m_extensions.insert(pattern.substr(2));
+        } else {
+            m_globs.push_back(pattern);
+        }
+    }
+
+    // 迭代式通配符匹配，只回溯到最近的'*'
+    static bool globMatch(const std::string& pattern, const std::string& name) {
+        size_t p = 0, n = 0, star = std::string::npos, resume = 0;
+        while (n < name.size()) {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+                ++p;
+                ++n;
+            } else if (p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                resume = n;
+            } else if (star != std::string::npos) {
+                p = star + 1;
+                n = ++resume;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') ++p;
+        return p == pattern.size();
+    }
+
+    bool m_matchAll = false;
+    std::unordered_set<std::string> m_extensions;
+    std::vector<std::string> m_globs;
+};
+
+namespace {
+
+#ifndef _WIN32
+    /**
+     * @brief 检查readdir未报告为目录或普通文件的项
+     * @return 该项是否为目录或普通文件，符号链接只在指向普通文件时才跟随
+     */
+    bool classifyDirectoryEntry(const std::string& path, bool& isDirectory) {
+        struct stat st;
+        if (lstat(path.c_str(), &st) != 0) return false;
+        if (S_ISDIR(st.st_mode)) {
+            isDirectory = true;
+            return true;
+        }
+        if (S_ISLNK(st.st_mode) && stat(path.c_str(), &st) != 0) return false;
+        return S_ISREG(st.st_mode);
+    }
+#endif
+
+    /**
+     * @brief 对目录中的每个子目录和普通文件调用f(path, isDirectory)，指向普通文件的符号链接算作文件。
+     * 指向目录的符号链接和联接点会被跳过，使遍历不会陷入循环；管道、套接字和设备同样被跳过
+     * @return 能否打开目录
+     */
+    template <typename Function>
+    bool forEachDirectoryEntry(const std::string& directory, Function f) {
+#ifdef _WIN32
+        std::wstring directoryWide = utf8ToWide(directory);
+        std::wstring pattern = directoryWide;
+        if (!pattern.empty() && pattern.back() != L'\\' && pattern.back() != L'/') pattern += L'\\';
+        std::string prefix = wideToUtf8(pattern);
+        pattern += L'*';
+
+        WIN32_FIND_DATAW data;
+        HANDLE hFind = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data,
+                                        FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+        if (hFind == INVALID_HANDLE_VALUE) return false;
+        do {
+            if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) continue;
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE) continue;
+            bool isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+            if (isDirectory && (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) continue;
+            if (!f(prefix + wideToUtf8(data.cFileName), isDirectory)) break;
+        } while (FindNextFileW(hFind, &data));
+        FindClose(hFind);
+        return true;
+#else
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) return false;
+        std::string prefix = directory;
+        if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+        while (struct dirent* entry = readdir(dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            std::string path = prefix + entry->d_name;
+            bool isDirectory = false;
+#ifdef DT_DIR
+            if (entry->d_type == DT_DIR) {
+                isDirectory = true;
+            } else if (entry->d_type != DT_REG && !classifyDirectoryEntry(path, isDirectory)) {
+                continue;
+            }
+#else
+            if (!classifyDirectoryEntry(path, isDirectory)) continue;
+#endif
+            if (!f(path, isDirectory)) break;
+        }
+        closedir(dir);
+        return true;
+#endif
+    }
+
+    bool isDirectoryPath(const std::string& path) {
+#ifdef _WIN32
+        DWORD attributes = GetFileAttributesW(utf8ToWide(path).c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+    }
+}
+
+/**
+ * @brief 以流的方式输出选择中的文件，选中的目录会被递归展开
+ *
+ * 选中的文件原样输出。选中的目录由任务调度器上的交互任务遍历，文件名匹配过滤模式的每个文件
+ * 都通过有界通道传递，因此消费者可以在遍历结束前开始处理，
+ * 消费者跟不上时遍历线程会暂停。展开得到的文件顺序不确定。遍历只输出普通文件：
+ * 其中遇到的管道、套接字、设备和指向目录的链接都会被跳过。
+ *
+ * 示例：
+ * @code
+ * selectionExpander files({getOpenDirectoryName("导入文件夹")}, {"图片|*.png;*.jpg"});
+ * std::string path;
+ * while (files.next(path)) importImage(path);
+ * @endcode
+ *
+ * @note 没有缓冲的文件时，next会自己列出一个目录而不是等待，因此即使调度器没有空闲线程供遍历任务使用
+ * （例如在任务中消费文件时），遍历也能完成
+ */
+class selectionExpander {
+public:
+    /**
+     * @param selection 选中的路径（UTF8编码），例如getOpenMultipleFileNames或getOpenDirectoryName的结果。空路径会被忽略
+     * @param filters 与对话框格式相同的"描述|模式"过滤器（也接受单纯的模式），所有模式合并使用。为空时接受所有文件
+     * @param threadCount 遍历任务数，0表示任务调度器每个线程一个，最多__GCOMMDLG_EXPAND_THREADS个
+     * @param capacity 遍历线程等待之前缓冲的匹配路径数
+     */
+    selectionExpander(const std::vector<std::string>& selection,
+                      const std::vector<std::string>& filters,
+                      unsigned threadCount = 0,
+                      size_t capacity = __GCOMMDLG_EXPAND_CAPACITY)
+        : m_matcher(filters), m_channel(capacity) {
+        for (const auto& path : selection) {
+            if (path.empty()) continue;
+            if (isDirectoryPath(path)) {
+                m_directories.push_back(path);
+            } else {
+                m_selectedFiles.push_back(path);
+            }
+        }
+
+        if (m_directories.empty()) {
+            m_channel.close();
+            return;
+        }
+
+        if (threadCount == 0) {
+            threadCount = std::min<unsigned>(taskConcurrency(), __GCOMMDLG_EXPAND_THREADS);
+        }
+        for (unsigned i = 0; i < threadCount; ++i) {
+            m_walkers.run([this] { walk(); }, taskInteractive);
+        }
+    }
+
+    /**
+     * @brief 若遍历仍在进行则停止遍历，并等待遍历任务结束
+     */
+    ~selectionExpander() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_channel.close();
+        m_walkers.cancel();
+        m_walkers.wait();
+    }
+
+    selectionExpander(const selectionExpander&) = delete;
+    selectionExpander& operator=(const selectionExpander&) = delete;
+
+    /**
+     * @brief 获取下一个文件，没有缓冲的文件时列出一个目录或等待遍历任务
+     * @param path 输出的文件路径（UTF8编码）
+     * @return 所有文件都已输出后返回false
+     */
+    bool next(std::string& path) {
+        if (m_nextSelected < m_selectedFiles.size()) {
+            path = m_selectedFiles[m_nextSelected++];
+            return true;
+        }
+
+        std::string directory;
+        while (true) {
+            if (!m_listed.empty()) {
+                path = std::move(m_listed.front());
+                m_listed.pop_front();
+                return true;
+            }
+            if (m_channel.tryPop(path)) return true;
+
+            // 只剩正在运行的遍历任务在列出的目录，它们的文件或输出流的结束终将到达
+            if (!takeDirectory(directory, false)) return m_channel.pop(path);
+
+            // 在此找到的匹配文件单独存放，推入通道可能会等待一个只有本线程才会取出的已满通道
+            listDirectory(directory, [this](const std::string& found) {
+                m_listed.push_back(found);
+                return true;
+            });
+        }
+    }
+
+private:
+    void walk() {
+        std::string directory;
+        while (takeDirectory(directory, true)) {
+            listDirectory(directory, [this](const std::string& found) { return m_channel.push(found); });
+        }
+    }
+
+    /**
+     * @brief 取出下一个要列出的目录
+     * @param wait 在其他遍历任务仍可能找到子目录时是否等待
+     * @return 遍历结束后，或'wait'为false且没有等待中的目录时返回false
+     */
+    bool takeDirectory(std::string& directory, bool wait) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (wait) {
+            m_wake.wait(lock, [this] { return m_stop || !m_directories.empty() || m_active == 0; });
+        }
+        if (m_stop || m_directories.empty()) return false;
+
+        directory = std::move(m_directories.back());
+        m_directories.pop_back();
+        ++m_active;
+        return true;
+    }
+
+    /**
+     * @brief 列出用takeDirectory取出的目录，将匹配的文件交给'deliver'，并将其子目录排队
+     */
+    template <typename Deliver>
+    void listDirectory(const std::string& directory, Deliver deliver) {
+        std::vector<std::string> subdirectories;
+        bool open = true;
+        size_t matched = 0;
+        __GCOMMDLG_PROBE1(enumerate__begin, directory.c_str());
+        forEachDirectoryEntry(directory, [&](const std::string& path, bool isDirectory) {
+            if (isDirectory) {
+                subdirectories.push_back(path);
+            } else if (m_matcher.matches(path.substr(path.find_last_of("/\\") + 1))) {
+                ++matched;
+                open = deliver(path);
+            }
+            return open;
+        });
+        __GCOMMDLG_PROBE3(enumerate__end, directory.c_str(), matched, subdirectories.size());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_active;
+        if (!open) m_stop = true;
+        for (auto& subdirectory : subdirectories) {
+            m_directories.push_back(std::move(subdirectory));
+        }
+
+        if (m_directories.empty() && m_active == 0) {
+            // 最后一个空闲下来的遍历者结束输出流
+            m_channel.close();
+            m_wake.notify_all();
+        } else if (!m_directories.empty()) {
+            m_wake.notify_all();
+        }
+    }
+
+    fileFilterMatcher m_matcher;
+    boundedChannel<std::string> m_channel;
+    std::vector<std::string> m_selectedFiles;
+    size_t m_nextSelected = 0;
+    std::deque<std::string> m_listed;           // next自己找到的文件，只由消费线程使用
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<std::string> m_directories;     // 等待列出的目录，从末尾取出以实现深度优先的顺序
+    size_t m_active = 0;
+    bool m_stop = false;
+    taskGroup m_walkers;
+};
+
+#pragma endregion
+
+#pragma region 注册表导出
+// 读取regedit或"reg export"写出的.reg文件中的注册表值，以便离线或在其他平台上构建字体索引
+
+/**
+ * @brief 注册表值的类型，数值与REG_*常量相同
+ */
+enum registryValueType {
+    registryNone = 0,
+    registryString = 1,         // REG_SZ
+    registryExpandString = 2,   // REG_EXPAND_SZ
+    registryBinary = 3,         // REG_BINARY
+    registryDword = 4,          // REG_DWORD
+    registryMultiString = 7,    // REG_MULTI_SZ
+    registryQword = 11          // REG_QWORD
+};
+
+/**
+ * @brief .reg文件中的一个值
+ */
+struct registryExportValue {
+    std::string key;          // 完整的键路径，例如"HKEY_LOCAL_MACHINE\SOFTWARE\Microsoft\Windows NT\CurrentVersion\Fonts"
+    std::string name;         // 值名称，默认值（"@"）为空
+    registryValueType type;
+    std::string data;         // 字符串类型为UTF8，REG_MULTI_SZ的各字符串以'\0'分隔；其他类型为原始的小端字节
+};
+
+namespace {
+
+    /**
+     * @brief 从左引号开始解析.reg中带引号的字符串，"\\"和"\""会被反转义
+     * @return 右引号之后的位置，没有右引号时返回nullptr
+     */
+    const char* parseRegistryString(const char* p, const char* end, std::string& out) {
+        out.clear();
+        for (++p; p < end;) {
+            // 不含转义的片段一次性复制
+            const char* run = p;
+            while (p < end && *p != '"' && *p != '\\') ++p;
+            out.append(run, p);
+            if (p == end) break;
+            if (*p == '"') return p + 1;
+            if (p + 1 < end && (p[1] == '\\' || p[1] == '"')) ++p;
+            out += *p++;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 将"hex:"列表（例如"41,00,42,00,\"）的字节追加到'out'
+     * @return 列表是否在下一行继续
+     */
+    bool appendRegistryHex(const char* p, const char* end, std::string& out) {
+        bool continued = false;
+        while (p < end) {
+            int high = hexDigitValue(*p);
+            int low = high >= 0 && p + 1 < end ? hexDigitValue(p[1]) : -1;
+            if (low >= 0) {
+                out += static_cast<char>((high << 4) | low);
+                p += 2;
+                continue;
+            }
+            if (*p == '\\') continued = true;
+            ++p;
+        }
+        return continued;
+    }
+
+    /**
+     * @brief 将hex(1)、hex(2)或hex(7)值的字节转换为UTF8，在结尾的空字符处停止。其他类型保持不变
+     * @param unicode 文件是否为以UTF-16LE存储字符串的5.00版导出文件，REGEDIT4文件使用ANSI代码页
+     */
+    void finishRegistryValue(registryExportValue& value, bool unicode) {
+        if (value.type != registryString && value.type != registryExpandString && value.type != registryMultiString) return;
+
+        std::string text;
+        if (unicode) {
+            appendUtf16AsUtf8(text, reinterpret_cast<const unsigned char*>(value.data.data()), value.data.size() / 2);
+        } else {
+            text.swap(value.data);
+        }
+        if (value.type == registryMultiString) {
+            size_t end = text.find(std::string(2, '\0'));
+            if (end != std::string::npos) text.resize(end);
+            while (!text.empty() && text.back() == '\0') text.pop_back();
+        } else {
+            text.resize(std::find(text.begin(), text.end(), '\0') - text.begin());
+        }
+        value.data.swap(text);
+    }
+
+}
+
+/**
+ * @brief 解析.reg文件的内容："Windows Registry Editor Version 5.00"（UTF-16LE或UTF8）或"REGEDIT4"。
+ * 删除项（"[-key]"和"name"=-）以及格式错误的行会被跳过
+ * @param data 文件内容
+ * @param size 内容的字节数
+ * @return 按文件顺序排列的值
+ * @throw std::invalid_argument 内容不以.reg文件头开始时抛出
+ */
+std::vector<registryExportValue> parseRegistryExport(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::string text;
+    if (size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE) {
+        text.reserve(size / 2);
+        appendUtf16AsUtf8(text, bytes + 2, (size - 2) / 2);
+    } else {
+        size_t bom = size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF ? 3 : 0;
+        text.assign(reinterpret_cast<const char*>(bytes) + bom, size - bom);
+    }
+
+    bool unicode = text.compare(0, 36, "Windows Registry Editor Version 5.00") == 0;
+    if (!unicode && text.compare(0, 8, "REGEDIT4") != 0) {
+        throw std::invalid_argument("Not a registry export");
+    }
+
+    std::vector<registryExportValue> values;
+    std::string key;
+    bool pendingHex = false;
+    forEachLine(text, [&](const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (pendingHex) {
+            registryExportValue& value = values.back();
+            pendingHex = appendRegistryHex(p, end, value.data);
+            if (!pendingHex) finishRegistryValue(value, unicode);
+            return;
+        }
+        if (p == end || *p == ';') return;
+
+        if (*p == '[') {
+            const char* close = end;
+            while (close > p && close[-1] != ']') --close;
+            // 被删除的键下的值会被忽略，直到下一个键
+            key = close > p + 1 && p[1] != '-' ? std::string(p + 1, close - 1) : std::string();
+            return;
+        }
+        if (key.empty() || (*p != '"' && *p != '@')) return;
+
+        registryExportValue value;
+        value.key = key;
+        value.type = registryNone;
+        p = *p == '@' ? p + 1 : parseRegistryString(p, end, value.name);
+        if (!p || p == end || *p != '=') return;
+        ++p;
+
+        if (p < end && *p == '"') {
+            if (!parseRegistryString(p, end, value.data)) return;
+            value.type = registryString;
+        } else if (end - p >= 6 && std::memcmp(p, "dword:", 6) == 0) {
+            unsigned long dword = std::strtoul(std::string(p + 6, end).c_str(), nullptr, 16);
+            for (int i = 0; i < 4; ++i) value.data += static_cast<char>((dword >> (i * 8)) & 0xFF);
+            value.type = registryDword;
+        } else if (end - p >= 3 && std::memcmp(p, "hex", 3) == 0) {
+            p += 3;
+            int type = registryBinary;
+            if (p < end && *p == '(') {
+                char* typeEnd = nullptr;
+                type = static_cast<int>(std::strtol(p + 1, &typeEnd, 16));
+                p = typeEnd && typeEnd < end && *typeEnd == ')' ? typeEnd + 1 : end;
+            }
+            if (p == end || *p != ':') return;
+            value.type = static_cast<registryValueType>(type);
+            pendingHex = appendRegistryHex(p + 1, end, value.data);
+            if (!pendingHex) finishRegistryValue(value, unicode);
+        } else {
+            return;
+        }
+        values.push_back(std::move(value));
+    });
+    if (pendingHex) finishRegistryValue(values.back(), unicode);
+    return values;
+}
+
+/**
+ * @brief 读取.reg文件，参见parseRegistryExport
+ * @param path .reg文件的路径
+ * @return 按文件顺序排列的值
+ * @throw std::runtime_error 无法读取文件时抛出
+ * @throw std::invalid_argument 文件不是注册表导出文件时抛出
+ */
+std::vector<registryExportValue> readRegistryExport(const std::string& path) {
+    FILE* file = openFileForRead(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open registry export: " + path);
+    }
+    std::string contents;
+    char buffer[65536];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, got);
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed) {
+        throw std::runtime_error("Failed to read registry export: " + path);
+    }
+    return parseRegistryExport(contents.data(), contents.size());
+}
+
+#pragma endregion
+
+#pragma region 拼音搜索
+// 按在拉丁键盘上输入的内容查找中文名称：全拼、首字母或两者混合
+
+/**
+ * @brief toPinyin拼写读音的方式
+ */
+enum pinyinStyle {
+    pinyinPlain,      // "wei ruan ya hei"
+    pinyinTone,       // "wei1 ruan3 ya3 hei1"，5表示轻声
+    pinyinInitials    // "wryh"
+};
+
+namespace {
+
+    // 不带声调的拼音音节，ü像拼音键盘上那样写作v（"lv"、"nve"）。
+    // 读音存储为 音节序号 * 5 + 声调，声调为1到5，0表示没有读音
+    const char* const g_pinyinSyllables[] = {
+        "a", "ai", "an", "ang", "ao", "ba", "bai", "ban", "bang", "bao", "bei", "ben", "beng", "bi", "bian", "biao", "bie",
+        "bin", "bing", "bo", "bu", "ca", "cai", "can", "cang", "cao", "ce", "cei", "cen", "ceng", "cha", "chai", "chan",
+        "chang", "chao", "che", "chen", "cheng", "chi", "chong", "chou", "chu", "chua", "chuai", "chuan", "chuang", "chui",
+        "chun", "chuo", "ci", "cong", "cou", "cu", "cuan", "cui", "cun", "cuo", "da", "dai", "dan", "dang", "dao", "de",
+        "dei", "den", "deng", "di", "dian", "diao", "die", "din", "ding", "diu", "dong", "dou", "du", "duan", "dui", "dun",
+        "duo", "e", "ei", "en", "eng", "er", "fa", "fan", "fang", "fei", "fen", "feng", "fiao", "fo", "fou", "fu", "ga",
+        "gai", "gan", "gang", "gao", "ge", "gei", "gen", "geng", "gong", "gou", "gu", "gua", "guai", "guan", "guang",
+        "gui", "gun", "guo", "ha", "hai", "han", "hang", "hao", "he", "hei", "hen", "heng", "hm", "hong", "hou", "hu",
+        "hua", "huai", "huan", "huang", "hui", "hun", "huo", "ji", "jia", "jian", "jiang", "jiao", "jie", "jin", "jing",
+        "jiong", "jiu", "ju", "juan", "jue", "jun", "ka", "kai", "kan", "kang", "kao", "ke", "kei", "ken", "keng", "kong",
+        "kou", "ku", "kua", "kuai", "kuan", "kuang", "kui", "kun", "kuo", "la", "lai", "lan", "lang", "lao", "le", "lei",
+        "leng", "li", "lia", "lian", "liang", "liao", "lie", "lin", "ling", "liu", "lo", "long", "lou", "lu", "luan",
+        "lun", "luo", "lv", "lve", "m", "ma", "mai", "man", "mang", "mao", "me", "mei", "men", "meng", "mi", "mian",
+        "miao", "mie", "min", "ming", "miu", "mo", "mou", "mu", "n", "na", "nai", "nan", "nang", "nao", "ne", "nei", "nen",
+        "neng", "ni", "nian", "niang", "niao", "nie", "nin", "ning", "niu", "nong", "nou", "nu", "nuan", "nun", "nuo",
+        "nv", "nve", "o", "ou", "pa", "pai", "pan", "pang", "pao", "pei", "pen", "peng", "pi", "pian", "piao", "pie",
+        "pin", "ping", "po", "pou", "pu", "qi", "qia", "qian", "qiang", "qiao", "qie", "qin", "qing", "qiong", "qiu", "qu",
+        "quan", "que", "qun", "ran", "rang", "rao", "re", "ren", "reng", "ri", "rong", "rou", "ru", "rua", "ruan", "rui",
+        "run", "ruo", "sa", "sai", "san", "sang", "sao", "se", "sen", "seng", "sha", "shai", "shan", "shang", "shao",
+        "she", "shei", "shen", "sheng", "shi", "shou", "shu", "shua", "shuai", "shuan", "shuang", "shui", "shun", "shuo",
+        "si", "song", "sou", "su", "suan", "sui", "sun", "suo", "ta", "tai", "tan", "tang", "tao", "te", "teng", "ti",
+        "tian", "tiao", "tie", "ting", "tong", "tou", "tu", "tuan", "tui", "tun", "tuo", "wa", "wai", "wan", "wang", "wei",
+        "wen", "weng", "wo", "wong", "wu", "xi", "xia", "xian", "xiang", "xiao", "xie", "xin", "xing", "xiong", "xiu",
+        "xu", "xuan", "xue", "xun", "ya", "yan", "yang", "yao", "ye", "yi", "yin", "ying", "yo", "yong", "you", "yu",
+        "yuan", "yue", "yun", "za", "zai", "zan", "zang", "zao", "ze", "zei", "zen", "zeng", "zha", "zhai", "zhan",
+        "zhang", "zhao", "zhe", "zhen", "zheng", "zhi", "zhong", "zhou", "zhu", "zhua", "zhuai", "zhuan", "zhuang", "zhui",
+        "zhun", "zhuo", "zi", "zong", "zou", "zu", "zuan", "zui", "zun", "zuo"
+    };
+
+    // U+3400到U+9FFF（CJK扩展A和统一表意文字）的读音，每个两位base-91数字。由Unicode CLDR的
+    // Han-Latin转写生成，它给出每个字最常用的读音
+    const char g_pinyinReadings[] =
+        "0b42!!!!*p5:6I!!!!!!!!!!6C!!!!!!!!!!!!!!!!!!5X!!!!!!!!!!$6!!!!!!!!/#!!!!%9!!!!!!5t5c!!5g,)+}5M6V5`7g%75;/D1M!!,c0A6E6H.."
+        "$)&{!!!!!!8E&n!95:8q!!7|&'3M6E0^*|+U.#8$2o!!!!!!5s!!!!2Z)b%n.~3M6E,56O!c!!!!!!+>-<6E+`)H6c,M#f!!!!!!);5s)81*!!7|!!(I5A3l"
+        "68)8*-,d,Y3t687^7K6c8F&`0}05$.5:(I3u2*3:0^+S1n!!!!+&0/3g2p62/63j!!-76J%k6c-D*-.L5Z6]!!!!#|&{+T+`!!,N!!)H!!!!!!!!0m!!#7+n"
+        "'r,x!!'w3W!!!!,x,l0l2h+^!!4y*f&17h4>!!!!#%)C&''i$&!!0R)p,@5e!!-u5Z!!!i)`3M!!'f!!6_5c0;/d%f'4,O0;0;3s!B'B$e5v+E!!!!2Q%h+^"
+        ")$4J/h%^1X&K0P6E8E1_)O!!$.$15=!!,Y%X+|*&3M5U7%!!!!8#7R)O8W$@5Z+`!!$.5>)Q!!)F!!&t$=!a)`!!!=+n*u!!5C!u*&+S5`!E64,T!Y&K,>!!"
+        "!!#|.~5w(f6c!!(.6E5x'i,:4*+P2h!!3[6:5H8W!!0t6H5=7q)K(|+36D*L'20S!+!!*L$;5Y$;4|!!!!).3M6_!!*-7]5t2g!!2t+'3&(V'@6/0c2Z)$5="
+        "&j/L%;&n'f!7'4.)5~6])!!!$!(7-g)$+`&c5R0+!!3=!!!!+P+~6E(v!!5t0h&^!!!!6$!!!!!!!!.R4~5Z4+(p4`.R.R6H7e!!!!!!!!!!4m2m/#6@044L"
+        "(G*-&&):,@)x)C,$!!41,H!!!!!!!!!!!!'R6-2f5|/X$[.`&E72&K5X6[&K2b5&*h(z'R5D,n,Y)F(u7r!!!!4m!!!F!+8:0='n%<!V#($:+`5U5o!!!!!!"
+        "!!!!(p4-$v+1+I7r5W5=!!0P7F5=!!!!$j)F)C3f6.5t0$1r!!!!!!(66@5O5{(V8q6E$e!!+W5I3k1C6E7r5=5I){)F(H!!/Q+`!!+>1r(H6.0g!!6.(H*9"
+        "$-.R)C!!!i5D5+5w4r6]0S5t.R!i(S)k!:!:!!!!7e3n)y!!8q#/)`!+7*$e&c!!!!!!!!.R,+-#&;!L!i!S!!$=5F41#p!!!!&C4|'5&E6c6>+%4~*u!!4|"
+        "67,45b#.$,5X.R+E6B8O,l7X5F(45X!!)H+r6E)F6H!!%/6E5Z(S6X*;#m3j3t7p!T--+%#k+T!!5A!!5=0K-|6p!!,3'58O!!'r*4%h)$+&!!'N3{!!2C+:"
+        ".R'3'N0N!J)J*^5A6d8:2]$b5R)G.o5S6E6b6C6/2]0}(S1n**6]!!5^/S0b#j!!#/&$3=&_!!,w6s)E!!0J5g/O$;/^/!)`6B&`&F!!!!!!&E!!!!0P,S0c"
+        "3G#>&,5=&{6E3_0M0'5]4F5`6]!Y,5!!!!!!!!6q+^3g+@,m0E7z605=,@5=2$&j!!4~&e6E.#$&3q)E2r/i!-*m#`!!5I7r!!!!&{+j6$5t-4)8-c6V7R6E"
+        ".k3t5=6q2r'36E%0!!+h#G#;){,@3M.3!:!/0A!!$}$i!!0|.B,g5^6n-p!:2Z,d!!!!+A5=6n7r5+)'-/.L4t-2.R0h7%+j7p8L(B5t(S5v7r-8$Z'n!!$Z"
+        ",C8$2l+s)v5Y%z)b1C,q!!*L69.Z6C+D6W6H6.3M!!+|6(,v-L8g6c6E'n-3*-5&!!*>%f,3!!5d%#0I-7-/0T!!4s%J!+!!!n.j+h)f6a$U8p#))56:4Z)H"
+        "!-,O)G4~#'6u5t.B6s!!!>7a)x4~5Z066C5Z$e0c&..M06)G4X!!3A%f+I7R!!!!6H#V)G)88L+>.!){0U%7!!)`5s$i6Y&+$,!!-H)13W*K8Z(S$'5~.;$."
+        "+h!0-b3:5N63)!%-0c+I'3&;,q+D4e(G,r#(0v04(G!!,5!z4572047%-2/T7S5P'I!!04!!,@#U6s&K&3-G4|0m3G-G4N!!-M69*&+`*u'I6g%3!!+I,80A"
+        "!8!r6V,r%F!!!8!!5>'3%9)v1d4E0g&K03)F)F)!)]8g!r--!E4~6D!:6c(Q&;51.=$y!!+^,=.L)'+`!!,T&{-36d!!){!!!!7R/^6D!!)H!h!!15)0&h'R"
+        "*k)b26!!3:4E6f8J!i*o+`)06$/!!!7a5'5I0;6=,x!!2A2r!!0H8@+)5;6L$P4++h!f'k,q5Z&~,87,7m$;,n,3!!6J/w7m)O,C.P6E!!)H)F7L6c)u),7q"
+        "+3,$7q!^7I)x%<+t6E7^5K$.$g$-6/+D&,,5#k!!4Y#a!*$-!!6N7a4J!!4Y#a698Q!!/D0K+h0S,>60*B3J6E#j)p)V!!)l!!&'!!*#(I%a!!!!(p!!$,%h"
+        "!i!!6&,=!!5X!i!!!i!!5I1_!x&_*#!!7h!Y&K6c0h7%-26E3=!!!!!!2D3j-c)l!n1C#^#>%w!!!!!!!!%_4F3g5c3@&D5A3x!!4+2D)R7r4|6J!!!!)-7v"
+        "068O!!5Z5Z724}!!!!3g7P.]!!!!5]6E142r#c8F!!-8)F&m/V!+&j!90U085U&v'B0H'Q4E#j6_'L!_'5$=8$!!7|!!(L.U*&$0#c*`+y+`6d!!6b(D+`(u"
+        "'h*L6i%J)8)Y(*)p8q'50P!X#|$e,q(F5A0c)2!!!!$61x6-7p%J4#-*,$2m4[#<%n#|/_6B)y)H+9416i!!#8036d+h$i!!!!!!6b)F5!-33W5X5q$.0c)8"
+        "!!6b0P333.&E,8!!/J3l7|6I2!&s#~6g6C)=2*6@-H&x(V!!6J#N.=!:&|+h#p#l,b%m(y,@!+6E)!7F(y&K)C3[.=5K+^5K60,3-*)d)E!!!m6c)C-=$6,g"
+        "!!+P)`5!6E5v5A#=+>6I5Z6u,N,$0>)C)O50!!!!'R7~%n6X)G631O5>3)6d6C0@)F0j402j0@-c)d,w6I'@0$5x,x&n6)'G3B)56d'u'},*&K8L8M!i4j+@"
+        "+y!!!!*t!!(D6G7~$35J5y!!0c/V(.&^'h0^(y+J+`$$1w8H500**X4a/^4#3g8F!s's(y!!#$7r&&&:7y..+}0%)G-G4~#{'n!L1M3n#.8O+$+I(I6M7r)`"
+        "5d5X6$2C0>5W3M(A-4);/c!!)8-m3B!_$5)`)3+@!!(|&))C(368#N(.)R)Q%F)g,d)8-8#<,Y/f65){){0t!!0=2;!!)v)C6r%05v5R&t#N6@!!%V!!0S)7"
+        "4_!!0D5>.<1p--4T+@(Q$g7N!7,N-D!!'2!!5X#()80Y5X!!!!#(0>0%)[*&++3B)y&K.R0=%n%n!!037o048=*h6b0S*h(V'3'd%`5K(/(V0w(I4F#(2C!h"
+        ",@6@.;$F1x%k,@4K+i*K1x7g$G+j,x!!0=*72M5R!i7F6J5=2D3M1n1_$_,=,$#a!!).!!!!)K!J(z&+!!,9)x*#*K3a,O7a%y&68$6//J#a!!!!!!!!6D!!"
+        "!!6])569697q'h05'_!!!!(w-4'3(y(*3p%^!!6.!!!!0j!!#q-M3x!T!-!!!!5J!!!!!!,x+F-v!Y$!!!&q7{)E)_2r!!+,%n,@!!!!!!!!6b3j#m,n-H)."
+        "5$.u).(u)l#(5J+`)g!!,r/p(Q63!!5K3M4~#|5=)g#[(X&v2>,$!!&;03016n#(!!)8%n60){)]-w+y6b4-4/5:(q5S(S!!447j!!)0'5!!!!4^!!18)[!!"
+        "5`!!!!6i*&)!!!!O-[!!'G4~!!-%3=!n,=0g!!!!'R7a,S/B1C0c+y'h5J5A5]!!.L!!!!!!5X+y'2%+8F!<8q7a8d(V)F!!)O!!!!!!4O5I6/3t3g%`*&!3"
+        "(G5S)y4|!N8:.R42-r!!!!6^-7!!!!-r2b#`6-'_$31X)K0S,v&K+`$,7'(V)`.B!!(%(u'@!!!_3a58)H5=0^(V5)5I)`);/d2Z$57h!!7P38)E3C7q!^!!"
+        "!!!!+E!i5y/T%7037o/d#l!i3M)C(a)p$K)V.3'r&n!!!!3g%#5=%J5I*y7a3d(z%#,@*#,@0A/Q7h!!+`#G04!!!!4-,$0h+i,>2p'i7a/N)g0X!!!!8O0/"
+        ")f!r)R(3!!!z7,+y+^,N2]-7)R%_!Y!!+i!!5I/x0t,38g!!*&2A5|!!5Z!!+@046C.~+^6n!!6D$+)H(K5Z*X8J(U5A0j(A5C(A(,#j6$5q2^*f5C296a6+"
+        "0+8Z6^8M+i5H5F6D2960)]5=$-2h*>6I(Z6E5=2*)g6@6[0t6=,C+)7m!!!!!!!!5W!!%#5l!05n#<$L7G!!6E/c*h2`+D4Z5=,$0351+j&/-*+A4~&6*u!)"
+        "6|)86E-X8M&y/_!!!i+`,=,O(A7g'<0t7e*^$')v*&)H,$!!2L0t1_$b.87o,8/N!!!!!T1C5H+U5R'20h!!267q3o1D3J6N,v-r!n!!2y3t(I2%1C!!%X0/"
+        ")Y3p!!0|.Z+y%n%n7w!!,T%<5=(.)F.=6E.C6c4y(9746.%#5I)[4K'5/V!!6[0b6(#/!n2h7G6E!n!!&;+>6B#h$05y5t6b5l!!!!!!3g(6!!!!!!,55Z#|"
+        ")Q3n/f7$5w5I.M!!!!!!!!!!-4)H.k(y(~4y6]72!i-30C5Z&j6E3n+U6X!!)g2S6J)G!!3M!!!!-r4y-93M6E2;5=)F,O6[,x7H3W7r!n+^!!!!!!!!!!!!"
+        "!!0K(%5=7h6V.R*-5Z695Z7o.6!!3:,4$!-40t%92C!!!!!!3M5Z#(%y8Z!!2r2Q(I3n'N!!!!!!-m-46$-*)R%!*&(X&t2f#{2^/(/},n!!!!!!!!6E$6!!"
+        "*h!R+S*K29!i3U'R/f6E5I.=6M8#$Z&|5t/o5:+r#B8W8n!n6:),/B5l!!+T0Z5U)Y(7!!!!6.5|7~(f6M5=!!!!+h5J),6G!!+j2C#B!Y)Q2r&j%f!!!@6b"
+        "!!!!-{+T6E%7!!#k#v'B)g.3!!!!!!+s-X6^!!,+(G!!6Y)g$-15.e!!!!(r42!!!('u!p#(0^!!2r$V)7#v'5)5&K5!&w3o!!,H(X6X)7!!6b8Q600c7^)p"
+        "3j!!!!!!!!!!!!4[+|)p7H5b(|!!5t!!!!!!%#0Y-X!!7,!d$+!!!!60'R-X!Y*!%n7^!!5960!!*&5H3j(H!!%e)H)`*G8a!!5Z+;&h)C5A.R-20|${6H-4"
+        "!!*&0g4E4u7`+_2L*a5H7a7o462o!Y6@/k#m(|*V)s!-$Z0>!Y!<&w*I4d4d8o,$!!(.6-2h(v+y263=!!!Y15&/#(+m0@&t)H8Q)5(V+^6g6n5l#l%_+S)f"
+        "$13=0069)T)+).3x1O5+6M1)6H2h6H*&4_5w)J7t0P8$%h!!6_!!!!6C2g6E-X!!!!0t5R59'a6N4@2g.;'a3g5.)y#l/o8F(y.#6.'m6c(u!!3:$+(|655)"
+        "5K/x1C,8+J2A5R72(D&h(H#j7S!!3f8$.e(I6b8F6_+`)C5=5H#k+h!!3:)v0/0c'h8L6b!!!!18.a-#!<)t!!5t/}!n,x!!!!!!!!6C6b!!/}0g!S)8!!!!"
+        "!!#/,q+64O59+`,$!!)H*-8T&E*&%7!Y!!!!!!!!!!+6!z3U4O5{!!!!!!!!!!&F!!!!3W!i4N2*#>4O-8)d,S!!!!7S!h)F7;5v+`!!!!3W6V2q!!!!&I!!"
+        "!!!!!!0^,M7h4_'p6c+T#(.-/i+j3u+h5$%>+`4@4j7|'G5c!5&j/a#(4d2o6C#(0P4K'h4E(G$')`).5e%f#e&'/d1X+y2b/6%a6b$K1C*>3t$j/n$Q,@4E"
+        "7m+`1n/D3:!!%>(z6E5K5Z,M,+!!3o'E!!3o!!!!!!6]-u!!'I*-$.'k4t+`,)+y5D!V!/6d)y1H6$8J%+#>7C6V'51X!!5>2r)[)[5q7X!!!!3.$!&i)F7o"
+        "!!'s5;!!0P2r(A4d&/8L0|-c'5,$)F5l5x-p6()b+`%01M6f,S2]+_+o'c5`5W0T0P#|6]#/*}0t!+0R0C$=/V+16B'z2b/h!!7|)1)5(z!Y!!!!7F)H'r5="
+        "'N#f,d8$4Z8=5H+D!!!!!!7r!+5J(65>!!4Z#=2%5H)b&y0w!!6:%F)K+T6.,=4Y6M/f,O+`!w!!,x!C)3!!6:(U$[(V.]$6+`3u),!i!<#|65%0!85|!!8J"
+        "%/0}!L%+4t3g!R'B6.5=8$6*&j6_!-4Y--2S)g'r)H0I)[6.5A*<-85y2A510=).157h4/*&5X06!3-%'r!!3x&h){#m33!i,x38'r(q)$,O(L)K0m'<)0#."
+        "'r&{-c!+6N33+o)`$.)`$50!#~6.&0%a!!+o5K!p5e-.6@-40606515Z6d0;$'696L63)F8O5v-G,7*6696/3[(/)36M2b#a+h!!5w$K#|.=0j-<)C6b7R(z"
+        "#[!p0>5=)V*c,g,r7R!m)E*&-z!i2h38-X+y-D-X5=#k0h)])C5H5t.a4E(u6d!!$0#(8a%h8E)E0;!!5e)82f*h!!&8686b!O)`7c)J2g%`&&$e'5-G7e7g"
+        "!!600J(K'h0H,Y'}+61_&d%,6.'f)`'z(73a507m.R%k+:3g%#6((3!!!!%^!!-7)_-G)z6b7e7^7I5b!!!G(V'n(p+I5;#'*X,@$v+h6B0K2p!!5y)d0R)7"
+        "3M$P&=,3!!.!3o%;4~'D%0+`#15K/E+67~.L)'6M5K+A-V!@!!(.!h'2)C6E,+626G*#)A$'&,&I!!6/8=7I056b0o)A.R)1)z2S!!!!/_-L#G,8+^$O!!$}"
+        "2D%904!!+;,$+s186b6E%j056C.A'2)Q6)&l1_5H!!!!!i2f0'.A7r3y41411O6E+y!0(V0^+`(,8M3M6i6+#a4t)}4A6^)8)Q1],q)z8J)x!-3W+9)=0n#o"
+        "&F*^.)#=4+5s)v)106)`,v6-!!7q4Y!!!+/J#D3t&T)=04$;3a8F.l4O2Z,9!p+^,l5]#V)1-$'L+h%G7R8J!!!!7r!@%#0b!!,35H&t(7$')v&K$06n(p69"
+        "6(684E7I6_5~69*L).+D6n$!!!!!2^!!.Z-L(o$O6r5v)g8F6a3n*>0^!!$')s5~7j$0/D0K!!0h+>6E1C3:0=3=!!&c!!--)$!!!!(D0K$=0t&;+`!@)b5q"
+        ",O!!6r7t(|6I0'7q0@!!'B)R8$8$*j.R1_72!47r'i6E$+)E7~+J151C7j-m#N!!!!6C*&!v$'*-&,4~6E7a6.!!1u,H/}7](G6d%77^&r29,$3g0g,q6@!R"
+        "(/'w-v'R!!2f*I3a$e7|3j*u0U5q&0#N)-$i1r7m0>)d8O4~!!!!5A-m0/3E){7e2K3x!G3g0A5)1C,O(z3G7t0/-D)d2K-42r,$+T)V+X7r%j!!1w'p&j-%"
+        "3W)Q3t5Z*h59&h,O#;#[,$6B$j6q--6d7r6D%;)C4}3o2*5Z3G3B0=,)6E!!+U+^&t+y+~5K5U/4-25H1$833&6.!n,$(p04+t!I!i(z(z!!#N/V0^-L)v#/"
+        "-#1w5!!!!!+^0n!!);5O!!2h6M!!-v)1)v6-!!1n4T5Z7a-(5A,l!!)13o5U6@!i,M&h+`%!$@%G%_+!$;5H#m-20A0c7h!!!!!!(|'B$-'}-c#()$'c68,x"
+        "4y!!!!!!1M5|7j-G)V!!7S8o6n+y!!7|!i156d!!$b&_6E-30Z!!4y)H#.!!!u&h6n+^&h0h'4&^&H7j4/6d)g05)y+9#{!X.b6E5s-[6$'3!!.U4>!c7H4|"
+        "*I67/75R'c3t(/)83d!!68%/06)f,Y-4-4)O,@&h/4-2)`'4!x)33J68.R)d+i#()O4,,$8a2e6I%G$6#1-D6/+@$1)Y3&0l.R,O!!2e,O8!!!$5*#)p&_6E"
+        "1_#813'3+>3W6b6]%e,$8$3g/}7M)Y$U#/*f%(!!(H(H-](|'f%^'35y-2-#+F's7^3g6d8R+^,@59+S)G+`+^!!0$644k4d/^!!7^(.!!5r-p0t4~7j&$4~"
+        "#(!!).5y7!+`6/)15~(z!S0}5R0'+t7y6E5t,O*G$=!!-m(G#v,@7R3g'2(o7A0I3M/w(%!!):$;!!&^&^1X053=)y!!6/!O6@8J.)$R!@#F4-(I8o!@7a4k"
+        "'a!i&`8$5;5%7r7|,@5%(30c+66|3G-7%`06#G/p+h2e,33M066i&|5q*&%a/k($.a157h'@/f3p#v$[(U80-X!v062h!h*&3=!!'u-m)75=&`5l-[!!5>7r"
+        "1d)y%n7c2N-.!i(I6b5K/I.6#<#/!!05)H8F,@*-5K5=#85&7p8M+)$i41$=%^$[0b7a7F1H!|)F5=7~*&'R)E%/#~3b1i5O)2048$3[#e5+*I*G'r'<&j$i"
+        "#G7r#l+S5l7N7a6b(/'f7!%9)C3E3q'p5A,l&D!:/f5;!*--/f--647r#(6M4}1%+>6-#l0m7g0/!!3j&t2q!!%B%+3n40$-3g)L33)1+s!!!!#~)g&K'k'3"
+        "&F!!&K!a3x%a!!%a#/4t7^,H04-c0A!!8O3E!!6]7y3g!!3M#/5>)V#I'54&#|'5&t5:5=64-N/K,r21--#H45*6!E5T5`06!!!!2M)..`5S$!%9&{6I!30}"
+        "1@,l&j0g2g(V!n%7-X%Z!!!!*|!!#c&E6^(S!!'u5~+U)f050g4y6B+r!!!!6.6E6H047a5A6E6=597o7r(H$b'2$Z/}*t$6!!4e0^$i'L*m0g0g7o-/+`7y"
+        "3g7o's+n(y+6%e$g6L!!!!048F#c,x&/6G#f1_(b1X'2+;5e)O6E-$!!,q)H3_(I!!+`8L8[68'Q+^05'i+`#!3_!!!!3M$8)O5X!Y5s)l0/,$5N8q%k$Z0Y"
+        "-u7K,T6C2M6b)!+^/9!!!!+^!!!!3(!!6E.]3:*k'56B%X0|#N!!4+0S!r3W4}&=2*!+068k*y&s!!6J!!2$&,)85Z723o3t7r6E'3&I!!*-)J#a5I,n!!!i"
+        ",$)`+')K!!$&+F5b&t,R7H(V)E.<6M5U4&+J72+%!!0>)y/n&h4J+}-28F5X(|-2)_6v$j+`0|8!6H(I!!6E,C6n0|,$.H6d/-!!6E/-6E0>5D$<6H-45=-m"
+        "*;8[5D6.4O4*583a6H$17{,r6g/(-<7.4t+^0g-m2f!i8J!O!!*#5O+%/B*|6$7I68+))55=&I63456]*&+^!!+^$&)H({7S'4#p($)y--#o3q-[5b+_6-3E"
+        "2e6E#%$i(u4t%a)E'R(G#(5l,)#<#<6E5w6.7.(I6W8O!!*>6b037c,b!!!!3()g(%0/+~!!4@)T+66E6V$g6/)`6#5!5J.Z'5'R!!-X8$-p5J5%+`#<-D)O"
+        ".=#h4r5t/(,i8d*<*/(L!!!!6d5!8!!!!!6E!!%h'3!h8#8L2r5D.;!!)[6$$0.l1C7r1z!!2A6d!!)d!!,@(F!u6E8g7S6d4t.;($*&!c#<!!&F0667+'1W"
+        "(u6$5Z!!+'!!5X#(*L$}5t!D/48Q!!4-$<$,.L(%&|5Z%X4}*&+'7D1n&E,$--!!(8--,3!!6O!!(%$v+^&/!!!p0=5=!!%J%J5K+h!!2N5X2e5!!!!!(X6]"
+        ",@+;6N2b*#06)Q6s!!06!!+~)F,g$P.B!z+`,$'G$'5v5J(z!f8Z%6%6)=1p#|4+!!/#7r,)&t)[(!5>+|5v183z/e5`2D7r4k4K4/6B5Z/e6868/((S.U6J"
+        "&i-u674u6h5D7|6h2h-95=)H3y&t5~.;$e-4!n)R-k6d&K7q135t,Y)86&.!(I)K&,)$4N/|$v5=3C-25`5;0^7U3y5e)v){)=4+,l60)E2m+T4t#|#>)b6_"
+        ")77H3M'R.#5A!!&8$,4}7a(3#t$+7,)8,C+r+I4c)55;!:2S3U,i3q5`)k!.3g#k5!4U)H$!#|6d5J5]!!!!!!.#!!600c)T3B*-+r)y!!,m+y!!$=$-5N0R"
+        "-$2r#g$-'q6b6G!!,)+I2r7a3&)5!!!!&K!!298R*&*-4S,84}$08$+y!!7a7]!!6E$:.;#'3O6D(S6+),,n,n0h+J(Q7t-G5I7h2q8o8$'n5y6E7r5X)g#<"
+        "!!#/+m7o)H4t(%)x)l!+'5(/(w601X7r!s6C3a%n(/2c6&$$2Q0X!!!!$[(p&'$&4~1M2q#6)F6v046-'56d'30'7o3p8o#{0h6_(V(w(.&K)W6r4L%%4N'5"
+        "8o(z!!#(7Z*'3s*&'5)1$Y6X$V3a$,0=#65S,l#;06)R!i)E7p8!0h7R)F!k!!+`+`6n0m$&'5#c3v2h(N0P04#(-m4L$;$v6n7o$!$=!i--!=40-G+x&}$&"
+        "0e45'3+1)Q!!!!!!7h0c8q$.+%+y!Y&15:!!8F,@3s!!$;+n41++#p*&4O).&t!i!!5C51)H0j+&(z0b3W#6!!0e/f/J4k681C6#$v%n$.%+-/5x&E!v7c$;"
+        "#m(/&68W%[+94&6n0m8!,$#~7g'52S46*m!)!!0^2r(B2C4p7R,4)s+`!!$Y1C6n*&*A&i04(p'3,=(p4d-G40*#057l0Z'h40+D,x6J,@6f)y/f!!5X!n):"
+        "7~1C1|58#c*X2D/_,n5l!!$i*X82#k3:$03W!Y*7!!7r5!-G,$8_.R,$066n!!6E5@$!!!1D$!.e6])H#(&n!!!!$t%`)Y6b(V5t6d0g!!!E'a)p!!6+2r6]"
+        "3C6@#D682r6.2|+t$i6d#(3U!!60+U+|4*&/6n)G!!6q!!!!)x)z$:$!'f5P5J!-(.6c+T!!4O$!5c0c(N!!%A#8%`6/8J!!6L#k!!+^3a,c,c!!3t/T,803"
+        "%+4O&K#<)`6C)F%A*&!h+U6E$Z$Z0'+^6|3l0'$t){5t&j!!5t&`)A7~0}&c)}(F+m7o-46a!!#V-#6G-84O+%!!!!-41C6d0C-2)y/e)f4z)H--)R5~!T'D"
+        "#l+`+_0c&A6O6r$!7q0}!!,Y*4(.6n)8/f#a&E#k262h2S5c6M2h$.6@(G&t6@6/8b3E)d&F5K(!3x0P#l(G-/6n$v0A)f2D-b6f!!/^7m7r$Z6c-[4u)W03"
+        "3M/t40*y$v3W!!)_)R!8)[6@!!6@,37-!R+h!!),,T4}5J4;#(7m8!!V--5Y/46[!!5T+`7G-2!!6=!!!!0$5Y!!!!!!2D8E!!2D*&)H)_!!.L!8$=5;($5Z"
+        "4A5~%B7P3p/^5X5t5K3=*p7m59)@1d5&&.),+1'5$H5I0S0N+>!!6+6L0t(K$[7r!!4~6.5P6E.<7m$H!!2f%w8L*&5t6g!!!!5s%G40'T6C(p6B!!+_*h5J"
+        "3T5A5y!!!!%^+97y.C$')R!i83,$(S!O3t$+,d5K3$6V0g!!0/)84}6D6@!!#|(Q!z!!5K#k)=!!(I$e7o04+%1H!!6L5h!!(z%!!!0t%_5;0b!!60+r!g!!"
+        "!z!!6f/-!R6N(p$e0;4+6d+S!R!!)H'35K#V(y2*!a0W6c4h!*(G%<'R%_)C/I!!8:,$,g,i+h5R5}7h0''5.j5A&;%<6r5K6I2o&;!d(|&s&t6v!Y&q5H2h"
+        "-87R7R7P)8'44t-W0I+s!!-D(y(p6b04&F!3!!!@%a5y%a!i7|/O4:6C!!)K7r4O5X%<455Z#r6h($+n!c!!,@)F5y2r&.3E(z6s#l!L1C&I5)!@&|6a7c&w"
+        "($#.'R&=)1&/4,#(0A+y,35!7S+>3T-m!i4d8$%m#.)y0'5D4~0'%/&g#j(|6v!!!!!!!!!!&h5Z(p$,!R6H!!)i#(1X$76L6B'>+)6r7g6*)x(w-G!B'R!n"
+        "8E(S7g2b'^!i&E$Z$C1x$'0|$#,x/T4|/e'48E03+|6B-(5906%n$#5D(V1|'u(u!7'40H)=/c6.3:5>-L+&'R!!!:1w3(,87g)8#k!!+~-k(I&/)g-7&h&K"
+        "#t(p(p6d5~/N!f#t6^6C5~1n5t+`+`6i&;)C29+X0)(y(7#/1]5!3E!06b5M(f635R68!!!i!!(f3y,)!!8$!!5A7%6E&,6g)v!!#(4+6N!!6C.A2N!_'k!I"
+        "-X'<&U2R!!7r65)R6i3.4+4~6&7r6E142h(z.)6<)R3V6N!S(z(z6@!!65+h5=&U&87$8$6N6N)f$P%<!!*u6E6@)Q&U.Z$e0@5~#'-33.-V+m05052l'3#("
+        "!d!v6D5!),&h04,v'5!3!4'5040w4d6E#(/i!=!!5w!!!!6d$,,=6C+`!!.L5A59!!+U0.8E8d8F#o!0&^6d+Z'57G);$[3E!f!i7G!!(V+`!!(I6|'q$',8"
+        "-X-4,i!:7a8!)1&h%[4E!!&/515!)H$.+|!p,3)Q.R,M2Z!!'u.R6E*h4s4h0;#(*D,$'E'u(B*|(f+$724>+D!i).0'694u4-3V*m&;!9)R-V+'*u!0,d0Y"
+        "0H!!*F(S&E5H-p3_)b/c/93@#p.R,l3@$g5H+1!!%_0*458Z50&t#9/_1p!!1H04%+/E#(,l8Q$g+')H+>!!---7/E,=8a)s,)6D5%+`+`7D8#);2[$.5e4y"
+        "&$)C/e(y-%#{-%#t)y.l!!6E1M,$6+!!068J!!!O'f72)b6b0S!Y!<4d620I6^7r)b-X2a2D042D-3'h6C'd'd4K'25|6@4@45-[,)#;+^2o,@)C%-/@,)){"
+        "7S)y7j8Z5K7r!!!!+6!!!!+65q'd&I-a7w4+6g7P'd5)+D6b3E7H(B)!7R#o,8#m7r5!5w7.-G(,3J!!!!3:&F#V*y4&.-+I,>6C5Z6/0X0.$65I($)`+;--"
+        "6@#o+`6J$Y0b4&6b!!!!%7&1(p!!5A!!04!!6g)F6s&n'f(L7h0t!!!!)b/d'E5w2`2f0J$e%n#(%h4t$e7q!C5:!S%<!=4E!!'f)v(/$g6^6g+J)y'3.R&I"
+        "&I5d*<604O0+!c-L3.60046g!u!!5v(u)167*#+%&K)F-X$1!S5;7h5t3g$.5=$j,b*f60#<!!(X%X0|4E6d5P.!33&w0/,$!9),6C),--6L+T60!S%n,$2e"
+        ")Y+y)i)y4*/f'I5R4m$H%_),69+`-2(y2`)J6H4|!!/n,@,$6E#72D(y2p4c-X)!4<#$/_);'2(8#/+^#m/d%+--3a0F7p+!!g!8--5K*k4J4S4~5H!!4S+J"
+        "#l.=.=+^&&){0A#(2>7F3z0A.f6E)l'D%_)Q-%%0)Q6d5Z6},q+^(46#3g7c654U2F5A0H5!6O$@0h4h!!7o4A'r2F#4'34<3g3g8F(G/}(V8:7|#(,)/(5="
+        "/Q%a(U4-4p4-04)H$,!@)g*L+`){0i+6'r0;045K)Q2f)O!))!7F72697P)H#c60)O!!6/!!)Y4E-u6n!!$,!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!6B%w*F03"
+        "2I5F(H4u7X1u2I5F)E#/6c-8'@$7$7800O/c2h2h0b#$6@$j&$3:$'%|0b+n%|6^+n6.#%1}(3)s'T6(0D7t)G)b&{(%$M#l+|8F8#!<4s%95!8#)k+`)z/t"
+        "'36C6E-q5:)u)u4c,~6E6B7o587I(y&c+P6H/|/I0I({'z$'$'6D6I6,-A)u056>5>5M'@)u5F(|2o&+2g)E-z)J){2f,w(y,h,E8J1N5|6/'426-l'B3a6b"
+        "%$7b0>7r(,'B,E+}6E*&+Q,e6c7j2h2h&`$=6b+$6b6q(|045:)k3=3W'_'_6+5W6+046+)F4J4x*B%2)Y(D6E#l(e-b6A5O)i4@+o5O)i6@0R#(6_5Z%;+h"
+        "&E-(1313)F)F4x6E2[13+P%w74)f0.$6!<7W)d)b#!18$j')1w,H#!#A8L2h3d7X'55H5H4c(p4E150='D'Q#(%7,&6D#w#p1k#p6C-c-+15&i#w640>7w/e"
+        "515:)R)M69&{#A154x&y%^&n7t05/V6b%k&A5;6E5_*B6B)F!+5:)H'3&c5l)g/c%;'23u7w6[)B)86c%#6q1w4~$K#y6)5K2F#o,H#A6&5`4~8$755I.p#("
+        "'p.<.=5Z!J5t,$7|2Z0g$g!a2h)J/c6E3=6D7j%f(F,i%<8$#/0g!h7Z$f5!%^8$8p6_644,7S(V!i4d2Q6b6E'38q'k.]4E.<5H0h6V4j0=2i*1!Q/V)6(X"
+        "+J5N'R63!D&d-M)J&`#%)F(b)A(.0m44)[$g6E2g5c2Z4c*;7p'<+96C$-*o('+`6G2h-37~5t6_!-,@-[&^,H&'#c$+6&'f7y6B1M%&5D3=%7,S3h)[7e#N"
+        "0I*u#f.].e)f5:(u)p$(7h8q$70R,S)y2r4A2^4[#(-u5R!n4Z6c5A$v&I0c5r(**k5:*-6E'4+m8[0K+`6X)=)l0A1x/U3K'35=+_'4/|!S6b045D5`5l6c"
+        "%a#y$67r6/+d+`+93:)Q5l'4)C){5U/@)R!s$=&t&~6+!/!Y6d5]!h({#o7o#%)v68%#+d4t+9#A8R'T(!!Y412o2o-+%G3o*&$U5e/_3u(w6D034-'E)l)b"
+        "3T#r)`&n7p*^*#8O){0A.;,H8E5.,N3@+Z)=&$8M!_5:){-q#8)Q7N6<7p290W.]6L$&0>6/1X7w$[)L)H4~6c#%1i4+4|/h60&{3u51&K5X#{2b*;%a8q#`"
+        "4@!Y5Z)1697S$76-6])R5s7F$d'5!f7r8Q-8)F6D5Z6$#6&3#N7e/64I4I!Y6v,8)`4~&y#p(,3G7r3M5C'56i1D+`.q6s)V,d!O%c3t(S)`5=2D0A*&#A$="
+        "1w!Y5U6X683q3_64&c#%)J%66}3u'r!z$<.~#;+T$}6V7,8Q!a3B!:$K6c7N8Z2F$Q)l$.28(I7U0W60%a5Z,8!Y/p)f+j,@,l0=5H3q6M&'835P2D0I)p4Z"
+        "8k0/5=+I#q('+r03$&#k4~)E#')8$L4;%<)[)v21&y5K)y&K)Y)R4E+~#('s5H3M5K)T-H6@)g)M0K/f&{7|!+1s6C*-.e#k6E%B)k5v*u)Q$=%9)[286}#>"
+        "!z!.1M3j$6#f+>.<)f0A--5:.Z0^.<#p+y+T,S*~!T6d!p7$7r3=6[(Q0Z$$+`4&4~,4$<#k1$2o)8+`,M7$.~3u6/+S-|&^5;6r7!6g5g$07^5g5H('&;*L"
+        "&;-84Q#p&^&;&^)d4Q3=6/6/2g!!%A0=&)&v,v2Z&)!!)i+_)21O4x..0m+n6b!<'f,+5=(J+>'i4/(!5e#!04){%e8J&v64)O2m)H6E)H#l)n,x0}..6g,w"
+        "'G0}#N)n#N6}'w)p,x7|,x'n5s-8-41D6H5Y*;**.e6C-22h(!--7v){6f-L*f+|'55Y-4#!&$3l'G&|#!(|$0*&(|+!6>+Y/G'3-H&'5J+y0;)O)l3E-$4O"
+        "03's8B3@)l+m0Z%h,$&''E)Q6G$q!)+`$R-M8B$}3:&D)g+}+}.Z5=&/)G&h&h&h&~)x$<7j&{-c7q'3&{/}&{*6)1*6'B%[/}0@5g*u4N!7$:)E%B(G(G7-"
+        "%D%h%D1515$O&v0P6E)E*90A%'$;5&)E%;5c)$4s*&+^6n+y,)72'G$R'3$:0j%h2A-H,$7t/G!v)`)`/O+`2A!v#l)k'u'a%G$R+$*h&F&`7r2t0o26$g*L"
+        ")`(/$g(/*6&F)H4-)k,8,N726f%-5{*N+40>26$R'w)R%-+^4*&t0)#l04$R8M'G4r#')E&C0X2D&.)R)H#'6-){)@2c)Q&D&358'w'52c)R'Q%0*6$R$J#l"
+        "4T,@+^/`2A/m*c)['u0H*&)$7F8F+h){/c,)(/)[(/)R)R3s)@)H)R6E)R7r#k)Q-V+^8#+`6+0o!J'f)J5;,i+y)g*X5X7q&'8$.p)`0h2N6E7~-X+`)g+I"
+        "+I*#*e634h5U-[*|)`+y(V2h*L)g'O#(-H$.+D6X6X-8*L6#*#0X,@#/-.$.+R*7-8&'5t5t*95;6E6#5+2c+I-c,@/p2h)E0S)W#t0o5P6E*&&g)}4E){%9"
+        "5X,i6#6#,T+`#|1$0o!Q2L6q)s!T'k5;6q5%5g'@'@!Q$i6E5g/^)x3y'R0/&K/O'3'f%0)v'f!h)$!X.#2i&l)v6C6u)W*B)W*|(y5D0g&h(.0P7'*|&s(y"
+        "6c(.+')8%9(/+h+h3Q&/)v*&5A/e0g6B*I6/!m.=0g2f6&0=.C1n8Z2`5:)8!J2h5A4u)!5X4u!V8Z8E5X%9,i-u%9)F#(2|#++!!n#.7S*1,=6^,>5='x51"
+        "5Z)`)`5!!30^7o,w6J4|2N)F0t,D$-*!5Z5t)f0t5;)F&K0W5=1u#q4~&K4>+`7a(H+`6*6(602S%`7H/J6)0P6)7r#N/J4++^2S(w4>8d%-&t6g#N6g5M6/"
+        "+`*&29%c$;)v)f!8(.603:+`#q+>+`6.6/6g3:'f+|1H0j0j&_+T&.5K801u#;#;#;#;!+%76_#`)F6^3&&i2j'}!=&b1i2h2o8F0i2m!n5t5D/G3G)F5!3G"
+        "%n1_$j*e'r){,&'w%D*f7q)]7^!<%w*K3j$.2g6_0c0&6@(S3:3q$-+P%h)E+s(o-A5q,q$+'T5v678L(V)F%k%(4E-L(w+`4P5P7F5F6>,S6(,e/6)@6B**"
+        "$7+~4^6H&t!h0U0U)b#/'/!A&=&v&I(G4>*X3205(p7o6I5959#v-m5~5=$T&)5&(v(o59'O6,*-,S&K'R-#%405$'59'O'2)](o$-2`-m4^'46E%4/6+`!Z"
+        "6g(65(0C58&K2e*!/Z5&.*,],&0|6[%`7y2h7|4<5A6E06/}8L'p$d5!5s(U.!'7/S6E5R2Z(y-N%00j)z(G6u4c&C0+/O!v'362(V6w(V(A)v6X'5%/7|4j"
+        "*/'p*/8r#/,3&$.Z3h3:5K)C06&`&K('7I5A6C+x8J-A-17q69)E7|'Q2r7#5U(A)5*o))3y5I&K5x5l(660+J6B!(/y2]4E(o5g&C4l(;6z6_%p/B5O!(']"
+        "*|6*%05R!i)8.A(~5f*u&E&v)H.e-Z6Q(S6g,50+,q'Q/0$+2N+]-l8Z(V*h5R5K+I#'7a7F+o!<-A+y3T'3#.(F(e'c35'S6_60'p'r!Z(G3_$Z6E!()K4N"
+        "5I4t+`5=3t8q0c#y597/6*&)05%_0U,d-X'i&+0j+I+n3a7/).+G26)E8[5.&})g({062m4}2t#r&^+`0F!/726Q.C6a41+;295=4f(y!)7Z.k*U8F8F2F%a"
+        "(e+|!'#85M4^5:5'%#29'r05053y%<%<6@8L!h%#$H(V6*057a&q+n5I/d29+7726L'x/97b2*83.R(6,L6.%^0m#l#'%z+C5U)y3t$.4+!.)s%<*/6W5!-u"
+        "2D6d7a+5)_(u(H%n7y#f4m/#6d6G6v67//-8(z6r$L)8).).5@(U)E+'7v4}295t)1&D.R5v+o6d1}$+0I60%9/[#;+^6Q7F4|-;6M/X#.+%5>6d)_,8*k7/"
+        "(|4+68(X!$5o0C2*6V3M(q5X!+3_,e#`(D*I%/1|#~1O3E4h)E/K580@2h'R8J)_+K5)4k3=$+(Q3c!!(A3a0S.R(U7p1s-f'S-k%m!(0C4D!i!8!8+h8d7`"
+        "-X3H3G3p%_03)]$0)Y*63q2A#G)J!)5U/p,8'7'r5R(y)8(6/65H72#p5q0%%I,e,d(z+V&.'73s6>!a6L1p)]-45U(~,h0|$H/^+I5U)E8##u+'8f5R3:(Q"
+        "'4+r0I5=$=#l%<(Z6&&J8k&g$+)57$$P$v%<6d4^#Z)]6<5=06(Q+h5q%X)56H0.*%0S6$.R,<3:6/6O%/7P//7|)g.e)85Z06&K7/6B2h)]6i!(6V*&*u6c"
+        "/X%G'8(n&=%>5]1p/c/e6G8f.Z%_+A3d)@1M(P5F6@&C/f$6)H)g(Q4-#p6#,z#14-,>)8#(6[.R6H(|,~(o7a+^,)(E-z5R-V60+`,=,3-V%<$$/x/e5P)C"
+        "-V5A&E*k6.#k6L1%%e+43g5R*&$b)+)C83.R5R#4+^#l#h+`6E,L-z6v3J5@7@)O6v8#+>.R-y+@,14})66G0c3=.U)Q)65`6G-t4T4T&A*B6f)p/h6q$i(z"
+        ")66g&I(7+,$i4D4O4},H(70v1@,$'s(73i(74O6_(76H)=006c(G6g,H0l6c0W(7$K4}6g0l*h006g6g6+4O4O4O4T,Y)86E),,C,C4P6+4P4A2c0/,@*u6("
+        "6}4}'Q6d58(,/e6C%M0=0=7h8F%B0;5F2A+!#q04.R-X)E)K7q7q!I6#6E0T-#**1D4_&l!_!_3n*;))8q*X!i)k%a)i)H*u%`)i)O3o+`!@5;&w8=0$!J3t"
+        "+)0g3p7o4d'B/}%f'x.;3j/c)n64')!:,@0b-b*K'n5~!=$,#|,$8$'5(y7r$U+3,4,4,=!:%7/O-J5c&')H(X,T$e$-+T'<6G(w&87^'3('68&E&E(.#a63"
+        "6H&c'n6g%n5X*U2H2l&K#%%f(p6(*o%3*1%B*6(L.#!/5b5K6i!L'2!@6E6J(I5t$U0S'c!(!c&m0t6X*-)J%a,g+F*!$'2A)d7a+y+y#/$'(~#/2f6#(6)n"
+        "6>.C%^6d#/6(0m3W/d0W4t){,I7j*^$2&$%73q!/#9$=!c*;7p&E6E7p6E/T)E8B042%){.;*h*L3t+).=)O&8)f'G6d&K/_'s4Q+Z&p6)0A+)!02Z&F.#4N"
+        "$'6G);!i+j(6%n83(w!S!S6b%^,v)_1W6@'d*98O6b)1&K6860!T$e-##q&04d6J&|7w)b)d(h'G$Y)Q/}+T5P)0+X&64r5v)H)F*u6M3d$'6X*63M3M2f-4"
+        "3f5+$'4O3t0t7v+`7v!O1p7*&8405;7m6#'R7h!+'f6.*;406g5$5Z,+(C+E#p/_!d$!,@,>/40A-#-X803(2p,9$,,n!p)l#N2r7r7X*<6V%f$#7p5A(60E"
+        ")g%a2F-c$}603f7A0>0D+m5!8=0H7A5q2D2D!=0/*u&&&h0t-X&=&=8i%a2c&F&F3o%[-a&w)13o%36@8$)R!:0D)E0H*U6E/d!i%f)T6>6V5|3o+@){))%B"
+        "1%0A6#5K5@(X!+6(%F(Q1W)g+T+!,=6.3o4~)),4,41_+`+|1%#k6#6.+S!@4r2h131y88882`6B,i*J8$88(z(z++6B(z5t++2m,r8i2m6B7q'r$=)W&|!Y"
+        "7K!n3T0v,$'5%-5F5j5Z.!5F+%5=4p6i,w3M&C&C6@0X4p'n'n06-/-/6H)B$#%2744/3l'2'}6762(K'N2e3x3l4J6/!h6C*m)J&D)$*~6r)J!<&R+h).%^"
+        "6//Q*#04-r&~5X&y%e0l+%8W).06*47F![6E)V3{7*!^5=)2&s%h6&!a%f!:2P5+(=!:5;!:)V+h&D6p)V2h&y)C!i,C&E/'.o%y-q0=)O3d)u.t#c(R5H&j"
+        ")G381M&q4z(p85'5,a%915'2)l6.(D5'7t/9&1)H*X7w67)g6q->'/$+6n85._60-m5]&w!h6b4e&{4u&m5:6d(,&1!=.:7z8F7Z%0-q6i4K5I7p&H-%-X03"
+        "!i2Z0P&H(V5s&c7j-G!J-b'2,$8L8L2g0}2A62,l)a'p3=5e4~8J){2A/w1568&')T2o)F'<5P)!)})Y'n+J)O)O6C.C7p)E)E5K(f('***m60-M+y/V&K6_"
+        "6.#c2Z6G2f(.0m8J3@4|(p4i,86+1))Y,C/|5K2N+_$'5Z,q'23_-#4~*L$b$b4A.F5c-u6b-m0).-)}2Z7r(G%a85&I/x4[5K-8596.5:!(6.6b3=6b4h+`"
+        "5I)x0i8=035I8F&$#o,@!*&H&H,8-7$j0+)y0%#8,$4t!r5R2p05)5&j501]3o&q&q)`4/.;0m)l):)i0=%f5e(|4r+9!i6G$5.$'5)l,H!0+>+)6H6+)x+`"
+        "%e5I(~)$6L#k2]4@%B695;-w$b)L4I5t6d4}%a1H-$%91X0R)5510>$Y-<'5)a&36C7w-#)1-7!-6L5v)_4|-%6i7j0b2h5Z4e+j,x0}3:/h5!4h$v(z!9)`"
+        "!S5q4I(,$;68/f5>6g6O1C1O$+,)-$/E!9,a'n+'0S)M2$7e6g)_1C-L6L)F3M.L5I3x/J+D.#!R!+/f/x6E/n6d+S5w,k6B7U*>6V.=+^%_(,6-)f80#p72"
+        "(F.3+K-V7`(|(|!:.30D,e/u'p5:0I4e7R-<5I5I-X+r+h)$(,%X7p5q6B)$5=+'1)5=60#k)Y-$&j&g5H6E)8)]'52h!i2D3W0D+i),5].L&&6E#;!+.F.Z"
+        ",a46$6)g$e6b/x1C1M-q6-3j6L0A.L6n6M-7!g,a2]5e.=&/,*6f+@603&,$)[.F+@0=6L3&)80m-3+^,C6.8!+@8N)`*&*&*`6s,a8M%&3Y'3!Y8J5U5`-/"
+        "3=3i!Q)H'p.o5|6_82(B,C3Y-~-A$j0=2p#>6(8J.<'28J+^5|#*1M-p.R.R6L,C-7.Z1D3d(.7L0^6c2l!-4N3C4s1J69(p6C)k8@-48#%B(p8O(!7|%z4t"
+        "6C!S2f2f$22]*L5v2h6_).6C462g5K'f$'0w'f5R6|7I!S(D605R)J2]$!1C)2-4*f*w!z3M#87$)H6f)H6H-4*f0W(X7e)R'5.Z#%),-%0T(G6d2f.Z)g.Z"
+        "7r6c!S*w.Z0T-X#a){'w0T(y5;+r2f.Z7N2]4~5Y*w)8+r*-),6E6C!S0R$2!S&{%(&;3=6$%F,T&;2m0&&{80'22S*L)T)T805!8i6$2r&;%F5T)`2M&_&_"
+        "&_'9)O2o$!2I2I-V'8#p+t5J5J+-6]4w6]+t+t68,q4w4w4w':68&F+'7v)v'B'r'B4Y'B'B2e6I$-*D.;)f4~.M)y/f#[5A!f)x)b400g4-)b58%j2e2g/}"
+        ")E5Z7g5Z.;7R5=4~,m&H,:/}4-&t2q5Z4O,S,S5@#[,S){5Z){*%+r*&2q5A#|4_.=2A4h5H+`&K)8)8,36E05155;(I2Z6c$:3W05156n!I69!36)5;)`&K"
+        ")F0=&w4s04#V0>04#c)b0g'I5K!:+>%F!<8q8q64){'G*K'm5|0$+`450g6.'35o)L,%4d/d!:%7+!6n0g(|0'-G!045,$$,/}&$(I+$5o,w4E5|6E!n(V!<"
+        ",O&K'56$%n,@&T&^'<0l&'6C-b2f!-4}),7r-4+_)H4E4}6_0:5D+_68)]7j,C)Y&I&I6d5X#,0K0v&{&{.!+_6]5K1C%F2Z$'4O'c*-'O5D6H6c+F*<+I+9"
+        "5J0t*^$1$13g+|)$)x+904-G+)+)8Z's$}6)6)'I,H,H+X*&&C7j(66H&$(G7j4~5S/d6-3@)`!a8Z*h&$7R's6H8J74)16b4o63&{0c634+6D7r2h6|69&K"
+        "8$*9,T6/-$(G)E)E).4@2c-#0A5;6b8O+>*K6.6.4~8O#a3W1C*I0R6b04,94O&85=5+#A%B1C)`*6,)5;3@0H8J4}!a%c%+0@6X.R%+)G2f1i3B8O)W+r*>"
+        "#l%n#U%y4N,97X7R7R!8#G0g0C$}8f%F%F5>6d/V,35P#[#'0R)Y6-+I7S+|+r+r)d%[&F8i)](/68)Y68*&7P6E5|.!6@6@6C.R5J)F5Z*K5=%a!:8f4|6C"
+        "1C%F,%)`6c6n6I1P)`+`(,,3,3%c1C5=)y#k6N+$6.4|.!0m#v$y,C%c%c.R6.6.6/+%6/$J*u$J7y)0)i6$#u#u+y'f8p0J){'h){580202#c0c0c)G6D3="
+        "!<7o7Z5P6C)f6&*#!<6&)d'36u!i2h#/%w2|&g.R2e&v/<7q5=(|%<4}7X3u%7-X/V/<49#'+h7r7{#(7r%a-X6E6E/}0;*!1M2|%77m3.0K7e2e0w5>!L%7"
+        "(,$6/}7X1x4r%74}#p290472(7,x&0(u7m5q-44}51'36E!L/}%n'f/E)23x-4)M4&)57t2A,n-c!p(772-c!L7X)k#l'37r(y&g$P!i!i7W-40H#j&w--!L"
+        "$6-D$;)`5J+>'E/}.A)O#%#%5e'E67).6_6[)G()/e4>74()85-V0Z!i0S&A$P(.6*!E)b5t,=5:85*k6L%`/O%f6(->'a$g'44E/J&t5N6D7r447r5l&18q"
+        "5R4O(.*k,q4@6^#,#%$(+9!i)F!-2r*>6V4e3@2r0Y6d6c->3E#N5M&t)v&K(,,+29+h+D3E7r#/0Y)v)v)f!8+1,86J+t%7,@6E$;#k4O3:5]->#q5:&t()"
+        "*k*u!i0D5Z+}+}+r,=)H6N5H4>6V+^4>6I6$6.4@%_/A)R)6-q)6'h.C*4!n6E06.g&y)z6/6E7*!i6E6B&`1u2h&`2h2h'f%k6I(|'3(p584Y$,)W!@2]%a"
+        "7U*&3x'4%`-25I(z#t.p)l7g6C-30l4r2K1i5v)l%h7U)W0D/_%<0D!i!i2S%<)Q'n'Q&b!i*c)Q!x5R%<(6)W(p-2(64r*&)H)H(,%>,@,@4V)87r)8)86C"
+        "6C6C6C6k6k2A5c5%4E60606d$+#8!p%h!z/_6X/m7U6N$+$.8F4e)F&n7t6E4x#|!h%^,$'34y7j$t4y)l%75=6&(b63)',T(w4y$(7r5r)l4O$j7s+9$j%J"
+        "/@5@&$)H#p7r$j7y+96d5Z)b)R2h)L!n)1'56$4~/J684|5=7j/p4+%J7j7q!v%J$0#|)[)8)[)5-#,55M!T0h5]5a!i6E+P13%D%z'>)H1413#m3p4#4#'B"
+        "062h%'7r4z,q5=&g6L41-G5&7t$05;)F5:5A)K6[4u$i3@*u6d!n7r04%#$!3l4_0>.C);5g.a*}5H5]*>(y*7&y)'3l3B5:/7#r$R){6E!S#t-G/S8q7=65"
+        "){!J.q.!7j/<#/49(|(|){%0+h3:$6%a%76C4N6]'2)F/^5e6i.;'}'35A!i6[0P5y$i#$)25t$=!i2r5=3n6X8Q&;-Y7q6E2h.36$2h5A+J(f*|-[7q5X+j"
+        "44)2%n(S*`(.(f5=)[2r3:(y0b65)8)6$.)K6C5g'}+~)58M5t$-2I/((c&R*L&'40'f0l5=0;6n/^*U%J)8&K5V4G6-*6#N.#6s,q6X6X6f/c++0H6n6d4O"
+        ")b5=7a+~4-(I(S0P4-#/6E0A)75=!Y,l6B(e3B0l$(+$5;5;6[+^+o).$i6E6n+`.U.#&K0t5w0=5;-H$j&s!V%J%##r-*+`)H(%(%5e%G03*^41,H5=*;(3"
+        ".=0X$6&=(87P)i4t6f)d)H+>6d)C(V0m3o4-4-.R4y$b(y):5=#q5]4})8&K3a8Q)O6X%f){#=$'%J!Y0P#<%<(%&F.#6s5O8=%n)1$[0^1/5b#N!m-H8O4+"
+        "0J$6!Y5v4|'R0=4~6d6b!i5v).-H!i6E-86X*7%B6G&K$!,x0;*L6b!+0P6//#'D6s8Q1p+Z&y6L+'+'0t'f6q3M3M04683B)3)F'r){$R.=5X*67l6X#H6&"
+        "2^#(*76i5A)=6X64+`2!3x6G$e5t0A3l)06s2^-M'j2S$j/m-c-c(7$.#=#<#<$}-H4#7U4G!:3(,n(%0t7/)v)8*6+h/73B0S6J,T2F5!4T,l0=2S6V0Z*>"
+        "%a7p,8*#03036d/}+r$l6[$07r4G$&060g/_!Y!u0^)Y7A$.+h/}+')80I$'6J6J5@5=%<3o&F&;&;3M*&#N5R&g&y+I+K$0(F065I-H)k+s5:#=*&$v5K3p"
+        "2a/c6E$=5H.!%<3p)k3@(I)[5!5v&&0S0S){#H*U5Z6L!:,x6E+}2**-)'-*+@!++}6-+15F$.6c6J%4-.!+--&;04-W+>-*$67r/#/#6-64#(7r+!*~6^'2"
+        ",)-D$')9#m-.+@)'5w1&#m)H){)+2S6E+j-v-23u*&'J'J88'Q6n5;)O5q2r1C5A$'50)b'Q)O0C)C0C7S&'03)K%n77)K)G7o*9)F+%'@%Z7S0C'Q)Q)`6d"
+        ")Q6/,@(y7S5A5A$_%70h(|(|(|&K2h4-,w(|+`&m3a!m%f)n2H6C6D2D(|&q6/2l2n#77F0c+P0.!<%117&i1O6}4c7X%j*@6a*h'D2Z#`4c'r*f5;%V0=7p"
+        "15+1-(2$63.a!J#{1*5=0>!G)K6b'3!:5=/c7q7r&K%V7]$')H6/*}!n#t)x5&(z6n*&!>0U%;7l6r4s.)6E2o8&0*4J&+*B7a0*'4/N!=!9724T*c,G0E6t"
+        "(|!T#$7q/^-u#//c3j697g7F62!T(U.<6@%`$./c)J-W-%#~6($50g-H$=)J'37H8#%9#e-b.@+3'4/N!J/>+{-k'|0>){3g!=4c4c!9)x8E/G7Z!E!E%`.<"
+        "){+1,4)Q096V+>.Z#'720=(a+12h)`7l.V'h'h0m2~%&6u*F6C5X#N)5/w8+2f-k!B$,'x7r+1&E&E7q0P!0.g7h'R)]*p&'-k44+y7F,S%n4h*&+x)z7r,C"
+        "6+5.3g5X.!%A)[7j)G)55I6c!(4c.~%-#('c4,7h$'1k1k*X-$.g)x/_)Q6E4A2A1R4t5X#`&|)[5:*-)v4F++)C4O8E0*,S!<(I2K.O)}742r6=*&#.4s#/"
+        "8l6@7K,S3E4c+H3[!L)Q).%F4~4u0S/`2R+y-G-('4!D){%E50!)*!6n8Q#~$U)`4N!_-m.B1g8o51035H$'%c2$,G0Z'G&C2m%k0*%`7W)=)G3x0804/@2o"
+        "0=,$6<6+*&7j+n'x6E)C2D7l,Y#83q#|#!)_4-*a4X6/%-7y)x420>*V!B/:)_,>'z-O)`7r%;-0#>2!(%/a6i/#)Q7j)s)Q6b6.+%-v(o1H/f4|1p8W5v-<"
+        "4+.O#`2h8Q7h6B6$6W!k63).6/7$!/5q6+51*J$E)F4-+4+6$!*4)s)s4O)_)5'_$35R%n5W6g0>6=#`7F!V684|!e+@5'0U#j'Q,98Q'_)['n0U1C0t$5$E"
+        "7R3[3Y#($=1C!O%*2!*I68%F7o.q+3)O3E0d'N5J381|)g-D&K$U/#2A3g7H3t/E!G%/+`3x(z7r4h)!0=5'0E407e&K5X/#0m#a7I'R5:&U2S*@2S2o!D68"
+        "!}3E3n1n#l3_)s$0$O'z#$&|2y%a063E7K+i$&$+(%,@,O,98Q'@(|7F$Q3v)$$}-p-V)T(,6N7p!87r.R,n#m*c$:2S4T)[-U-V7a#>*X!p)W68'n0=+t)E"
+        "6L*%/r/r+H&=5K1W(/7$6E5I$&$&1k.!(r3:(I(*%/8k.B+}7l)588)[)G#F%;%;#|#'#{*%'4+q!_'40K#'%*8F834~0.0U&=.B)!5X,<)[$x3g(I0K5.)Q"
+        "'D6V+S-{,>2D8F720.$b)E%A2*#F0X0X).)_0S*t%95X*//e!B!:){6@&K-,3G-2)G3j8F%F5d+@#1)z6=1N6@6@.<51)`!}.Z'Q7r7r+1-V)R5X+y3n!D3G"
+        ",>,Y1*4*/D64+U#12o7$.B5J*-)@+`+6)-6M,=,40=0=7$0=+>5H6L-#1%#j5+$x5X2S,M*--2$+7$,C3n8b+`%c4h%A)[*&+@+`-{7o(/(.036$0.0.2j*F"
+        "6['>6D'f'B!G&o7m0'%c*f-H5;'s(V#N5U-3$='R%_5t)]-H$!)v2Z&D6c$.!8!E5t)]&D+i.R!i#q%e&C6E'D1x*K60&=)E4K5U&C)[)l635D-H2r!)0H!)"
+        "7l%_7h'22r+r0g5j6D)[2D)[8F6E+i!i+^5U5U5%5|04047K!z*&7K+D&s!G!G+>6c+>4~&,2`+t)L(z5X)L6c7e)]5146&,)d$.6H'40C7R0h8F7R&6%-3:"
+        "5]8F8F0S+|8F$=&68#&l#l(L6b2e/V6]-%/J047P,v,S/V/c,)'2&n5w)i)i.<8Z7^6D,)2K)R6b6D047r&g/m&g7P*u3W6b59)H)H)H)C1@%<)v7q7.5X44"
+        "6$5t'7+4'E(I3j%a5q#l2f+!632f4z-G-G4^$Y5:6q!Y!374!I)`+)2`(|&n(S(/#o5v-L):&v0T(y6E5=5]6.74&n3o2^){637$#$5b6O5y0'7g,$$Y(S-%"
+        "8o-X!n5t):7Z8R2h2h6d&t%n,w.=#q5$&$!*#$!37|,35J+!46#u2f)2)25x+%5q)[)g7r)g2H4E(q60'<5O2>5T6@6p)5(G(I*-4t5K+)7|5=$'2c#,7a7a"
+        "5;4t)8(S$!4t418F8g7{00)k5=2C.<5=0X05)i(.7l6E7r!04t+|+o#o4y5T7%&q5v'd6C5D6p)55s-H+%6<6O2q4~2q0X,x-u)Q.u!063$Y683a00-L)[*6"
+        "'N5+#r06(S60+`!+)H)H-*7%5Z(S-c-X$i.=7U)8!T(I5w$K+r5H3p)k/r+|4^5@6E)H)3%76@6@+`3o4E5T&t2]7^(S6E5O5b2Z)[!T)l60!+6@1M2q--6#"
+        "6:01+`$!+!%n+s60)C,=5=1C,3-{,N,C2>3u6/8!6k6k0g6@'d6@(y(V2o#G#G2`,n#Z#[4-8g#=5t)86I0P&v/d6n6^1X/_&w'3,$&s0h4-/(46387h+E+E"
+        "8d-L)04z4^#u)E036L8O4z4E+E+I--,3-c%Z5!-X!^7G2r2r-c7~13!<00&E&E%D+`(.)E)s!h5n$'$g261O6v0m0=6b'B58#`2A6$&h5;8L+_5e#7%%15!p"
+        "4c%a7X,q$.6E'@'f&1+^052r'G45)X-74u+9)u,q63,d-=3=6g(L&t!V)`&$'N695H$<$Y/:2o)$5]$78$$73@!I3@)F51)g'n)E,v/d!i4y!5&l&w6E'3-u"
+        "5=(|6(&+5^7g67+|1_&J-#7^(87o$i6s8h2`2o7.%a+`,=)Q$'3@0C&{7P5R5H*h/}3j5@7q'|5R)M)J'm!Q-X6E6@6@2h.R!h&F6C,$#$.<+3(V!J&h7t%7"
+        "$e64'2!D-]'B030}1H,x2L3@7c5D6_2Z(/4f7I-u.Z6X%`7r7F#a%<'p#/)v!7'3)Q!<&F*I-r8$!i,*#f2A3=$=/S2h'|7F69$&)v2h7o,*-#+`1C7I7.!p"
+        "7S7r,3&',=2`+`+>6X2r6$2~067e03+`6C5N7h+`2*'u*9![145U!D14#%8J$66E$g5s7~)R8g&^&_6^&c'h*F+J7P+y6G65(V'[6E2h'R6z,C'3)`(f(/3y"
+        "('4}*|1M!0!-*#6C8E*h7r0^4E1z1z),)y)v5~&F8=6b7$!!6L)`,*7S6(1)7e%B030I)$(/)V856$3_267e!V4>+1)l0(!_'31]4F*&5=+D,*&{035&**'D"
+        "3M+m0c4A6^-#!L,5/^85%a5v4O7/!7's!i%_(G8L7o15!Y'c)Q).4t.~)J45)H5R,S);2K#V&w3@-/59+^+^&,0T6N3_)x4*5Z++8F2o#j&j4~)l+^!z5F')"
+        "3y7r+9+h)Q8E,$+^06#$,H$i0A-70404#9(4#k%J&s/@!O!O):8O$'7.)F+`/_6d6d's*-&'3t'G4y%a%-&h$&7S056f6/6d0l6E2,14$U+X038E'3*I+98T"
+        "8T7^(!&v&w2Z0X.;4t(8,@(Q)_6D$6)z)y$'8o+m0C7p$U6()x!V)Y8F8J!z/_%z$<#o-'(~)Q(,5A&/0A%G(/%e,M7o0p-N'4'a/a2D6C4e2,&E6<'54~4|"
+        "&6)L8O)O6C2^5>606/$K)O$Y6c(V7F51/i!f67)C5q1i63+66.!^)5+%)b+%3:&{5W4e7r)R-c,x$<(|(z+j+X4@-u6b6]-#3B5y5y647e/i6@)F)`6@$<&A"
+        "6b8W4|-#4-)F)`*60b6M1I)1,8+P0m5M/y2g'@3o+@5$6b$$,R)z2[$>!f5Z)L6E7R'3/#-4+D1C'r)R)z3d697e!N266g8L-L3M)M68)`)3'E&s7I0>,d3["
+        "6g5Z1C2f7o$}5$4@,)1C3t0t7K3:2c3g*I5='r03'N'N3Y/E3x'R$Y%c.l)F38'n$U0C#a0@)'-#5t'J'L8E4d0I65%c)L*;8g%F,3!z7~1z5>)E+h)86V0A"
+        "(8'@'@4T)$032,$}/_6^(z)V(|).(/.R6E'L*>(,(,#G,n)f%_85+P+E$!$i+^5l0X3(&h4D(%723M+T,>+m-4,8#u3M*I$:3t!p,@)s7c7F2o7U,l-V.L65"
+        "45/_8$265=0m(f)O$i)E6-0D5}6L&`6$7p0I8d$j002r)$+'7e8i6n2D5=$Y%f&c'D-V5:0H1)+~,)0I5K1d&h7R4d+J6q33&=$&3t--)y$'3M*&*&%f)8)E"
+        "/!5P4e.[1^7~4E7A&w0^0}(f0>'p,*+K'L$;5@2c8L1y)F&))i,>)S$>6g3g2o)T3o+}.e6I5>)82A8g5w$&'E)y8g6E0S006.+S&{)7%B)H3W#*/}$'$<8&"
+        "(/)F)a)L0X7L)Q0D%G6D!r3@2P+}+`#a--6H3y3j-7044T!z)C)H0=.<.Z6B'N*;6J.l0Y6/04-47^(/$Y)E+%0%%[$;'R-76[7r)20=+T+S1n,>+`$y,T-D"
+        ")8/4,R7r'L&/6g+`&t8F3G+h)W$;0Z7~,=6.+`7~$$)`&K3J)'.R6d,3+;)^5J(,)z5R,$6L)O6I6]6M5M.e#(#k+>)z3&2S4}$j0m0h#B)v6d,M+`$y,C%A"
+        "*&6.+@+>8!+S+_!@-z6d,$(+0A$g)+5]6b6E0=/45q#t$=06*76E*&5A5t(U6d+'+D*y385=!(6B03$@$-0R*y*;*y*;$L29'u6G5]5W6b0A5R6@'Q583q)g"
+        "/4(y4-)+5q/X5@5U$@2S2D(F$=6E&K6b$b)+7q7m$f#/5:04#/#/4m){0>$,2*$-2*7v3W3W+`726b+`(,%6&K3<)O7a-X-X67-X$t62412`%72F5t6&2o#<"
+        "*&/o0;0c3M0X6r+j6E'/7p6@#<):%9)F%n7e6r5$$8!}4-)g2F6H%h)v)8${6E%9&1)T+j!}&/)O)O2o/4&68$6G0Z6E260K*J5S6&%f)7)7'r0H)E6E/4)7"
+        "&66B5R59(%-b-$-$!*)a&/6d!h!i!i/d/d!i#k,v(Q#8/d+x)J7P1p-c4f6$&_1C5J)y-a(Q0c&,263p/T)y&C%#!f1u1u,x1p2o2o4f(V)R3g1u,R-a,v4E"
+        "1D#q00,A7P2%7P--,>0h%n2h%^-G*&,q06/r-q06%D5H$J&v63..!~'32Z&$0W066G5=(D64!-6+*L0W6+&$%<,T0X646p6p3-3/7l#!6X%B3-+P.=4`&h(."
+        "4>7o0c!z74-8$x)8%h(I#c8F$M4s&j%25=4c,q0c062D/z(I0=58586&3=1N'h)T$,584R)u3s7o7q0=-4'r4w)k)k1_**(p3l0n)F!n!n'E5'7t&l5g*&({"
+        ".`06&w5t5t0U6C516q6g(N6/2]$!%<6]&A(|)C03-c/(-#%0-8-4$0/I!h267q/V/G8<6u'k,)-#72&{/4+`,H#A&{4}(|-X-%2r)z6v4c4d4d(V+`-36C&b"
+        "&t6]407r7]'p7P6.3:+!)p)x5Z0c6E)J7t0m0$)8-4![728!+P6['p(p'B&d,w3=(y/}$f&j7o3M.]$&,$/Q#'063=.;)y1n8$2`+U5y*&'3/G-H3l62)G6X"
+        "(%!d5|,3,=%<,O5Z0$72)i6H/E)`6@)5)66}$'6G4}(w)R63+y3=)H&^5c'31m2*7q6J595@*F7~)W,O,O!0&'4--[+U6B-30m)d0'4~5S5Z(p5t3M*|3y0P"
+        "){&_7y1O/}6$5g7r('),-L)A4h0;/B580g,)6E)J)l0@)T)Y7e2e8F#N&c)8)H,)#l);({.e6$)g+y0c4~7c*-(G!L,q8F6]5=#(&,).(p6E006N+@(S+F(H"
+        "+_'a'359+j$Z&|6E6d4E+I(C)g)J$0)p-$3T$&/V5K2^4O+,/|.R(I)i5R2S.B4N6X5U5I4A&I3M4^)}#V4-+`3.3=+U3.3x&/+K+9+h4}5.6q).%_(e1d)R"
+        "7W2*'3(%5e2m3$6)$b7X6@*^51(G4c&$(V5.)x2S+m):3g8E%f0P%J*#8J5=5S04'r(86-+|3u7y/`(S#o2o03&l7p,@.$)y3y$j+U7c/}&r3@41/f%<6d.;"
+        "6a,@'E-4)l,$,H6H%#0h)'6d.B2Z!p$Z(y6f+9)=0W6-0@4/-=7q6I#(!_6f5'1i&q0W6f*K)H2S6f2*,@8M&/6B)R-8/B5=6b6f2]2^1H).8#)Q.u6b0c4@"
+        "0h&1&h7F#(515.%a4|5$1M5Z#N5!(V'I6/(p5y-3*K,v6L6/6](o-=2b-$6z);-r(.$.&K/B-#+j0606-#40$q4}#;4S-8)8-X5q)F/Y)O)Q(z&~5M6E6J7S"
+        "2f)_$&)13q6b!i-H2e4N2`6X)y&'4V)[)[0c6-3s,3)C6g-v!J6^0m85+o#k5I$Z.R8J4r2e,m6M+6+'&|)R5t,84}'@#'6M0$)g603t6g3a6g+h69--8B$'"
+        "*L3l3f4h,('k2!-L7I2f6E,J,c004|+`6z5;5=5$0C722e3M!)0S3E6q5o6G1C)=3M3b.=3d2e1O!(/G$=$;/I5)#A-D'R%c(S)35A8J%_7r5c'4)`)!'Q8L"
+        "3x4&3T!i)])8(36H'L,37r602S,m6M$Z,T+A,C68!z3n6d5n(|!i!p7r)W*f2^2F%^-4!8,>({(y6[#l&j6V(3,m0Y6b/p)H6)#u035@)H,@,8,3)f(7$j,:"
+        "7p'@0D+^6/#G)]$i$Z4T/44&6>5>-43t-X2F(I+h+@4h$,'B&|5w6B,n8M,r*>,O/^2r7W7U885t).)B)R6-3(+r%!4+65)T$j6N(p5n2r(%6M5R8S+)5t+j"
+        "7r4}/f6d)]0$%B)8)`5:/:)F/D4}3M0>0>5=,@5A6&&A)1-H1d3M+J7e$j6E7c4r2D3o#u6$+'6<2N4O7~1m(Z!i2A#k#k2q4E0.+|4}2*2*$')p$')$)Y+K"
+        "#|'D%%(r3:2r/^(G6q,+(r'3(S(V5I)R2A5A6e,>+>.]6b+}-87.%>).725Z6d+_2h5|,$4u8J6V)8#>+j%f6@!:),7e#k,n%;%<6E3W/f){3g0S)E8F+h.e"
+        "(6)g&w2*)F3T)8$<3g3@%y2*8#+;!z+h-32e2r-4.]6M6M--)g04!i)H(Q1M%#513x6I6I&;$e)C0Z+A*-!*0/8F4}!z'r0>6M!z+1&t#A,~)R4~,O7%,T+`"
+        "6[65,>3=7r6M&/4y)55Z/E2]!p#k-X,))O012*$''r!z)C5K,=0U(I6M1C+`)l5R6M3V4~5Z)'5~7~,3+;&;&h(z+;2o,'6M-2)H+j)R6M&y+|6E)O6n#k%7"
+        "1$)Q+>&h3)6f8F&{2S+T+>$j0h6V0>&d(%*&60(S6M1m7%,C60+^-32D3n%A)[#l6M(S!@8!+@+>-{4r,C6$5J60'E606d)B!p-D('%X)55R5R)5(o,$7/83"
+        ")u7I5Z$.8F6z6z#>63067t&w.a)p5%0.6E,=$T/c*7/G6.*7/L-c#v+t(/*B&A('5]7r('('4~0F!o%05D7j8!*K7^'3!=5Z5Z,&8E5y){3q/Q)p/O3j3j#$"
+        "644D2C8$7I%e5!2f+j$.)27y(y38+A4>)[5t(f0n+y).635l5l5J6H587y682h4|4E-D6z*7(o+K5D8!5x7j0'6-)6('#|)5*F){&h2K6@)8!!3v)g10+y5="
+        "'3)p5Z004>8F4A4s(C/^+E605t&{$.1C(z5=2o(X6#*k)}5R5=6-(I88*-%a5Z)F5;6-,S(G60).-*)y%G!Y&w+~+))=4^5=%#59(o#v'451)Y$i&~/}0^1i"
+        "5=0^5`#t60606E*&6d'J0|/d5j'J2`#r2K5i.B'a5#$!(X+&7v&65C)5&~+j5v5b)1)[)O!i6L8#4~4S2C5=.u.u#k6-)p)p6d-%265!7G)g0^1H-#).5t7^"
+        "4|&h0c3W63+y8#)_7/'u!Q(z6p-v2h+p!k'n4[3t#v2A&R#()25X5A5;5=6s(V(X5=6q5h-p2C0^6:6#-4+h6M5:1C'f600F,(5=!i!p$i,@)O2p6E,8/_3T"
+        "6E4%*&8O6s(|6C7r!85!,*(I/410)p,n+)2F${7A)O5=5=5=6E5U$.)1#l6@3o0|606$0H*-%X&A2Z)Y&w3:+r6d+|4E2K&w&h606$+A-$3v6E)p-*)m)[6M"
+        "6d6E5|+>3l7/#>3W5=0t8Q+h)78!5Z,$4|6E5X7^)8%0.e+>1M5J(X6#)g$6%G6:(X+A!p1C+`-X!T1i,T+6!76#+!38+r+`,=*&+s605=5Z,36@#;1%6n+A"
+        "$j*&$1(%)|#|-23u+A8!+@,$${6d7]7]/:7j/O$&6g!+5!(J*&*&'56=!@%m6=688[3(&_/E$P*I7'%n0C6V0D/k!I/G#u)O/@&/$O6b7G!k%n!N#($O6^6^"
+        "&/6)$&.`.`/z)s-[3d-b+I15,p&l,v-c'G5;60'Q!Y3=)R'r6_'Q2`-b%`0=0o0m8M4#5=,q*X0=5:'s5=+^+^0+)E'G7p![0m$Z&/){)J)O&{/h*I)y*G$;"
+        "5A!Y,O)b,b1u5!,v&=4E0I)W5=+`&/+y/@/m#(5=$54}+%$50n0n!=&j0c)G#f8F!0'Q88(),d6]*B#((v6+6H)+886r*}.a%_*}7w-c!Y/c)y6C2`/O5D4d"
+        "(z,$&t/d.<696_'m5~)x%<#(*j5J.Z),(b)[(V7^)F6&2A3g1C2m4E+J&/5D2e*u7j6d3Y6b!i,q5=*#+^5D6H3O+D!Y7r6.26+`(I5J)i/@&q5R!E04.;!p"
+        "6J+9+y)O0C+)60(88R-2#o6B7r7j6)-.#6$v2P+y%e,M(z8O(/4~&{5.6g5b7~,u5!$J5K4S6+.!5W)J(u!k6]6]-##a683Y#(-L)!6g3E,d6g%46d2e(Q0C"
+        "6E7e#A(Q,n)l)V-X7U#k!8!8(Q$}!_*&!i!i)10/+|5t4E6:+r385R2m&=)]'R*#&/)8*u5J5Z3f5J6#.Z!k)C.l-.+y.#()2m,=3f5K-21$)+.#,M5J04*&"
+        "5w->8J,T,=6d3M4x0c'9%w+P!<)E(p%a$M'B)u6b056b#r,c(p5:'25%)b6)!z!n!O6n*&-(*&4s)O-#%;/x4~),5K0C,$%76E!./}%f'35w5@#'$f'm)L2L"
+        "0'$e*I0}2`2Z6C8[)J-G2A,*!i7e7e*&&e,3)d)])R+`('5H7y'h6-5o635s,O3M7~0S6H6$!S&_5P685D(L(,$05t!G/V+J%>6L)55%&I$'%a5:59$'*--#"
+        "!Y4A5K$=(G5w6.0c5y+D+_5o'3,)6)5=,$+^)g+i3a3a&{4s%f/x7R2*-G6d)x#~+9-G2c4}41$=8o!c$&({04&K+)#o04!c4t,@$j($6/%h!Y+|0S/d/:0t"
+        "8F0S&e)d0^&0)b);6c,x-#$Y5v4+5b%71H-G)O4~1X).5X$J)Q83#r+j0m5D&66i6).#(z6L6b)11_2*,)2e1C3a685$5:7e)g6M,c3x,)3t+`+D(,7h0C%*"
+        "*&7]68!+!z2o#p+)80$i)f6B%!$i04+^)k3a0c5w!8+i-(7U6H6@6L5!,@59%X5o7A6$0h%B+|+r0^3M)1(,0/)k&h)g,))E)8)k!+!i#>0h7.%>)[(43p)8"
+        "),2*3W40$<6b)g,=!z2p5'8f+>5@8J5w1X51'@+S&/+`7r1H+^7%0^4-(,3U+6,3,=+`7%+A6L-25M0^(%%G7%),'u#(%n#((|7p/n!J1$+`4j!!5N0=!I/Y"
+        "&n%;5,/4!!!!4l(z,$6C/}$e!D)}#p$+!!%B-.#/8=/}!k7|7e!!$e6L065I,9%a/4--80!d+~7D5:/f%95,6L6/'B%72[4040(G#p2`0X2Z#l#l1]2`3J2Z"
+        "6Y2{,@'46X!b&~.Z406])L2Z7G%f'3-u%c/|4>)$4A7h6z--!i!i,+6$,)#r-b6q&j'3'a40)b)b0n5!'340-b&C/G)T4h%0-u,)!^7g$=-b-b#N40'<!i%0"
+        "7r,Y04,Y/D6B&g)$2P6b-b*-6E,)2P%n$6)$%>8=)E4t)T$'#r4`+S)E#`,)%n4U+~)T)T$6/f%n%n/e)`%<2o2o7r6C.)-q%w!h)_+r'G'Q)v7{5F2D5q/-"
+        "+`63$$6]!<)b*&045C%#!i6E+`8R$O&{8$/Q/d'B*I$d5{7o%;7g&c7q4&)x)F&t)x2A)J5w7I#%.R7m6V)l0m4&4D6C)_4~)63n64$.7r(a6*-%&,)l5R4G"
+        "4N,q/e5R3O'2+`7r%+&D5;26+I2m).5I6E!a7X($3o&t,b+|$+)H41!-$.!i!i-G's&8&H4~6a%#6*8!$v%92^7v$.6d(u&{+663$!4O6c(65%).*k)L6G6E"
+        ",:2%*&$.5=(!6E5$)F$O!G)8,)#h2m/-%c%3!w3n7X!p2^$v,N6E8R$57X7N3H2*0r%k,:,:-X0S6I6N)1'3+r,30I,)+I5I&t%96J(X!)!G5I(!(/.g6d4}"
+        "6E6V/e+T+`2q%<+}%f+}+;!w)H$+645x)_7j,~+`)C+;)E%c5x6N6I0h6V3n%c,N,C,C#'#'(.!=&b%X&b!C!D0N)F7/7/,x%M/9)_)1(,$f,$'L-X)F)[/`"
+        "'L!)&I(S(I!i4t$60A5=!)5T(S)3(S72%!(S5T6@0%(S)[!+5b)3+`/o(V)]/d'D/Q7|**0c%%0t7F'r****7|7F'r7Z&/-H056M6b!V7Z7t/Y(V6M(V6E#'"
+        "4t(V!57R6.)O(V6a+$&j'@%G/E'40c2c%G,@7R--+^)f5t)O/E(%!-,=5s7y%B!-'r+`-c%w'E5q,q4z7p066h405M&@5]5A/G&{&A-G-L2b2h6q-8/D&n-="
+        "%9-#,x*<5K*c2h627j692Z)C%27g+!)x2^6C2b-%-X8$7e7e-72h6f%n.=8M8M#v7H5y#$-3,33T4E-1%p%a.)-L5y$++!*#-[7h47636/-X7w-X7d7j-#3_"
+        "2N(I).%a$(%+*#&I,m5K5=+,+;)Q2C41(44t+Z2h0^+y6))i7j+^+;3W*#3.3T&.!i/f-c):.=,@6E)`#87{6b):,d5F5d)5(46z$[)O-%&0(u5v42+%'L1_"
+        ",x5t&c51-<$7+'-15+*f%B#~*I3G5C0^-X-L,l3.727X6E%h*c-X33$i,7$+,l/o$&(,--4u1b/r5=0I0/8#%[2]33+t#|5I*<6@5t4E-[+|(/)R6@!+)87P"
+        ")Q'r7^0h-#$72%.[6#6:)C---7/x-7+T+!*&5v-7)C,=--,3(%,m5@$=3u*<8#,v)d)d6d3872*&2g6D2]7o(u2]6N)z7y)[%+&5!*)[7A6k!@2f%z06)E8L"
+        "'B5;7a*h'G5A&h+!%B,c26%9*&+`'2-G&J)C*>7q06*;)b!z&K6+/c7a6.3W80#y&A4j60)d&{&c-X7H)x6d*I4d4d%`7N7e&K'3-b8$+4!k.p/|/^,$/Q+P"
+        "0'#'0'2Z6v!++`,34E6Y+`+!$<*X0m7~*|(,&K.!0;,@4~!+'T5K5c6.&'/^5=+J(p385D0H0[4}0I6E*X5R0t#m+D(o6b5R5D,r,O6X#y#|51,)6O,q0t60"
+        "26++6d$.(~,>$#)Q/-3@8F*X/_6-8=*^$'048R0Z+|**#'%z-G%h)O(X,@!+3W0t+X!V6H&;5:04,I4t%e.!!Y06$#1X6.%n%z&/4d)`6L!m*L!i5!387e&6"
+        "5D%B4+.#/a)Q%a3q#a4006&A&{5y0t0t,c'f.B3M&I$e,)3:3t!O)!/c4~1|+T%*405D5=+h/E4}6r&87a*I+48068(380#k06!8/^,+,>*<$Q$#6I+T!p06"
+        "-V06$}8O0Z$b,H)E2D+I0h7A%[)R5A+|%z3o)1/E6v0H%^+`)R)Y5=7W0I&=)Q6d8=(V*L72+S)`$<6@0t%B6D)T/c/c6d/w&K!+*I)O6d1X--/Q$e#(64,d"
+        "#35I+!+S+T7r+`+`&h0t/Q6L+`,3,3-X#(3&(%+>#36.2h2h+_182S6n3=043d,d5Z675H04047q!a&;7w156B2f6_7r45'3'5-48[7o3R-%8q0g(|8$2[3W"
+        "$e#f-2,S6c5N5944/p8$(.5D7o)H'O7e'O3.)g2^'<++%a%F)C3y04's(%8g,$,@#$)g%F7p,@#k!i7b)56^5A6G8J)C7e'36i595J637o6B-#3:%a!Y8F7e"
+        "6X)H'O3t3:,d3g'55v046d5@)E3=#k%<(/3W+_.e-2%F+`1$6n4+7%+U1H6c6b+^5Z0S(V4N5o3:134N8L#a'D6E5H#$.A0b0b7v&y(S6q*I-=7o)i!h7o6d"
+        "-4*k!J/c.;+`6]8Y/c#(,$-X$).A0S628o7r7o2p){8L)A)E$&4E7r)A(V6G8J7r)_14&16C7~)8.e'55='N+D'26&3.,S++'D)i4+$'4O2K3.6+,I,@'s8o"
+        "148C!O!E)E7o7r+++X/_*I#$$68g6d3J,Y5M6B5A!m)H'3/f/#)_7v8O5s$&%G5&5I8J6d)H5t7g7r%G)M)E'N'N'r1C3W1F)H*>-c#=-#7r)H,@3J)E6N5&"
+        "0b2*(X6E)10P)G3W5R0/)Y8E7v8h,S3W.e2*)81$/#6d/w)H4Y5&$&)C+!,S!p2*1$8E+^$y5|4h)s0^5=0^*^6a2Z)k6:$J8@4N+I0P7M69!m!R69#$4h8!"
+        ")]0K%k58(,687r$O6:46)]$O)p5R$'*f${5.%<*h*I8F5q3J(!+$&,8I6#5.4h6+6b){0^686846#u6c40%k){+t5=5;+$$O7Z*y*y,3$&%#+r7/${0K0^&,"
+        "7/,40P+`$=2f'50=$=(p04(Q2`&v2r->0i7S8$,$,3#%)l)l7U!D3=*-(p4E3B)l%k6E2r)l0i)`/|&3+^82#[%X%%4m)l*;)l8!8!+P/_6b$,'B,q8!4s&0"
+        ")E)[!<3R)F0T7^3[6)8=6g(|(L5U#V!i!h)Q6D&$2A2`%/%_8!-m$+'p+`0P-H!Q453='3#N!_&c%08L%a,$72.o'3'm&h)J'D&j2g,w0&4.)O0^,3-H!k,O"
+        "(/0g$,6G6:5J!h0^+1%Z5S)d0m3[1M&c*|8$4F)E%0(L#N7w*f+9!i2;%>7j#N'26q4O/:+^+D)z($)Q(G4E5D7r$'3R2h8$8o5T2K4@#N6.'O*u'B$6*|'J"
+        "6q/40=5T)Q0*+98T!h!i!i'T3j'|6a)O%G'p$,7j0Z297{,@#()E+|3R*-'37G'p*^0>0=*-$U($6f#N8Z#)720P4f,M%95R1i)R5v!k3[5M5J/}7e5b(z6C"
+        "8$6k$Y,T58&&38)F)`)15b-%&j$K83/h&{8!)10P(u0b-=0A'p+'2i,96q(V3t6n$5'L&s1i7j'k.R0A5T${,4/_&0+`!i8F$;2;$,8$0C,3+>)O#/+^)8!i"
+        "%_$i6-/_#=83/d/o&)6d-D4T722;(/6C(|#l*f$v/}7/)E(.3M,9#N,@.B3_${%h3_+P&6+p5R#(-42;%B+r%9%f'4)Q-H+'%7)Y%X)13[+I7!5R,@2h7!07"
+        "/@04/@'D){,@,@6.#)%>1s8&'k0=+h#/7|+;2i+>+'6b6n(Q7e3j4-.R$6)F6C044&837|&g3G7|0B8F4&,@,=)Q4f6M6d+;,30P+h+>0=6n7t0h+h!k&68a"
+        "+^3:,M6M6n8F6d-3%_&h2Z7a2Z/'(V+U5H8L.;%(7X0=7K!h!I5;26*>1H&x!i%#6K7a-33m(|!<+`'B){0'-X$s7P7|$+3M47+`5=3M(p4E8J#N6n7y+|85"
+        "!D+H&y&^0g(V+m5K'3+m#>)i+_6n,@)y04%#!E7U+|8R)i(8(~1w1w3t!m1H-9(u5s8R(z)R7!$e+^5Z'2/#!Y'r5n'L3t0d)J#F853t-21w&y7,*>)W-V1w"
+        "1w/#5=+m)W*u#*),2q8R5K/#4T.R+`8q%_.R47+A-43:)s5A'f7l)s6_)H#c7|6$6k(p6a(V4s155&5%0c-m8J4K.a'.)H2o$Z/c7h26(p7q)F&v6q15%;)d"
+        "3M&n3a%#)u6u!A)f'27r038L$6(p6u+U5A'35Z2Z#'8$0g,$8$2N'E64'34d7g%7$=2e7t5I8[)n!J0h-X2r8g+!)i15(L5Z)`7~$6'x!D*&+!(z$g),'a3x"
+        ")`*k)[0m'>,O5y!a5K'3'X&'1C476G+T5Z*#5t'<%n4F3:)W5N)8*&7p)Q*#$+-87h,S$'0c2o!N4F5R),0R'c5n4+4L5X(p5A'34>3T&;++'2)i(|7o6.)p"
+        "&|)H5t148O#~&E+`,T+m$60n2N04048B044t0A5K2m4}053y4t'G4y!a8=#8(8%#,H,*057S!i$b,$-7030P408O(38T5=8J5e+n)f&q1]-G6d8Q&h,T5t6L"
+        "2I075t5M)O*L5K1X-7)E&6$1%a-G-<6g5Z!S3:0b!k)-'a$i-85!'54~4J'k-=5X+j8O!n6s6G4+'u7r6s$&#k%75D6g8Q5q2a4|'a5v6M)g6E8=.=!L'r/E"
+        "7|)O$d0m3(6s5D$}5=1C3x'56q#~'N1O(z6}4&5K3M7g8R3x)2#9!i&~$v+^3_6/5@8R+S*#0A,n7p,S-c/o+h-25y8Q)E2A3W&h,T!c6B2!-[680E);5H)H"
+        "2:5o0|5y3W0H7A8p7o2D1w+|6d&g+r$b8i)R1+#l1^5o)8)$8a5=0E6t%32a)85A2*)Q)T),7.$i5Z)[!i%<6E.f3W6E2=5q)H!z0@+>0/6#8a04/_6:-X+U"
+        "5X8a+!6[5t+S5H#k)[,=#k6L#71%5H8d8a,O+^%G+@+S+j3:)s6a(p7|5H'Q6k)F4s+!)H154~6q(p$Z/c26'G-m158R,H&v7q5%&n8$7h.a2o5K'E5Z'3+j"
+        "8[2Z5A7o7t7|!J'3$=2N6E)i%7!N1C)`*k1+%n(L)8'X5y)W,O*&)[4F'c5R*#5o5A3U3x)H4+)E5t,$6L5t05&q$b2I(32a4}-72m!a$63y,*0n8O7S4t,T"
+        "8=8J*L5M)O-8+@4+-=)E6p)83:&E&6!n5K'k8=)-%a,S!k-G6g)g'51O7g&~$}'N#k+^6E)O!z/m,n+S6L3_-[2!5X+r2D7A)T0@0H),)[8a'/5Z'G'/0q'/"
+        "07#'/}5P7_'G6L6L0Z5F(%8i3o$&065,6L+S3o,=(%4y4y'G4y(H,M,L'32Z&c'p8#)x,v'r-G'G!@'x4+*#'32^6/7^8g'x8F6d7r!/&c+@2q3:/d,d,*!@"
+        "&c+^#u5!!i)H7A$0,*)E*#-47^,M/d)E)E,C63-30C%0-$636^6^&w!<'L65'r0C7''L,$6E8$%^5l0E6C5K1C0w0w0E),3_5K6E660C0>6b'a)`3s6g5=&h"
+        "2A&w2A+i+S'a.j0F#m6c'i6E$05)&v(p$.$.%#'35D!^6E+36E/c,$,+7r0h5>5X5N5=5=*J0K)8)55R29(p)T%_%#&s%G29$.8$)Q5v$./h8O4s)5(u(V(X"
+        "(I!8/m6E+h(u!8+|/Z0K!8&g6E)85v%G6:+J+J*F,x7b04'm'm'm%n%n&^2v1X-r-r&3+T4>8L'a#w(S6q!@/c6C3=0j)J){)@$;+K,I)F3s/6,8.l)V/K7G"
+        ",8)E+K)C6[-X)'&_6E%w6=%/3B0S6q$-%9%9(p'c7p/G.R%97g#|,$7j6^4k+r,37p.Z44&^6+49'u5t+h(S2c+y/z)i){!h%`(75%5t/|$i%z.;4@)z$i+$"
+        "+h+'$i+h5++'+h+h$i!82`3B4>+'.R7p%9.Z0N.<4>4>,36d6d7^3=3M6E3M3=7^7^1J6E+M)E0c*U#I'Q#().)0$-155U1N7{6i&1'G1C'B#`51#p'r7o(G"
+        "'2&r&w/S/L)O&m8@6]-m!2*U0|'f6d5&6804/d0@5=5=&t*U)k3l2^7v7X5X2^5!7|%n%;&t!=#(0h40!Y'u3i8L&s7o.=/}8M'4/L7e5I8q/S)L2c7o!Q-b"
+        "0g(z*I$-6J5q62,3&'*1,=)l.p6-/I*p6C('(C'Q&'$+)Y5g5g&^!0(f/i.68M(,$'467o%#-#5X%#5X,i,i)F5X.X*u1n7*04.#-3.e,C4u#(5&4t5l)[)l"
+        "6^(e%,+y2A4A-#$Z2^0@%M)}$v5l5`4c/N$'.-0/&,4c.M.#/e'r,M+`+i7X%#)_+n3,/d!p,H/i+T+'$U%<41.-)i-p+66@6-152^$b'4'4)x&r0C4u&'/d"
+        "(78O%z51-#.;83$.$q,M/6%a!-5b.#2r3$-v6s7v1H&K1p4O67)R4~)[6b)J&6!i#p'55K.=-84k4&4Z!N0@,S4k2m3t3M8='R6E#(+r)F/d5X'L,S!}/4#p"
+        ",@(7/I$F!p)V'23t-V5=80,T)Y6O,R7r5}%%+~4E/_.=$H+r%#(,5R4%&h7p)Y2D(y%#1d5M3V&y6L2A8&%;*u.e4_+h!i6V*&$=6E*!+6+i2!4_'r04%#!}"
+        "6#.$517*5K!p5e*w+66-,=)C6u,N0h7*,C.;6u$!0=51(*7'+|()8M)[.R$8)H'L$8-7.R7r7r'R)R%n7o5l3j7e)v5K6b#`696b$05A5A)v6b6c5e)z)v5`"
+        "2Q2R2S)u2h3n2o2h413q0101($)$42$L335D5:7y%D$K2A6D&h/93l&h!I$K(L&n!G!h,=7t)R#A,$8!72&F#(5I'S$K5D,=0^/J5=*m'37/&|+^2K6b+D4A"
+        "6d4~#(-..C)x)12l*L!n-c%n%G!O#`6E3E#A#G,8%75}6:$0%X%>0D,>6D)F)R)C--04,>,=#k3&'^+m)O)O2*60'3/|6060#H#J6E+P4>)Y!+-q45)Y)`/_"
+        "4s6E#e-7-3'B0=6d6d2L0]&1(|05,q8M)83T7r5M/d'34_4~597o062A5%0A13'3*c)b,=5t)E0S046.&v!<1_5])H(~(~&l5;*&'m7q6q0S!9$;,x6)&t1:"
+        "(L$i6H6^!n6E0M4~+`/e&K5K#p#A8$3J4+6i0},$3j2L%_-<0Y+`6Y*I-c!Y!Q'm-G6D6D){/t1i*j.Z.<#(#$2A5m695H!^(p6L7H&$)x%n.P'B(y/}-#'3"
+        "2`'p!i5!'38F,x&j)J,v,v!=$e-X8J7q$,)H)i,3$i.L6g5|6M0^'R-L+`1C6J'_0A#g$!6d(P8M+y59)H(,$g)Q$e'n(',q#a)Y)Y'36b7~8J)T)66G#a&c"
+        "1B1M$0,r4E7w0=8!6$),'20m'<%/)i5e$L#H)i&^!00I$,14)R4+)0/}+`)d+J2r85%0)K1)!i#N0I)8)H%B8M1C):5c,O6M6$)g3Y6G,h(p7|6:&14~+^&,"
+        "'2146H(V!g#/6r%_4O3T3T$'$!59!v5='c+`0/8$-X+`858o4c0c263_$!/_)z-#--5e)i#y2Z**6.4@6]%-($(I6^%-)K4x3M.a2K5K+F'3&I-X5')`-u-c"
+        "*;+9+h2f5.4Q5H)C6]6M6L'i$Z,r,r$g4t)i%a0h&$)O8T'p+3,@)y5!**.R+)(V0/6z'N(8'3,H#o$63@$U7S-(#9!=+^4O#'(I!T0U*!5=0S%`)_0/%B)f"
+        "0I3j'a)!'p,$&q0S!-4y!c7{6-)x)O+}3p2o40%G({04(V%#3y$Y!i#p),&t+903--/}4|%<29),6/6C45044t#N-r7g4f)s49,M!i6E/D#+/N%z6M6M6M5R"
+        "1n0b*I5P4u6c6b'5+j5v5v-v#N5.$[5R6b!m,x!-&K,O6M+1+1)T-88q8q8Y!S1H5@6@!-0h)O'3,T)i/Y&{(p(p(u604N7d8J5M15'R080X-3)12Z0/'@&&"
+        "7|)R4~#(4|/9)H(z7*)J&66:3T$i0m4|7e+%4@):5@2e06+>8O676f-#6p2r%a83(!0}5{#l*6+'(~)V,84~/B6`3E6G2e$Z2f6p7e+F1M--+`0q3R6g+`)z"
+        "5=!O$;5r4O,))C%e0A8Y0'%+6f$;6d*t/E0/0/-m385>&w6q7j)O)F1i#A&R-2(P3Y7e-L3E5t,)5>'r+D1C5+'@%-2e3t,N1O3_5v!Y69(/!i8Q(38q45#N"
+        "/V+>%<)H+^2Z+E6d,$6M-X%k45,w4D$=/_!-+h$i5@/}0b)f$Z)`4}4X#G6d6E8K+s!i,>5u#/7U+S0D,n6.,$)H!p(3(H%_3M,@2S2F%_-D6#,n#(%a%+7c"
+        "2Z5y5!(z!8-3,8$v7t#90%)V-4$i.L)8*#6H)R.@2o6G(7$!(|26*f0A,b7'720D&)+i+~*f!*!i+^4~)F0>2c&g--/6#l%e6&)Y1^1^+T6b0I$;)!)O,h6q"
+        "!Q6]0h,@1))8&K4+&s*&8g&e1M&w+'331]6*5q'5*&%B59&&3:5R5A,35$2K04)O6s3Y,$6d5D5,)F(p3=.e+T5v6s6d5>(S!R(P!+4|)8)8)H$e5M4u-D6E"
+        "+X)T#>2Z0D+h*I6g%04-3s5{!i7P3Y5H&h%y5Z'r5Z2q)R(P(o1n5]6#6:!E3G2q6#&;/x4~.Z$6,g1M/n3j)H7.$!7e&_.<6M'N$j5R04&c)Q5t+%)F!m%k"
+        "-4+>)g#B-=0^0P5J+r/65I3M,R6E5t5Y+^6E+5+T)]%_7q!V4&6:-X).!p&g3G3o4X0^0I5!,))8/4'N6s!S+`2q$;!*+~7.5v0U+;)C4f5;1^1^04(f,=3J"
+        "4Y--6s/}6c6#)H)n5v-V0b3J)n/_.R#*1$6E5J6b)y+i+i6I0D6L,34K(~6n,$0h68&h-#(I+$+>)H%B,n+U+S)5&{7o5!+%7S)'+^)H-2+T)),M)E+%,@)O"
+        "1n4&+S0n5R6E,C-(!u(y({,>/-,T3:5R0>$=(y5q%+'35q5q,>({6b(S)Y){(7!T6.7S7S+$!z5A2r$10c%h)G0c%w2e5C*&7a2Q6a(G8L(p)5--'T3T5C#h"
+        "2f6D,c5O&l&K!<$-0=5%5%1_!O/d6n6n**044E6I04#<6g*&)60S047w6)(Q-c4x&w&w(L'f7.'50|)b'3$+&+!T5J.;%70b6]7I/}$,6_(V(F){+`'50|7G"
+        "'m/d/d5I8$%h!v#$'p7P0g2Q4;,$'r%<'r6M+`$&0g-['R$g)6)6,q'5634h+y7~6B5I+1)Y+`6E/}03(<2Q6C4y-X0^0P(.0^7r,l+J7a)K.!3:045b)b0c"
+        "2K6X)K4[#y!Y&I(I2q5w&{2^2^'45K7`59'3+^+D!i$;6f6^)`%<6.4@%f4[)65.7o3@&q)x-404046d*-+6-.0C3:5=,H+`%n453y+)(G(I6d!O&r/d4|&="
+        "6E6f3b0m0@1_.;0W5!+n(84r&$&K!I%a4y#<646M(6#k%z+6*I)`5W4@,x5q-76b)_2f5v)16/!k1H4|'56g-%5!'31M5X6]0c,v5C6L2e$13s7~8O4+'56g"
+        "+%--+6&/(z0b%n+`5.6p0i-v,8$Y1C6M)T!K+D/J3:5=$g5=6g5)+h3E!G1C1C)F585o(I0S6C!f)!3t6D&1-r(V(z(,,c-L6E5%6M4#7t#A2!04,m482F2h"
+        "#G$+%a!8,@5!7r3t$!/m0h/d6b)R,M,80T7t6I)T2|5%5R4u7a7c,b,b(6,),v5=$i+^,m5R#s7U,r5P-X8d3:0b4#7p/_/_)[0h!u+r/E(.5@)G80)1&r+I"
+        "*&*&)86H#k)Y2D.!5R59$16$3:$;$&%>+_5Z2D6D)k%0#k06$d5O2S,N0S6M#h+`775v+h8!725W,r5Z041C)Q-.(Q1M)C8F)`/x(U-D&h+T)`+6-H+^$[+`"
+        "0b.R,=&15R7~,3+^,3&{6</d-z'r)}6L2q5=#<0h0m&1#<,l0h)`8!8E5~)0/(/S/(5`7w,i&`*/-D5A5c6/*<6i0h,$5y2r5I4G5P)_5I6)(z5!%G$05!%G"
+        "8@(f0h6B6B#.'D6b!r#b6C2A$$'2(3&v2y)`-m7t%;6E7w7t)b7q5X0|7o150R)d**6g-%#h!9.L)50|)J4d,%%7!T/O6:8q!i2N3p){(X5|5o7g6C/<#'%^"
+        "4k'5(37r7r0|/G6E,x4c-m'k5y7a0g!Y6d5>-2#(#''3$-$-*k15)W08)R#()`&^'Q1M7~(,6G#7+y*15f85%>5q+)*V.L2r)K++$'+_)}2Z0*'R6E6d7g,)"
+        "0c0w)H6E#.853.260w+_+h+i*k)Q'.#j!i+)3y6i,$$-#o$6&C!r+n2J/T/T&q6f,N(86/&/4-7r)x6D04(8'x*V034-4+'5$15Z!m%n+)&35o5o(X6i!Q!S"
+        "'56b4V6/)5!Y$<,S/O%96r3d'k%/)'1C6i1O-r)p3a!G4[$-1|.L6L)b0=)'*k+h+>+^7b2e,S6E%m5Z5H5!!r#G)E0E2,!Q5M!i'3)Q83)Q%#)F%96v&h#("
+        "5P5^!v1),m+>!972(/#I3W.e#j+i!i)d%>2q3p!i+>'31M7q&;2q4k2h!D5X#($$+;,35>5H+>7b%7)z7%2e)Q/G6E+>6+5=5=6:&}3o'5'&'5!@(V)E)E)R"
+        "(!!n60(,*&/j,x-4-4-D2h3=#j,M*&-447+h6:7r**5>2C4|5A416b+@&K&00R/K)H-L6M'n0g7S)g(!%X)R,M0j)O4}*&0g,M+@2]%_(!)R(!60(,-42h#j"
+        "+@*&)H5>%_416b'n)g0j)[0c)d$s*&7r#w)F'p%<8J%`2F)$0m'R2h)a(.'f$=)a)=0c5b3M.;)E,@7r7F!i5b(z2F'f7r5|$=5=6C+`*&5=605=6.6.%z'5"
+        "0c0c)](o)H&j6&%k(r#h3z5q)`6C156&6H2D064c)H6&6H&I&v6+673C2]6H5]*&5S.)$!6]7q5g&n5`#t2S6.1m8C5s6E6E3M$+(U2Z(V5t7g8$7m'n8J8L"
+        "7P'r'5)Q%n,$%`65+`.!/G7|'E6E){6:7I6C6C0i7^/}!i5j0g!=%08[3x8#$e7a6X5s6$6E)2(V2h#a5U2e(b#c'n(.0m)8)`)$'<5N4|2Z7|4E-27P-N&K"
+        ")56.5g'x&`#%466C+T7~*|*m586d4&)H7r15$v+E&I*}&N2h4A%<!Y#k6_*X0K0R2w!-6c5U$')b5K585;'O3C#,)8)l357h35&/(~#r3,)`*L0g$j5S3W4y"
+        "5I&s$+3g6E.=6H%k/e8F#l#~8@)H033o8=4~)x0Y&&7m728T0=8F+o)R$=(Q,J2]!r)$/i6b%n5q/j2h5v2h)=)$&K7w%a5X'3004@)R056d8J805@)86G!-"
+        "5I-u$!&}7~6360)15v'R/#03-[6@5!5b4&7y2D)Q0%+')2)C'Q6M-25T-45@0C#~5~4+3M!O$,0=2h)V6g5Z(X3x6868,<6b!p$l0Z+^-V-V2F7a-S)Q72)_"
+        "+h,8#>/4(45>8F!8!8)f7a6C(y)W,l#u(I)!#l5q7A2*5=7F&;7m.!+>&I6L*&)E8k)[#*)883597>7G2f0K3o7>002a5v7/3o%A3W5J)E)])k7S-z6B!*7P"
+        "/f)7)$6E6E2D1&.l0@&;3g(|7y(Q!+6L)R6d)Q)8&/7a5y7%+T2]5!#l+`6C!n7a60&K$65!$66:#k1&6I+>$$5X.R)+7%6E%A7P60&/6.)H%z'515)E)`(r"
+        "3z1&2D064c6&6E6&)H15)V)8/4){6+.)5s&I,J5g3C&}2S&n*&7m'r(U/}8[2f5j7I3M7g%`7y$e0g7^!i6E6C*|+T2h'x2e)F)5$'7~2Z)$%<'n0m(.6$6E"
+        "7j'<5N#c)=5s7y)b586c0K5;'O6_)8*}353C&N0Y7~8T/#&/8F&s*L4~6b2V2]%k#l+o8@3W3o2]6E-[$!%n)2)R5X5~6@5!&K6d5v#k8J!-60%a-2/i5q-V"
+        "%A3M5Z68!O2h0=-4)f,l7a)Q-S3o7>0I+>00*&600@7P$$'r0=(p5C)F(p(F(o5=5=)@+r(H&/,3&,)T052h+_%X4r!f2r5K&{7r7r60602g$=)54_6E4_6E"
+        ")O!<(w&K$;5P).)O*U'<){'25=!z(Q6d7~)J&w5=#(5$),!z%_8O&w6E7r!T#f!0/d-m/c'm-m6_%h-X3=5l),+)(V(Q-X!0,x+^.;!h6c)J4S,u/d5=6E){"
+        "-X$:3o)+*&!Y7e6g'5#7'i4#6C(L4s/x)C&j3n(%727r&`8$2h!i8J&`(//j!m,h%72c+!&t496C$,,x(X!i,@+~)8'</i8J)L5t77)['<7')R6L6&7h2P!z"
+        "!z0c2P$M7'7y+;7%$g#~2H41/T'a5I,i)R3W'53q$j$j7r)E7X&0)g5g$[6r!S6z+;&~#D)E2c6E83'5'n1s72+r6E!E$#4u7r8=!p6p7D%<7%600/2D4u6M"
+        ")g'E5I7'!i&/2p602H5y,5'E7'!Y7e'56g'i#7725I!E7X)C7r&j3n/x!m'n8$(%&`)R![2h49(/+!%7,x&t(X6C777r)L)88J+~,@7'8J'<)g0c7h+;2P'5"
+        "&0)E2p2H$g!i7y'a/T%;+;&~8='5831s72607%6p7D2D6M'E$.5=2S-v4E5A$&(X$&7b5D3t8V8V+`)s'57^'D052D0^6I5J8J*&0T$,$d$$$$%n)x#t%^5A"
+        "7P*&6n0g)F$,$;'u5~8J45&E+y'D3_$v5>7^3M6I)y)R0t3v$b%!,@0j%B0b8J4+0g$.)10I0H)]7/4-&_7$7$8Z/9!T*k*I&@*&'2$#)Q&o7q3d6n!@046n"
+        "0C4f3j6E.B,$-%!=%m*h4d)J$d/P0:8$)x%e7p'2/E){2A#).;){+`'[6C)E&F5J)Y&F7~0m*p8-(/0^+&5N$.,@/i7r)K47#8)R%00H!i5H&F)E)y)H2o4O"
+        "$=)l.R5R#/5|%%-b2o+m6X)[$60H-[3g)R045.4~$_)`)F.R)x.R,H,@+Z)'){$,4t0m4*#(8Z0P6D$v8O#88O/a7r7j%e7p6b&D&A$L6X7v%a7H$#$H)R'u"
+        "3t)z'38Z%n/i1H/#4+#b4Z)Q%F%*033g0C.B%c4+)F.R,l,(7%!i$0,@+r$v3s%73M5@+&)E7p0C%_/E8O+h!d7,.B!v4Y)y%X#^5H&h$;7t&=#'$v$v*&*&"
+        "+~3e0H*%00+q&=$x(%7/%0!i!i8!){$;0K&@$6)E5:6n.B+~+y7p+`7r#k$;&65!,3+~5H5!8_+>5Z1$1m.R3g0h)F$x%+5@+%*&+~2Z'f%9&v0g4,&E&E'f"
+        "+D14,N!*)E)y3u*^+K6/-$*>0g,8+K&E7p604,%G6L6d#y6+(.**5!6n5`%75v&j152A*}2o4_$!%7&K-m04,v1X*}0>82(o(y0h+!%`,$%7!77g&j*|64/^"
+        "!Y'p'p/O8$1D&K!=7z7q68*I6E7r2h/}&^'h)y)]('(V*60m7y6}7r2P+o6d2K6]4u6I7a4t'40W7y.;+X7a7S+o8J)54y$b(8*;6D/_0A(3.B/}($!Y,H/@"
+        "+m1X1H)F635I$K$q$Y'R6](o2o'58J'35$!_7R6b5$3x'r7e5D6g,@)Y#u825!);5}7a)]7S#-+J&w&g+|'R2**;),6D)F8=&^6d)R(o+S/V+`+`,=+~#y6+"
+        "(.5v%71582&K,H1X(o'p*I,=7z7q6E(y7g+`680W2h6}7r)]7y0m,@)]7a'4+o.B!Y)5(34y+m$b8J$q'3)F5$2o/V6g5D.B,@7a+|5]'p$e$e/f8g!n+6+6"
+        "$e5{!J!n!n!n5{!n!G$e!n!n$!1N.e.e#l$b$b6B18!k!k2f6a+r%0#j'B0=6a6a066&6C(9,i036u4z4Q8@6M%06s)g(L6+&i5;%0&I(B7c%0)g6h4}+h$,"
+        "#|.=457r6C)p)J$!%7&_%_0'8$%n723y2r4d0k)l)6&'6_-2!d)E-q6C)`8:+y6&4[3C2h3y/J(w.=&A)p5x6&#,6[5R0c4L8!0c%a%a4O)l4-&,6D7c4D(*"
+        "5;2h$(3M7/0v&|+h3b)6+_'r+9!_%-*&!d).%6,@6]7y)g6d$_+%4|4-6E%06h,M!f/#6b%B3U&A3W6/$K$,4+6d2f7e6]6s&K!n(9&K5D)10c%G%04}-u6C"
+        "'n68$8,)6&3g%a$,6h3M3g0@,c68(%7U!82h#4$.3M7,7`&A%a,8$,%*+|8i1+0=5x6d6C&K+r){2h!i67,i5Z3W(B7P4&&_-=!k!k+3+^6g68,M+_6E4@%["
+        "056V2A(G6b,q1M0^5=+!'2*B!z&l5c-m5]2]!L6g%%)B5X!L58){6](G3j0b!i/c#$2N!Y4j%`8T6@+|*|(,7~2e*h6d'<(V0P7r)F),(w5c)Y5>(,.~+D)K"
+        "*u7m+D6s6.$'&,5=,S'459'3'O(R+D)K'c*-6N#(5A!Y+`6q#/5S03/d0W(67y3o8T/}+9.;#~6]#/5M%9)y6V0H6B&)6/-#1i!Y&K2o*#6c6s(u+%5M5M3E"
+        "3t-L5=1N$=8J8T6@585M6q(S6V!h,x#u'2+s6H80(|0H6-7U,n0H5s%[!i6$!i7A4}7m,x2D+|0%%9--6@#I*u&{--8T+!+i7%#k6[)E60#k%+,$)+5=&{7%"
+        "+`6^%w0c8F/V7|6D'B6b)u6/8g,v7h5t&,7e&v6g'66s3l4/0:4d$v(F'p3J0'$66}-M+K$b$66_4E7q5H)W$'6J4O)]-#*k3O+U0/8g(C602;.H4},@+@6-"
+        "3y/S7R$Z3o8g8=$v+)4+5I&.(z5s5d3p0c$Z6s0'*I3E-20m$7%*6s6Y!57I(C3t)W/o$#6d+^7,+I6B)W#-)]5=3o&b.e6E+_){606E.H1M6#$660,$-2-2"
+        ".H5`)]2;-260!n#82h6_2h2h+_7w6>+o5=)d)d0c6D+s%D7Z%w0'0c!<'47e7p!<,E'4-q%k2D0J*f$M8L&i)!)!(I'G04,q1@%a3=5A6E#e2e4P5=/'0=0c"
+        ")R/f6=)d!>&l$!5c&+6n0='2/c-m5]&I*&&A'k6I0>!I1n13#t.a&v6r6D0S/c(6(p6H**%k6E7t5@'@1@)B3l*B6g,=&K0S&D8J.<4O2h-G'p*I,$#$3='r"
+        "#(/c6d3=8o#,6]40)L7e2g2h7p){#j2e2e5y7Z!T(V!i2`$;2f#(8$$.6u0$4E0>'37M,*0='3+`6n/c62!J#')`'k2r7j-b5@5@%a)J-c3p),6D3:+!*1!X"
+        ")R4E5c(p)[$-&`,O#$2h-[)J6H**7y$35O4E-X+U)E6d5t138l7r0^2D$.5J5c0m/c4;7~5P-L*o685H5I5l**#`+J)F/e1M-36B6G('!/%|6^2**G0>,C3:"
+        "!(%k(I1_2h*X0c5R7a5o7*4+%-'u(r7t4I,S-#+D4u5]6q!Y5;3M6d#k%z#((I)K(p$x&{#j4t7r3:5v)!6c45+!8F,Y5c0T2^(G,Y6=$;7D)x5K4;,q01+^"
+        "/G1_$''O+_4##!8$7h4N,*8g){#q6h)R'G%k3y#p,H(8,$/c,@+^0C0**!-G8g/_!0/c5K6(8:+U*I*^3g+)&/..$U8J7j![.R8R$Z3o%z040>8=)E6d)f($"
+        ",v#o415=+j3y's%-2r7e,@-.,@(~!r'8+9*U&l5<-r4u7%({%J5H/h)@+o&d-(*66L%^+j(65J&14O4}8O'51H)F&K**$#4+7G(|63&65D6b*X2`)14~'57Z"
+        "#`0P2e(o+%41-[0H0H(u4I$i),6@-G)R&3)R3@+%(z5v&E)`7e!k7t8J5l6=-$/B!()b0B-#3a%0!O5D+h3a*7,)686@.l5)1C3t3a0C+`38$U#(/E%/!f1|"
+        "'G8J586M)345,)*63[263E4u(S7h7h+D6E6g3u.R5>)J'Q,c)}3C8[3a5F&{5$-k,>3a/48Z4T5l(%5y+j2m!:,m-X,M!i5!,)%_1w8Q6C,@!8*X0C$}03#p"
+        "3s,n6V#l&{)l!p2r,:5o$i,37%)R#G+^5F5=*>3(!d7Y0B$&,@)!)F0/)80E0$+|2*5o1w$&+'3:,).!)1/t3W&h0I0l633s5P*&)Y8i+r0P+I&;5^7!)E)Q"
+        "7t%[6(6N&8*&.l7!004;&h$&%y2D*4)O&t3W,>)})86d+h8F0H)R8F+S!i4;),6@&D(8%>){&w%0!Y6E!+8O6&%k8$(f8=)E.R(V)C0W!z6L+'.Z5q)R)R0@"
+        "#b7r-D+^+S)E8b+!2H/_+6&/38$b,T!p!T,>5L*w,3&K,=5])R+A#()O6:#k5M)R5=(%#B.R+T$x0h/G,M8_,C7-.R*&3u8!+>)d'86D7e%w7Z0$+s4P0=$M"
+        "2A1n&h%k-(/'63#e5c'@#/3l){&A#t7t-m!Y'G!I0>6:0R**58'k*B&l)B4K.a!>6d0>7j0>'r#'*I0&#,#(6n8_-c3p)L%f6]4;#(,$380=,w!T2h5y3d!i"
+        ".;/c&D5c*G+J&_,q6(6^$')K6=.!7r%>4E,S%k6G*67G7~5@%z%|5H)!0m26(;%k'T-L7j2*)[6B#l$33s!/6H1M8$+I0159+94#+j*X5R3a+_7D$;(6'O&I"
+        "5o%-,Y&{5],**4)Q1_4*+D0T)x!#0C7b/#%-,v![04%J*L+)#o5='s,M$U8:)f7r5H*!)@/T3o%z)R){-.8J0P6L*60C3:&K#`0H7t&63E)1),!(&1-$,:8J"
+        "&t-#-X7h#('R.R3u)}.R-k,)'N!O6E)J!z1C!p3s,n,M!d6V)l%^8Z5y,)#k*&+t0/,>&;+>00$x0C%[)C+S),8F+h6E#b!p+6#k5M7W#p)u!9%n0g+s-27W"
+        "-(,d2~2C)C-(6.!i(I!i2A*4*B!a(p1d1x5I5I)O-H5C3/&,7G.$7P/^5E,$!n!i1d!+(!'R'R&c$=(r(,-H2'+++F,R4@29)y6n6n#l0j+~#o2>++6-5%6."
+        "&K):6d5%(r!Q(r0j695%!I!04}6G+10t+>&.0m&{40.R3g*6(V0t$Q(!&,05+$3t(!/n*<5A)8#l/f%B),3g5%3d-(2~2C6.(I!i5'$Q1d4}5I(p)O-H*>-*"
+        "7G.$(,5%3g-H,R*6&c'R(V++)s6n+D&.6d6-#o5A5%):6.&K#l+>0j)8+10t(V40%00q(H),'5'5+P&;5`0=5;'@7r6G63&+&K2`!I/T*X6r1X7q/d)k&m63"
+        "6G7h)_$&&K0g%`8[8q%f,%!#4d4d!V#$'5)H,@,4$!5c&F,:-X)W2o&F5K&^(.6a'<2C*-0K5c$Z'5!i5D2C2`7r0.&+6i7h$;5K%F.R6r5J/T&t8T6E&;,H"
+        "6G)x$U$!/d,$3y5K,@2`5J6G8#63185D$1606G2r%^6b,34|4|.R&;3U!/)1)_3U6I'@6/)5'R6r5;+%!+5A3t)H7X%F!85A6I1n1*+|4Y%[)[3W3U!:5J&w"
+        ".<&^)E%F5>6I7r)5,45=+`+`+`8:(z7o3[*#-u6E0t600S0=5h6*)F's),7r'n*#$e6V)x$;(y6v,O6b$6%h3T(I513&(%$;6v6V)E5=$6,++^-u5|6v)F)F"
+        "6c6b5}-l'/2*-c5%&v/I6q+`$.62,$+S!.!R5;%f%B(|5;%k5q)H-c$!5R7I4@7h/V-#,$037y)C29&q(p7P6G.;8$4_+|,$&'6L5;,$3&,$5D(p6G,i,i6r"
+        ",+-/!z5;5!+16H5>6E!*%<4(5K6d,@,3%7)F/I63!@/c4}&{5A)H,g----+S+`)C!*&t%7,3,$!+&{+`!S(X(X(X#%0W0W)l4/7e)l$&0Z)l)l%f)l4/&q&q"
+        "*G-2-9-9!T6@41)86@'R%w#a0>15%_&15;150S)g5{.a!>6I1m-m-X8[%0!J6E6:3y!Y)_(p/O62#$6G'R3y)`5X!-!-(a'h0:%00I4>,l6O3T450K5y*a!c"
+        "3g2I#$+1)x+75Z1H!L&W0b0b(V0K-c)x)O!k%^)O5$3x'k3g!Y5X/E'R!i+13s,8(/0I5{)E)O)T#m%0(|5J0=&/4k)O+>4}15'3-%0o'R4~0K(G#r+11I6s"
+        "2S4~'R!E3x'k6s'L!i4~3W&/4k&/4}15'3(G4~6s3x)u)u5H5Z5H)E6G6v6s2L+P/_)16L6s/_!-6G5O(|6@%y0Y+%5P33(F5q6C5q&J3C+&04(L6d4s!G&A"
+        "%_%9/G0$,%#|)k+U(V0H&K&I4~5X+12]6C6C(B&:6c/|+U'4)K4J)8+%)K,L4A$&6N6p(z(I)k4Y4Y/x+;4Y8J8J$U%z+;3o(I0=*I%#5x0R6C1p4+&I&K6."
+        "5'*;6W806.5J5`6D6i1|%c%c)V+$+U+I/o4p,l$v68(S0I's6&6/)8#m1M--!z5J/x,=+@.R0m6@%y0Y(F5P335q5q4s's&A04!G3C(L6d,=,%0&)k)`)K4A"
+        "(V6N)p*I6C/x)84Y(I6N6N*I4+6W&K806.&I.R,k%c1|(S+U#m1M/x0m&{!p'u'35C7R!p1n!=3j+y'u5y2K){!p3:4~63683E*63E&g,)5>,+/m/m,)!p!p"
+        "!p+r!p2*&{5l&{637R!p1n){3:3E68,)/m!p!p&q&g&q&q2f2f#;)E%z3=4c7P3Y5O4_156d*#$.6I&j&j3Y6I4K6C8q!i)a3x!S$e4<3=!S2h&F(D1541)["
+        ")K#$684E$e5O64*#&_60+Q5=#;#'.-&K#/*-&,3M6b2h68);(82h)R8=#$5K#/6@3o&q7U5!($&K.u6s(z)14<)8)O(u!+3t&v5!'r#`3C3t#('L5A+',+3E"
+        "3y6@5$-V3t,l!i6d5l)f1w+'832D$.%<6E)E1)$&6V3x5!5O7P&v(D--60-V#k5O,M7%-z2f%z)E4c3t4_5A156d$.&j6I)R2h!S3=&F6C&_1)5O(V+Q)[5="
+        "#$#'&,&K6b.-*-(8);5K($#`+''r3E#k6@-V#(,)5l)f,l1w83-z2l+%(75M&w#(.<!i#(4O(F&q)O!-!+'55H6p5]&w/w5],c6d&|(I%_4d7a$,6$8$7o/V"
+        "5`1@1n6r5%7p%<,R6]#(!S*&4d6E0g5%0g)n0&7Z6f/T7|){8$.o)x/c7))M,$7g3j'5642g!i4d4d3=,),d/i3y7r1C4&&'6#0l2Z)n&_(D#(7~6G,O7y%<"
+        "(D,))y3B0R,q+D(I4O5v4[*-&J$(5b!),@8:7y2S/i+)3y+98O*L040460&q2!60'R695;/k$i/k0>&q)10>)@6b4+0m5D8O+%1H3:'u4d(,3E0=$'7r,)/_"
+        "4&5>#H&/606g8T2!2D047r3&,@5>,M7U-X!:#;!p$i0g!i7r6d5q)!#'3M5R+|7S&=,)4d#[%f)Y4;60,M7P)i6E6@4c/w7|60,3,R4&5M)H3&)y5>)++^!p"
+        ",c6d4d6$$,0g1@#(,R7)2g3='5)x8T8$4d.o)M6E%75R,d6G)Y)!,O(D/i!p+^$(605b0R*-0404*L8:8O3M#;/k7r+%2!5;!:,)0=2D!p,M$i#l7|)H3&5M"
+        "'r4~4~4~6b'E6E!24J)b!T!Y$d4,%`*h(B0H(u*p'R4Z'c/i!i*I0;6b3V,8#(5R!N#($d*w!}-V+r,85R&/7'3V4,!}*w,='L'L0K*D0J+I2%!p+)+)%_&n"
+        "5l0|,v%<+)!}&e45/c8J&e0|4-!T!i,v'3&^1C0g'f5l+1)H/_8&2K3_4-+`!}8O%_/_3@7j0m8O33)Q4e(z+6)s04+h7g!}/_,d1u,l,l215q+y0=0=-z),"
+        "+1.Z!}+y1$&,&,.$(r5A&,(H&,&,)s#r6d6d'R60'40S(,8O,+(,2F6d(.-%)H04':+%);!=0'-%5q6/5R+n6d4Y034y+n5!'B$+/m!i-V)G5q$76/7P6b%D"
+        "13)`!<(p4c%k)G5t&I&K26(L4_-X)b2]!I6g/d,>5%(z,=6u&m&w-m6]/k-V(V5D0g(G/c,$4d#'0c/}'3!i$f5!)x%h!@6](3/c.A5b3j!T'57H){'p2f&$"
+        "%83g)`2o(w5O&^!04}7^7~6J+y,O4E4,6E#%4~)Y*h(,5H'R)6+J'3*G5l&D**4+-82K7H3_0R6b.-7a(3'c3J590c2A0.).45+_2626*G--$'+^8V5=6X2Z"
+        "8J047j5O.-$Z)H%h0P's7{&$+9&t.;6E+),@)v#o)i,H,$8T+^-.8O7r.A({6b%`2e2Z).4+(u5b7~+68O77!k!k).0m774|4|6b$Y1H%n)1+j6/0b0b)Q!f"
+        "&K63'51p'D5C4e(z2h1i5v5$0A(S58&m2!,),c2f2e(!8J4&3f68&I6W0>045$1i2[+h!8+P)5-H)H450g)O2Z,l5>0c!s)H)H8!)T5l806V7U*>5}!u6d0g"
+        "5P#')[6$3M)18i2D2D&g(/+|6$-<5@7A5M&y(!(w*u772!7P'D(/6O+_#p+S2q!+1M)H5t(|2q+`+y+`-D7e5O&K,=(%+^5H6b%D)G6]4_,>&m!<(V!@/}.A"
+        ",=6]7H'5!@!T(w/d3j(,)`*G4~&^4E77(w*u)H)Y5H7H5O6$'c+^+h)O+_2f45(326).**)H6X0W,$048T&q+)#o's.;.A%h)i2Z2e8J&y%n!f#p4+5$4|1p"
+        "&K0b'5)10m)T!k2!!8043f(!68/J)O+P!s5}!u,l-H6V5!5>(/2D+|8i(|'D+_7P($.L6D'3+`)s#-60'4%h)E&~1O'B2e&~-L!S6f7o(|0S'2!G5%)O2e6d"
+        "'/67*&*&/e)+7h!S606(7m&l&~5%/4%7'Q1M,$-D'34d-G+`!m7r'Q6f$e0h5R$+%<)x69'p7t6d626d6(4;6d406L&858&^'u!+7o60(f5R)K+y7~634+(p"
+        ",O1M-['Q13)Y5l7y$+,O(f.A&J,C)K)H4O)+4e#.59)}6d#(*-*-!f5=*-)y4N)i4+&I&I*}(z5:2Z+;)^/G,@/d2o'3!-8F/_0S0=!V%h,@0t)O)y4Q6(6f"
+        "04+^6@8:*^&F+)2`04)i6E6E)i8J+9&$03$Z'a)x*&6E8i)E2r6L$.-<1H!-0b4+(z4+&K)_,v'3$Y4O6/(V6g/h+)-#(z6L$M5;)y&$#A&n(X6L6g5H5)2e"
+        "(X$;3t5D1i,))F'q)O3[(I$e$e6E6:60)E+`40*f4*4*6E4O,c5R'L40$!)F4T7c!8696B/4$.7r,+6V,R!i3&8F6b59*&6H4+3:)Y6E)!!i6L3M)1&h)Y+r"
+        "60'L)v5I5I4O,h8i6d6L,@4T5I5|6E/f2q,M5=6C)E726b7P6@63/f.Z(|-26L--%_6n6d+T#.,=(X,33&6n6L(%0h+^,C.L)s)E6f-L2e/46(#A!S7h'p&$"
+        ",=6(5R62,$$+0h6f5|4d3:7r&^'u5l(f7y'Q,C(p59#(+^)}'r&I6d5I4+5:0t-<!-+)!V/_0=$Z'a6f3M(z(V&K'r0b$e-#5;6E6:5),))F6E)O(X6B6L7c"
+        ",++r)Y)v6d,@),7P6L(|--(%3&,>)d,$)Q5I%+)Q)Q6.%+,@6[$s)G/O$s/O8$**8#)O-2-26c,)$!**+|.;04,@)v**)i+`5M5I)J-2+`2S7U+|)i04,$6."
+        "$s,i,i(V#v'2-9-9'2/Q0j0g-['25K+90g-9$/&{'20g-9,b,~-V)5-Y8T.y&w)1)1)d('4/4K(p)$+!(p2q+^.A$+(Z(Z6E0>%;5A4^-X-X0>%7$=6^%e6B"
+        "5D6/0g-$6/0X6n+^%A&/#=6-6.6/%;!07g%7#=6B-#7R6/&/,=7q&x'3'4-8-86g$v0j#u4h7~7o--!8!u4d!i6g#u4d%y-4-r%y8J'r'r&$&w3y6f/d#o'L"
+        "066f3s4%2q2q&w&t5%!=%h4d7t0h2`2f6_2f4@59)y)i);)y6/4N3:5=5K6/+S!g6:0c(F5;5;(t5Z&K7F5o5,7F.g-|047K)H8J)E)E04)E$-$$$$(V6)6H"
+        "5Z!Q725Z#f$+6/)z45,$,$$:0m5Z*U.R)v69$b6r6c$<6D.;728T0i6r6//5&K516E$d8T%c$<)g6+$-$$(V6H)z,$!Q458J*U6c$b0i51,3/J'f/J6/,3,4"
+        "'f*9%0,$%0,3'f*9(,0b!u(,6n$T(V*&5X6d!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!2C!!!!!!!!!!!!!!!!!!'J3f,i"
+        "!!!!!!!!'Q%9!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!:40.<!!!!!!!!!!!!&$7r+D!0!!!!,i!!!!!!!!!!";
+
+    // U+F900到U+FAFF（CJK兼容表意文字）的读音，格式同上
+    const char g_pinyinCompatibilityReadings[] =
+        "05'd#y)L)!$M){(,(,06)d+5-r+@+;,M,M,M,N,M+P,O+K,O,O+K,O,E,D+>+A+>,C+>+A+>+>+3+6+6+D+E+F+D+D+9+Y+I,>,>,=,=+J,=,>,@,@,>,@,@"
+        ",@,T,@,@,@,J,4.g,3,3+I+T,@+S+T,S,8+U,:+U,S,:+R+M+},$+X,$,$,$&/-k+P/#%9.Z.q,T6E!X/E!n'5#/-42r3a#;1p2b6@3526$!2]2f1i,Y,Y+o"
+        "+n+m+m+m+m+o+o+`,S/',=,S,T+`,R+^+`+^+`+`+`+`.A+h+j.B+h+j+i.A+j+h.B+h+h+j+y+y60+y+y35+h.C.B+j+h+y,&,$.Z,%+h,$6M,$,$,$,$,$"
+        ",%+`+_+_+`&K+Q+r+r.M+t+P+r+r+s+r,36p1X,)$7,*,),(,),),).a+U,+,@,@,H,H,H,H,T+`+`,T,3+`+`,S6E+_+^.;+_+`+^+_+_+_+^.=.=+~+|+|"
+        "+~+|+|+|+|+|+|+`+`+`887r2f2[#a$g0P&13g3t7L&'!T'35c)W)R+15;(|!!!!7v!!0X!!!!5=7~6E+_2[5N'3)l)i6c!!0b!!7~!!!!6E&)!!!!!!&j3="
+        "($(X+D+`5:21-8-80S!V(U3q06/}-X#[#|)7*67A$'-H)H2q-#(C8#(I8#7]8o!V2S7q046_8[8$)C7e'r4N)`+j)g&h2q7b$8#J#J7d(X2h6@)f!z7D$b6E"
+        "-u5O/x)8!!($!!!!#%+!0m5c$0)H6X2L(U3y)84k7v&w6/![!i$e!86E#8684y2^6d7A!:$'%76b3E#$!80X+E4z7X%626,)6H8J(I)l8#0I*&&j7~7h$e)$"
+        "(!5$6E2c7p*#7d4046)`+U3x+j/}7b)0)!6p0E'52h%k7~0Y6@/#6d)f!n7D2o$,3E5c8#-u)l!E5O&J/x7g(,!!!!!!(V5X)`!!0@!d&K/J!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!";
+
+    // 来自CLDR Hant-Hans转写的繁简字对，每个字用三位base-91数字表示
+    // 其相对U+3400的偏移，按繁体字排序
+    const char g_traditionalToSimplified[] =
+        "!-I!,[!3u!3C!LG!Ml!Lj!Mp!M/!Mt!Yn!Z!!d{#JY!fn!fs!h4%7#!hu!i8!hy%7|!l1#!w!mO!mR!mV#>L!nS#>H!nW!nF!no!nn!nt!np!pg!pJ!ph#=3"
+        "!pt!|:!q8#>L!qJ#XX!qZ!oK!q{!qh!q|#87!r)!rL!r*$9>!r<!pB!rI!qe!rU$07!rZ!vu!rj!pD!rp!rR!rr!rT!rs!oM!ru!mZ!r{!og!s##>N!s0!oz"
+        "!s8!pE!sW!p=!t&!ql!t'!qk!t/!pI!tD#Xd!tI!pF!tK!p<!tL#/1!tU#6e!ta!q&!tc!s{!tg!p>!th!p9!ti!sH!tk!pC!tr!sL!tv!t-!ty!o>!t{#Iw"
+        "!t}!q(!u(!qm!u,!o@!u5!pI!u<!qj!u@!t0!uI%&t!uQ!or!uX!oe!uZ!qq!u]!o8!ua!qn!ub!rV!ui!tZ!um!rO!un!qo!uq#84!ux!t1!v&!p6!v.!t["
+        "!v3!rS!v4!#0!v6!t]!v7!tX!v8!rQ!vD!x<!vI!vN!vO!v;!vT!vS!ve!w&!vg!mT!w+!w-!wL#=t!wk!wc!wp!w^!x!!w~!x7!x5!xm!xs!xr!xh!y/!xu"
+        "!y2!xa!y6!vH!y9!y$!yC!xt!yG!xb!yI!yQ!yZ!y;!ya!y+!yb!xc!yd$~f!yp!xY!yt!yS!yv!x`!yw!y(!yy!y*!yz!y<!y|!$R!y~!y-!z*!$w!zR!zC"
+        "!zg!z8!zi!zh!zk!z1!zm!z]!zo$E6!zp!zD!zt!zP!z{!zl!{&!z2!{(!z]!{*!zB!{-!z-!{0!{5!{d!{]!{f#g@!{h!{e!{w!{q!|.!|)!|T#Dt!|V!|O"
+        "!|u!|i!||!|q!},!|h!}1!|e!}3!}!!}C!}B!}D!}A!}c!mK!~6#!o!~G!~H!~X!~Y!~[!~v!~h!~9##%#$j##*#!!##P!~~##t!~}#$-!~H#$L#C`#$d%$P"
+        "#$h!~T#$s##@#$t!~T#$w#$4#%G!&U#%S#$7#%b!o'#%d!mW#%e!~'#%f!n(#%h!|/#%l##N#&##!$#&$#%$#&'#$0#&+!~;#&7#!%#&G#$5#&T##C#&e!}z"
+        "#&l#%w#&s!~{#&u#$|#&v#7q#&{#$.#'+##F#'0#$3#'1#%0#'2!}~#'7##B#':!~x#'@#%,#'V#&w#'^!&A#'a#!h#'d##A#'i##L#'j##D#'s#&Q#'v##H"
+        "#'x#%q#'|!~M#'}#At#('#!f#(.!~7#(3##K#(7#7q#(<#'`#(A#%&#(M##+#(N!~|#(P#!d#(V!~5#(Z!o1#([#%x#(]!mU#(_#'&#(i#%%#(j#&I#(k#(K"
+        "#(n!w!#(q!~y#(r#%(#(v$/z#(z#'3#(|#%&#)6#)=#)T#)B#)X#)J#)Z#)A#)`#)9#)a#)S#)d#)K#)f#).#+L#,*#+y#+D#,+$un#,2#JT#,A#*L#,F#+@"
+        "#,R#+K#,Y#+r#,l#7{#,n#K6#,q#*+#-*#*I#-+$KM#-/#+I#-2#+p#-7#jk#-:!wD#-C#*P#-E#+q#-V#7l#-Z#,M#-l#+B#-~#*R#.3#,Q#.8#*Q#.A#-{"
+        "#.D#+<#.M#*M#.Q#+H#.T#+q#.Y!|g#._#+(#.`#**#.a#*y#.c#*M#.e#*A#.f#*w#.g#*x#.i#*N#.p#*O#.v#.u#/$#.}#/&#/!#/'#7R#/K#/J#/M#],"
+        "#/P!p7#/j#/e#/|#/n#06#04#08#/m#09#/f#0;#0%#0=#/w#0L#1o#0n#0V#1>#1E#1B#1L#1[#0H#1`!qH#24#2K#2[#1z#3$#0W#3+#1{#3g#2L#3o#0|"
+        "#3|#3j#3}#0X#4.$Zj#4:#0{#4Y#0z#4`#2N#4d#31#4e#0|#4m#1|#4p#33#4q#1}#4~#4U#5%$Zj#5)#45#5,#5@#52#47#58#32#5A#34#5L#21#5U#1~"
+        "#5u#5c#6%#5p#6,#5t#6]#6Y#74#7/#78#6L#79#6.#7;#6O#7=!w:#7>#6l#7H#6N#7I#6K#7X!vH#7Z#7Y#7[!mC#7_#7N#7a#7L#7b#7O#8.#8+#8=#8B"
+        "#8E#8/#8K#8:#8T#8A#8Z#8Y#8]#89#8a#8_#8e#8V#9=!w)#:5#94#:7#97#:>#:!#:O#:E#:S#Tf#:Y#93#:[!oK#:e#:&#:o#9Z#;6#96#;i#;D#;l#:p"
+        "#;o#92#;|#;A#<!#:D#<+#:%#<-#:$#<2#9b#<9#:F#<@#95#<D#;>#<F#9J#<H#8x#<W#9]#<_#:'#<a#<Q#<c#9F#<}#<|#=V#=5#=]#=8#=e#=A#=h#=W"
+        "#=r#=X#=u#=@#>,#=n#>-#=m#>4#=M#>8#=1#>A#=`#>B#=c#>O#>H#>T!x&#@%#>j#@;!|q#@<!|~#@>!}(#@C!}%#@U!}'#@X!}-#@Z#>p#@[!|^#@]#>h"
+        "#@^#>v#@_#>U#@e#@f#@h#>g#@o!|a#@w#)*#A1#A0#A3!~.#AS#AJ#AU#A@#AW#AZ#Ag!xs#Ai#AY#Am#AE#Ao#AO#Az#g@#B!#A~#B)#B*#BD!p{#BQ!~2"
+        "#BV#BI#Bd!oH#Bf#BZ#Bo#/7#Br#B;#B{#BF#C!#B@#DU#Db#Du$CL#E8#EZ#ER#Ec#Eh#B}#Ej#Cp#Ek%$Y#Er!wg#F9#E)#FJ#E/#FK#E0#FT#E.#Fu#w{"
+        "#Fv#FE#G%#E`#G1#Cq#G4#E-#G;#Ci#GB#ZT#GE#eg#GI#Cl#GK#Fz#GV#FA#GX#FF#G^#E+#Gb#FH#Gc#E`#Gi#Co#Gj#Cm#Gm$TW#Gr#Eb#Gu#>]#G{#Ic"
+        "#G}#d;#H$#CQ#H,#FD#H2#D*#H3!x3#H4#G##H<#FG#HG#F~#HN#Ed#HQ#Cn#HU#6X#HY#C/#Hg!zv#Hk#E&#Hm#>k#Hp#DN#Hq#Hx#I%$Og#I&#DK#I*#Hu"
+        "#I/#E,#I5#CQ#I9#FB#I=#Hv#I>#Ck#I@#Ea#IB#C8#ID#F@#IF#GO#IH#DZ#IO#IN#I]#IS#Ip#I`#Ir#Iu#Iy#Ia#Iz#Ix#I{#IW#J!#J##K^#K,#La#M8"
+        "#Lv#LV#MD$HW#MG#JW#MN!|R#M`#JX#Ma#K2#Mt#LS#Mv#LZ#Mx#L8#M~$un#NA#Kv#N[#JY#N]#M=#Np#L]#O+#Xx#O2#M:#O;#On#O<#M>#OK#MR#OM#J3"
+        "#ON#Kf#O[#O##O]#K3#Oe#_z#Og#Lz#Ox#N4#P&#N<#P)#O'#P9#LQ#P=#K1#PA#K0#PE#K)#PF#N:#PS#M9#PZ#L^#P[#P]#P_#LW#Pf#MW#Pi!2D#Pk#LY"
+        "#Pn#N8#Po#N8#Pq#K{#Pw#K+#P~#J=#Q!#O$#Q*#LU#Q-#LT#Q.#M<#Q0#Kx#Q3#N3#Q6#K|#Q9!xB#Q:#LX#QC!2R#QD#KW#QJ#MJ#QP#L[#QS#M>#Q]#Kr"
+        "#Q`#Oo#Qa#Kz#Qb#O&#Qc#N7#Qe#JV#Qh#Q&#Qk#Om#Ql#QN#Qm#Q'#Qo#J^#Qu#Ol#Qw#Q$#R##Ku#R(#Ky#R*#PO#R-#O%#R/#Q)#R0#Oa#R1#Ok#R6#R&"
+        "#R7#LR#R8#Oq#R>#O*#RA#O!#Rm$hk#Rn!}Y#S.#Rb#S1#S)#S;#Rq#S<#f,#SO#SM#Sg#Sd#Sr#Sh#Sw!nd#Tg!{~#UF#TU#UM#UO#Ub#U@#V0#UY#V1#UZ"
+        "#VA#TW#VK$#[#VT#V*#VZ#U8#Vn#UX#Vp!|b#Vq#Ty#Vs#UW#Vy!~5#W##VP#W-#TV#W5#UA#W9#UV#WF!n:#WQ!p8#Wv$EB#Xe!mL#Y)!m[#Z1#ZB#[b#X8"
+        "#[w#Z<#[{#Y>#]##XT#]%#YE#]8#]H#]K#A!#]^#Y@#]_#Y:#]g#ZH#]o#ZE#]z#ZS#]~#]E#^:#[B#^w#X[#_##YC#_8#[D#_=!mJ#_F#Xu#_h$f1#_|#X]"
+        "#`#$LA#`'#_V#`4#[F#`A#Xx#`C#YB#`I#XS#`L#al#`Z#]F#`^#^L#`_#^,#`j#[J#`x#[K#`y!n$#`|#Y5#a+#[d#a-#_M#a3#ZD#a8#Y9#a=#Zu#aS#X&"
+        "#aT#ZN#aU#[H#ad#[C#ag#[G#a{#X,#a~#^Y#b*#aE#bA#bj#bI#Z9#bT#[E#b]#[I#b^#_;#b`#`P#bc#]G#bd#aJ#bo#]C#bp!}q#bt#`U#by#Yy#b|#`Q"
+        "#c'#Yu#c7#b8#c>#_Y#c@#ZF#cB#^K#cC#b;#cD#ZK#cJ#b0#cL#`V#cM#ZI#cO#Y<#cP#b$#cQ#_X#cV$Sx#cX#ZG#c^#_Z#c`#]I#ca#aL#cj#ZL#cp#X5"
+        "#cu#^P#cx#Z|#c|#_U#d'#]I#d>#dH#dG$}u#dX!}z#dZ#d0#df#Rq#dj#d-#dl#d+#d}#8z#e%!|b#e&#As#e-#e/#eG#e9#eM#eA#eS#e5#eW!9e#eZ#eI"
+        "#e^#eB#e_#eP#e`!9`#eb#e*#ej#X2#el#.z#ep#eq#ev#ed#f@#})#fS#fI#fV#xT#f]#f4#fa#f[#fx#fi#g##fw#g$#f~#g+#g*#g1!xC#g6#hz#gG#hz"
+        "#gR#gZ#gt!wU#h*!wS#h/#h>#h3!wT#h`!wW#im#hc#iz#gs#jb#j*#jp#iA#kI!wl#k`!wg#kh#i,#ks#l=#kv!wc#kx#hD#l&#l;#l'#k*#l+#j,#lK#k/"
+        "#lM!wr#lX#k-#l_#j2#lq#j8#l}!wt#m4#j/#m=#ju#mF#g^#m`#hG#mn!wi#mu#h<#n&#l[#n7#mV#n@#hE#nA#r~#nH#k0#nJ$LC#ni#hH#nl#nZ#no#lI"
+        "#nt!|>#nu#j9#nx#j7#n{#nV#n|#n^#n~#lF#o:#hB#oC#gB#oD#k+#oM#l>#oS#k4#oV#m^#oY#lB#oa#j-#oc%+s#os#i>#ov#iD#o{#hG#o}#o~#p)#k2"
+        "#p4#j;#p5#mZ#p<#nS#pE#k,#pF#k5#pL#j.#pM#k)#p^#k3#pg#lC#pk#i@#pm#ng#pp#i8#pu#j4#px#kM#q+#j1#q-#j:#q@#mV#qC#h}#qJ#j5#qO#k'"
+        "#qV#nb#qW#jB#q[#oo#q]#ne#qf#m]#qh#i<#qj#na#qq#n_#qr#l@#qs!:Z#qu#i=#qw#h%#q{#j6#r$#q<#r'#i:#r,#hC#r.#oi#r/#oh#r5#p9#r6#i9"
+        "#r7#q;#r@#AE#rB#om#rN#pc#rS#hA#rT#n]#rb#iU#rf#o3#ri#nf#rn#r`#rq#oE#rt#mU#ru#nc#rx#n[#s1#s2#sp!mk#t(!m}#tN#sy#t|#T>#uH#sr"
+        "#uQ#sQ#uX#t8#ub$KN#ue#tp#ui#t@#ul#s4#uq!=G#v(#ut#v5$LE#v:#sR#vU#tG#vV%+t#vc#ss#vf#tB#vi#u.#vm#s##vn#sK#vu$.##vw#tA#v~#tE"
+        "#w$#tq#w'$NM#w.#s3#w4#eq#w5#t4#w<#tC#w>!=@#wD#v2#wE#tF#wG#ts#wH$Bm#wV#sw#wY#s=#we#sx#ww!n_#w|!mk#x'#x$#x+#7h#x-#>a#x3#-{"
+        "#x8$4E#xF#x:#xl#xd#y($LD#y4#xy#y9#xi#yS#yI#z0#z$#z4#y[#zQ#z'#zo#yL#zt#z)#zz#yK#z|!~l#z}#z(#z~#z%#{*#0%#{E#z##{G#z&#{H#z:"
+        "#{K#yq#{M#yr#{N!@b#{O$M9#{R#zF#{T#yJ#{U!v{#{W#{J#{X#zg#{Y#zM#{^#zY#}$#|1#}b#|R#}g#|u#}s#|/#}z#{x#~.#}6#~/#~B#~4$M;#~5#{y"
+        "#~:#}+#~=#|2#~U#}5#~p#{o#~s#~C#~x#|s#~}#|0$!-#|;$!:#}d$!@#|S$!E#~Z$!K$!C$!~$!a$#*$!`$#7!n}$#8!n}$#t!o!$#y#f($$%$#Q$$*#@~"
+        "$$0#At$$B$$.$$E!}a$$|!p}$%8$%($%@$tz$%_$$p$%c$%5$%l$$k$%n$$]$%t$%J$&!$%x$&%$$j$&+$$Z$&2$%g$&6$$i$&>$%y$&@$%y$&G$$R$&K$%H"
+        "$&L$%K$&N$%f$&W#Fb$&^$$[$&e$&.$&g$%T$&h$%1$&j$$Q$&k$%&$&m$$h$&o$&d$&r$&i$&s$&D$&t$&C$&v$%'$&w$&/$&x$&q$'%!}Q$'*$'+$'D$':"
+        "$'Z$$m$'c$']$'e$'[$'n#Xc$(*$(%$(,$'z$(/#84$(1$'|$(2$(&$(5!|<$(8$L>$(n$(o$(u$(v$)1!p5$)C#)<$)P$)4$)R$)D$)_$)s$)|$)!$*0$(]"
+        "$*4!Ed$*6$**$*F!n[$*O$){$*U$)E$*m$(|$*t$*B$+,$+($+q#sd$,1$+R$,>$,#$,G$,8$,K$+U$,R$+X$-0$,7$-4$+=$-@$+Z$-B$,Q$-D$+>$-Y$,;"
+        "$-c$+T$-l$-#$-p$-!$-x$+3$.)$,9$.2$,Z$.:$,!$.F$,q$.N$.b$.S$+<$.W$+y$.X$+}$.Y$+;$.[#sd$._$+z$/&$0O$/Q$/V$/`$/J$/a$/A$/h$.|"
+        "$/t$.q$/y#Bg$/}$/W$0$$.j$0&$/3$0'$/I$05$09$0>$7w$0}$1)$1#$0<$1*!HE$17#]y$1:$/R$1J$0D$1M$0h$1]$f1$1i$1>$1j$0g$1k%+|$1}$0v"
+        "$1~$1n$2!$0u$2)$1O$2+$M9$2-$0~$2k$2_$2l#j#$2p$27$2q$2R$2w$2O$2x$2o$2|$2g$3)$2^$3*$2N$3,$2h$3-#s*$3/$2D$3P$3;$3]$3D$4Q$3{"
+        "$4X$3r$4s$3|$5#!J7$56!mZ$5:$4E$5=$6>$5>$4i$5M$~%$5q$Ir$5u$K;$5z$4]$5|$5W$6($5+$68$3j$6=$4g$6H$4f$6U$5V$6[$4d$6c$6'$6t$5Z"
+        "$6w$5/$6y$6%$7$$5[$70#bP$72$4h$76$5-$77#=I$7<$6C$7F$5($7J$SE$7S$5C$7V$5X$7Y$7:$7Z$4G$7_$5-$7d$4I$7e$6l$7g$6F$7i$5Y$7m!~%"
+        "$8F#0V$8T$8C$8}$8a$8~$8I$9*$8M$93#).$95$8;$97$7o$99$8:$9<$=x$9B$=y$9D$>&$9F$=|$9H$>!$9I$={$9J$=z$9K$=~$9L$>$$9M$>'$9O$>5"
+        "$9Q$>/$9T$>9$9W$>:$9X$>+$9Y$>,$9Z$>8$9[$>-$9]$>*$9^$>4$9_$>#$9`$>3$9a$>)$9b$>0$9f$>6$9q!Mm$9s#J:$9u$>C$9v$>>$9w$>=$9x$>B"
+        "$9z$>7$9~$>J$:!$><$:$$>H$:'$>M$:($>I$:*$>E$:+#AF$:,$>A$:-!Mo$:.$>G$:6$>T$:8$>P$:=$>Z$:D$>d$:F$>Q$:G$>[$:J$>Y$:K$>W$:O$>V"
+        "$:Q$>O$:Y$>S$:Z$>]$:[!mM$:]$>X$:`$>Z$:c$>`$:k$>N$:m$>_$:p$>^$:r$>f$:s$>a$:v$>b$:y$>c$:z!Mr$:{#L~$:}$>L$;)$>z$;+$@.$;-$>}"
+        "$;/$>v$;0$>y$;8$>;$;9$>t$;:$>r$;<$>w$;=$>|$;>$>.$;@$@t$;A$>u$;B$>~$;C#B-$;F$>2$;G$>x$;H$>l$;I$>{$;K$>n$;L$>i$;M$>s$;R$>p"
+        "$;U$@!$;X$9l$;Y$>m$;`$>}$;a$>h$;b$>j$;c$>o$;f$@$$;g$@%$;h$@#$;i$>;$;l$@*$;m$@/$;o$@5$;p$@8$;r$@9$;u$@-$;w$@7$;x$@4$;{$@&"
+        "$;~$>($<#$@2$<$$@)$<&$>@$<($@0$<+$@($<-$H=$<:$NN$<;$@:$<<$@D$<=$@3$<C$>F$<D$@E$<H$@+$<J$@@$<N$@;$<P$@=$<Q$@A$<R$@<$<V!}>"
+        "$<Z$>d$<_$@>$<a$@C$<b$@K$<e$>1$<f$@I$<g!Mn$<h$=}$<i$@H$<j$:a$<k$@6$<m$@G$<q#DJ$<r$>g$<w$>u$<y$@M$<z$@L$=)$@Q$=+$>D$=,$@P"
+        "$=1$@O$=5$>R$=8$>a$=9$@,$=A$>q$=B$>U$=C$9>$=E$Ka$=F$@R$=G$@U$=H$@T$=K$@V$=P!Mw$=Q$>K$=T$>e$=U$@F$=V$@S$=W!Mv$=a$@N$=c$>%"
+        "$=e$>k$=f$9t$=h$@B$=l$@J$=m#J9$=o$=}$=q$@W$=u$@'$@`$~'$@k#*M$@o$@e$@q#*M$A)#L8$A6$@}$A;%1E$A=$A($AL$@z$AM$A:$AO$AH$AR$Ix"
+        "$Ak$Al$Am$Ag$Ap$Ai$Aq!mz$A~$Ga$B=!n4$BW#|*$Bf$BD$Bg$B^$C<$C7$C>$C2$Ch#)q$Cp%$^$D$$Cf$D%$C|$D'#.w$D($CI$D*$C{$D+$CS$D,$C^"
+        "$D.$C_$D2!~Q$D3$C]$D:$D8$Ea$Dx$Ed$Ee$Ew$EF$F!##w$F*$F0$F8$Dw$FN$Du$FV$EC$Fb$F5$Fg$Em$Fl$Dv$Ft$Ev$Fy$DV$G'$F~$G>$DZ$GE$EQ"
+        "$GN$F|$Gc$D}$Gd$Ei$Ge$Eo$Go$F7$Gs$El$Gu$G5$G~$FJ$H#$EE$H($Ek$H)$Ep$H+$H%$H.!|B$H1!me$HD!}q$HQ!m=$HR!vr$HS!mo$HT#TF$Ha$~n"
+        "$IH$H|$IS$Hn$IU$H{$IZ$I)$Ia$I`$Ig$Ic$JO!xT$Jc$J|$J|$Jc$Kl!vw$L'$L#$LQ$fA$Li#>Z$Lu$KG$M$$L7$M)$J`$MV#Y3$Ms!|($M|#t8$N.$Ja"
+        "$N1$M3$NT!m6$N^$M6$Nr!}w$N{$LK$O#$)3$O0$LL$O2$J[$O;$LM$OD$LB$O^#OB$Oa$M>$Ob$M5$Ol$Ld$P-$Jb$P1$LH$P7#=_$P<$($$Pa$M4$Pb$JU"
+        "$Pp$L9$Q*!|6$Q4$OY$Q9$OX$Q;$O=$Q<$KJ$QD$LI$QK%=9$QX$LF$Q^$OT$Qf$L;$Qj$LJ$Qk$JL$Qm$M:$Qp$L8$Qz$OV$R$$L>$R%$J/$R($NO$R2$PU"
+        "$R;$R+$RD$L<$RF$PQ$RH$J*$RM#1Q$RP$QN$RT$L6$R[$M8$Rc$L-$Rf$NP$Rp!RC$Rq$J|$Rw$L=$S)!s,$S-$PO$S.$LG$S=$Ij$SF$LM$SK$Rk$SU$R/"
+        "$SW$J]$SX$Rl$SZ$QS$S[$QQ$Sf$R-$Sh$J9$Si$Jd$Sl$R/$Sm$K1$S|$S3$T#$QP$T'$KH$T2!vn$T@$PR$TE$NE$TL$Pu$T[#/.$Tb$Ta$Tc$TU$Tf!}x"
+        "$Tn!ne$Tv$Ts$VJ$VA$VK$Vf$VV$UW$WJ$U*$WT#ze$W[$U($W^$Tx$Wn$Vh$Wz$VC$X7$U,$X;$NL$XH!U2$XU$Wr$XY$Wv$X_$V@$Xc$W<$Xi$XB$X~$Tu"
+        "$Y*$W=$Y-$VB$Y0$Tr$Y4$U{$Y9$U+$YD$W;$YE$U)$YL$WC$YO$VD$YP$Wt$YS$UH$Y_$Vr$Yc$Uz$Yg$Yy$Yh$Xj$Yq$Uv$Yv$U@$Y{$V=$Z)!p5$Z-$Q'"
+        "$Z6#W~$Z=$E;$Z>!|F$ZA!wT$[&$ZR$[<$>Q$[S$Zj$[X$us$[f$ZI$[g$[N$[k$us$]*!x~$]4#/7$]9$[Q$]F$Zk$]a$[n$]b$[l$]g$]I$]j!o.$]v$[o"
+        "$]~$[7$^($Zi$^/$[m$^2$[O$^6$]c$^<$[$$^>!VU$^B$ZP$^E$[5$^[#Zv$^_$_8$^b$_:$^c$_;$^g$_<$^j$_=$^l$_>$^u$_C$^y$_E$^z$_F$^~!o+"
+        "$_#$_B$_&$_G$_)$_H$_.$_I$_1$_A$_4$_@$_6$_D$_7$_9$_m$_V$_o$_h$_q$__$_z$dQ$_{$dS$_|$dT$`$$dR$`&$da$`($dX$`*$dY$`,$dW$`.$dc"
+        "$`/$d_$`1$d[$`2$d]$`3#JE$`4$db$`7$dk$`9$dh$`;$dn$`>!Xp$`@$dr$`B$di$`F$dm$`G$dq$`J$dp$`N$dj$`Q$d{$`S$du$`W$d|$`X#i*$`Y$ds"
+        "$`_$dt$`d$d}$`l$dg$`n$dz$`p$e'$`r$e$$`s$dv$`t$e%$`u$dy$`v$e#$`y$dw$`|$e!$`~#!Y$a!$e>$a#$e7$a$$e8$a'$e*$a*$e,$a,$e<$a-$e4"
+        "$a.$e6$a/$e5$a1$e-$a2$e2$a3$e:$a4$e;$a6$e1$a=$e.$aA$e+$aF$e)$aG$e0$aH$e($aI#/d$aN#CA$aO$dU$aS$eI$aT$eL$aW$e3$aZ$eG$a]$eD"
+        "$aa$eC$ac$e/$ad$eA$af$eB$ag$eE$ah$eF$ai$eK$ak$eH$am$eJ$ao$eJ$as$eW$au$eT$ay$e^$a|$eS$b!$ea$b$$`6$b%$eY$b($eZ$b*$e]$b-$e_"
+        "$b/$eU$b1$eM$b3$e9$b5$eO$b7$eR$b8$e[$b<$dl$b=$eX$bB$eV$bC$ed$bD$eu$bE$et$bH$e|$bI$e=$bK$ek$bM$er$bN$eg$bR$ef$bT$el$bU$eo"
+        "$bX$de$bZ$ep$b^$ec$b_$do$b`$eN$bb$eq$bd$em$bf$eP$bh$eb$bi$ei$bj$ej$bl$aL$bm$d~$br$ee$bv$es$bx$e~$b|$eh$b~$ex$c!$e{$c$$e}"
+        "$c%$e|$c&$dd$c($ey$c+$ez$c,$ez$c3$ev$c6$f$$c7$f&$c8$f%$c>$df$cE$f!$cJ$f#$cM##F$cQ!Xt$cU$ds$cZ$f,$c[$dV$cc$f($ce$dx$cf$f)"
+        "$cg$f'$ci$f+$cl#'n$cx$f/$c|$e&$c}$d`$d$$f.$d'#K5$d($e@$d-$aK$d.$f%$d0$eQ$d:!}X$d<!Xv$d>%'0$dC$en$dD$dZ$dF$f*$dG$f0$dK$iH"
+        "$dM$ew$dO$f-$fC#8{$fI$3;$fK!ma$fO$Ic$fh#zc$fr$fj$g,#z/$g2#zd$g8!YJ$g<$hc$g=$hd$g>$hf$g@$he$gA$hh$gB$hg$gG$hq$gH$hm$gI$ho"
+        "$gJ$hp$gK$hu$gL$hi$gO$ht$gP$hy$gR$i)$gS$hv$gT$h{$gV$hr$gW!nE$gX$h}$gZ$h|$g[$i!$g]$hz$g^$i$$g`$h~$ga$i#$gb$hx$gc$i+$gd$i*"
+        "$ge$i($gf$i.$gh$i-$gi$i'$gk$i%$gr$i1$gs$i3$gt#6m$gv$i0$gz$i;$g{$i2$g}$i9$h!$i8$h$$i=$h%$i<$h&$hj$h'!|0$h($hw$h*$i4$h+$i>"
+        "$h.$hn$h/$i6$h0$hl$h1$i5$h4!Z%$h8$i@$h9$iA$h<!yU$h>$iD$h@$iC$hA$hs$hB$iE$hC$iF$hI$i&$hJ$iB$hL$iI$hM$iJ$hO$iH$hP$iG$hR$iK"
+        "$hT$iL$hU$i/$hX$i,$hY$i:$h[$i7$h]$iG$ha$iM$hb$i,$iV$iT$j#$ia$j'$i`$j6$iv$jA$j@$jq$pg$jt!nz$k/#87$kD$k($kU$W+$ke$qP$ki$k="
+        "$l$$jS$l-$k+$l7$pg$l;$l*$l<$k_$l@$9!$lS$k*$l[$k)$lc$jG$ld$k@$le$k.$lg$jR$lk$kd$ll$jn$lm$ka$lo$lI$lt$k,$l{$l)$m!$lX$m#$lv"
+        "$m'$li$m=$m,$mH$o-$mI$o.$mJ$o/$mK!w<$mO$o1$mP$o0$mR$o2$mY$o4$m^$o6$mc$o>$mj$o@$mq$o8$mw$o;$mx$o<$my$oB$mz$o9$m{$o=$m}$oD"
+        "$n%$oK$n'$oJ$n)$oI$n*$oH$n+$oE$n,$oF$n4$oL$n5#Lu$n6$oM$n7$oC$n=$oN$n>$oV$n@$oQ$nA$oS$nB$oU$nH$oR$nI$oO$nL$oP$nM$o5$nO$oT"
+        "$nR$oY$nV$oW$n[$o[$n_$oX$nb$o`$nc$HP$nd$oZ$nf#er$nh$o_$ni$o^$nj$oa$nm$o3$nq$ob$nr$oG$nx$oc$o$$HP$o&$o7$o($o]$o)$oA$o+$o:"
+        "$oo!z.$ov$og$ow$ot$ox$or$o{!w=$pb#)*$q&$pa$q*$pF$q4$pK$qC#!1$qD$pH$q]#lk$q^$p<$qa$p3$qg$p*$qh$pJ$ql$qx$qo$px$qq$q#$qs$pI"
+        "$q|$pp$r%$qS$r($pL$r-$p-$r.$pw$r0$qj$r2$p)$r7$p4$r:$pE$r=$pV$rA$p%$rF$qM$rG$q7$s:$s*$sQ$rf$sc$s.$sf!n5$so$rq$sq$rd$ss$sC"
+        "$t'$rJ$t-$s,$t0$rs$t2$sT$t4$rr$t6$s+$t:$rT$tH$tC$tI$sB$u($FL$u;$t_$uB!mA$uD$t_$uQ!{r$uR$ts$uW$th$uc#6c$ug$u$$uh$Z($uj$u#"
+        "$ul$u!$ur$uq$uw!|t$uy$}S$uz$}T$u{$}U$u|$}Z$u~$}X$v!$}W$v#$}Y$v'$}V$v-$}b$v.$}_$v0#JP$v1$}^$v3$}a$v@$}f$vB$}[$vD$}d$vE$}]"
+        "$vK$}~$vL$}z$vN$}g$vO$}|$vS$}i$vT$}o$vX$}l$vY$}x$v[$}s$v]$}r$v^$}`$v`$}m$va$}}$vj$}v$vo$}h$vq$}{$vr$}j$vs$}y$vz$~>$v|$~:"
+        "$w!$~($w#$~5$w&$~&$w'$~+$w($~@$w)$~!$w,$~*$w-$~2$w.$~1$w/$~0$w4$}k$w7$~<$w8$~;$w:$~9$w<$~=$wA$~4$wE$~)$wG$~%$wJ$~8$wK$~7"
+        "$wN$~,$wR$~'$wT$}x$wV$~$$w]$~.$w^$~/$wg$~B$wi$~d$wk$~E$wl$~`$wp$~^$wq$~j$wt$~g$wv$~O$w~$~M$x%$~V$x'$~[$x*$~U$x,$~a$x.$~_"
+        "$x/$~Y$x0$Z7$x4$~D$x7$~k$x9$~e$x:$~R$x<$~i$x=$~X$x>$~H$x@$~c$xA$~C$xF$~Q$xG#te$xH%!'$xL$~t$xN$~|$xP%!($xQ$~}$xV$~P$xX%!)"
+        "$xZ%!#$x]$}p$xb$~W$xe$~J$xh%!!$xo$~o$xs$~~$xu%!*$xy$~K$xz$~x$x{$~w$x|%!+$x~$~{$y!$~F$y#$~n$y&%!'$y'$~I$y($~z$y)$~v$y*$~q"
+        "$y/%!$$y1%!G$y5$}q$y:%!5$y=#Av$y@%!-$yA%!C$yB%!A$yI$~G$yJ%!<$yL%!,$yO%!6$yR%!;$yS%!I$yT$~b$yU%!2$yY%!D$yZ%!E$y[%!3$y]$~#"
+        "$ya%!=$yc%!1$yd%!7$yf%!8$yi%!9$yj%!0$ym#Av$yn%!H$yq$ZL$ys$~p$y{%!4$y|%!@$y~%!B$z$$}c$z%%!L$z&%!K$z(#sr$z)$~y$z+%!X$z2%!O"
+        "$z6$~T$z8$}e$z9%!S$z>%!U$zC%!P$zD%!J$zH%!/$zK%!Q$zO%!V$zT%!F$zU%!N$zY%!.$z^$}n$zb%!Y$zd%!W$zg%!^$zj%!j$zt%!n$zv$~u$zw#YB"
+        "$zx%!b$zz%!;$z{%!a${$%![${%$}w${&$PW${)%!h${*$~S${,$~]${-%!T${/%!i${1%!`${3%!k${5%!d${6%!f${8%!l${;%!e${C%!g${G%!w${K%!x"
+        "${L$~r${P%!_${Q%!r${T%!y${U%!v${[$~s${]%!M${a%!p${b%!q${c%!t${d$~f${f%!u${g%!o${i%!Z${m$yy${u%!s${z$~Z${|%!}${~%#&$|%$~|"
+        "$|+$~L$|3$~h$|8%!|$|:$~m$|;%#!$|<%!z$|A$}n$|B%#'$|F%!{$|I%#$$|O%!%$|P%!&$|Q%!]$|T%!e$|W%#,$|[%#+$|]%#)$|_$~3$|`%#*$|b$~A"
+        "$|d$~N$|i%#-$|n$~l$|t%#($|v%!m$|{$we$||$we$|~%#.$}!%!>$}+%#0$}-$~6$}0%#/$}2%!~$}:%##$}=$}t$}>%#1$}@%#2$}E%!c$}G%#%$}J%!:"
+        "$}K$~-$}L$xC$}M!xF$}O!`U%#3%#;%#<%$J%#>%$K%#@%$L%#C%$M%#E%$N%#F%$O%#H#@|%#I%$X%#K%$U%#L%$R%#N%$T%#O%$T%#P%$V%#Q%$W%#U%$Z"
+        "%#_%$e%#`!vq%#a%$d%#c%$c%#e##2%#f%$]%#g%$`%#i%$f%#j%$i%#k%$a%#o%$h%#p%$h%#t%$m%#w%$l%#y%$q%#z%$r%#{%$p%#|%$k%#}%$o%$$%$u"
+        "%$'#Xs%$(#V@%$)%$S%$+%$w%$,%$x%$-%$t%$.%$j%$1%$z%$3%${%$4%$b%$5%$y%$6%$|%$7%$Q%$9#SQ%$=!vq%$@%$}%$B%$v%$C%$s%$D$oh%$F%$~"
+        "%$G%$_%%.!|`%%0#*3%%`%%P%%e%%]%%f!{~%%k%%;%%x%%:%%{%%O%&#%%M%&(%%9%&/#,a%&4%%o%&5%%%%&9%%<%&A%%p%&G%%L%&T%&:%&V%%q%&^%&;"
+        "%&a%%N%&e%&c%&h!}k%&x%&j%'&$U'%')!}L%'+%&|%',#X4%'.%;V%'2$01%'3%&k%'C!ng%'L$#K%'c#h]%'t%'s%'y%'O%(2%'R%(7%'D%(9%(!%(=#s)"
+        "%(P%(I%(R%(O%(]$F}%(_%([%(n$>8%(w%>:%))#<v%)7$>o%)X%),%)]$@R%)_%)+%)e%)J%)g%*%%)h%*&%)i%*'%)o%*(%)u%*)%)x%*+%)z%**%*-%*,"
+        "%*:%*4%*>##;%*A%+Z%*B%+[%*C%+]%*E%+_%*F%+`%*G%+^%*H%+a%*J%+b%*L%+h%*N%+f%*O%+i%*P%+j%*Q%+c%*R%+g%*S%+e%*W%+m%*X%+l%*]%+r"
+        "%*b%+o%*e%+v%*g%+u%*n#/`%*o%+x%*q%+p%*s%+q%*u%+{%*x%+z%*y%+n%*z%+y%*|%+w%*~%+y%+*%+}%+0%+~%+1%,&%+2%,#%+3%,%%+6%,!%+7%,$"
+        "%+8%,%%+<#G<%+=%,*%+@%,)%+C$7v%+G%,(%+J%,+%+L%+d%+P%,-%+Q%,.%+T#UB%+U%,/%+V%+k%+X%,'%+Y%,0%,1%,X%,6%,Z%,7%,[%,8%,]%,:!}q"
+        "%,<!xv%,@%,^%,B%,_%,D%,Y%,E%,a%,F%,`%,J%,b%,N%,c%,P%,d%,R%,e%,f%,i%,k%.6%,m%.8%,n%.7%,p%.9%,t%.;%,u%.=%,v%.>%,x%.@%,z%.A"
+        "%,}%.B%-!%.H%-*%.F%-+%.E%-,%.D%--%.G%-1%.N%-2%.L%-3%.P%-7%.K%-8!vy%-:%.I%-<%.M%-=%.O%-@%.Q%-A%.U%-B%.S%-D%.V%-E%.R%-G!py"
+        "%-I$Dk%-J%.X%-K%.W%-M%.C%-P%.Y%-W%.Z%-[$8j%-a$8g%-c%.:%-e#%:%-f%.^%-g%.[%-j%.c%-l%.<%-m%.]%-n%.d%-o%._%-q%.a%-s%.b%-u%.g"
+        "%-x%.e%-y%.f%-z%.h%-{%.]%-|%.i%.$%.8%.%%.J%.*%,s%./%-;%.1%.`%.5%.j%/$%1.%/%%1/%/&!wQ%/)%10%/+%12%/,%11%/1%14%/9%15%/I%1="
+        "%/J%1@%/K%1;%/M%17%/N%1A%/Q%1C%/R%1:%/T%18%/V%1>%/X%19%/Z%1E%/[%1K%/g%1J%/j%1F%/k%1I%/r%1Q%/y%1R%/{%1N%/|%1P%0!%1V%0)%1W"
+        "%0*%1U%0+%1T%0,%1S%03%1_%06%1Z%0B%1]%0E!fr%0I%1b%0K%1[%0L%1a%0N$G!%0T%1<%0U%1^%0V%1c%0]%1e%0_$PX%0`%1`%0a%1Y%0b%1d%0c%1f"
+        "%0d%13%0i%1H%0k%1X%0l%1D%0n%1g%0t%1G%0v%1O%0y#F!%0z%1B%0~%1h%1$%16%1&%1k%1'%1i%1(%1j%1,%1M%1-%1L%1s$De%26%2,%29$Ek%2;!ps"
+        "%2<%23%2=%22%2V!}Q%2i!y.%2o#Xr%2v$E;%3&%+a%3.%2|%31#SQ%33%$[%34##2%35%$n%39#SQ%3:%$g%3=$ry%3[%3V%3f%3T%3h%6y%3i%6z%3p%6{"
+        "%3v%6}%3}%6~%4%%7!%4(%6|%4+%7$%42%7%%44%7&%4;%7,%4<%7)%4>%7/%4@%7'%4B%70%4C%7-%4D%7+%4E%7*%4L%72%4N%78%4O%7>%4P%75%4X%76"
+        "%4]%74%4^%7;%4`%71%4a%7<%4f%73%4i%7K%4m%7=%4s%7H%4t%7A%4z%7J%4|%7E%4}%7I%5(%7M%5*%7]%5+%7P%5,%7N%51%7X%53%7U%57%7R%58%7V"
+        "%5:%7S%5=%7T%5>%7Y%5A%7O%5B%7Q%5G%7W%5K%7[%5N%7b%5T%7L%5V%7l%5X%7j%5Y%77%5Z%7d%5`%7_%5a%7i%5e%7g%5g%7`%5h%7f%5j%7h%5k%7e"
+        "%5t%7t%5w%7s%5x%7m%5{%7F%5}%7q%6#%7p%6$%7r%6(%7o%6)%7c%6,%7C%6-%7n%6.%7u%60%7z%62%7G%64%7D%65%7Z%66%7y%67%7}%69%7v%6=%7k"
+        "%6A%7{%6D%7w%6E%7x%6N%8$%6P%8!%6R%7~%6S%8#%6T%7@%6Y%7^%6[%7.%6]%79%6`%8(%6a%8&%6d%8'%6e%7a%6j%7:%6l%8%%6t%7f%6u%7(%6w%7B"
+        "%8*%;T%8,!x1%8.%;U%81!x1%87%;Y%88!x*%89%;X%8;%;W%8D!jT%8L%;_%8M%;^%8O%;[%8X%;f%8[%;k%8b%;i%8d%;h%8e%;d%8f%;g%8j%;`%8m%;e"
+        "%8o%;c%8v%;n%8w%;o%8{%;q%8~!jV%9%%;u%9)%;s%9+!jU%9,%;p%9-%;r%9:%;v%9;%;y%9<%;|%9=%;w%9G%;~%9H%;{%9K%;z%9L%<!%9U%<%%9W%<("
+        "%9Y%<)%9Z%<'%9^%<#%9c%<,%9j%<&%9p!jW%9s%;a%9u%<*%9v%<+%:!%<$%:%%<2%:'%<.%:)%<0%:0%</%:4%<4%:8%<5%:9!jX%:;%;]%:>$M<%:B%<8"
+        "%:D%<=%:I%<9%:J%<:%:K%<1%:L%<<%:P%<3%:Q%<;%:R%<7%:T%;V%:X!jY%:Z%<6%:d%<A%:g%<>%:h%;Z%:j%;m%:k%<B%:v%;l%:w%<D%:|%<-%;#%<C"
+        "%;&%<E%;'%;}%;,%<F%;-%<J%;.%<G%;1%;j%;3!jZ%;6!<o%;;%<I%;A%<K%;D%<L%;J%;b%;M%<N%;O%<@%;P%<M%;R%;x%;S%;t%<O!|>%<S##&%<T%<X"
+        "%<V$-8%<W$'{%<r!mn%=!$85%=#%=$%='%=6%=-#W@%=3%(X%=:!my%=;!my%=B%=C%=K%=H%=^#so%=h!vW%=r%=j%=t%'Z%=v%=a%=w%=i%=}%=~%>!%>."
+        "%>*%7n%>+%7x%>,%>0%>8!wN%>X%>^%>o%>u%>p#SE%>s$i6%>t%>v%>w%@H%>y%@I%>z%@J%>|%@K%>~%@N%@$%@P%@'%@L%@(%@O%@)%@M%@+!xA%@.%@Q"
+        "%@/#%&%@1#!w%@2%@S%@4%@R%@:%@T%@>$Fn%@@%@U%@V%@c%@W!|l%@Y#>u%@^%@d%@_%@e%@f%@i";
+
+    // 常见多音字的其他读音，这样"chongqing"能找到重庆，"yinhang"能找到银行
+    struct pinyinAlternate {
+        uint16_t codePoint;
+        const char* syllable;
+    };
+
+    const pinyinAlternate g_pinyinAlternates[] = {
+        {0x4E50, "yue"}, {0x4E86, "liao"}, {0x4F1A, "kuai"}, {0x4F20, "zhuan"}, {0x4FBF, "pian"}, {0x533A, "ou"},
+        {0x5355, "chan"}, {0x5355, "shan"}, {0x5361, "qia"}, {0x53A6, "xia"}, {0x53C2, "shen"}, {0x53F6, "xie"},
+        {0x5426, "pi"}, {0x548C, "hu"}, {0x548C, "huo"}, {0x5730, "di"}, {0x585E, "se"}, {0x58F3, "qiao"}, {0x5927, "dai"},
+        {0x5947, "ji"}, {0x5BBF, "xiu"}, {0x5C06, "qiang"}, {0x5C5E, "zhu"}, {0x5DEE, "chai"}, {0x5E7F, "an"},
+        {0x5EA6, "duo"}, {0x5F97, "dei"}, {0x6076, "wu"}, {0x6298, "she"}, {0x63D0, "di"}, {0x6570, "shuo"},
+        {0x66FE, "zeng"}, {0x671D, "zhao"}, {0x671F, "ji"}, {0x6734, "piao"}, {0x67CF, "bo"}, {0x67E5, "zha"},
+        {0x6821, "jiao"}, {0x6A21, "mu"}, {0x6BB7, "yan"}, {0x6C88, "chen"}, {0x6CA1, "mo"}, {0x7684, "di"},
+        {0x76D6, "ge"}, {0x76DB, "cheng"}, {0x7701, "xing"}, {0x7740, "zhao"}, {0x7740, "zhuo"}, {0x77F3, "dan"},
+        {0x79CD, "chong"}, {0x79D8, "bi"}, {0x7CFB, "ji"}, {0x7ED9, "ji"}, {0x7F2A, "miao"}, {0x85CF, "zang"},
+        {0x8840, "xie"}, {0x884C, "hang"}, {0x89C9, "jiao"}, {0x89D2, "jue"}, {0x89E3, "xie"}, {0x8BF4, "shui"},
+        {0x8C03, "tiao"}, {0x8F66, "ju"}, {0x8F6C, "zhuai"}, {0x8FD8, "huan"}, {0x90FD, "du"}, {0x91CD, "chong"},
+        {0x957F, "chang"}, {0x964D, "xiang"}, {0x9732, "lou"},
+        {0xFFFF, ""}  // 结束标记，大于上面所有的码位
+    };
+
+    /**
+     * @brief 上述表中一位base-91数字的值。数字为'!'到'~'，不含'"'、'?'和'\\'
+     */
+    unsigned base91Digit(char c) {
+        return static_cast<unsigned char>(c) - 0x21 - (c > '"') - (c > '?') - (c > '\\');
+    }
+
+    /**
+     * @brief 汉字的读音，参见g_pinyinSyllables
+     * @return 码位不是已知读音的汉字时为0
+     */
+    unsigned pinyinReading(uint32_t c) {
+        const char* digits;
+        if (c >= 0x3400 && c < 0xA000) {
+            digits = g_pinyinReadings + (c - 0x3400) * 2;
+        } else if (c >= 0xF900 && c < 0xFB00) {
+            digits = g_pinyinCompatibilityReadings + (c - 0xF900) * 2;
+        } else {
+            return 0;
+        }
+        return base91Digit(digits[0]) * 91 + base91Digit(digits[1]);
+    }
+
+    /**
+     * @brief 将繁体字折叠为简体字，其他码位原样返回
+     */
+    uint32_t simplifiedCodePoint(uint32_t c) {
+        // 只解码一次为（繁体，简体）对，查找只需简单的二分查找
+        static const std::vector<std::pair<uint16_t, uint16_t>> pairs = [] {
+            std::vector<std::pair<uint16_t, uint16_t>> decoded;
+            for (const char* p = g_traditionalToSimplified; p[0]; p += 6) {
+                unsigned traditional = (base91Digit(p[0]) * 91 + base91Digit(p[1])) * 91 + base91Digit(p[2]);
+                unsigned simplified = (base91Digit(p[3]) * 91 + base91Digit(p[4])) * 91 + base91Digit(p[5]);
+                decoded.emplace_back(static_cast<uint16_t>(0x3400 + traditional), static_cast<uint16_t>(0x3400 + simplified));
+            }
+            return decoded;
+        }();
+
+        if (c < 0x3400 || c >= 0xA000) return c;
+        auto it = std::lower_bound(pairs.begin(), pairs.end(), std::make_pair(static_cast<uint16_t>(c), static_cast<uint16_t>(0)));
+        return it != pairs.end() && it->first == c ? it->second : c;
+    }
+
+    /**
+     * @brief 码位在g_pinyinAlternates中的第一项，没有其他读音时为nullptr
+     */
+    const pinyinAlternate* findPinyinAlternates(uint32_t c) {
+        const pinyinAlternate* end = g_pinyinAlternates + sizeof(g_pinyinAlternates) / sizeof(g_pinyinAlternates[0]);
+        const pinyinAlternate* found = std::lower_bound(g_pinyinAlternates, end, c, [](const pinyinAlternate& entry, uint32_t key) {
+            return entry.codePoint < key;
+        });
+        return found != end && found->codePoint == c ? found : nullptr;
+    }
+
+    /**
+     * @brief 解码p处的UTF8序列并前进到其后。无效字节逐个解码为U+FFFD
+     */
+    uint32_t nextCodePoint(const unsigned char*& p, const unsigned char* end) {
+        uint32_t c = *p++;
+        if (c < 0x80) return c;
+
+        int extra;
+        uint32_t minimum;
+        if ((c & 0xE0) == 0xC0)      { extra = 1; c &= 0x1F; minimum = 0x80; }
+        else if ((c & 0xF0) == 0xE0) { extra = 2; c &= 0x0F; minimum = 0x800; }
+        else if ((c & 0xF8) == 0xF0) { extra = 3; c &= 0x07; minimum = 0x10000; }
+        else return 0xFFFD;
+
+        const unsigned char* start = p;
+        for (int i = 0; i < extra; ++i) {
+            if (p == end || (*p & 0xC0) != 0x80) {
+                p = start;
+                return 0xFFFD;
+            }
+            c = (c << 6) | (*p++ & 0x3F);
+        }
+        if (c < minimum || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+            p = start;
+            return 0xFFFD;
+        }
+        return c;
+    }
+
+    void appendCodePoint(std::string& out, uint32_t c) {
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+            return;
+        }
+        if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        }
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+
+    /**
+     * @brief 为拼音搜索折叠码位：ASCII和全角拉丁字母转为小写ASCII，
+     * 全角空格转为空格，繁体字转为简体字
+     */
+    uint32_t foldSearchCodePoint(uint32_t c) {
+        if (c >= 0xFF01 && c <= 0xFF5E) c -= 0xFEE0;
+        if (c == 0x3000) c = ' ';
+        if (c >= 'A' && c <= 'Z') return c + ('a' - 'A');
+        return simplifiedCodePoint(c);
+    }
+
+    bool isSearchAlnum(uint32_t c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z');
+    }
+
+    /**
+     * @brief 字符在拼音搜索签名中的位：0到25位为任意位置输入的字母，26到51位为可作为一个字符开头的字母
+     * （ASCII字母或读音的首字母），52到61位为数字，之后一位用于
+     * 其他ASCII字符，一位用于其余字符
+     */
+    uint64_t searchSignatureBit(uint32_t c, bool starts) {
+        if (c >= 'a' && c <= 'z') return uint64_t(1) << (c - 'a' + (starts ? 26 : 0));
+        if (c >= '0' && c <= '9') return uint64_t(1) << (c - '0' + 52);
+        return uint64_t(1) << (c < 0x80 ? 62 : 63);
+    }
+
+    /**
+     * @brief 输入音节可用字母的签名位，v也可输入为u
+     */
+    uint64_t syllableSignature(const char* syllable) {
+        uint64_t signature = searchSignatureBit(syllable[0], true);
+        for (; *syllable; ++syllable) {
+            signature |= searchSignatureBit(*syllable == 'v' ? 'u' : *syllable, false) | searchSignatureBit(*syllable, false);
+        }
+        return signature;
+    }
+
+    /**
+     * @brief 在128位字母对签名中设置先后键入的两个字母或数字对应的位，v视为u
+     */
+    void addSearchPair(uint64_t pairs[2], char first, char second) {
+        uint32_t key = static_cast<uint32_t>(first == 'v' ? 'u' : first) << 8 | static_cast<uint32_t>(second == 'v' ? 'u' : second);
+        uint32_t bit = (key * 2654435761u) >> 25;
+        pairs[bit >> 6] |= uint64_t(1) << (bit & 63);
+    }
+}
+
+/**
+ * @brief 用拼音拼写文本中的汉字，每个字使用最常用的读音。
+ * 音节之间以空格分隔，其他文本原样复制："报告2024"变为"bao gao2024"
+ * @param text UTF8文本，简体或繁体中文
+ * @param style pinyinPlain；pinyinTone在每个音节后加声调数字；pinyinInitials只取首字母
+ */
+std::string toPinyin(const std::string& text, pinyinStyle style = pinyinPlain) {
+    std::string out;
+    bool afterSyllable = false;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    while (p < end) {
+        const unsigned char* start = p;
+        uint32_t c = nextCodePoint(p, end);
+        unsigned reading = pinyinReading(c);
+        if (!reading) reading = pinyinReading(simplifiedCodePoint(c));
+        if (!reading) {
+            out.append(reinterpret_cast<const char*>(start), p - start);
+            afterSyllable = false;
+            continue;
+        }
+
+        const char* syllable = g_pinyinSyllables[(reading - 1) / 5];
+        if (style == pinyinInitials) {
+            out += syllable[0];
+            continue;
+        }
+        if (afterSyllable) out += ' ';
+        out += syllable;
+        if (style == pinyinTone) out += static_cast<char>('1' + (reading - 1) % 5);
+        afterSyllable = true;
+    }
+    return out;
+}
+
+/**
+ * @brief 逐字将繁体字折叠为简体字，例如"報告"变为"报告"
+ * @param text UTF8文本
+ */
+std::string toSimplifiedChinese(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    while (p < end) {
+        const unsigned char* start = p;
+        uint32_t c = nextCodePoint(p, end);
+        uint32_t simplified = simplifiedCodePoint(c);
+        if (simplified == c) {
+            out.append(reinterpret_cast<const char*>(start), p - start);
+        } else {
+            appendCodePoint(out, simplified);
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief 支持拼音的名称列表搜索，用于字体族、文件列表或快速打开的条目。
+ * 查询匹配名称中一段连续的字符：汉字可由其本身或其拼音的任意前缀（"w"、"wei"）匹配，
+ * 其他字符由其本身匹配，忽略ASCII大小写。两边的繁体字都折叠为简体字，
+ * 查询中的空格和撇号被忽略，名称中的空格和标点可以跳过。
+ * 因此"wryh"、"weiruanyahei"和"wei ruan"都能找到微软雅黑，"baogao"
+ * 和"報告"都能找到报告.docx
+ */
+class pinyinSearch {
+public:
+    pinyinSearch() = default;
+
+    explicit pinyinSearch(const std::vector<std::string>& names) {
+        for (const auto& name : names) add(name);
+    }
+
+    /**
+     * @brief 添加一个名称，其索引为调用前的size()
+     * @param name UTF8名称
+     */
+    void add(const std::string& name) {
+        uint64_t signature = 0;
+        uint64_t pairs[2] = {0, 0};
+        std::string previousEnds;     // 上一个未被跳过的单元可以结尾的字母和数字
+        std::string starts, ends;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(name.data());
+        const unsigned char* end = p + name.size();
+        while (p < end) {
+            uint32_t c = foldSearchCodePoint(nextCodePoint(p, end));
+            if (c >= 0x10000) {
+                // 存储为代理对，查询也这样处理，因此这些字符仍只匹配其本身
+                uint16_t high = static_cast<uint16_t>(0xD800 + ((c - 0x10000) >> 10));
+                uint16_t low = static_cast<uint16_t>(0xDC00 + (c & 0x3FF));
+                m_units.push_back(searchUnit{high, 0});
+                m_units.push_back(searchUnit{low, 0});
+                signature |= searchSignatureBit(high, false);
+                previousEnds.clear();
+                continue;
+            }
+
+            searchUnit unit{static_cast<uint16_t>(c), 0};
+            signature |= searchSignatureBit(c, false) | searchSignatureBit(c, true);
+            starts.clear();
+            ends.clear();
+            unsigned reading = pinyinReading(c);
+            if (reading) {
+                unit.reading = static_cast<uint16_t>((reading - 1) / 5 + 1);
+                signature |= syllableSignature(g_pinyinSyllables[unit.reading - 1]);
+                addSyllablePairs(pairs, g_pinyinSyllables[unit.reading - 1], starts, ends);
+                const pinyinAlternate* alternate = findPinyinAlternates(c);
+                if (alternate) {
+                    unit.reading |= 0x8000;
+                    for (; alternate->codePoint == c; ++alternate) {
+                        signature |= syllableSignature(alternate->syllable);
+                        addSyllablePairs(pairs, alternate->syllable, starts, ends);
+                    }
+                }
+            } else if ((c < 0x80 && !isSearchAlnum(c)) || (c >= 0x3000 && c < 0x3040)) {
+                unit.reading = 0x4000;  // 空格和标点可以跳过
+            } else if (isSearchAlnum(c)) {
+                starts.assign(1, static_cast<char>(c));
+                ends = starts;
+            }
+            m_units.push_back(unit);
+
+            // 跨字符键入的字母对：上一个字符（跳过空格和标点）的结尾，接着本字符的开头
+            if (unit.reading == 0x4000) continue;
+            for (char first : previousEnds) {
+                for (char second : starts) addSearchPair(pairs, first, second);
+            }
+            previousEnds.swap(ends);
+        }
+        m_ends.push_back(static_cast<uint32_t>(m_units.size()));
+        m_signatures.push_back(signature);
+        m_pairs.push_back(pairs[0]);
+        m_pairs.push_back(pairs[1]);
+    }
+
+    size_t size() const {
+        return m_ends.size();
+    }
+
+    /**
+     * @brief 索引处的名称是否匹配查询。只使用查询的前63个字符
+     * @param index 名称索引，小于size()
+     * @param query 输入的UTF8查询
+     */
+    bool matches(size_t index, const std::string& query) const {
+        searchQuery prepared(query);
+        return matchName(index, prepared);
+    }
+
+    /**
+     * @brief 所有匹配查询的名称的索引，按升序排列。空查询匹配所有名称
+     * @param query 输入的UTF8查询
+     */
+    std::vector<size_t> find(const std::string& query) const {
+        searchQuery prepared(query);
+        std::vector<size_t> found;
+        for (size_t i = 0; i < m_ends.size(); ++i) {
+            if (matchName(i, prepared)) found.push_back(i);
+        }
+        return found;
+    }
+
+    /**
+     * @brief 只在之前的结果中搜索。匹配某查询的名称也匹配该查询的前缀，因此在用户输入时，
+     * 每次按键都可以缩小上一次的结果，而无需重新扫描所有名称
+     * @param query 输入的UTF8查询
+     * @param candidates 要检查的索引，通常是去掉最后一个字符的查询的结果
+     */
+    std::vector<size_t> find(const std::string& query, const std::vector<size_t>& candidates) const {
+        searchQuery prepared(query);
+        std::vector<size_t> found;
+        found.reserve(candidates.size());
+        for (size_t index : candidates) {
+            if (index < m_ends.size() && matchName(index, prepared)) found.push_back(index);
+        }
+        return found;
+    }
+
+private:
+    // 折叠后名称的一个UTF-16单元，只有四字节，扫描大量名称时能留在缓存中
+    struct searchUnit {
+        uint16_t codePoint;
+        uint16_t reading;     // g_pinyinSyllables中的序号加1，没有时为0。g_pinyinAlternates中有更多读音时
+                              // 设置0x8000，单元是查询可跳过的空格或标点时设置0x4000
+    };
+
+    // 与名称同样折叠的查询，带有其位置的位掩码，以便同时匹配所有位置（Shift-And）
+    struct searchQuery {
+        uint16_t units[63];
+        unsigned length = 0;
+        uint64_t signature = 0;         // 缺少其中任一签名位的名称不可能匹配
+        bool wide = false;              // 查询是否包含非ASCII单元
+        uint64_t pairs[2] = {0, 0};     // 查询中相邻的字母和数字，缺少其中任一字母对位的名称不可能匹配
+        uint64_t positions[128] = {};   // 查询单元i为ASCII字符c时设置positions[c]的第i位
+        uint64_t syllableStarts[sizeof(g_pinyinSyllables) / sizeof(g_pinyinSyllables[0]) + 1];  // 见下文
+
+        explicit searchQuery(const std::string& text) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+            const unsigned char* end = p + text.size();
+            while (p < end && length < 63) {
+                uint32_t c = foldSearchCodePoint(nextCodePoint(p, end));
+                if (c == ' ' || c == '\'' || c == 0) continue;
+                if (c >= 0x10000) {
+                    if (length == 62) break;
+                    units[length] = static_cast<uint16_t>(0xD800 + ((c - 0x10000) >> 10));
+                    signature |= searchSignatureBit(units[length++], false);
+                    wide = true;
+                    c = 0xDC00 + (c & 0x3FF);
+                }
+                if (c < 0x80) {
+                    positions[c] |= uint64_t(1) << length;
+                } else {
+                    wide = true;
+                }
+                signature |= searchSignatureBit(c, length == 0);
+                units[length++] = static_cast<uint16_t>(c);
+            }
+
+            for (unsigned i = 0; i + 1 < length; ++i) {
+                if (isSearchAlnum(units[i]) && isSearchAlnum(units[i + 1])) {
+                    addSearchPair(pairs, static_cast<char>(units[i]), static_cast<char>(units[i + 1]));
+                }
+            }
+
+            // 从查询开头输入各音节的前缀所到达的位置，这是常见情况
+            syllableStarts[0] = 0;
+            for (size_t i = 1; i < sizeof(syllableStarts) / sizeof(syllableStarts[0]); ++i) {
+                syllableStarts[i] = syllablePrefixes(g_pinyinSyllables[i - 1], 1);
+            }
+        }
+
+        /**
+         * @brief 从任一活动位置输入音节的前缀所到达的查询位置，以位表示。
+         * 所有起始位置一起前进，每次一个音节字母
+         */
+        uint64_t syllablePrefixes(const char* syllable, uint64_t active) const {
+            uint64_t reached = 0;
+            for (; *syllable && active; ++syllable) {
+                uint64_t next = positions[static_cast<unsigned char>(*syllable)];
+                if (*syllable == 'v') next |= positions['u'];
+                active = (active & next) << 1;
+                reached |= active;
+            }
+            return reached;
+        }
+
+        /**
+         * @brief 名称的单元可作为其本身输入的查询位置，以位表示
+         */
+        uint64_t literalPositions(uint16_t codePoint) const {
+            if (codePoint < 0x80) return positions[codePoint];
+            uint64_t found = 0;
+            if (wide) {
+                for (unsigned i = 0; i < length; ++i) {
+                    if (units[i] == codePoint) found |= uint64_t(1) << i;
+                }
+            }
+            return found;
+        }
+    };
+
+    bool matchName(size_t index, const searchQuery& query) const {
+        if (query.signature & ~m_signatures[index]) return false;
+        if ((query.pairs[0] & ~m_pairs[index * 2]) | (query.pairs[1] & ~m_pairs[index * 2 + 1])) return false;
+        // 单个字母恰好匹配含有以它开头的字符的名称，签名即可判断
+        if (query.length == 0 || (query.length == 1 && query.units[0] >= 'a' && query.units[0] <= 'z')) return true;
+
+        // 前i个查询单元与到当前字符为止的字符匹配时设置active的第i位。
+        // 每个字符前都加入第0位，因此匹配可以从任意位置开始
+        const uint64_t complete = uint64_t(1) << query.length;
+        uint64_t active = 0;
+        const searchUnit* unit = m_units.data() + (index == 0 ? 0 : m_ends[index - 1]);
+        const searchUnit* end = m_units.data() + m_ends[index];
+        for (; unit != end; ++unit) {
+            active |= 1;
+            // 查询中没有NUL，因此positions[0]代表所有非ASCII单元
+            uint64_t next = (active & query.positions[unit->codePoint < 0x80 ? unit->codePoint : 0]) << 1;
+            next |= active & (uint64_t(0) - ((unit->reading >> 14) & 1));
+            unsigned syllable = unit->reading & 0x3FFF;
+            next |= query.syllableStarts[syllable];
+            if ((active & ~uint64_t(1)) && syllable) {
+                next |= query.syllablePrefixes(g_pinyinSyllables[syllable - 1], active & ~uint64_t(1));
+            }
+            if (unit->reading & 0x8000) {
+                for (const pinyinAlternate* alternate = findPinyinAlternates(unit->codePoint);
+                     alternate->codePoint == unit->codePoint; ++alternate) {
+                    next |= query.syllablePrefixes(alternate->syllable, active);
+                }
+            }
+            if (query.wide && unit->codePoint >= 0x80) next |= (active & query.literalPositions(unit->codePoint)) << 1;
+            if (next & complete) return true;
+            active = next;
+        }
+        return false;
+    }
+
+    std::vector<searchUnit> m_units;        // 依次排列的折叠后名称
+    std::vector<uint32_t> m_ends;           // 每个名称在m_units中的结束位置
+    std::vector<uint64_t> m_signatures;     // 每个名称的字符和拼音字母，参见searchSignatureBit
+    std::vector<uint64_t> m_pairs;          // 每个名称两个字：查询可能连续输入的每对字母或数字，参见addSearchPair
+
+    /**
+     * @brief 添加音节内部的字母对，以及按前缀键入时它可以开头和结尾的字母
+     */
+    static void addSyllablePairs(uint64_t pairs[2], const char* syllable, std::string& starts, std::string& ends) {
+        starts += syllable[0];
+        for (const char* letter = syllable; *letter; ++letter) {
+            ends += *letter;
+            if (letter[1]) addSearchPair(pairs, letter[0], letter[1]);
+        }
+    }
+};
+
+#pragma endregion
+
+#pragma region 排序键
+// 可用memcmp比较的名称排序键：拉丁字母忽略大小写，数字按数值，中文按拼音或笔画
+
+/**
+ * @brief 排序键中汉字的顺序
+ */
+enum collationOrder {
+    collatePinyin,    // 按拼音，其次声调，再次笔画数，与中文词典和zh拼音排序规则相同
+    collateStroke     // 按笔画数，与zh笔画排序规则相同
+};
+
+namespace {
+
+    // U+3400到U+9FFF的总笔画数，每个一位base-91数字，未知时为0。取自CLDR zh笔画排序规则的笔画分组，
+    // 它覆盖统一表意文字和部分扩展A
+    const char g_strokeCounts[] =
+        "'(!!%!!!!!!!!!!!!!!!!!!!!!!!!!!!+!-!!!5!!!!(!*!!''''''''((!(!!!((!!!!!)!!!!!*!!!*!!!!!!!!!!!!!!!!!!!-,,!!!!!!!!!!!!.!!!!"
+        "!!.!!//!!!!!!!!!!!!!!!!!!!!1!!1!1!!!!!!!!!!5!6!7!!!!!!!4'!!)!!!!!!!!-!!!!&!!!!!!)!!!!!!!!!!!!!!!!!!!!!!)!!!!*!!!!!!!!!!!"
+        "!!!!!!!!!!!.!!!!0!!!0!0!!!!!!!!!!!!!!!!!!!*!!!!!-!0!!33!!!!&!-!!)-///0<).&!(!!%!!!(!!!!!!!!!!!!!!0!3!!!!!1!!!!!!!00!!!(!"
+        "!!!!!)!!)!)!!!!**!!!!!!!!!!!+!!!!!!!!!!!!!!!!!!,,!!!!!!!!-!!!-!!!!!!!-!!!!!!!!!!!!!!!!!.!.!!..!.!!.!!!.!!!/!!!/!!!!/!/!!"
+        "/!!!!!!!!!!!!!!!!111!!!!!!!2!!2!22222!!!!4!!!!!!!!!!!!!!8!9!!!!!*!+,!!'!!)!)!))!)*****++++!+!!+!!!!!!!!---!!!!.!!!!!!!!!"
+        "!!!!!!!/!!!!!00!!!!!!!!!!!!!!!!!!!3!!!!!!:!!!!!!!!!!!!!!!!!!!!!!!!+!!!!!!!!!!(!!!!)!)!!!**!!!*!!!*!!*!!!!*!+++!++!!!!!,!"
+        "!,!,,!,!!!!!!,!!!,,!!--!!!!!!!!!!!!!!.!!!!!!!!!!..!..!!!/!/!!/!!!!!!!!!!!!!!0!0!0!01!11!!!!222!!44555566678<!!!!*!!,!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!.!!!/!!!!!!!!1!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!,!!!!!!!!1!!!!!!!!!!!!!!!!!!!!!!!!*!!!!*!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!/!!!!!/!!0!!!!00!!0!!!!!!!!!!1!!!!!!!!!3!!!!!!5!5!!!7!!!!,!.!!*-''((()"
+        "))!)!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!122233!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!0!!!!!!!!*!!!!0!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!'!!!!!)!!!!!!!)!!!!!!!!!!!*!!!!!!!!!!!,!+!!!++"
+        "!!!,!+!!-,-,,-,,,,!-!!!-!!!!!!!!!!!!!-!!!!!!!!!!!!!!!!!!!..//./!!!!!!!!!!!!!!!!!!!!!!!!!0!!!!!!!!11!!!!!!!1!!!!!!2!4!!!!"
+        "!4!!6!!!!!!!!!!!!!!!!!!!.!!!!!!!!!!!!!!!!!!!!!!!!)!!**!!+**!****!++!!++!!!!!,!!!!!!!!!!!,!!-!!-!-----!-!!!!!!!!!!!!!!!!."
+        ".!!!!!!!/!!/!!/!!//!!!!0!000000000!!1!!!!!!!!!!!!!!1!!!!!!2!2!!2!!!!3!3!!4!!!!44!!!!!!!!6!!!!!!9!!!!!!!!!*!+++!,,,-----."
+        ".!!!!!!.!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!.!!!++!!.!!!!!+!!,!-!!!!!!!!!!!!!!!!!!+!+!!!!!!!!!!!!!!!-!-!!!!!!!!.!!!!.///////"
+        "/////0000111111222222222333444444556889;(23*,,--..0011123()))))**********+++++++,,,,,,,,,,,,,,,,--------------.-........"
+        ".!!!!!!!!!!!!!!!!!!!!!/!!/!!!!!!!/!!!!!!!!!!!!!!!!!!!!!!!!!!0!1!!!1!1!!!!!!!!!!!!!!!!!!2!!!!!2!!!!!!!!!!!!!!3!!!!!333!!!"
+        "!!!!!!!!555!5!!!!66!!6!!!6!!!7!!8!!!!!!!*!!!!!+!!!!!!!!-!!!!!!!!!!!!/!/!!!!!!!3!!!!!!!!!)!!!+!!!!!!!!!!!!,-!.!.!..!!!!/!"
+        "!!!11!!!!!!!!!!!!!!!!!!!!!!+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*!*!!!*!!!!+!!!!!+!!!!!!!!!!!"
+        "!!!-!!!,!!!!!!!!!!!!!!!!-!!!-!!!!!!!!!!!!!!.!!!!!!!!!.!!.!.!!!/!!!!!!!!!!!//!!!!!!!/!0!!!!!!!!0!!!!!1!1!!1!!!!!!!!!!!!!2"
+        "!!2!!2!!!22!!!!3!!!3!3!!!!!!!4!!!!!!!5!!!!5!!!!6!6!!!!!!!!!!!!!!!!!!!)!!!!!!!+!!!!!!,!!!!!!!!!!-!!!!!!..!.!!..!!!!!/!!!!"
+        "!!!/!!!!!!!!!!!00!!1!!!!!!!2!!!2!!!!22!!333!4!5!!!6!!7!!!!!!!!!!!!!!!!!!,!0!!!&!!!!!!!!*!!!!!!!!!!-!-!-!-!!.!!!!/!!!!!!!"
+        "!!!!!3!!!!!!!!!!!!*!!!!!!*!!!!!!!!!!,!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!(((!!)!!!+!!!!!!,!!!!!!,!!,!!!!,"
+        "!!-!-!!!-.!!!!./!!..!!/!!//!!!!0!0!1!!!!1!!11!!!!!3!2!!333!!5!5!!!!!!!-!!!!!!!!!!!!!!!!!!!!!!!-!!!!!!!!!!!!!!!!!!!!!!!!3"
+        "!!!!!!!!!!!!!!!!!!!1!)!!++!!!!!!!!!/!!!!!!!!!!!!!!!!!!!!!!!!+!!!!!!!!!!!!!!!!!!!!!!.!!!!.!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!1"
+        "!!!!!!!!1!!!!!!!!!!!!!!!!!!!!!!7!!!!>!!!!!!!!1!!!!!!!,!!!!!!!!!!!46!!!!!,--./!!!!3!!!!!!!!!!!!!!!!!!!+!!!!!!!!,!!!!!!!!!"
+        "!!!!!!!!!.!!!!!!.!!!!/!!!!!!!!!!!!!0!!!1!!!!!!!!!!2!!2!!!!2!!!!3!3!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!+!!!!!!!!!!!!!"
+        ",!!!!!!!!!!!!!!!!!!/!!!/!!!!!!!!0!!!!!!!!!!!!!!!2!!!!!!3!!!!!!!!!!!!!!!!!!!!!!!!!!:!!!!!+!!,-!!!!.!!!!/!!!!!!!!!!!!!!!!!"
+        "4!!!!!)!!!!!!!!!!!+!!!!!!!!-!!!!!-!-!-!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!0!!!!1!1!!!!!!1!!!!!!!!!3!!!!!!!!!!!!!!!!A!*!!+!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!2!!!!!!3!!!!!!!!!!*!!!!!,!!!!/!!!!!!!,!!!,!!!!!!!!!!!!!!!!!...!!!!!!!!//!//////000000000000011"
+        "111111!!!!1!1!!!1!11!!1!!122!22!222!!!!!!!!3!!!!333333!!!!!!!!45!!!!!4!!!!!!!!!!5!!!!!!!!!7!!!!!!!!!9!:!!!+!!!!!!!!.!!!!"
+        "!!!!/!!!!!!!1!!!!!!!!!!!!!3!!!4!!!!!!!6!!!!!!*++!+!!,!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!00!!00!!!0!!1!!!!!!11!!!"
+        "11!!1!!!!!!!!!!!!!!!!!!!4!!!!!!!5!!!!!6!!!!8!!!!!!!!!!!!!!!.!!1!!!+,--!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!..!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!!!!!!!!!1!!!!!!!!!!!!!0!!!!!!2!!!!!!!!!!!!!!!!!!!!!!!*!!!!!+!!!!!!!!!!!!!,!!"
+        "!!-!!!!!!!!!!!!!...!!!!!!!!!!!!!!!!/!!!!!!!!!!!!0!!!!00!!!!!!1!!!!!11!!!!!!2!!!!!!!4445!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!,!!"
+        "!!!!!!!!!!!!!!!!!!1!!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!!!!,,!,!!!!!!!!!!!!!.!!!!!!.!!!!!!!!.!!!!/!!!!!!!!/!!!!!!!!!!!!!!0!0"
+        "!!!!0!!!!0000!!!!!!!1!!!!!!!!!!!2!!22!!!!2!2!!!!!!!!!!3!!!!!!3!!3!!!!!33!!!!!!4!!!!4!!!!!!!4!4!44!!4455!!!!!!!!!!56!66!6"
+        "!!!!6!!!!!7!!!!8!!8!!!!!!!!!!!!9!!!!!!!!!!!!!A!!!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!!!!!!.!.!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!2!!!!!!!!!!!3!!!!3!!!!!!!!!!!!!!!!!667!!!8!!!!!!!!+!!!!!,!2!!!!!!!!!!!!!!-!!!!!!!!!!!!!!!!!!!!0!!!!!!!!!11!"
+        "!!!!!!!2!!!!!!!!!!!3!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!-!!!!!/!!!!!!!!!!!!4!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!-!!!"
+        "!!!!!!!!!!!!!!!..!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!1!!!!!!!!!!3!!!!!!!!!!!!!!!!!!6!!!!6!!!!!!!8!!!!!3!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!--.!!!!!2!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!1!!!!!!!!!!!!!!!!!!!!!!!!!!!,!!-!!!!!.!.!!/!!!!!!!!!"
+        "!!!!!!1!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!,!!!!!!!!!!!!!!!!!!!!!!!.!!!!!!0!!!!!!!!!!!11!!!!!!!!!1!!!!!!!!!!!!!!!!!!!!4!!!!!5!"
+        "!!!!!!!!!!!!!!!/!!!!!!!!!!!!!!-----!!!!!!!.!!!!!!!!!!1!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!-!!!!"
+        "!!!!!!!!!!!!!23!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!.!!!!!!!!!!!!1!!!!!!!!!!!!!!!-!!!!!.!!!!!!0!!!!!2!!!!!2!!!!!!!!!!5!!!!!!"
+        "!!!!!!.!.!!!000!!!0!!1!!!!!!!2!!!!!!3!4!!!!!44!4!5!!!!!!!5!5!!!!!!!!!!!!!!!!!7!!!!8!!8!!!!9!!!!!!@!!!!!!!!!!!!!!!/!!!!!!"
+        "!!!!!!!!!!!!!!!!!2!!!!!2!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!/!!!!!1!2!!!!!!!!!!!!!!!!!!!!!!!!23345!!!"
+        "!!!!!!!0!!!!!!!!!!!!!2!!!!!!3!4!!!!!!!!!!!!!!9!!!!!!!!!!!!!!!!!!!!36!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!!!!!!!!!!!!!!!!!!/!!!0!!!!!!!!!!!!!!!!!!!!!!!!3!!!!!!!!!!!!!!!!!!5!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!00!!!!!!!!!!!!!!!3!!!!!!!!5!!!!!!3!!!!!/!!!!!0!!!!!!!!!!1!!!!!!!!!!!!!!!!!4!44!!!!!!5!!!!!!!!!!!!!!!!!!!!!!!!!!!0"
+        "3!3!!!!!!!!0!!0!!!!!!!!!!!!!!!3!3!!4!!44!!!!!5!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!;<!>!!!!!!!0!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!44!!5!!5!!!!!!8!!!!!!!!!!!!!!!!!1!!!!!4!!!!!!!!!!!!!!!!!!!!1!!1!!!!!!!!!!2!333!!!!!!!!!!!!!5!!!!"
+        "!!!!!!!!!!!!!6!!!!!!!!!!!!!!!7!!!8!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!77!!!!!!!!!1!1!!!!!!1!!!!!!!!!!!!!!!!!!!!!3!!!!!!3!!!"
+        "!!!!!!!!!5!!!!!!!!!!!6!!!!!!!!!!!!!!!!!!9!!!!!!!!:!!!!!!B!!!!!!!!!!!!!!!!!!!!!4!!!!!!!!!!!!!2!4!!!!!!!!!!!!!!!!!!!!!567!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!A!!!!!!!!!!8!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!#$$$$$$%%%%%%&&&&&&&''''''''''((((()))**#$%%&&&&&')*+,#$%&&'')+#"
+        "##$$$%%%%%%&&''''(((()*+,###$$%%%%&&&&&'((((((((())******++++,---.///#$%&()*$%%%%&&&&&&'(((*)***$%&&(((()))**++++++,..//"
+        "28$$%%%%&&&&&&&&&&&&&&&&&&&&''''''''''''''''''''''''''((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((()))"
+        "))))))))))))))))))))))))))))*)))))))))))))))))))))))())))***************************************************************"
+        "******++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,"
+        ",,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,----------------------,-----------------.-----------------------........................"
+        "..................////////////////////////////////////000000000000000000000000000000000000000110111111111111111111111111"
+        "2222222222222223333333333332344414355567777889:$%&&&''((((()))))))*****+++,,---../027$%&(*+$&&&&'(((()***+,+,-//24$&&&&&"
+        "&''''(()*++,,-$&&''(()*++,,,,,,,-02$''''((((()))))))*****+++,,,,,,,,,,,---...../01111223$%%%&'''(((()***-..00$&'''''(*+."
+        "$$$%%&&&&'''''(((((((((((((())))))))))))))))))*********************+++*+++++++++++,,,,,,,,,,,,,,,,,,,,,,-.--------....-/"
+        "////////000001111111111122222357799$%&&''''(((((())))))))))))***********++++++*+++++,,,,,,---------..../////////00000011"
+        "111233355$%&&&&&&&&'''''()***+,--..-1$&'--$''''(((()))*+++,,---/00012356$&&)*+---$%%%&&&&''('((((******++-.7$&&''''))***"
+        "-$%%&'''(())))*****+++-,//$&&&&'''(((())))****++++++,,,,----.....-//000/01135A$&&&'''(()***--.01$%&&&&&'''()*****+++++,,"
+        "/24%'''''''''''''''''''''''''''((((((((((((((((((((((((())))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))"
+        ")))))*******************+*+*******************************************++++++++++++++++++++++++++++++++++++++++++++++++++"
+        "++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,-,,,,,,,,,,,,,,,,,,,,,,,,,,,--------------------------------"
+        "-----------------.--------------------------------.................../........................................-......../"
+        "//////////////////////////////.///////////////////////000000000000000000000000000000000000000000100000000111111111111111"
+        "1111111111111.1111111111101111111111112222222222222222222222122222222333333333333333333333334444444444444444455555555545"
+        "566666666677677777777888888897899:::;;>%'''''((((((())))))))))))))))))*********++,,,,,,-----...-./////00001228<%&&''''''"
+        "((((((((((((((((((())))))))))))))))))))))))))))))))))))))******************************************+++++++++++++++++++++"
+        "++++++++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,+,,,,,,,,,,,,,----------------------------------------------------------.."
+        "..........................,..-......./...../...../////////////////////////////////////////000000000000001000000000000000"
+        "00000000000011111111111111111011111111111122222222222222222223333333333344555555555666799:;%&'()))))++,--.../00112%&'()*"
+        "++%)*+,,04547%'''(((**,--.00001%%&&&&&'''''''(((((((())))))*******,***++++++*++,,,,-----..-...///0000122489%'''((((((((("
+        "((((((((())))+))))))))))))))))))))))))))))))*****************************************+**++++++++++++++++++++,+++++++++++"
+        "+++++++++++++++++,,,,+,,,,,,,,,,,,,,,,,,,,,,,,,,,,,--,,,,,,,,-----------------------------------------------------------"
+        "-------.......................-./...............................///////////////////////////////./////0000000000000000000"
+        "000000000000111111111111111111111111111122222222222222222223333323333333333323334544455566666667778889::%%%%&'(((()))))*"
+        "********+++,,,---.-./0/022335668%''''((((()))))))))***************+++++,++++,,,,,,,,,,,,,,,,,,,-----------............//"
+        "//////000000000001.1111223355567%'((()))*++,,,+---...01%&&''''(((**+++.//0%&&((()))))*++..///133%&&''())))))*******+++++"
+        ",,,,,,,,,-----..-.00111134457:%&(%&'''''(((((((((((()))))))))))))))))))))))))*****************************************++"
+        "++++++++++++++++++++++++++++++++,,,,,,,,,,,,,,,,+,,,,,,,,,,,,,-------------------------------------------..............."
+        "........../.................../////////////.///////////00000000000000000000000011111111111111111111111222222222222222223"
+        "333333334445556666676787788888989:9%$%(())--1%'''(()++,./%%%&)*+++++,.%&&&''''((())))))))************+++++++++++,,,,,,,,"
+        ",,-----------.-...........///////000000000101111111011222133344256%'(((**/%&'+.%''''((())))))))))))))******+****+++++++,"
+        ",,,,,,,,+------------.-....../////.//00000000000001101111111122222245566678;%(*)**+++,%&&'()))*++,0%&'(((./%&&&''(((()))"
+        ")**********+++++,,,,------.....////0000111223489%%'(**+-.//22445<%)))++,,----./0018%(())))))*********+++++++++,,,,,,+,--"
+        "--.----------......./////010010111122335667&%'&'(''()))()))(((())((()**)*)*))*)))*)))))))))))*)))))))*)*)**))))*******+*"
+        "**+*****+****+**+**+++**+********+*****+++*++***+,+++++++++,+++,,++++,,++,,++,+++++,+,+,+,+++,+,+++,,,,,++++++,-,,,,,,-,"
+        ",--,,,,,-,,,,,,,-,,,,,,,--,---,,-,---,,,--..--.--.-------.--.----.--.-.--..---.---------....-.---...----.../..././......"
+        ".//..././...././......././//.../......./0///0//////0////0//0///0/00////00//0////0/0001010100110000001011.001011010000010"
+        "110010110011110101212111121111221211121121111211221111111121232222223222223322232323222223222443433333343334333334445445"
+        "445445556665777899899;;>&'''((((()))****+,----..///////000000111223438&&&')))****+++,,,,-..&%%&''''''''((((((((((((((((("
+        "((((())))))))))))))))))*))))))))))))))))))))))))))))))))))))))*****************************************+************+***"
+        "**********++++++++,,+++++++++++,++++++++,+++++++,++++++++,,,++++++++++++,,,,,,,,,,-,,,,,,,,-,,,,,,,,,,,,,,,,,,,,,,,,,,,,"
+        ",,,,,,,,,,,,,---------------------------------------.-------.--------------.------------..------------......./.........."
+        "....................,../.../...../..................../////////////////////////////////////0////////0//////0///0////////"
+        "///0000000.00000000000000.0000001100001110000000010000001001011012111111111111111111111111111101111111111111111111122222"
+        "222222122232223222222222322222233333343433433333334244444444444454444445555555555756666666677788888989889999::;&(+.2&&(("
+        ")))))**+++++++,,,,,,,---------------.-.............//////0002111111122223333566&)*,,.---../2479&),,--../0023&'****++--.."
+        "/.012334;&***++++,,,,,,---,-----..////0022345556&&+-/&''(((((((()))))))))*********************************++++++++++++++"
+        "++++++++++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,--------,,---------............../.........../////////////.////////000000"
+        "00000000011111111111111122221222222222222222223233333333433445555556666667999::;&'(())*+,-,,--...../0027&(****++++,,,,-,"
+        "----....//022246&&'''''''((((((((((((((((((())))))))))))))))))))))))))))))))))))))***********************)**************"
+        "******************************+++++++++++++++,+++++++++++++++++++++++++++++++++++,++++++++++++++++++,++++*++++++++++++++"
+        "++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,+,,,,,,,,,,,,,,,,,,,,,,,,---------------------"
+        "----------------------------------------------------.--------------....................................................."
+        ".......................................................///////////////////////////////////////-///////////////////////./"
+        "./////////////////////////0//0000000/000/0000000000000000000000000000000000000000000000000000000000000000000000000111111"
+        "111111111111111111111111111011111111111111111111111111111111111121111101112222222222222222222222222222222222222222222222"
+        "222221222222222222222222222223333333333333333333333333333333333333333333333444444444444444444444444444444445555555555555"
+        "55535555545555556665646666666668767777777777778888887889999:::;;;;;;<;>>&((*)***+++,,,,,,,--,----......./////////0000011"
+        "111122222223334458&'()****++,,..0///01124&'()*****++++++,,,,--------.......//0000011111222223334557&*++,----...////00112"
+        "249&&'())*+/&(+++,3&))**++,,,,,,,,,----........///////0111122222333458<&''(*&'((())***+++++,,,,,,,--...../00&%''''''((''"
+        "'')'''('''(((((((((((()((((((()(((((()))))))*))))))))))())))))))*)))))))))*))))))))*)))+)))))*)))))))))))))****+********"
+        "*****************+****************+*********************,***+++********++++++++++++++,++++++++,+++++,++++++++++++++++++,"
+        "*+++++++++++++++++++++,+++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,-,,,,,,,,,,-,,,,,,,,,,,,,,"
+        ",,----------------------------------------------------------------------------------.-.----.--------------------..-....."
+        "............................................................................/.......-........................///////////"
+        "///////////////////////////////////////////////////.0/0//////1////////.////////////0000000000000000000001000000000010000"
+        "100/00000000000000000010000000000000000000000101010000000000000111111111111111211111111111111111111011111111111131121111"
+        "111111111111111112111122222222222322222222222222222222222222221222223222122233233333333333333333333333333335333434444444"
+        "444424444444444444444555555555555555554555655556666666666666666666677777777777<77889888889999:::::;;<=<==BC&&'(((((())))"
+        ")))))))))******************************+++++++++++++++++++++++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,-"
+        "-----------.-----------------------------........................................////////////////////0/////0////////////"
+        "//////.//////////0/00000000000000000000000000000001111111111111111111111111111222222222222222222222222222222222222222223"
+        "3333333333333333333333334444444444545555555655566666656667778788899:;;;>@D&&**+++,.013&(*,/&+-0&*+,/013&*++.../////00111"
+        "5&.&&((()))))********+++++++++,,,,,-----.-..........//////000000111122223555555668;=&%'''((((()(()))))))*))))))))*+*****"
+        "***************++++++++++++++++++++,,,,,,,,,,,,-,,,,--.----..-----.---------------........-.../......../../////////00///"
+        "///100100000001111111111111212222222223333333444555666788999'+,--''&''(((())))))))))**********************++++++++,+,+++"
+        "++++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,----.-,---------------,----------........../......../................"
+        ".....///////////////////////////////////000000000100100/0000000001111112111111111111121232212223222222222222233433333333"
+        "3333344544644544444555555555666666677878889:'*,,-/258:')**+++++++++,,,---....///0/0000011122222333344457'*+--//'+,--...0"
+        "''())++.''''''())))*)*********++++++++++++++,,,,,,,,,,,,,---------......-....//////0001122233455668'*,..00')))))********"
+        "**++++++++++++++,,,,,-,,,,+,,,,,,,,,,,,,,,-------------.....................///////////////////////////00000000//0000000"
+        "01111111111111101111222222222222222222223333333333233334444444444444444555654667777788899::<>A'*+++..'(())))*++++-,,,,--"
+        "--.....///11111222333344456678'*,,-../000012346'))*++++++,,,,,,,,,-------..-.///00001222333446')******++++++++++++++++++"
+        "++++++,,,,,,,,,,,,,,,,,,,,,,,--,,,,,,------------------,--................////////////////////////////00000000000/000000"
+        "0000000111111111111122222222222222223233333333333333333344444444444555555556666677779:::;;<'+,../;')**+++,--../3356')))*"
+        "**********+++++++++++++++++++++++++++,,,,,,,,,-,,,,,,,,,,,,,,,,,,,,,,,,,,,--------------------------...................."
+        "........//////0//////////////////////////////0000000000000000000/0000000001111111011111111111111111111211122222222221222"
+        "22222223333333333333333333333344444444444444444555555555556666666666677777777899:;'&()******+++++++++++,,,,,,,,,,,,,,,,,"
+        ",-,---.---------.........///////////.//00000000000000000001111111111222332334444556889::'++-./')))))*******+++++++++++++"
+        ",,,,,,,,,,,,,,,,,,,,,,,,,--------------.......-........///////////////////////000000000000001011111111111111222223022222"
+        "2222333333333334444455555555666688::'())****++++++++,,,,,,,,,,,-------....-...//////////00000011111112222222223333374456"
+        "778'))**++++++++,,,,,,,---......////0000023334668(**++++++++,,,,,,,,,,,,,,,,,,-----------------------------------------."
+        "..............................//////////////.////////0///////////0000000000000000000000000000000000000000000111111111111"
+        "01111111/111111112111111111122222222222222222222222222223333333332333333333333333333333332333333344444444444444444445444"
+        "444555555555555555566666666666667777767888888898889999999;:;;;;<<AC(***++++++++++++,,,,,,,,,,,,,,,------------.....-...."
+        "......////////0000000000/01111111111111222222222233333333334444435555566687<89;=(())****++++++++++,,,,,,,,,,,,,,,,,,,,,,"
+        ",,,,,,,,--..---------------------------------............../............................//////.///////////////////////0/"
+        "////00000000000000000000000000000000000000000000000000000001001111111111111111111111111111111111111111111111111122222222"
+        "222222222222222222222222233333333333333333333333333333333335334444444444444444444444445455555555545555555556666666667777"
+        "777777777889999:;;;;==@%'((((((((((()))))))))))))))))))******************+++++++++++++++,,,,,,,,,-----------------------"
+        "--.......................////////////00000001111222225(*+,,-,-...002333444556788:('&*)**+*+,,,,,,,,-...////////000/00111"
+        "1222233343455558::(**+++,+,,,-,,,,------...////////011111224445555677(++,,,,,,,------------........///000000001111111122"
+        "22333334444435566(&(,*,+--,.(+++++(*+,,,,,------.//0001122233446788()*++,,,,,,,,,,,-----------.......////0000000.0001111"
+        "11112223333334445666688(&,,*///00('((((*)))))))))))))))))*********************************++++++++++++++++++.+++++++++++"
+        "++++++++++++-,,,,,,,,,,,,,,,,,.,,,,,,,,,,+,,,,,,,,,,.-----------.------------------------.......................0......."
+        ".../////////////////////////.//////////000000000000000002011111111111111111113222222222222222222323333333333333333353444"
+        "4444556556666788;;9(**.033(),,...12(+.....02(**+,,-../202245(***,-.00011245(./0(*++++,,,,,,,,,,,,,----------....////////"
+        "//00001111111222223333444555556666789:()*3(,-.5:(%'(((((((()))))))))))))))))+)))***********************************,****"
+        "****************++++++++++++++++++++++++++++++++++++++++++++++++++++++++,+++++++++.+++,,,,,,,-,,,,,-,,,,,,,,,,,,,,,,,,,,"
+        ",,+.,,*,,,,,,,.,,,,,,,,,,,,,,,,,,-,,,,,,,,,,,,,,,,,-,,,,------------------------------------------.---------------------"
+        "-----------/--.........................../.........................................................................../.."
+        "////////////////.//////////////////////////////.//////////////////////////////////////////////////1/////0000000000000000"
+        "0000000000000000000000000000000000000/00/0000000000000000000002010000001111111111/111111111111111111111/1111111111111111"
+        "111111111111111111111111111111111111112222222222222222212222222322222222222222222222222222222233333333333333333333332333"
+        "333333333333333333333333343333334444444444444444444444444444444445447555555555555555555555555565555555655666666666666666"
+        "6666666666666777777677777767677777778777698888889999999999;:<:;;;;=@>(**+,,,,------././/0012222334<()******+++++++++++++"
+        "++++,,,,.,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,-,-----------------------------------....../..............................///"
+        "/////////////////////////00/////0000000000000000000000000000000000000000000000/000001/1111111011111111111111111111101111"
+        "111111111211111112122222222222222222222222222222222222222233333333333333333333333333333333333333333445444444443441444444"
+        "44444444444444555555555555555555555555456666666666777757777778888787899999999::::::;<===(++,,-....7:(++,-----...//111122"
+        "22:('*++*++++,,,,,,,,,,,,,,,,,,,,,,,,,,,-----------------------------------------........................./////////////."
+        "//////////0///100000000000000000000000000.000111111111111111111111011122222222222222222222232333333333333333334444444444"
+        "4434345555555555555666666777777888899:9:;;;;;=(((+-../4559;)+,,------.-....//00000111122212333334444555556667788;&()**++"
+        "++,-../011)++-----../../////////00001111123345566678899;))+++++++,,,,,,,,,,,,,,,,,,-------------------------..........//"
+        ".................................//////////////////////////////////////////000000000010000000000/00000000000000111111111"
+        "111111111111111111111111111111111111222222222222212222222222222212222222222233333333333333332333333333333334444444444444"
+        "4444444444444445555557545555565555555555555556666666666666666666666777777777778888888889999999999::::::;;;<<===@$&&&&&''"
+        "''''''''''((((((((((((((())))))))))))))))))***********************+++++++++++++,,,,,,,,,,,,,,,,,,,,--------------------."
+        "......../////0000001115),---/013334589),,-//111346;=>)*,------..../////00002122333334455),,,--......///////0001122223334"
+        "445;=)+++,,,,----------.../.............../////////////00000000001111111111111111111112222222233333333444444445555555666"
+        "77777888899:;&((())*************++++++++++++,,,,,,,,,,,----...........//000012222337)---///02123)(++++,,,-------........"
+        "..../////////00000011111111112223455556779<)+,,,,---/--------.........../..............//////////////////////.//////0000"
+        "000000000000000111111111111111111111111111111111222222212212222222222233333333333333444444444444444444445455554555555555"
+        "5555555546666665667777778888888899899::::;;;;;<<>==),---.//000111111122444555567:=)*++,,,,,,,,--------------........./.."
+        "..............///////////////0000000001111111111111111111111122222222222222223333333334444444555555556666667777788899=&'"
+        "()))*****+++++++++++,,,,,,,,---........//////000122)..///000122222234567),/15)&'(((((())))))))))))**********************"
+        "++++++++++++*+++++++,,,,,,,,,,,,,,,,,,,,,,,-----------------------------....................////////////////////////////"
+        "000000000000001111111111112122212222233333333324435556799)''(,(((((((()))))))))))))-)***************++++++++++++++++/+++"
+        "++0+-+,,,,,,,,,,,,,,,,,,---------+---.1--.2..-............./////////////00000000000000114111.111111222223344444556567778"
+        "8)++,,,,,,,------------.......////////////000000000000001111111111111222222222223333333333333444444445555566666667779:::"
+        ":;:<<=)*-..6)+-.4**++,,,,,,,,,,,,,,--------------------------................................................0//////////"
+        "/////////////////////////////////////////////////////////////00000000000000000000000000/00000000000000000000000000000000"
+        "001111111111111111111111111211111111111111111111111111111111110111111112222222222222222222222222222222222222222222222222"
+        "322222222222222222222222222222232333333333333333333333333333333333333333333333333323333333333333444444444444444444444444"
+        "434444444544444344444444444444445555555555555555555555555555555555555555555555555556766665666666666666666666666666666666"
+        "66666666666666666777777677777777777767777788888888888888888889999999999999999998:::::;;;;;;;<<<<<<<====>>>>@@'(()))))***"
+        "********++++++++++++++++++++++++,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,-----------------------------------------................"
+        "..............////////////////////////////000000000000000000001111111111111111222222222223333333333344444456688**--.158'"
+        "*++,,,-----............./////////00000000001111111111223222222223223333333333233444444444555556666777778%&'((((())))))))"
+        "**+++++++++,,,,----------.....////02*%''((((())))))))))))))))))*******************++++++++++++,,,,,,,,,,,,,,,,,,,,------"
+        "--.--------.-.................././///////00000000011112222223333333456*23*,,,,,--........///0///000122344444444445457::>"
+        "*---........///////////0001111111112222222222222333333333344445555555566667667777777888889:::::::;<====@J**..//0001224*."
+        "15+*01279+-.......////////0000000000000111111111111222222233333333444444444444444555555566667777888899:::<A+.00111233344"
+        "444655556778::&)+.//0+/1235+//00244556669+---....///////////000000011111111122111111122222222222222222443333333333344444"
+        "44444455555555566666777778889999:;;==(**++++,,,,,,,,,----.......///////01111112222445679+..//000001122334445555556666777"
+        "7778==&)+++./000122+7=%++-,,,--....././.././////0/1/////0000000010110100211111111122222222222322223333433333234344444444"
+        "44355535556666676666887776889:;;==A%''(()))))))******++++++++,,,,,,----../../////0011;+-3+/0002223334455679=,..///////00"
+        "000000000000000011111111111111111111111112222222222222222223333333333333333344444444444444445555555555555555555556666666"
+        "666666666777777777777777888888888888889999999:::<<<<=<==>>@A%'((())))************+++++++++,,,,,,-------.....////00013566"
+        ",./////00011111122222332445565666666677789899:;<,-01489,.//0000000011211111112222222333333344442455555556666777778888899"
+        "9::;=,012468::=,=@,234456778,/0000011112334444446777788:::-////000011111111111111111111111222222222222322222222222222222"
+        "233333333332333333333333333334444434444444444544444444344444555555555555555555555555555555555566665664666666666666666666"
+        "6666666666667777677777777777777778888888888888886888888888999999999999999999::::::::::::;:9:;;;;:<<<<<<==@AD*,-.....////"
+        "/////////000000000000000111111111111122222222222222233333333333333334444444555555555666677778-./////+////000000111111111"
+        "111111111121111222222222222232222222222222222333333333333333333333333333334444444444444444444444454444535555555555555555"
+        "555555555555555555555555656666666666666666666666666677777777777777777776777777777778777788888888888888888999999998999999"
+        "999998999::99::::::::::::::;;;;;;;;<<===>>>@@AA'))***+++++,,,,,,,,,,,,,---------.........////////////0001000011111111222"
+        "2333344445588-125677::2-///11222233344444555555566667789:;>BD-)0111122233445568@-12-0014569..2233344;.138.-1222221333334"
+        "445566666667777788999;<=>.235/*344455799;;<./6/1112//44577779;:;/*333444444445666788889999>0223355899::;=G034579(1123455"
+        "56667666663677777788899999::::::;;;;>>F*,-.////001133245567888CDS'--27>)378;<<!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+        "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!";
+
+    // U+00C0到U+00FF的基本字母，其中的两个符号为'*'
+    const char g_latin1BaseLetters[] = "aaaaaaaceeeeiiiidnooooo*ouuuuyts" "aaaaaaaceeeeiiiidnooooo*ouuuuyty";
+
+    /**
+     * @return 汉字的总笔画数，未知时为0
+     */
+    unsigned strokeCount(uint32_t c) {
+        if (c < 0x3400 || c >= 0xA000) return 0;
+        return base91Digit(g_strokeCounts[c - 0x3400]);
+    }
+
+    bool isHanCodePoint(uint32_t c) {
+        return (c >= 0x3400 && c < 0xA000) || (c >= 0xF900 && c < 0xFB00) || (c >= 0x20000 && c < 0x40000);
+    }
+
+    /**
+     * @brief 为排序折叠码位：全角ASCII转为ASCII，字母转为小写，Latin-1字母转为其基本字母
+     */
+    uint32_t foldCollationCodePoint(uint32_t c) {
+        if (c >= 0xFF01 && c <= 0xFF5E) c -= 0xFEE0;
+        if (c == 0x3000) c = ' ';
+        if (c >= 'A' && c <= 'Z') return c + ('a' - 'A');
+        if (c >= 0xC0 && c <= 0xFF && g_latin1BaseLetters[c - 0xC0] != '*') return g_latin1BaseLetters[c - 0xC0];
+        return c;
+    }
+}
+
+/**
+ * @brief 计算名称的排序键，这样列表排序时只需用memcmp（或std::string的operator<、基数排序）比较键，
+ * 而不必每次比较都调用区域设置相关的比较器。顺序在所有系统上都相同，
+ * 不依赖当前的区域设置。
+ * 字符按以下顺序排列：空格和标点，按数值排列的数字（"file2"在"file10"之前），忽略大小写和重音的拉丁字母，
+ * 汉字，然后是按码位排列的其他字符。按这些权重相等的名称
+ * 按其字节排序，因此只有完全相同的名称才有相同的键
+ * @param text UTF8名称
+ * @param order 汉字的顺序
+ */
+std::string collationKey(const std::string& text, collationOrder order = collatePinyin) {
+    std::string key;
+    key.reserve(text.size() * 2 + 1);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    while (p < end) {
+        uint32_t c = foldCollationCodePoint(nextCodePoint(p, end));
+        if (c >= 'a' && c <= 'z') {
+            key += static_cast<char>(0x20 + (c - 'a'));
+        } else if (c >= '0' && c <= '9') {
+            // 有效数字的位数，然后是各位数字
+            size_t countOffset = key.size() + 1;
+            key += '\x10';
+            key += '\0';
+            unsigned digits = 0;
+            for (;;) {
+                if (digits > 0 || c != '0') {
+                    key += static_cast<char>(c);
+                    ++digits;
+                }
+                const unsigned char* next = p;
+                if (next == end) break;
+                uint32_t d = foldCollationCodePoint(nextCodePoint(next, end));
+                if (d < '0' || d > '9') break;
+                c = d;
+                p = next;
+            }
+            if (digits == 0) {
+                key += '0';
+                digits = 1;
+            }
+            key[countOffset] = static_cast<char>(std::min(digits, 255u));
+        } else if (c < 0x80) {
+            key += '\x05';
+            key += static_cast<char>(c);
+        } else if (c >= 0x3000 && c < 0x3040) {
+            key += '\x05';
+            key += static_cast<char>(0x80 + (c - 0x3000));  // CJK标点在ASCII标点之后
+        } else if (isHanCodePoint(c)) {
+            unsigned strokes = strokeCount(c);
+            if (order == collatePinyin) {
+                unsigned reading = pinyinReading(c);
+                if (!reading) reading = 0xFFF;  // 在所有已知读音之后
+                key += static_cast<char>(0x40 + (reading >> 8));
+                key += static_cast<char>(reading & 0xFF);
+            } else {
+                key += '\x40';
+            }
+            key += static_cast<char>(strokes ? strokes : 0xFF);
+            key += static_cast<char>(c >> 16);
+            key += static_cast<char>((c >> 8) & 0xFF);
+            key += static_cast<char>(c & 0xFF);
+        } else {
+            key += '\xF0';
+            key += static_cast<char>(c >> 16);
+            key += static_cast<char>((c >> 8) & 0xFF);
+            key += static_cast<char>(c & 0xFF);
+        }
+    }
+
+    // 每个权重都以不小于0x05的字节开头，因此作为另一个名称前缀的名称排在前面
+    key += '\0';
+    key += text;
+    return key;
+}
+
+/**
+ * @brief 按排序键对名称排序，每个键只计算一次
+ * @param names UTF8名称，原地排序
+ * @param order 汉字的顺序
+ */
+void sortNames(std::vector<std::string>& names, collationOrder order = collatePinyin) {
+    std::vector<std::pair<std::string, size_t>> keys;
+    keys.reserve(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        keys.emplace_back(collationKey(names[i], order), i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<std::string> sorted;
+    sorted.reserve(names.size());
+    for (const auto& key : keys) {
+        sorted.push_back(std::move(names[key.second]));
+    }
+    names.swap(sorted);
+}
+
+#pragma endregion
+
+#pragma region 字体索引
+// 将已安装的字体按字体族分组，并合并系统、用户和应用程序的字体来源，使字体族和样式能解析到字体文件
+
+#ifndef __GCOMMDLG_FONT_SCAN_THREADS
+#define __GCOMMDLG_FONT_SCAN_THREADS  8            // 读取字体文件的任务数上限
+#endif
+#ifndef __GCOMMDLG_FONT_NAME_TABLE_MAX
+#define __GCOMMDLG_FONT_NAME_TABLE_MAX (1 << 20)   // 超过此大小的'name'表视为损坏
+#endif
+#ifndef __GCOMMDLG_SHARED_FONT_INDEX
+#define __GCOMMDLG_SHARED_FONT_INDEX   1           // 在进程间共享getSystemFontIndex的索引，为0时每个进程各自保留一份
+#endif
+#ifndef __GCOMMDLG_SHARED_FONT_WAIT_MS
+#define __GCOMMDLG_SHARED_FONT_WAIT_MS 2000        // 等待另一个进程完成发布索引的最长时间（Windows）
+#endif
+#ifndef __GCOMMDLG_FONTCONFIG_CACHE
+#define __GCOMMDLG_FONTCONFIG_CACHE    1           // getSystemFontIndex在fontconfig缓存为最新时从中获取字体（POSIX）
+#endif
+
+/**
+ * @brief 字体的来源，按优先级排列：两个来源提供同一字体族的相同样式时，值较小者胜出
+ */
+enum fontSource {
+    fontSourceSystem,     // HKLM的Fonts键，其他平台上为系统字体目录
+    fontSourceUser,       // HKCU的Fonts键（为当前用户安装），其他平台上为主目录中的字体目录
+    fontSourceDirectory   // 通过addFontSearchDirectory或fontIndexBuilder::addFontDirectory添加的目录
+};
+
+/**
+ * @brief 可变字体的一个变体轴，以及字体在该轴上的坐标
+ */
+struct fontVariationAxis {
+    std::string tag;          // 轴标签，例如"wght"、"wdth"、"ital"、"slnt"或"opsz"
+    float minValue;
+    float defaultValue;
+    float maxValue;
+    float value;              // 字体的坐标，传给渲染器，例如FT_Set_Var_Design_Coordinates
+};
+
+/**
+ * @brief 字体族中的一个字体。可变字体的每个命名实例各算一个字体
+ */
+struct fontFaceInfo {
+    std::string family;       // 字体族名称，例如"Segoe UI"
+    std::string style;        // 样式名称，例如"Semibold Italic"
+    std::string path;         // 字体文件路径（UTF8编码）
+    unsigned faceIndex = 0;   // 字体在字体集合（.ttc）中的索引，单字体文件为0
+    int weight = 400;         // 100（极细）到900（特粗），400为常规，700为粗体
+    int width = 5;            // 1（极窄）到9（极宽），5为正常
+    bool italic = false;
+    fontSource source = fontSourceSystem;
+    int instance = -1;                          // 可变字体的命名实例，静态字体为-1
+    std::vector<fontVariationAxis> variation;   // 可变字体的各轴及此字体的坐标，静态字体为空
+    unsigned char panose[10] = {};              // OS/2 PANOSE分类，未知时全为0
+    int xHeight = 0;                            // x高度，以千分之一em为单位，未知时为0
+    int capHeight = 0;                          // 大写字母高度，以千分之一em为单位，未知时为0
+};
+
+/**
+ * @brief 字体族，其字体在fontIndex中连续存放
+ */
+struct fontFamilyInfo {
+    std::string name;
+    size_t firstFace = 0;
+    size_t faceCount = 0;
+};
+
+namespace {
+
+    const uint32_t g_fontIndexMagic = 0x58444946;  // "FIDX"
+    const uint32_t g_fontIndexVersion = 3;
+
+    // 每个OS/2宽度等级对应的'wdth'轴值
+    const float g_fontWidthPercent[9] = {50.0f, 62.5f, 75.0f, 87.5f, 100.0f, 112.5f, 125.0f, 150.0f, 200.0f};
+
+    /**
+     * @brief 折叠字体名称以进行不区分大小写的查找：ASCII字母转为小写，去除首尾空格
+     */
+    std::string foldFontName(const std::string& name) {
+        size_t begin = name.find_first_not_of(' ');
+        if (begin == std::string::npos) return std::string();
+        size_t end = name.find_last_not_of(' ');
+        std::string folded = name.substr(begin, end - begin + 1);
+        for (auto& c : folded) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return folded;
+    }
+
+    /**
+     * @brief 将字体名称中的样式词（如"bold"或"condensed"）应用到字体属性
+     * @param word 小写的词，前面可以连接修饰词（"extrabold"）
+     * @return 该词是否为样式词
+     */
+    bool applyFontStyleWord(const std::string& word, int& weight, int& width, bool& italic) {
+        static const struct {
+            const char* word;
+            int weight;
+            int width;
+        } styleWords[] = {
+            {"regular", 0, 0}, {"normal", 0, 0}, {"book", 0, 0}, {"plain", 0, 0},
+            {"thin", 100, 0}, {"hairline", 100, 0}, {"extralight", 200, 0}, {"ultralight", 200, 0},
+            {"light", 300, 0}, {"semilight", 350, 0}, {"demilight", 350, 0}, {"medium", 500, 0},
+            {"semibold", 600, 0}, {"demibold", 600, 0}, {"demi", 600, 0}, {"bold", 700, 0},
+            {"extrabold", 800, 0}, {"ultrabold", 800, 0}, {"black", 900, 0}, {"heavy", 900, 0},
+            {"extrablack", 950, 0}, {"ultrablack", 950, 0},
+            {"ultracondensed", 0, 1}, {"extracondensed", 0, 2}, {"condensed", 0, 3}, {"cond", 0, 3},
+            {"narrow", 0, 3}, {"semicondensed", 0, 4}, {"semiexpanded", 0, 6}, {"expanded", 0, 7},
+            {"extended", 0, 7}, {"wide", 0, 7}, {"extraexpanded", 0, 8}, {"ultraexpanded", 0, 9},
+        };
+        if (word == "italic" || word == "oblique") {
+            italic = true;
+            return true;
+        }
+        for (const auto& entry : styleWords) {
+            if (word == entry.word) {
+                if (entry.weight) weight = entry.weight;
+                if (entry.width) width = entry.width;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 在末尾的样式词处将完整字体名称（如"Segoe UI Semibold Italic"）拆分为字体族和样式
+     * @param legacyFamily 输出GDI所见的字体族名称，其中只有常规、粗体和斜体算作样式（"Segoe UI Semibold"）
+     */
+    void splitFontName(const std::string& name, fontFaceInfo& face, std::string& legacyFamily) {
+        std::vector<std::pair<size_t, size_t>> words;
+        for (size_t i = 0; i < name.size();) {
+            if (name[i] == ' ') {
+                ++i;
+                continue;
+            }
+            size_t end = name.find(' ', i);
+            if (end == std::string::npos) end = name.size();
+            words.emplace_back(i, end);
+            i = end;
+        }
+        auto word = [&](size_t i) {
+            return foldFontName(name.substr(words[i].first, words[i].second - words[i].first));
+        };
+
+        // 从后向前跳过样式词，至少为字体族保留一个词。修饰词与其后的词连接（"Extra Bold"）
+        int weight = 400, width = 5;
+        bool italic = false;
+        size_t first = words.size();
+        size_t legacyEnd = words.size();
+        while (first > 1) {
+            std::string last = word(first - 1);
+            size_t count = first > 2 && applyFontStyleWord(word(first - 2) + last, weight, width, italic) ? 2 : 1;
+            if (count == 1 && !applyFontStyleWord(last, weight, width, italic)) break;
+            bool ribbi = count == 1 && (last == "regular" || last == "bold" || last == "italic" || last == "oblique");
+            if (legacyEnd == first && ribbi) legacyEnd = first - 1;
+            first -= count;
+        }
+
+        face.weight = weight;
+        face.width = width;
+        face.italic = italic;
+        face.family = words.empty() ? std::string() : name.substr(words[0].first, words[first - 1].second - words[0].first);
+        face.style = first < words.size() ? name.substr(words[first].first, words.back().second - words[first].first) : "Regular";
+        legacyFamily = words.empty() ? std::string() : name.substr(words[0].first, words[legacyEnd - 1].second - words[0].first);
+    }
+
+    uint16_t readBigEndian16(const unsigned char* p) {
+        return static_cast<uint16_t>((p[0] << 8) | p[1]);
+    }
+
+    uint32_t readBigEndian32(const unsigned char* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    bool readFileBytes(FILE* file, unsigned long long offset, size_t size, std::vector<unsigned char>& out) {
+        out.resize(size);
+        return seekFile(file, static_cast<long long>(offset), SEEK_SET) == 0 &&
+               (size == 0 || fread(out.data(), 1, size, file) == size);
+    }
+
+    struct sfntTable {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    /**
+     * @brief 在sfnt表目录中查找一个表
+     * @param directory 紧随12字节偏移表之后的表记录
+     * @param tag 四字符的表标签，例如"name"
+     */
+    sfntTable findSfntTable(const std::vector<unsigned char>& directory, const char* tag) {
+        sfntTable table;
+        for (size_t i = 0; i + 16 <= directory.size(); i += 16) {
+            if (std::memcmp(directory.data() + i, tag, 4) == 0) {
+                table.offset = readBigEndian32(directory.data() + i + 8);
+                table.length = readBigEndian32(directory.data() + i + 12);
+                break;
+            }
+        }
+        return table;
+    }
+
+    /**
+     * @brief 将'name'表中的字符串解码为UTF8
+     * @return 对Unicode和仅含ASCII的Mac Roman以外的编码返回false
+     */
+    bool decodeSfntName(uint16_t platform, uint16_t encoding, const unsigned char* data, size_t length, std::string& out) {
+        out.clear();
+        if (platform == 0 || (platform == 3 && (encoding == 0 || encoding == 1 || encoding == 10))) {
+            std::vector<unsigned char> swapped(length & ~static_cast<size_t>(1));
+            for (size_t i = 0; i < swapped.size(); i += 2) {
+                swapped[i] = data[i + 1];
+                swapped[i + 1] = data[i];
+            }
+            appendUtf16AsUtf8(out, swapped.data(), swapped.size() / 2);
+            return true;
+        }
+        if (platform == 1 && encoding == 0) {
+            for (size_t i = 0; i < length; ++i) {
+                if (data[i] >= 0x80) return false;
+                out += static_cast<char>(data[i]);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 按语言对'name'记录排序，值越小越优先：Windows美国英语、其他英语、Mac英语、Unicode平台、其余
+     */
+    int sfntNameRank(uint16_t platform, uint16_t language) {
+        if (platform == 3) return language == 0x0409 ? 0 : (language & 0x3FF) == 0x09 ? 1 : 4;
+        if (platform == 1) return language == 0 ? 2 : 5;
+        return 3;
+    }
+
+    void addUniqueName(std::vector<std::string>& names, const std::string& name) {
+        if (std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+    }
+
+    float readFixed(const unsigned char* p) {
+        return static_cast<int32_t>(readBigEndian32(p)) / 65536.0f;
+    }
+
+    /**
+     * @brief 根据可变字体在注册轴上的坐标得出字重、宽度和斜体
+     */
+    void applyVariationStyle(fontFaceInfo& face) {
+        for (const auto& axis : face.variation) {
+            if (axis.tag == "wght") {
+                face.weight = std::min(std::max(static_cast<int>(axis.value + 0.5f), 1), 1000);
+            } else if (axis.tag == "wdth") {
+                int nearest = 0;
+                for (int i = 1; i < 9; ++i) {
+                    if (std::fabs(g_fontWidthPercent[i] - axis.value) < std::fabs(g_fontWidthPercent[nearest] - axis.value)) nearest = i;
+                }
+                face.width = nearest + 1;
+            } else if (axis.tag == "ital") {
+                face.italic = axis.value >= 0.5f;
+            } else if (axis.tag == "slnt") {
+                face.italic = axis.value != 0.0f;
+            }
+        }
+    }
+
+    /**
+     * @brief 读取sfnt（TrueType / OpenType）字体中一个字体的名称、字重、宽度和斜体标志。
+     * 可变字体按其'fvar'表中的每个命名实例各产生一个字体
+     * @param offset 该字体的偏移表在文件中的偏移
+     * @param face 字体的路径和索引，其余字段由此函数填写
+     * @param familyNames 输出所有语言的排版字体族名称，每个字体一个列表
+     * @param legacyNames 输出所有语言的旧式（GDI）字体族名称，例如"Segoe UI Semibold"，每个字体一个列表
+     */
+    bool readSfntFace(FILE* file, unsigned long long offset, fontFaceInfo face, std::vector<fontFaceInfo>& faces,
+                      std::vector<std::vector<std::string>>& familyNames,
+                      std::vector<std::vector<std::string>>& legacyNames) {
+        std::vector<unsigned char> buffer;
+        if (!readFileBytes(file, offset, 12, buffer)) return false;
+        uint32_t version = readBigEndian32(buffer.data());
+        if (version != 0x00010000 && version != 0x4F54544F && version != 0x74727565) return false;  // 1.0、"OTTO"、"true"
+        std::vector<unsigned char> directory;
+        if (!readFileBytes(file, offset + 12, readBigEndian16(buffer.data() + 4) * 16u, directory)) return false;
+
+        sfntTable names = findSfntTable(directory, "name");
+        if (names.length < 6 || names.length > __GCOMMDLG_FONT_NAME_TABLE_MAX ||
+            !readFileBytes(file, names.offset, names.length, buffer)) {
+            return false;
+        }
+
+        // 名称ID 1（字体族）、2（子族）、16（排版字体族）、17（排版子族）
+        // 以及'fvar'和'STAT'引用的256起的字体专用ID中，排名最高的字符串
+        std::unordered_map<uint16_t, std::pair<int, std::string>> best;
+        std::vector<std::string> family, legacy;
+        size_t recordCount = readBigEndian16(buffer.data() + 2);
+        size_t storage = readBigEndian16(buffer.data() + 4);
+        std::string text;
+        for (size_t i = 0; i < recordCount && 6 + i * 12 + 12 <= buffer.size(); ++i) {
+            const unsigned char* record = buffer.data() + 6 + i * 12;
+            uint16_t nameId = readBigEndian16(record + 6);
+            size_t length = readBigEndian16(record + 8);
+            size_t start = storage + readBigEndian16(record + 10);
+            if ((nameId < 256 && nameId != 1 && nameId != 2 && nameId != 16 && nameId != 17) || start + length > buffer.size()) {
+                continue;
+            }
+
+            uint16_t platform = readBigEndian16(record);
+            if (!decodeSfntName(platform, readBigEndian16(record + 2), buffer.data() + start, length, text) || text.empty()) {
+                continue;
+            }
+            if (nameId == 1) addUniqueName(legacy, text);
+            if (nameId == 16) addUniqueName(family, text);
+            int rank = sfntNameRank(platform, readBigEndian16(record + 4));
+            auto it = best.find(nameId);
+            if (it == best.end() || rank < it->second.first) {
+                best[nameId] = std::make_pair(rank, text);
+            }
+        }
+        auto name = [&](uint16_t nameId) {
+            auto it = best.find(nameId);
+            return it == best.end() ? std::string() : it->second.second;
+        };
+        if (name(1).empty() && name(16).empty()) return false;
+
+        if (!name(16).empty()) {
+            face.family = name(16);
+        } else {
+            // 没有排版字体族时，从旧式字体族中去掉样式词，例如"Foo Light"归入"Foo"
+            fontFaceInfo parsed;
+            std::string legacyFamily;
+            splitFontName(name(1), parsed, legacyFamily);
+            face.family = parsed.family;
+        }
+        face.style = !name(17).empty() ? name(17) : !name(2).empty() ? name(2) : "Regular";
+
+        sfntTable os2 = findSfntTable(directory, "OS/2");
+        sfntTable head = findSfntTable(directory, "head");
+        int unitsPerEm = 0;
+        uint16_t macStyle = 0;
+        bool hasHead = head.length >= 46 && readFileBytes(file, head.offset, 46, buffer);
+        if (hasHead) {
+            unitsPerEm = readBigEndian16(buffer.data() + 18);
+            macStyle = readBigEndian16(buffer.data() + 44);
+        }
+        if (os2.length >= 64 && readFileBytes(file, os2.offset, std::min<uint32_t>(os2.length, 90), buffer)) {
+            int weightClass = readBigEndian16(buffer.data() + 4);
+            if (weightClass > 0 && weightClass < 10) weightClass *= 100;  // 一些旧字体使用1到9的刻度
+            if (weightClass >= 1 && weightClass <= 1000) face.weight = weightClass;
+            int widthClass = readBigEndian16(buffer.data() + 6);
+            if (widthClass >= 1 && widthClass <= 9) face.width = widthClass;
+            face.italic = (readBigEndian16(buffer.data() + 62) & 0x0201) != 0;  // ITALIC或OBLIQUE
+            std::memcpy(face.panose, buffer.data() + 32, 10);
+
+            // sxHeight和sCapHeight从OS/2第2版起才有
+            if (readBigEndian16(buffer.data()) >= 2 && buffer.size() >= 90 && unitsPerEm > 0) {
+                int xHeight = static_cast<int16_t>(readBigEndian16(buffer.data() + 86));
+                int capHeight = static_cast<int16_t>(readBigEndian16(buffer.data() + 88));
+                face.xHeight = std::min(std::max(xHeight * 1000 / unitsPerEm, 0), 65535);
+                face.capHeight = std::min(std::max(capHeight * 1000 / unitsPerEm, 0), 65535);
+            }
+        } else if (hasHead) {
+            face.weight = (macStyle & 1) ? 700 : 400;
+            face.italic = (macStyle & 2) != 0;
+        }
+
+        // 'STAT'给出文件在其不可变的轴上的位置：拆分为两个文件的字体族中，斜体文件只有一个值为1的'ital'轴值
+        sfntTable stat = findSfntTable(directory, "STAT");
+        uint16_t elidedName = 0;
+        if (stat.length >= 18 && stat.length <= __GCOMMDLG_FONT_NAME_TABLE_MAX && readFileBytes(file, stat.offset, stat.length, buffer)) {
+            size_t axisSize = readBigEndian16(buffer.data() + 4);
+            size_t axisCount = readBigEndian16(buffer.data() + 6);
+            size_t axesOffset = readBigEndian32(buffer.data() + 8);
+            size_t valueCount = readBigEndian16(buffer.data() + 12);
+            size_t valuesOffset = readBigEndian32(buffer.data() + 14);
+            if (readBigEndian16(buffer.data() + 2) >= 1 && stat.length >= 20) elidedName = readBigEndian16(buffer.data() + 18);
+
+            std::vector<std::string> tags;
+            for (size_t i = 0; i < axisCount && axisSize >= 4 && axesOffset + i * axisSize + 4 <= buffer.size(); ++i) {
+                tags.emplace_back(reinterpret_cast<const char*>(buffer.data() + axesOffset + i * axisSize), 4);
+            }
+            std::vector<int> valuesPerAxis(tags.size(), 0);
+            std::vector<float> values(tags.size(), 0.0f);
+            for (size_t i = 0; i < valueCount && valuesOffset + i * 2 + 2 <= buffer.size(); ++i) {
+                size_t at = valuesOffset + readBigEndian16(buffer.data() + valuesOffset + i * 2);
+                if (at + 12 > buffer.size()) continue;
+                uint16_t format = readBigEndian16(buffer.data() + at);
+                uint16_t axis = readBigEndian16(buffer.data() + at + 2);
+                if ((format == 1 || format == 3) && axis < tags.size()) {
+                    ++valuesPerAxis[axis];
+                    values[axis] = readFixed(buffer.data() + at + 8);
+                }
+            }
+            for (size_t i = 0; i < tags.size(); ++i) {
+                if (valuesPerAxis[i] != 1) continue;
+                if (tags[i] == "ital" && values[i] >= 0.5f) face.italic = true;
+                if (tags[i] == "slnt" && values[i] != 0.0f) face.italic = true;
+            }
+        }
+
+        sfntTable fvar = findSfntTable(directory, "fvar");
+        if (fvar.length >= 16 && fvar.length <= __GCOMMDLG_FONT_NAME_TABLE_MAX && readFileBytes(file, fvar.offset, fvar.length, buffer)) {
+            size_t axesOffset = readBigEndian16(buffer.data() + 4);
+            size_t axisCount = readBigEndian16(buffer.data() + 8);
+            size_t axisSize = readBigEndian16(buffer.data() + 10);
+            size_t instanceCount = readBigEndian16(buffer.data() + 12);
+            size_t instanceSize = readBigEndian16(buffer.data() + 14);
+            if (axisCount > 0 && axisSize >= 20 && instanceSize >= 4 + axisCount * 4 &&
+                axesOffset + axisCount * axisSize + instanceCount * instanceSize <= buffer.size()) {
+                for (size_t i = 0; i < axisCount; ++i) {
+                    const unsigned char* record = buffer.data() + axesOffset + i * axisSize;
+                    fontVariationAxis axis;
+                    axis.tag.assign(reinterpret_cast<const char*>(record), 4);
+                    axis.minValue = readFixed(record + 4);
+                    axis.defaultValue = readFixed(record + 8);
+                    axis.maxValue = readFixed(record + 12);
+                    axis.value = axis.defaultValue;
+                    face.variation.push_back(axis);
+                }
+
+                const unsigned char* instances = buffer.data() + axesOffset + axisCount * axisSize;
+                for (size_t i = 0; i < instanceCount; ++i) {
+                    const unsigned char* record = instances + i * instanceSize;
+                    fontFaceInfo instance = face;
+                    instance.instance = static_cast<int>(i);
+                    for (size_t j = 0; j < axisCount; ++j) {
+                        instance.variation[j].value = readFixed(record + 4 + j * 4);
+                    }
+                    std::string subfamily = name(readBigEndian16(record));
+                    if (subfamily.empty()) subfamily = name(elidedName);
+                    if (!subfamily.empty()) instance.style = subfamily;
+                    applyVariationStyle(instance);
+
+                    faces.push_back(std::move(instance));
+                    familyNames.push_back(family);
+                    legacyNames.push_back(legacy);
+                }
+                if (instanceCount > 0) return true;
+                applyVariationStyle(face);
+            }
+        }
+
+        faces.push_back(std::move(face));
+        familyNames.push_back(std::move(family));
+        legacyNames.push_back(std::move(legacy));
+        return true;
+    }
+
+    /**
+     * @brief 读取字体文件或字体集合中的每个字体，见readSfntFace
+     * @param familyNames 输出排版字体族名称，每个字体一个列表
+     * @param legacyNames 输出旧式字体族名称，每个字体一个列表
+     * @return 是否至少读取了一个字体
+     */
+    bool readSfntFaces(const std::string& path, std::vector<fontFaceInfo>& faces,
+                       std::vector<std::vector<std::string>>& familyNames,
+                       std::vector<std::vector<std::string>>& legacyNames) {
+        FILE* file = openFileForRead(path);
+        if (!file) return false;
+
+        std::vector<unsigned char> buffer;
+        std::vector<uint32_t> offsets;
+        if (readFileBytes(file, 0, 12, buffer)) {
+            if (std::memcmp(buffer.data(), "ttcf", 4) == 0) {
+                uint32_t count = readBigEndian32(buffer.data() + 8);
+                if (count <= 65536 && readFileBytes(file, 12, count * 4u, buffer)) {
+                    for (uint32_t i = 0; i < count; ++i) {
+                        offsets.push_back(readBigEndian32(buffer.data() + i * 4));
+                    }
+                }
+            } else {
+                offsets.push_back(0);
+            }
+        }
+
+        bool found = false;
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            fontFaceInfo face;
+            face.path = path;
+            face.faceIndex = static_cast<unsigned>(i);
+            found |= readSfntFace(file, offsets[i], face, faces, familyNames, legacyNames);
+        }
+        fclose(file);
+        return found;
+    }
+
+    /**
+     * @brief 字体字重相对于请求字重的惩罚值，越小越好。遵循CSS规则：400优先尝试500，
+     * 较细的字重先查找更细的字体，较粗的字重先查找更粗的字体
+     */
+    int fontWeightPenalty(int desired, int actual) {
+        if (actual == desired) return 0;
+        if (desired >= 400 && desired <= 500) {
+            if (actual > desired && actual <= 500) return actual - desired;
+            if (actual < desired) return 1000 + desired - actual;
+            return 2000 + actual - desired;
+        }
+        if (desired < 400) return actual < desired ? desired - actual : 1000 + actual - desired;
+        return actual > desired ? actual - desired : 1000 + desired - actual;
+    }
+
+}
+
+/**
+ * @brief 只读字体索引：字体族及其字体存放在一个扁平数组中，按名称以O(log n)查找
+ *
+ * 索引是一个不含指针、与位置无关的映像，见data()。可用fontIndexBuilder创建，或使用getSystemFontIndex
+ */
+class fontIndex {
+private:
+    // 字体索引映像的布局。偏移均相对于映像起始处，因此映像可以被复制或映射到任何位置
+    struct imageHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t size;            // 映像大小（字节）
+        uint32_t familyCount;
+        uint32_t familyOffset;    // familyRecord[familyCount]，按折叠后的名称排序
+        uint32_t faceCount;
+        uint32_t faceOffset;      // faceRecord[faceCount]，按字体族分组
+        uint32_t nameCount;
+        uint32_t nameOffset;      // nameRecord[nameCount]，按折叠后的名称排序
+        uint32_t axisCount;
+        uint32_t axisOffset;      // axisRecord[axisCount]，每个可变字体文件的轴只存一次
+        uint32_t coordinateCount;
+        uint32_t coordinateOffset;  // float[coordinateCount]，可变字体的轴坐标
+        uint32_t featureOffset;   // featureRecord[faceCount]，按字体顺序排列的相似度特征
+        uint32_t stringOffset;    // 以NUL结尾的UTF8字符串，记录通过相对此处的偏移引用它们
+        uint32_t stringSize;
+    };
+
+    struct familyRecord {
+        uint32_t name;
+        uint32_t firstFace;
+        uint32_t faceCount;
+    };
+
+    struct faceRecord {
+        uint32_t family;
+        uint32_t style;
+        uint32_t path;
+        uint32_t faceIndex;
+        uint16_t weight;
+        uint8_t width;
+        uint8_t italic;
+        uint8_t source;
+        uint8_t reserved;
+        uint16_t axisCount;       // 静态字体为0
+        uint32_t firstAxis;
+        uint32_t firstCoordinate;
+        int32_t instance;
+    };
+
+    // 与faceRecord分开存放，使相似度搜索只扫描一个紧凑的数组
+    struct featureRecord {
+        uint8_t panose[10];       // 未知时全为0
+        uint8_t width;
+        uint8_t italic;
+        uint16_t weight;
+        uint16_t xHeight;         // 以千分之一em为单位，未知时为0
+        uint16_t capHeight;
+        uint16_t reserved;
+    };
+
+    struct axisRecord {
+        uint32_t tag;
+        float minValue;
+        float defaultValue;
+        float maxValue;
+    };
+
+    // 可用于查找字体族的每个名称：自身名称、本地化名称，以及"Segoe UI Semibold"这样的旧式名称
+    struct nameRecord {
+        uint32_t name;            // 折叠后的名称
+        uint32_t family;
+        uint16_t weight;          // 旧式名称隐含的字重，没有则为0
+        uint8_t width;            // 旧式名称隐含的宽度，没有则为0
+        uint8_t reserved;
+    };
+
+    friend class fontIndexBuilder;
+
+public:
+    /**
+     * @brief 包装由fontIndexBuilder创建的索引映像
+     * @param image 映像数据，由索引保持存活
+     * @param size 映像大小（字节）
+     * @throw std::invalid_argument 当映像被截断、版本不同或引用了自身范围之外的位置时抛出
+     */
+    fontIndex(std::shared_ptr<const unsigned char> image, size_t size) : m_image(chargedBuffer(memoryFontIndexes, std::move(image), size)) {
+        const unsigned char* base = m_image.get();
+        if (!base || size < sizeof(imageHeader)) {
+            throw std::invalid_argument("Font index image is truncated");
+        }
+        std::memcpy(&m_header, base, sizeof(m_header));
+        if (m_header.magic != g_fontIndexMagic || m_header.version != g_fontIndexVersion) {
+            throw std::invalid_argument("Font index image has an unknown format");
+        }
+
+        auto inside = [&](uint64_t offset, uint64_t count, uint64_t recordSize) {
+            return offset % 4 == 0 && offset + count * recordSize <= m_header.size;
+        };
+        if (m_header.size > size ||
+            !inside(m_header.familyOffset, m_header.familyCount, sizeof(familyRecord)) ||
+            !inside(m_header.faceOffset, m_header.faceCount, sizeof(faceRecord)) ||
+            !inside(m_header.nameOffset, m_header.nameCount, sizeof(nameRecord)) ||
+            !inside(m_header.axisOffset, m_header.axisCount, sizeof(axisRecord)) ||
+            !inside(m_header.coordinateOffset, m_header.coordinateCount, sizeof(float)) ||
+            !inside(m_header.featureOffset, m_header.faceCount, sizeof(featureRecord)) ||
+            static_cast<uint64_t>(m_header.stringOffset) + m_header.stringSize > m_header.size ||
+            (m_header.stringSize > 0 && base[m_header.stringOffset + m_header.stringSize - 1] != 0)) {
+            throw std::invalid_argument("Font index image is corrupt");
+        }
+        m_families = reinterpret_cast<const familyRecord*>(base + m_header.familyOffset);
+        m_faces = reinterpret_cast<const faceRecord*>(base + m_header.faceOffset);
+        m_names = reinterpret_cast<const nameRecord*>(base + m_header.nameOffset);
+        m_axes = reinterpret_cast<const axisRecord*>(base + m_header.axisOffset);
+        m_coordinates = reinterpret_cast<const float*>(base + m_header.coordinateOffset);
+        m_features = reinterpret_cast<const featureRecord*>(base + m_header.featureOffset);
+        m_strings = reinterpret_cast<const char*>(base + m_header.stringOffset);
+
+        bool valid = true;
+        for (uint32_t i = 0; i < m_header.familyCount; ++i) {
+            valid &= m_families[i].name < m_header.stringSize &&
+                     static_cast<uint64_t>(m_families[i].firstFace) + m_families[i].faceCount <= m_header.faceCount;
+        }
+        for (uint32_t i = 0; i < m_header.faceCount; ++i) {
+            valid &= m_faces[i].family < m_header.familyCount && m_faces[i].style < m_header.stringSize &&
+                     m_faces[i].path < m_header.stringSize &&
+                     static_cast<uint64_t>(m_faces[i].firstAxis) + m_faces[i].axisCount <= m_header.axisCount &&
+                     static_cast<uint64_t>(m_faces[i].firstCoordinate) + m_faces[i].axisCount <= m_header.coordinateCount;
+        }
+        for (uint32_t i = 0; i < m_header.nameCount; ++i) {
+            valid &= m_names[i].name < m_header.stringSize && m_names[i].family < m_header.familyCount;
+        }
+        if (!valid) {
+            throw std::invalid_argument("Font index image is corrupt");
+        }
+    }
+
+    size_t familyCount() const {
+        return m_header.familyCount;
+    }
+
+    /**
+     * @param index 字体族索引，小于familyCount()
+     */
+    fontFamilyInfo family(size_t index) const {
+        const familyRecord& record = m_families[index];
+        fontFamilyInfo info;
+        info.name = m_strings + record.name;
+        info.firstFace = record.firstFace;
+        info.faceCount = record.faceCount;
+        return info;
+    }
+
+    size_t faceCount() const {
+        return m_header.faceCount;
+    }
+
+    /**
+     * @param index 字体索引，小于faceCount()
+     */
+    fontFaceInfo face(size_t index) const {
+        const faceRecord& record = m_faces[index];
+        fontFaceInfo info;
+        info.family = m_strings + m_families[record.family].name;
+        info.style = m_strings + record.style;
+        info.path = m_strings + record.path;
+        info.faceIndex = record.faceIndex;
+        info.weight = record.weight;
+        info.width = record.width;
+        info.italic = record.italic != 0;
+        info.source = static_cast<fontSource>(record.source);
+        info.instance = record.instance;
+        for (uint32_t i = 0; i < record.axisCount; ++i) {
+            const axisRecord& axis = m_axes[record.firstAxis + i];
+            fontVariationAxis variation;
+            variation.tag.assign(reinterpret_cast<const char*>(&axis.tag), 4);
+            variation.minValue = axis.minValue;
+            variation.defaultValue = axis.defaultValue;
+            variation.maxValue = axis.maxValue;
+            variation.value = m_coordinates[record.firstCoordinate + i];
+            info.variation.push_back(variation);
+        }
+        const featureRecord& features = m_features[index];
+        std::memcpy(info.panose, features.panose, sizeof(info.panose));
+        info.xHeight = features.xHeight;
+        info.capHeight = features.capHeight;
+        return info;
+    }
+
+    /**
+     * @brief 按名称查找字体族，忽略ASCII大小写。本地化名称和"Segoe UI Semibold"这样的旧式名称也能找到
+     * @param familyIndex 输出字体族索引
+     */
+    bool findFamily(const std::string& name, size_t& familyIndex) const {
+        const nameRecord* record = findName(foldFontName(name));
+        if (!record) return false;
+        familyIndex = record->family;
+        return true;
+    }
+
+    /**
+     * @brief findFamily知道的所有名称（以同样方式折叠）及其找到的字体族：字体族名、本地化名称和
+     * 旧式名称。基于它们的pinyinSearch在输入"wryh"时能找到微软雅黑
+     * @return 名称和字体族索引对，按名称排序
+     */
+    std::vector<std::pair<std::string, size_t>> lookupNames() const {
+        std::vector<std::pair<std::string, size_t>> names;
+        names.reserve(m_header.nameCount);
+        for (uint32_t i = 0; i < m_header.nameCount; ++i) {
+            names.emplace_back(m_strings + m_names[i].name, m_names[i].family);
+        }
+        return names;
+    }
+
+    /**
+     * @brief 按CSS字体匹配顺序（先斜体，再宽度，最后字重）选出字体族中最接近请求样式的字体
+     * @param familyName 字体族名称，同findFamily。请求常规字重和宽度时，"Arial Black"这样的旧式名称会使用其隐含的字重和宽度
+     * @param weight 请求的字重，例如LOGFONT::lfWeight
+     * @param italic 是否请求斜体
+     * @param width 请求的宽度，5为正常
+     * @param faceIndex 输出字体索引
+     * @return 没有该名称的字体族时返回false
+     */
+    bool matchFace(const std::string& familyName, int weight, bool italic, int width, size_t& faceIndex) const {
+        return matchRequest(familyName, weight, italic, width, faceIndex);
+    }
+
+    /**
+     * @brief 与matchFace一样选出字体，对可变字体还会将'wght'和'wdth'坐标移到请求的字重和宽度（限制在轴范围内），
+     * 例如字重450会按450渲染，而不是按最接近的命名实例渲染
+     * @param face 输出字体，字重和宽度与坐标一致
+     */
+    bool matchFace(const std::string& familyName, int weight, bool italic, int width, fontFaceInfo& face) const {
+        size_t index;
+        if (!matchRequest(familyName, weight, italic, width, index)) return false;
+        face = this->face(index);
+        for (auto& axis : face.variation) {
+            if (axis.tag == "wght") {
+                axis.value = std::min(std::max(static_cast<float>(weight), axis.minValue), axis.maxValue);
+                face.weight = static_cast<int>(axis.value + 0.5f);
+            } else if (axis.tag == "wdth" && width >= 1 && width <= 9) {
+                axis.value = std::min(std::max(g_fontWidthPercent[width - 1], axis.minValue), axis.maxValue);
+                applyVariationStyle(face);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 查找其他字体族中外观与某字体最相似的字体，例如在字体缺少字形时建议替代字体。
+     * 按PANOSE分类、字重、宽度、斜体、x高度和大写字母高度比较字体；每个字体族只取其最接近的字体
+     * @param face 字体索引，小于faceCount()
+     * @param count 返回的字体数量上限
+     * @return 字体索引，最相似的在前
+     */
+    std::vector<size_t> similarFaces(size_t face, size_t count = 10) const {
+        const featureRecord& target = m_features[face];
+        uint32_t targetFamily = m_faces[face].family;
+        std::vector<std::pair<float, size_t>> candidates;
+        candidates.reserve(m_header.familyCount);
+        for (uint32_t family = 0; family < m_header.familyCount; ++family) {
+            if (family == targetFamily) continue;
+            const familyRecord& record = m_families[family];
+            std::pair<float, size_t> best(std::numeric_limits<float>::max(), 0);
+            for (uint32_t i = record.firstFace; i < record.firstFace + record.faceCount; ++i) {
+                float distance = featureDistance(target, m_features[i]);
+                if (distance < best.first) best = std::make_pair(distance, static_cast<size_t>(i));
+            }
+            if (record.faceCount > 0) candidates.push_back(best);
+        }
+
+        count = std::min(count, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        std::vector<size_t> faces;
+        faces.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            faces.push_back(candidates[i].second);
+        }
+        return faces;
+    }
+
+    /**
+     * @brief 索引映像，例如可保存到文件，之后再用构造函数加载
+     */
+    const unsigned char* data() const {
+        return m_image.get();
+    }
+
+    size_t size() const {
+        return m_header.size;
+    }
+
+private:
+    /**
+     * @brief 为指定字体族的各字体打分，weight和width会更新为旧式名称隐含的值
+     */
+    bool matchRequest(const std::string& familyName, int& weight, bool italic, int& width, size_t& faceIndex) const {
+        const nameRecord* name = findName(foldFontName(familyName));
+        if (!name) return false;
+        if (weight <= 0) weight = 400;
+        if (name->weight && weight == 400) weight = name->weight;
+        if (name->width && width == 5) width = name->width;
+
+        const familyRecord& family = m_families[name->family];
+        long best = -1;
+        for (uint32_t i = family.firstFace; i < family.firstFace + family.faceCount; ++i) {
+            const faceRecord& face = m_faces[i];
+            long score = ((face.italic != 0) != italic ? 100000L : 0L) +
+                         10000L * std::abs(static_cast<int>(face.width) - width) +
+                         fontWeightPenalty(weight, face.weight);
+            if (best < 0 || score < best) {
+                best = score;
+                faceIndex = i;
+            }
+        }
+        return best >= 0;
+    }
+
+    /**
+     * @brief 两个字体的差异度，特征相同时为0。未知特征计固定代价，
+     * 因此PANOSE分类相符的字体排在未分类的字体之前
+     */
+    static float featureDistance(const featureRecord& a, const featureRecord& b) {
+        float distance = std::abs(a.weight - b.weight) * 0.005f + std::abs(a.width - b.width) * 0.5f + (a.italic != b.italic ? 2.0f : 0.0f);
+        distance += a.xHeight && b.xHeight ? std::abs(a.xHeight - b.xHeight) * 0.02f : 1.0f;
+        distance += a.capHeight && b.capHeight ? std::abs(a.capHeight - b.capHeight) * 0.01f : 1.0f;
+
+        // PANOSE各位：字体类别、衬线样式、字重、比例、对比度、笔画变化、笔臂样式、字母形式、中线、x高度
+        if (a.panose[0] == 0 || b.panose[0] == 0) return distance + 5.0f;
+        if (a.panose[0] != b.panose[0]) return distance + 8.0f;
+        if (a.panose[0] != 2) {
+            // 手写体、装饰字体和符号字体的各位含义不同，只统计不同的位数
+            for (int i = 1; i < 10; ++i) distance += a.panose[i] != b.panose[i] ? 0.3f : 0.0f;
+            return distance;
+        }
+
+        // 拉丁文本。字重已通过上面的字重等级比较；0（任意）和1（不适用）视为未知
+        static const float digitWeight[10] = {0.0f, 3.0f, 0.0f, 2.0f, 1.0f, 0.5f, 0.5f, 1.0f, 0.5f, 0.5f};
+        for (int i = 1; i < 10; ++i) {
+            int x = a.panose[i], y = b.panose[i];
+            float difference;
+            if (x == y) {
+                difference = 0.0f;
+            } else if (x <= 1 || y <= 1) {
+                difference = 0.5f;
+            } else if (i == 1) {
+                // 衬线样式为2到10，无衬线样式为11到13
+                difference = (x >= 11) != (y >= 11) ? 1.0f : 0.3f;
+            } else if (i == 3) {
+                // 比例9表示等宽
+                difference = (x == 9) != (y == 9) ? 1.5f : std::min(std::abs(x - y) * 0.25f, 1.0f);
+            } else if (i == 4) {
+                difference = std::min(std::abs(x - y) * 0.25f, 1.0f);
+            } else {
+                difference = 1.0f;
+            }
+            distance += digitWeight[i] * difference;
+        }
+        return distance;
+    }
+
+    const nameRecord* findName(const std::string& folded) const {
+        const nameRecord* begin = m_names;
+        const nameRecord* end = m_names + m_header.nameCount;
+        const nameRecord* found = std::lower_bound(begin, end, folded, [this](const nameRecord& record, const std::string& key) {
+            return std::strcmp(m_strings + record.name, key.c_str()) < 0;
+        });
+        if (found == end || folded != m_strings + found->name) found = nullptr;
+        __GCOMMDLG_PROBE2(font__lookup, folded.c_str(), static_cast<int>(found != nullptr));
+        return found;
+    }
+
+    std::shared_ptr<const unsigned char> m_image;
+    imageHeader m_header;
+    const familyRecord* m_families = nullptr;
+    const faceRecord* m_faces = nullptr;
+    const nameRecord* m_names = nullptr;
+    const axisRecord* m_axes = nullptr;
+    const float* m_coordinates = nullptr;
+    const featureRecord* m_features = nullptr;
+    const char* m_strings = nullptr;
+};
+
+#ifndef _WIN32
+namespace {
+
+    const uint32_t g_fontconfigCacheMagic = 0xFC02FC04;  // FC_CACHE_MAGIC_MMAP
+
+    // fontconfig的对象ID（fcobjs.h）和值类型（FcType）
+    const int g_fontconfigFamily = 1;
+    const int g_fontconfigStyle = 3;
+    const int g_fontconfigSlant = 7;
+    const int g_fontconfigWeight = 8;
+    const int g_fontconfigWidth = 9;
+    const int g_fontconfigFile = 21;
+    const int g_fontconfigIndex = 22;
+    const int g_fontconfigInteger = 1;
+    const int g_fontconfigDouble = 2;
+    const int g_fontconfigString = 3;
+    const int g_fontconfigRange = 9;
+
+    /**
+     * @brief 将fontconfig字重（80为常规，200为粗体）转换为OpenType刻度，即FcWeightFromOpenTypeDouble的逆运算
+     */
+    int fontconfigWeightToOpenType(double weight) {
+        static const double fc[] = {0, 40, 50, 55, 75, 80, 100, 180, 200, 205, 210, 215};
+        static const double ot[] = {100, 200, 300, 350, 380, 400, 500, 600, 700, 800, 900, 1000};
+        if (weight <= fc[0]) return 100;
+        for (int i = 1; i < 12; ++i) {
+            if (weight <= fc[i]) {
+                return static_cast<int>(ot[i - 1] + (weight - fc[i - 1]) * (ot[i] - ot[i - 1]) / (fc[i] - fc[i - 1]) + 0.5);
+            }
+        }
+        return 1000;
+    }
+
+    /**
+     * @brief 64位小端fontconfig缓存文件（"<hash>-le64.cache-<version>"）的只读视图，其中保存了
+     * fc-cache从一个目录的字体中提取的模式。结构之间通过偏移量相互引用；指针
+     * 字段保存相对于所在结构的奇数"编码"偏移量（参见fcint.h）。每个偏移量都会做边界检查，
+     * 不符合该布局的文件视为无效，改为扫描该目录
+     */
+    class fontconfigCacheView {
+    public:
+        fontconfigCacheView(const unsigned char* data, size_t size) : m_data(data), m_size(size) {
+            int32_t version;
+            uint64_t fileSize, directory;
+            if (!read(0, m_magic) || m_magic != g_fontconfigCacheMagic || !read(4, version) || version < 7 || version > 9 ||
+                !read(8, fileSize) || fileSize != size || !read(16, directory) || !readString(directory, m_directory) ||
+                !read(24, m_subdirectories) || !read(32, m_subdirectoryCount) || !read(40, m_set) ||
+                !read(48, m_checksum) || !read(56, m_checksumNano)) {
+                m_magic = 0;
+            }
+        }
+
+        bool valid() const {
+            return m_magic == g_fontconfigCacheMagic;
+        }
+
+        const std::string& directory() const {
+            return m_directory;
+        }
+
+        /**
+         * @brief 缓存是否仍然描述该目录，比较方式与FcCacheTimeValid相同
+         */
+        bool current(const struct stat& st) const {
+#ifdef __linux__
+            return m_checksum == static_cast<int32_t>(st.st_mtime) && m_checksumNano == static_cast<int64_t>(st.st_mtim.tv_nsec);
+#else
+            return m_checksum == static_cast<int32_t>(st.st_mtime);
+#endif
+        }
+
+        bool subdirectories(std::vector<std::string>& out) const {
+            for (int32_t i = 0; i < m_subdirectoryCount; ++i) {
+                uint64_t offset;
+                std::string path;
+                if (!read(m_subdirectories + i * 8, offset) || !readString(m_subdirectories + offset, path)) return false;
+                out.push_back(path[0] == '/' ? path : m_directory + '/' + path);
+            }
+            return true;
+        }
+
+        /**
+         * @brief 对缓存中的每个字体模式调用f(模式偏移量)
+         */
+        template <typename Function>
+        bool forEachPattern(Function f) const {
+            int32_t count;
+            uint64_t fonts;
+            if (!read(m_set, count) || count < 0 || !readPointer(m_set, m_set + 8, fonts)) return false;
+            for (int32_t i = 0; i < count; ++i) {
+                uint64_t pattern;
+                // 数组元素相对于字体集，而不是相对于数组
+                if (!readPointer(m_set, fonts + i * 8, pattern) || pattern == 0 || !f(pattern)) return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief 按顺序对模式中某个对象的每个值调用f(类型, 值偏移量)
+         */
+        template <typename Function>
+        bool forEachValue(uint64_t pattern, int object, Function f) const {
+            int32_t count;
+            int64_t elements;
+            if (!read(pattern, count) || !read(pattern + 8, elements) || count < 0) return false;
+            for (int32_t i = 0; i < count; ++i) {
+                uint64_t element = pattern + elements + i * 16;
+                int32_t id;
+                if (!read(element, id)) return false;
+                if (id != object) continue;
+
+                uint64_t list;
+                if (!readPointer(element, element + 8, list)) return false;
+                for (int guard = 0; list != 0 && guard < 4096; ++guard) {
+                    int32_t type;
+                    if (!read(list + 8, type)) return false;
+                    f(type, list + 8);
+                    if (!readPointer(list, list, list)) return false;
+                }
+                return true;
+            }
+            return true;
+        }
+
+        /**
+         * @brief 将FcValue读取为数字，范围值不产生结果
+         */
+        bool readNumber(int type, uint64_t value, double& out) const {
+            if (type == g_fontconfigDouble) return read(value + 8, out);
+            int32_t integer;
+            if (type != g_fontconfigInteger || !read(value + 8, integer)) return false;
+            out = integer;
+            return true;
+        }
+
+        bool readStringValue(int type, uint64_t value, std::string& out) const {
+            uint64_t text;
+            return type == g_fontconfigString && readPointer(value, value + 8, text) && text != 0 && readString(text, out);
+        }
+
+    private:
+        template <typename T>
+        bool read(uint64_t offset, T& out) const {
+            if (offset > m_size || m_size - offset < sizeof(T)) return false;
+            std::memcpy(&out, m_data + offset, sizeof(T));
+            return true;
+        }
+
+        /**
+         * @brief 读取位于'base'处的结构中'field'处的指针字段，0仍为空指针
+         */
+        bool readPointer(uint64_t base, uint64_t field, uint64_t& out) const {
+            int64_t encoded;
+            if (!read(field, encoded)) return false;
+            if (encoded == 0) {
+                out = 0;
+                return true;
+            }
+            if (!(encoded & 1)) return false;  // 文件中不可能出现真实的指针
+            out = base + static_cast<uint64_t>(encoded & ~static_cast<int64_t>(1));
+            return out <= m_size;  // 空数组可能位于文件末尾，读取时另行检查
+        }
+
+        bool readString(uint64_t offset, std::string& out) const {
+            if (offset >= m_size) return false;
+            const void* end = std::memchr(m_data + offset, '\0', m_size - offset);
+            if (!end || end == m_data + offset) return false;
+            out.assign(reinterpret_cast<const char*>(m_data + offset), static_cast<const unsigned char*>(end) - (m_data + offset));
+            return true;
+        }
+
+        const unsigned char* m_data;
+        size_t m_size;
+        uint32_t m_magic = 0;
+        std::string m_directory;
+        uint64_t m_subdirectories = 0;
+        int32_t m_subdirectoryCount = 0;
+        uint64_t m_set = 0;
+        int32_t m_checksum = 0;
+        int64_t m_checksumNano = 0;
+    };
+
+    /**
+     * @brief fontconfig存放缓存的目录，系统目录在前
+     */
+    std::vector<std::string> fontconfigCacheDirectories() {
+        std::vector<std::string> directories(1, "/var/cache/fontconfig");
+        const char* cache = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        if (cache && *cache) {
+            directories.push_back(std::string(cache) + "/fontconfig");
+        } else if (home && *home) {
+            directories.push_back(std::string(home) + "/.cache/fontconfig");
+        }
+        if (home && *home) directories.push_back(std::string(home) + "/.fontconfig");
+        return directories;
+    }
+
+}
+#endif
+
+/**
+ * @brief 从注册表值、字体文件和目录收集字体，并据此构建fontIndex
+ *
+ * 字体按排版字体族名称分组，因此"Segoe UI"、"Segoe UI Bold"和"Segoe UI Light"成为同一个字体族。
+ * 多个来源提供相同的字体族、字重、宽度、斜体和可变轴坐标时，保留优先级较高的来源（见fontSource）中的字体，
+ * 与来源的添加顺序无关。
+ */
+class fontIndexBuilder {
+public:
+    /**
+     * @param readFontFiles 是否打开注册表值所指的文件，读取真实的字体族名称、字重和本地化名称。
+     * false时仅依据值名称，速度更快但缺少本地化名称
+     */
+    explicit fontIndexBuilder(bool readFontFiles = true) : m_readFontFiles(readFontFiles) {
+#ifdef _WIN32
+        WCHAR windowsDir[MAX_PATH];
+        GetWindowsDirectoryW(windowsDir, MAX_PATH);
+        m_fontDirectory = wideToUtf8(windowsDir) + "\\Fonts";
+#endif
+    }
+
+    /**
+     * @brief 设置Fonts注册表值中不含路径的文件名所相对的目录，Windows上默认为%WINDIR%\Fonts。
+     * 从注册表导出文件构建时，将其指向已挂载的Windows映像中的Fonts目录
+     */
+    void setFontDirectory(const std::string& directory) {
+        m_fontDirectory = directory;
+    }
+
+    /**
+     * @brief 添加以Fonts注册表值列出的字体
+     * @param values 值名称（例如"Segoe UI Bold (TrueType)"）与值数据（相对于Windows字体目录的文件名或完整路径）的对。
+     * 字体集合的各字体以" & "分隔
+     * @param source 这些值的来源
+     */
+    void addRegistryFonts(const std::vector<std::pair<std::string, std::string>>& values, fontSource source) {
+        std::vector<std::string> paths;
+        paths.reserve(values.size());
+        for (const auto& value : values) {
+            paths.push_back(registryFontPath(value.second));
+        }
+
+        std::vector<bool> read(values.size(), false);
+        if (m_readFontFiles) {
+            read = addFontFiles(paths, source);
+        }
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (!read[i]) addRegistryName(values[i].first, paths[i], source);
+        }
+    }
+
+#ifdef _WIN32
+    /**
+     * @brief 添加注册表根键下SOFTWARE\Microsoft\Windows NT\CurrentVersion\Fonts中列出的字体
+     * @param root HKEY_LOCAL_MACHINE或HKEY_CURRENT_USER
+     */
+    void addRegistryFonts(HKEY root, fontSource source) {
+        HKEY hKey;
+        if (RegOpenKeyExW(root, L"SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts", 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+            return;
+        }
+
+        std::vector<std::pair<std::string, std::string>> values;
+        WCHAR valueName[256];
+        WCHAR valueData[1024];
+        for (DWORD index = 0;; ++index) {
+            DWORD valueNameSize = sizeof(valueName) / sizeof(WCHAR);
+            DWORD valueDataSize = sizeof(valueData);
+            DWORD valueType;
+            LONG result = RegEnumValueW(hKey, index, valueName, &valueNameSize, NULL, &valueType,
+                                        reinterpret_cast<LPBYTE>(valueData), &valueDataSize);
+            if (result == ERROR_MORE_DATA) continue;
+            if (result != ERROR_SUCCESS) break;
+            if (valueType != REG_SZ) continue;
+
+            std::wstring data(valueData, valueDataSize / sizeof(WCHAR));
+            data.erase(std::find(data.begin(), data.end(), L'\0'), data.end());
+            values.emplace_back(wideToUtf8(std::wstring(valueName, valueNameSize)), wideToUtf8(data));
+        }
+        RegCloseKey(hKey);
+
+        addRegistryFonts(values, source);
+    }
+#endif
+
+    /**
+     * @brief 添加.reg文件中列出的字体，取自所有以"\Microsoft\Windows NT\CurrentVersion\Fonts"结尾的键，
+     * 因此HKLM、HKCU以及以其他名称加载的离线配置单元的导出文件都适用
+     * @param path .reg文件的路径，参见readRegistryExport
+     * @param source 这些值的来源
+     * @return 添加的值的数量
+     * @throw std::runtime_error 无法读取文件时抛出
+     * @throw std::invalid_argument 文件不是注册表导出文件时抛出
+     */
+    size_t addRegistryExport(const std::string& path, fontSource source) {
+        static const std::string fontsKey = "\\microsoft\\windows nt\\currentversion\\fonts";
+        std::vector<std::pair<std::string, std::string>> values;
+        std::string lastKey;
+        bool fontsKeyMatched = false;
+        for (auto& value : readRegistryExport(path)) {
+            if (value.key != lastKey) {
+                lastKey = value.key;
+                std::string folded = foldFontName(value.key);
+                fontsKeyMatched = folded.size() >= fontsKey.size() && folded.compare(folded.size() - fontsKey.size(), fontsKey.size(), fontsKey) == 0;
+            }
+            if (fontsKeyMatched && (value.type == registryString || value.type == registryExpandString)) {
+                values.emplace_back(std::move(value.name), std::move(value.data));
+            }
+        }
+        addRegistryFonts(values, source);
+        return values.size();
+    }
+
+    /**
+     * @brief 添加字体文件或字体集合（.ttf、.otf、.ttc）中的每个字体
+     * @return 文件不是可读取的字体时返回false
+     */
+    bool addFontFile(const std::string& path, fontSource source) {
+        return addFontFiles(std::vector<std::string>(1, path), source)[0];
+    }
+
+    /**
+     * @brief 添加目录及其子目录中的字体，并行读取文件
+     * @return 添加的字体文件数
+     */
+    size_t addFontDirectory(const std::string& directory, fontSource source) {
+        std::vector<std::string> paths;
+        {
+            selectionExpander files(std::vector<std::string>(1, directory), {"*.ttf;*.otf;*.ttc;*.otc"});
+            std::string path;
+            while (files.next(path)) {
+                paths.push_back(path);
+            }
+        }
+        // 遍历顺序取决于线程时序，排序以得到可重现的索引
+        std::sort(paths.begin(), paths.end());
+
+        std::vector<bool> read = addFontFiles(paths, source);
+        return static_cast<size_t>(std::count(read.begin(), read.end(), true));
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief 与addFontDirectory一样添加目录及其子目录中的字体文件，但在fc-cache已解析过的目录中
+     * 直接从fontconfig的缓存中获取字体。只有没有最新缓存的目录才会被列出，
+     * 并行读取其中的字体文件。可变字体总是从文件读取，因为缓存中没有它们的轴
+     * @param directory 要添加的目录
+     * @param source 字体的来源
+     * @return 添加的字体文件数
+     */
+    size_t addFontconfigDirectory(const std::string& directory, fontSource source) {
+        if (!m_fontconfigCachesListed) {
+            listFontconfigCaches();
+            m_fontconfigCachesListed = true;
+        }
+
+        fileFilterMatcher matcher(std::vector<std::string>(1, "*.ttf;*.otf;*.ttc;*.otc"));
+        std::vector<std::string> pending(1, directory);
+        std::unordered_set<std::string> visited;
+        std::vector<std::string> paths;
+        size_t added = 0;
+        while (!pending.empty()) {
+            std::string current = pending.back();
+            pending.pop_back();
+            while (current.size() > 1 && current.back() == '/') current.pop_back();
+            if (!visited.insert(current).second) continue;
+
+            std::vector<std::string> subdirectories;
+            size_t files = 0;
+            if (addFontconfigCache(current, source, matcher, subdirectories, paths, files)) {
+                added += files;
+            } else {
+                // 缓存缺失或过期：列出该目录，其子目录可能仍有各自的缓存
+                forEachDirectoryEntry(current, [&](const std::string& path, bool isDirectory) {
+                    if (isDirectory) {
+                        subdirectories.push_back(path);
+                    } else if (matcher.matches(path.substr(path.rfind('/') + 1))) {
+                        paths.push_back(path);
+                    }
+                    return true;
+                });
+            }
+            pending.insert(pending.end(), subdirectories.rbegin(), subdirectories.rend());
+        }
+
+        std::sort(paths.begin(), paths.end());
+        std::vector<bool> read = addFontFiles(paths, source);
+        return added + static_cast<size_t>(std::count(read.begin(), read.end(), true));
+    }
+#endif
+
+    /**
+     * @brief 用目前已添加的字体构建索引。之后构建器仍可继续使用
+     */
+    std::shared_ptr<const fontIndex> build() const {
+        // 先访问优先级最高的来源中的字体，并保持添加顺序
+        std::vector<size_t> order(m_faces.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return m_faces[a].source < m_faces[b].source;
+        });
+
+        struct familySlot {
+            std::string folded;
+            std::string name;
+            std::vector<size_t> faces;
+        };
+        std::vector<familySlot> families;
+        std::unordered_map<std::string, size_t> familyOf;
+        std::unordered_set<std::string> styles;
+        std::unordered_set<std::string> files;
+        std::vector<size_t> kept;
+        for (size_t i : order) {
+            const fontFaceInfo& face = m_faces[i];
+            std::string folded = foldFontName(face.family);
+            if (folded.empty()) continue;
+            if (!files.insert(wideToUtf8(foldFileName(utf8ToWide(face.path))) + '\n' + std::to_string(face.faceIndex) + ' ' +
+                              std::to_string(face.instance)).second) {
+                continue;
+            }
+            std::string style = folded + '\n' + std::to_string(face.weight) + ' ' + std::to_string(face.width) + (face.italic ? " i" : "");
+            // 命名实例还可能在其他轴上不同，例如光学尺寸，因此其坐标也属于样式的一部分
+            for (const auto& axis : face.variation) style += ' ' + axis.tag + '=' + std::to_string(axis.value);
+            if (!styles.insert(style).second) continue;
+
+            auto it = familyOf.find(folded);
+            if (it == familyOf.end()) {
+                it = familyOf.emplace(folded, families.size()).first;
+                families.push_back({folded, face.family, {}});
+            }
+            families[it->second].faces.push_back(i);
+            kept.push_back(i);
+        }
+
+        // 字体族按名称排序，字体族内的字体按宽度、字重和斜体排序
+        std::vector<size_t> familyOrder(families.size());
+        for (size_t i = 0; i < familyOrder.size(); ++i) familyOrder[i] = i;
+        std::sort(familyOrder.begin(), familyOrder.end(), [&](size_t a, size_t b) {
+            return families[a].folded < families[b].folded;
+        });
+        std::vector<uint32_t> familyRank(families.size());
+        for (size_t i = 0; i < familyOrder.size(); ++i) {
+            familyRank[familyOrder[i]] = static_cast<uint32_t>(i);
+            std::sort(families[familyOrder[i]].faces.begin(), families[familyOrder[i]].faces.end(), [this](size_t a, size_t b) {
+                const fontFaceInfo& x = m_faces[a];
+                const fontFaceInfo& y = m_faces[b];
+                if (x.width != y.width) return x.width < y.width;
+                if (x.weight != y.weight) return x.weight < y.weight;
+                if (x.italic != y.italic) return x.italic < y.italic;
+                return a < b;
+            });
+        }
+
+        // 查找名称：先放字体族名称以确保其总是胜出，然后是本地化名称，最后是隐含样式的旧式名称
+        struct nameTarget {
+            size_t family;
+            int weight;
+            int width;
+        };
+        std::unordered_map<std::string, nameTarget> nameOf;
+        for (size_t i = 0; i < families.size(); ++i) {
+            nameOf.emplace(families[i].folded, nameTarget{i, 0, 0});
+        }
+        for (size_t i : kept) {
+            for (const auto& name : m_familyNames[i]) {
+                std::string folded = foldFontName(name);
+                if (!folded.empty()) nameOf.emplace(folded, nameTarget{familyOf[foldFontName(m_faces[i].family)], 0, 0});
+            }
+        }
+        for (size_t i : kept) {
+            size_t family = familyOf[foldFontName(m_faces[i].family)];
+            for (const auto& name : m_legacyNames[i]) {
+                std::string folded = foldFontName(name);
+                if (folded.empty()) continue;
+                auto it = nameOf.emplace(folded, nameTarget{family, m_faces[i].weight, m_faces[i].width}).first;
+                // 一个旧式字体族最多包含四个字体，以其中最细的非斜体字体命名
+                if (it->second.family == family && it->second.weight > 0 && !m_faces[i].italic &&
+                    m_faces[i].weight < it->second.weight) {
+                    it->second.weight = m_faces[i].weight;
+                    it->second.width = m_faces[i].width;
+                }
+            }
+        }
+        std::vector<std::pair<std::string, nameTarget>> names(nameOf.begin(), nameOf.end());
+        std::sort(names.begin(), names.end(), [](const std::pair<std::string, nameTarget>& a, const std::pair<std::string, nameTarget>& b) {
+            return a.first < b.first;
+        });
+
+        // 输出映像：头部、记录，然后是字符串池
+        std::string strings;
+        std::unordered_map<std::string, uint32_t> pooled;
+        auto intern = [&](const std::string& text) {
+            auto it = pooled.find(text);
+            if (it != pooled.end()) return it->second;
+            uint32_t offset = static_cast<uint32_t>(strings.size());
+            strings.append(text.c_str(), text.size() + 1);
+            pooled.emplace(text, offset);
+            return offset;
+        };
+
+        // 可变字体文件的轴由其所有实例共享
+        std::vector<fontIndex::axisRecord> axisRecords;
+        std::vector<float> coordinates;
+        std::unordered_map<std::string, uint32_t> axisRuns;
+        auto internAxes = [&](const std::vector<fontVariationAxis>& variation) {
+            std::vector<fontIndex::axisRecord> run;
+            for (const auto& axis : variation) {
+                fontIndex::axisRecord record;
+                std::memcpy(&record.tag, (axis.tag + "    ").data(), 4);
+                record.minValue = axis.minValue;
+                record.defaultValue = axis.defaultValue;
+                record.maxValue = axis.maxValue;
+                run.push_back(record);
+            }
+            std::string key(reinterpret_cast<const char*>(run.data()), run.size() * sizeof(fontIndex::axisRecord));
+            auto it = axisRuns.find(key);
+            if (it != axisRuns.end()) return it->second;
+            uint32_t first = static_cast<uint32_t>(axisRecords.size());
+            axisRecords.insert(axisRecords.end(), run.begin(), run.end());
+            axisRuns.emplace(key, first);
+            return first;
+        };
+
+        std::vector<fontIndex::familyRecord> familyRecords;
+        std::vector<fontIndex::faceRecord> faceRecords;
+        std::vector<fontIndex::featureRecord> featureRecords;
+        for (size_t slot : familyOrder) {
+            fontIndex::familyRecord family;
+            family.name = intern(families[slot].name);
+            family.firstFace = static_cast<uint32_t>(faceRecords.size());
+            family.faceCount = static_cast<uint32_t>(families[slot].faces.size());
+            familyRecords.push_back(family);
+            for (size_t i : families[slot].faces) {
+                const fontFaceInfo& face = m_faces[i];
+                fontIndex::faceRecord record;
+                std::memset(&record, 0, sizeof(record));
+                record.family = familyRank[slot];
+                record.style = intern(face.style);
+                record.path = intern(face.path);
+                record.faceIndex = face.faceIndex;
+                record.weight = static_cast<uint16_t>(std::min(std::max(face.weight, 1), 1000));
+                record.width = static_cast<uint8_t>(std::min(std::max(face.width, 1), 9));
+                record.italic = face.italic ? 1 : 0;
+                record.source = static_cast<uint8_t>(face.source);
+                record.instance = face.instance;
+                if (!face.variation.empty()) {
+                    record.axisCount = static_cast<uint16_t>(face.variation.size());
+                    record.firstAxis = internAxes(face.variation);
+                    record.firstCoordinate = static_cast<uint32_t>(coordinates.size());
+                    for (const auto& axis : face.variation) {
+                        coordinates.push_back(axis.value);
+                    }
+                }
+                faceRecords.push_back(record);
+
+                fontIndex::featureRecord features;
+                std::memset(&features, 0, sizeof(features));
+                std::memcpy(features.panose, face.panose, sizeof(features.panose));
+                features.width = record.width;
+                features.italic = record.italic;
+                features.weight = record.weight;
+                features.xHeight = static_cast<uint16_t>(std::min(std::max(face.xHeight, 0), 65535));
+                features.capHeight = static_cast<uint16_t>(std::min(std::max(face.capHeight, 0), 65535));
+                featureRecords.push_back(features);
+            }
+        }
+        std::vector<fontIndex::nameRecord> nameRecords;
+        for (const auto& name : names) {
+            fontIndex::nameRecord record;
+            std::memset(&record, 0, sizeof(record));
+            record.name = intern(name.first);
+            record.family = familyRank[name.second.family];
+            record.weight = static_cast<uint16_t>(name.second.weight);
+            record.width = static_cast<uint8_t>(name.second.width);
+            nameRecords.push_back(record);
+        }
+
+        fontIndex::imageHeader header;
+        header.magic = g_fontIndexMagic;
+        header.version = g_fontIndexVersion;
+        header.familyCount = static_cast<uint32_t>(familyRecords.size());
+        header.familyOffset = sizeof(fontIndex::imageHeader);
+        header.faceCount = static_cast<uint32_t>(faceRecords.size());
+        header.faceOffset = header.familyOffset + header.familyCount * static_cast<uint32_t>(sizeof(fontIndex::familyRecord));
+        header.nameCount = static_cast<uint32_t>(nameRecords.size());
+        header.nameOffset = header.faceOffset + header.faceCount * static_cast<uint32_t>(sizeof(fontIndex::faceRecord));
+        header.axisCount = static_cast<uint32_t>(axisRecords.size());
+        header.axisOffset = header.nameOffset + header.nameCount * static_cast<uint32_t>(sizeof(fontIndex::nameRecord));
+        header.coordinateCount = static_cast<uint32_t>(coordinates.size());
+        header.coordinateOffset = header.axisOffset + header.axisCount * static_cast<uint32_t>(sizeof(fontIndex::axisRecord));
+        header.featureOffset = header.coordinateOffset + header.coordinateCount * static_cast<uint32_t>(sizeof(float));
+        header.stringOffset = header.featureOffset + header.faceCount * static_cast<uint32_t>(sizeof(fontIndex::featureRecord));
+        header.stringSize = static_cast<uint32_t>(strings.size());
+        header.size = header.stringOffset + header.stringSize;
+
+        std::shared_ptr<std::vector<unsigned char>> image = std::make_shared<std::vector<unsigned char>>(header.size);
+        unsigned char* out = image->data();
+        std::memcpy(out, &header, sizeof(header));
+        if (!familyRecords.empty()) std::memcpy(out + header.familyOffset, familyRecords.data(), familyRecords.size() * sizeof(fontIndex::familyRecord));
+        if (!faceRecords.empty()) std::memcpy(out + header.faceOffset, faceRecords.data(), faceRecords.size() * sizeof(fontIndex::faceRecord));
+        if (!nameRecords.empty()) std::memcpy(out + header.nameOffset, nameRecords.data(), nameRecords.size() * sizeof(fontIndex::nameRecord));
+        if (!axisRecords.empty()) std::memcpy(out + header.axisOffset, axisRecords.data(), axisRecords.size() * sizeof(fontIndex::axisRecord));
+        if (!coordinates.empty()) std::memcpy(out + header.coordinateOffset, coordinates.data(), coordinates.size() * sizeof(float));
+        if (!featureRecords.empty()) std::memcpy(out + header.featureOffset, featureRecords.data(), featureRecords.size() * sizeof(fontIndex::featureRecord));
+        if (!strings.empty()) std::memcpy(out + header.stringOffset, strings.data(), strings.size());
+
+        return std::make_shared<const fontIndex>(std::shared_ptr<const unsigned char>(image, out), header.size);
+    }
+
+private:
+    /**
+     * @brief 将Fonts注册表值解析为路径，不含路径的文件名位于字体目录中（参见setFontDirectory）
+     */
+    std::string registryFontPath(const std::string& data) const {
+        if (m_fontDirectory.empty() || data.empty() || data.find(':') != std::string::npos || data[0] == '\\' || data[0] == '/') {
+            return data;
+        }
+        return wideToUtf8(joinPath(utf8ToWide(m_fontDirectory), utf8ToWide(data)));
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief 查找fontconfig缓存文件及每个文件描述的目录
+     */
+    void listFontconfigCaches() {
+        for (const auto& cacheDirectory : fontconfigCacheDirectories()) {
+            forEachDirectoryEntry(cacheDirectory, [this](const std::string& path, bool isDirectory) {
+                if (isDirectory || path.find("-le64.cache-") == std::string::npos) return true;
+                std::string directory;
+                mapFontconfigCache(path, [&directory](const fontconfigCacheView& cache) {
+                    directory = cache.directory();
+                    return true;
+                });
+                if (!directory.empty()) m_fontconfigCaches[directory].push_back(path);
+                return true;
+            });
+        }
+    }
+
+    /**
+     * @brief 映射缓存文件，文件头有效时调用f(cache)
+     * @return f的结果，无法映射文件时返回false
+     */
+    template <typename Function>
+    static bool mapFontconfigCache(const std::string& path, Function f) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= 64) {
+            view = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (view == MAP_FAILED) return false;
+
+        fontconfigCacheView cache(static_cast<const unsigned char*>(view), static_cast<size_t>(st.st_size));
+        bool result = cache.valid() && f(cache);
+        munmap(view, static_cast<size_t>(st.st_size));
+        return result;
+    }
+
+    /**
+     * @brief 在fontconfig缓存为最新时从中添加目录中的字体
+     * @param subdirectories 输出缓存中记录的子目录
+     * @param paths 输出需要从文件读取的可变字体文件
+     * @param files 输出从缓存添加的字体文件数量
+     * @return 没有可用的缓存时返回false，此时不添加任何内容
+     */
+    bool addFontconfigCache(const std::string& directory, fontSource source, const fileFilterMatcher& matcher,
+                            std::vector<std::string>& subdirectories, std::vector<std::string>& paths, size_t& files) {
+        auto caches = m_fontconfigCaches.find(directory);
+        struct stat st;
+        if (caches == m_fontconfigCaches.end() || stat(directory.c_str(), &st) != 0) return false;
+
+        for (const auto& cachePath : caches->second) {
+            std::vector<fontFaceInfo> faces;
+            std::vector<std::vector<std::string>> familyNames, legacyNames;
+            std::unordered_set<std::string> cachedFiles, variableFiles;
+            bool read = mapFontconfigCache(cachePath, [&](const fontconfigCacheView& cache) {
+                if (!cache.current(st) || !cache.subdirectories(subdirectories)) return false;
+                return cache.forEachPattern([&](uint64_t pattern) {
+                    fontFaceInfo face;
+                    face.source = source;
+                    double index = 0, slant = 0;
+                    bool variable = false;
+                    bool ok = cache.forEachValue(pattern, g_fontconfigFile, [&](int type, uint64_t value) {
+                        if (face.path.empty()) cache.readStringValue(type, value, face.path);
+                    }) && cache.forEachValue(pattern, g_fontconfigIndex, [&](int type, uint64_t value) {
+                        cache.readNumber(type, value, index);
+                    }) && cache.forEachValue(pattern, g_fontconfigWeight, [&](int type, uint64_t value) {
+                        double weight;
+                        if (type == g_fontconfigRange) variable = true;
+                        if (cache.readNumber(type, value, weight)) face.weight = fontconfigWeightToOpenType(weight);
+                    }) && cache.forEachValue(pattern, g_fontconfigWidth, [&](int type, uint64_t value) {
+                        double width;
+                        if (type == g_fontconfigRange) variable = true;
+                        if (!cache.readNumber(type, value, width)) return;
+                        int nearest = 0;
+                        for (int i = 1; i < 9; ++i) {
+                            if (std::fabs(g_fontWidthPercent[i] - width) < std::fabs(g_fontWidthPercent[nearest] - width)) nearest = i;
+                        }
+                        face.width = nearest + 1;
+                    }) && cache.forEachValue(pattern, g_fontconfigSlant, [&](int type, uint64_t value) {
+                        cache.readNumber(type, value, slant);
+                    });
+                    if (!ok) return false;
+                    if (face.path.empty() || !(index >= 0)) return true;
+                    if (face.path[0] != '/') face.path = directory + '/' + face.path;
+                    if (!matcher.matches(face.path.substr(face.path.rfind('/') + 1))) return true;
+
+                    // 命名实例的实例编号位于索引的高16位
+                    if (variable || index >= 65536) {
+                        variableFiles.insert(face.path);
+                        return true;
+                    }
+                    face.faceIndex = static_cast<unsigned>(index);
+                    face.italic = slant != 0;
+
+                    std::vector<std::string> names, localized, legacy;
+                    ok = cache.forEachValue(pattern, g_fontconfigFamily, [&](int type, uint64_t value) {
+                        std::string name;
+                        if (cache.readStringValue(type, value, name)) names.push_back(name);
+                    }) && cache.forEachValue(pattern, g_fontconfigStyle, [&](int type, uint64_t value) {
+                        if (face.style.empty()) cache.readStringValue(type, value, face.style);
+                    });
+                    if (!ok || names.empty()) return ok;
+
+                    // 第一个字体族名称是排版字体族名称；其余为旧式名称（例如"DejaVu Sans Light"）或译名
+                    face.family = names[0];
+                    for (size_t i = 1; i < names.size(); ++i) {
+                        bool isLegacy = names[i].size() > face.family.size() && names[i].compare(0, face.family.size(), face.family) == 0 &&
+                                        names[i][face.family.size()] == ' ';
+                        addUniqueName(isLegacy ? legacy : localized, names[i]);
+                    }
+                    if (face.style.empty()) face.style = "Regular";
+                    cachedFiles.insert(face.path);
+                    faces.push_back(std::move(face));
+                    familyNames.push_back(std::move(localized));
+                    legacyNames.push_back(std::move(legacy));
+                    return true;
+                });
+            });
+            if (!read) {
+                subdirectories.clear();
+                continue;
+            }
+
+            for (const auto& path : variableFiles) {
+                cachedFiles.erase(path);
+                paths.push_back(path);
+            }
+            for (size_t i = 0; i < faces.size(); ++i) {
+                if (variableFiles.count(faces[i].path)) continue;
+                m_faces.push_back(std::move(faces[i]));
+                m_familyNames.push_back(std::move(familyNames[i]));
+                m_legacyNames.push_back(std::move(legacyNames[i]));
+            }
+            files = cachedFiles.size();
+            return true;
+        }
+        return false;
+    }
+#endif
+
+    /**
+     * @brief 不读取字体文件，添加注册表值名称所描述的字体
+     */
+    void addRegistryName(const std::string& valueName, const std::string& path, fontSource source) {
+        std::string name = valueName.substr(0, valueName.find(" ("));
+        unsigned faceIndex = 0;
+        for (size_t start = 0; start != std::string::npos; ++faceIndex) {
+            size_t separator = name.find(" & ", start);
+            fontFaceInfo face;
+            std::string legacy;
+            splitFontName(name.substr(start, separator == std::string::npos ? std::string::npos : separator - start), face, legacy);
+            start = separator == std::string::npos ? separator : separator + 3;
+            if (face.family.empty()) continue;
+
+            face.path = path;
+            face.faceIndex = faceIndex;
+            face.source = source;
+            m_faces.push_back(face);
+            m_familyNames.emplace_back();
+            m_legacyNames.emplace_back(1, legacy);
+        }
+    }
+
+    /**
+     * @brief 并行读取字体文件，并按paths的顺序添加其中的字体
+     * @return 每个文件是否读取成功
+     */
+    std::vector<bool> addFontFiles(const std::vector<std::string>& paths, fontSource source) {
+        struct fileFaces {
+            std::vector<fontFaceInfo> faces;
+            std::vector<std::vector<std::string>> familyNames;
+            std::vector<std::vector<std::string>> legacyNames;
+            bool read = false;
+        };
+        std::vector<fileFaces> results(paths.size());
+        std::atomic<size_t> next(0);
+        auto work = [&] {
+            while (true) {
+                size_t i = next++;
+                if (i >= paths.size()) break;
+                results[i].read = readSfntFaces(paths[i], results[i].faces, results[i].familyNames, results[i].legacyNames);
+            }
+        };
+
+        // 除调度器的线程外，调用线程也读取文件
+        unsigned threadCount = std::min<unsigned>(taskConcurrency() + 1, __GCOMMDLG_FONT_SCAN_THREADS);
+        threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, (paths.size() + 15) / 16));
+        taskGroup workers;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.run(work, taskBackground);
+        }
+        work();
+        workers.wait();
+
+        std::vector<bool> read(paths.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            read[i] = results[i].read;
+            for (size_t j = 0; j < results[i].faces.size(); ++j) {
+                results[i].faces[j].source = source;
+                m_faces.push_back(std::move(results[i].faces[j]));
+                m_familyNames.push_back(std::move(results[i].familyNames[j]));
+                m_legacyNames.push_back(std::move(results[i].legacyNames[j]));
+            }
+        }
+        return read;
+    }
+
+    bool m_readFontFiles;
+    std::string m_fontDirectory;
+#ifndef _WIN32
+    std::unordered_map<std::string, std::vector<std::string>> m_fontconfigCaches;  // 目录 -> 描述该目录的缓存文件
+    bool m_fontconfigCachesListed = false;
+#endif
+    std::vector<fontFaceInfo> m_faces;
+    std::vector<std::vector<std::string>> m_familyNames;   // 本地化的排版字体族名称，每个字体一项
+    std::vector<std::vector<std::string>> m_legacyNames;   // 隐含该字体样式的旧式字体族名称，每个字体一项
+};
+
+namespace {
+
+    bool isSharedFontIndexName(const std::string& name) {
+        if (name.empty()) return false;
+        for (char c : name) {
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.')) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#ifdef _WIN32
+    std::wstring sharedFontIndexName(const std::string& name) {
+        return L"Local\\GL_Commdlg.FontIndex." + utf8ToWide(name);
+    }
+
+    /**
+     * @brief 以只读方式映射已发布的索引，发布进程仍在复制时会等待
+     * @param mapping 文件映射句柄，返回的索引释放时关闭
+     */
+    std::shared_ptr<const fontIndex> mapFontIndex(HANDLE mapping) {
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        std::shared_ptr<const unsigned char> image(static_cast<const unsigned char*>(view), [mapping](const unsigned char* p) {
+            UnmapViewOfFile(p);
+            CloseHandle(mapping);
+        });
+        MEMORY_BASIC_INFORMATION region;
+        if (VirtualQuery(view, &region, sizeof(region)) == 0) return nullptr;
+
+        // 魔数在映像其余部分就绪后最后写入
+        const volatile LONG* magic = static_cast<const volatile LONG*>(view);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(__GCOMMDLG_SHARED_FONT_WAIT_MS);
+        while (*magic != static_cast<LONG>(g_fontIndexMagic)) {
+            if (std::chrono::steady_clock::now() > deadline) return nullptr;
+            Sleep(1);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        try {
+            return std::make_shared<const fontIndex>(image, static_cast<size_t>(region.RegionSize));
+        } catch (const std::invalid_argument&) {
+            return nullptr;
+        }
+    }
+#else
+    /**
+     * @brief 保存已发布索引的文件：有每用户运行时tmpfs时位于其中，否则位于/dev/shm
+     */
+    std::string sharedFontIndexPath(const std::string& name) {
+        const char* runtime = getenv("XDG_RUNTIME_DIR");
+        const char* temp = getenv("TMPDIR");
+        std::string directory = runtime && *runtime ? runtime : access("/dev/shm", W_OK) == 0 ? "/dev/shm" : temp && *temp ? temp : "/tmp";
+        return directory + "/.gcommdlg-" + std::to_string(getuid()) + "-" + name + ".fidx";
+    }
+
+    /**
+     * @brief 删除当前用户为其他字体时间戳或索引版本发布的系统字体索引。仍在映射这些索引的进程保留各自的副本
+     */
+    void removeStaleSystemFontIndexes(const std::string& current) {
+        std::string path = sharedFontIndexPath(current);
+        size_t slash = path.find_last_of('/');
+        std::string keep = path.substr(slash + 1);
+        std::string prefix = ".gcommdlg-" + std::to_string(getuid()) + "-fonts-";
+        forEachDirectoryEntry(path.substr(0, slash), [&](const std::string& entry, bool isDirectory) {
+            std::string file = entry.substr(slash + 1);
+            size_t version = prefix.size();
+            while (version < file.size() && file[version] >= '0' && file[version] <= '9') ++version;
+            // 只处理fonts-<版本>-<16位十六进制数>.fidx形式的名称
+            if (isDirectory || file == keep || file.compare(0, prefix.size(), prefix) != 0 || version == prefix.size() ||
+                file.size() != version + 22 || file[version] != '-' || file.compare(version + 17, 5, ".fidx") != 0) {
+                return true;
+            }
+            struct stat st;
+            if (lstat(entry.c_str(), &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == getuid()) {
+                unlink(entry.c_str());
+            }
+            return true;
+        });
+    }
+#endif
+
+    /**
+     * @brief 以只读方式附加到以指定名称发布的索引
+     * @return 未发布或不是有效索引时返回nullptr
+     */
+    std::shared_ptr<const fontIndex> attachFontIndex(const std::string& name) {
+#ifdef _WIN32
+        HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, sharedFontIndexName(name).c_str());
+        return mapping ? mapFontIndex(mapping) : nullptr;
+#else
+        int fd = open(sharedFontIndexPath(name).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+
+        // 只信任当前用户的文件，任何人都能在/dev/shm中创建文件
+        struct stat st;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_uid == getuid() && st.st_size > 0) {
+            // 改为私有之前发布的副本
+            if (st.st_mode & 077) fchmod(fd, 0600);
+            view = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (view == MAP_FAILED) return nullptr;
+
+        size_t size = static_cast<size_t>(st.st_size);
+        std::shared_ptr<const unsigned char> image(static_cast<const unsigned char*>(view), [size](const unsigned char* p) {
+            munmap(const_cast<unsigned char*>(p), size);
+        });
+        try {
+            return std::make_shared<const fontIndex>(image, size);
+        } catch (const std::invalid_argument&) {
+            return nullptr;
+        }
+#endif
+    }
+
+    /**
+     * @brief 以指定名称发布索引并附加到发布的副本。
+     * 在Windows上，若该名称下已发布索引，则保留并返回已有的索引
+     * @return 无法发布索引时返回nullptr
+     */
+    std::shared_ptr<const fontIndex> publishFontIndex(const std::string& name, const fontIndex& index) {
+#ifdef _WIN32
+        HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, static_cast<DWORD>(index.size()),
+                                            sharedFontIndexName(name).c_str());
+        if (!mapping) return nullptr;
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            return mapFontIndex(mapping);
+        }
+
+        unsigned char* view = static_cast<unsigned char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0));
+        if (!view) {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        std::memcpy(view + sizeof(uint32_t), index.data() + sizeof(uint32_t), index.size() - sizeof(uint32_t));
+        InterlockedExchange(reinterpret_cast<LONG volatile*>(view), static_cast<LONG>(g_fontIndexMagic));
+        UnmapViewOfFile(view);
+        return mapFontIndex(mapping);
+#else
+        // 读取方映射的要么是旧文件，要么是完整的新文件，不会是写了一半的文件。文件以0600权限创建，
+        // 其他账户不应看到用户安装了哪些字体
+        try {
+            writeFileAtomically(sharedFontIndexPath(name), index.data(), index.size(), 0600);
+        } catch (const std::exception&) {
+            return nullptr;
+        }
+        return attachFontIndex(name);
+#endif
+    }
+
+}
+
+/**
+ * @brief 获取当前用户所有进程共享的字体索引：附加到以指定名称发布的副本，或者构建并发布它
+ *
+ * 副本在Windows上是只读的命名文件映射，在其他系统上是每用户tmpfs中以只读方式映射的文件，
+ * 因此每台机器只占用一份内存，附加只需一次映射和一遍校验。
+ * @param name 索引名称，由字母、数字、'-'、'_'和'.'组成。来源变化时应使用新名称
+ * @param build 该名称下没有已发布的索引时用于构建索引
+ * @return 共享的副本；无法发布时返回build构建的索引
+ * @throw std::invalid_argument 名称包含其他字符时抛出
+ */
+std::shared_ptr<const fontIndex> openSharedFontIndex(const std::string& name,
+                                                     const std::function<std::shared_ptr<const fontIndex>()>& build) {
+    if (!isSharedFontIndexName(name)) {
+        throw std::invalid_argument("Invalid shared font index name: " + name);
+    }
+    std::shared_ptr<const fontIndex> index = attachFontIndex(name);
+    if (index) return index;
+
+    std::shared_ptr<const fontIndex> built = build();
+    index = publishFontIndex(name, *built);
+    return index ? index : built;
+}
+
+namespace {
+
+    std::mutex g_systemFontMutex;
+    std::shared_ptr<const fontIndex> g_systemFontIndex;
+    unsigned long long g_systemFontStamp = 0;
+    std::vector<std::string> g_fontSearchDirectories;
+
+    /**
+     * @brief 将getSystemFontIndex的索引作为缓存预算中只有一个条目的缓存
+     */
+    class systemFontBudget : public budgetedCache {
+    public:
+        ~systemFontBudget() {
+            budgetLeave();
+        }
+
+        void evictEntry(const std::string&) override {
+            std::lock_guard<std::mutex> lock(g_systemFontMutex);
+            g_systemFontIndex.reset();
+        }
+    };
+
+    systemFontBudget g_systemFontBudget;
+
+#ifndef _WIN32
+    /**
+     * @brief 默认搜索的字体目录，系统目录在前
+     */
+    std::vector<std::pair<std::string, fontSource>> defaultFontDirectories() {
+        std::vector<std::pair<std::string, fontSource>> directories;
+        const char* home = getenv("HOME");
+#ifdef __APPLE__
+        directories.emplace_back("/System/Library/Fonts", fontSourceSystem);
+        directories.emplace_back("/Library/Fonts", fontSourceSystem);
+        if (home && *home) directories.emplace_back(std::string(home) + "/Library/Fonts", fontSourceUser);
+#else
+        directories.emplace_back("/usr/share/fonts", fontSourceSystem);
+        directories.emplace_back("/usr/local/share/fonts", fontSourceSystem);
+        const char* dataHome = getenv("XDG_DATA_HOME");
+        if (dataHome && *dataHome) {
+            directories.emplace_back(std::string(dataHome) + "/fonts", fontSourceUser);
+        } else if (home && *home) {
+            directories.emplace_back(std::string(home) + "/.local/share/fonts", fontSourceUser);
+        }
+        if (home && *home) directories.emplace_back(std::string(home) + "/.fonts", fontSourceUser);
+#endif
+        return directories;
+    }
+#endif
+
+    /**
+     * @brief 各字体来源的组合最后写入时间，安装或删除字体时会变化。
+     * 只检查顶层目录，向已有子目录添加的字体需要调用getSystemFontIndex(true)
+     */
+    unsigned long long systemFontStamp() {
+        unsigned long long stamp = 0, size, written;
+#ifdef _WIN32
+        HKEY roots[] = {HKEY_LOCAL_MACHINE, HKEY_CURRENT_USER};
+        for (HKEY root : roots) {
+            HKEY hKey;
+            if (RegOpenKeyExW(root, L"SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts", 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+                continue;
+            }
+            FILETIME lastWrite;
+            if (RegQueryInfoKeyW(hKey, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &lastWrite) == ERROR_SUCCESS) {
+                stamp = stamp * 31 + ((static_cast<unsigned long long>(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime);
+            }
+            RegCloseKey(hKey);
+        }
+#else
+        for (const auto& directory : defaultFontDirectories()) {
+            if (getFileStamp(directory.first, size, written)) stamp = stamp * 31 + written;
+        }
+#endif
+        for (const auto& directory : g_fontSearchDirectories) {
+            if (getFileStamp(directory, size, written)) stamp = stamp * 31 + written;
+        }
+        return stamp;
+    }
+
+}
+
+/**
+ * @brief 将应用程序字体目录加入getSystemFontIndex返回的索引，优先级最低（fontSourceDirectory）
+ * @param directory 目录路径（UTF8编码），递归搜索
+ */
+void addFontSearchDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(g_systemFontMutex);
+    if (std::find(g_fontSearchDirectories.begin(), g_fontSearchDirectories.end(), directory) == g_fontSearchDirectories.end()) {
+        size_t bytes = heapBytes(g_fontSearchDirectories);
+        g_fontSearchDirectories.push_back(directory);
+        chargeMemory(memoryFontSearchDirectories, static_cast<long long>(heapBytes(g_fontSearchDirectories)) - static_cast<long long>(bytes), 1);
+        g_systemFontIndex.reset();
+        g_systemFontBudget.budgetDrop("");
+    }
+}
+
+/**
+ * @brief 获取已安装字体的索引，首次使用时构建，安装或删除字体后重新构建
+ *
+ * Windows上合并HKLM和HKCU的Fonts键，其他平台上合并系统和用户字体目录，
+ * 之后是通过addFontSearchDirectory添加的目录。重复查询时请保留返回的指针。
+ * 索引通过openSharedFontIndex与该用户的其他进程共享，因此通常只有第一个进程会构建它。
+ * @param forceRefresh 即使来源看起来未变化也重新构建。重新构建的索引只保留在本进程中
+ */
+std::shared_ptr<const fontIndex> getSystemFontIndex(bool forceRefresh = false) {
+    std::unique_lock<std::mutex> lock(g_systemFontMutex);
+    unsigned long long stamp = systemFontStamp();
+    if (g_systemFontIndex && !forceRefresh && stamp == g_systemFontStamp) {
+        g_systemFontBudget.budgetUse("");
+        return g_systemFontIndex;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    auto build = [] {
+        fontIndexBuilder builder;
+#ifdef _WIN32
+        builder.addRegistryFonts(HKEY_LOCAL_MACHINE, fontSourceSystem);
+        builder.addRegistryFonts(HKEY_CURRENT_USER, fontSourceUser);
+#elif __GCOMMDLG_FONTCONFIG_CACHE
+        for (const auto& directory : defaultFontDirectories()) {
+            builder.addFontconfigDirectory(directory.first, directory.second);
+        }
+#else
+        for (const auto& directory : defaultFontDirectories()) {
+            builder.addFontDirectory(directory.first, directory.second);
+        }
+#endif
+        for (const auto& directory : g_fontSearchDirectories) {
+#if __GCOMMDLG_FONTCONFIG_CACHE && !defined(_WIN32)
+            builder.addFontconfigDirectory(directory, fontSourceDirectory);
+#else
+            builder.addFontDirectory(directory, fontSourceDirectory);
+#endif
+        }
+        return builder.build();
+    };
+
+#if __GCOMMDLG_SHARED_FONT_INDEX
+    // 来源和搜索目录相同的进程共享同一个发布的副本，副本按它们命名
+    std::string key = std::to_string(stamp);
+    for (const auto& directory : g_fontSearchDirectories) {
+        key += '\n' + directory;
+    }
+    xxHash64 hash;
+    hash.update(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+    char name[48];
+    snprintf(name, sizeof(name), "fonts-%u-%016llx", static_cast<unsigned>(g_fontIndexVersion),
+             static_cast<unsigned long long>(hash.digest()));
+    g_systemFontIndex = forceRefresh ? build() : openSharedFontIndex(name, [&name, &build] {
+#ifndef _WIN32
+        // 新的时间戳或索引版本取代为旧版本发布的副本
+        removeStaleSystemFontIndexes(name);
+#endif
+        return build();
+    });
+#else
+    g_systemFontIndex = build();
+#endif
+    g_systemFontStamp = stamp;
+    std::shared_ptr<const fontIndex> index = g_systemFontIndex;
+    g_systemFontBudget.budgetStore("", index->size(), std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    lock.unlock();
+    enforceCacheBudget();
+    return index;
+}
+
+#pragma endregion
+
+#pragma region MIME数据库
+// 根据shared-mime-info数据库按名称和内容确定文件类型，Linux文件选择器按这些类型过滤
+
+namespace {
+
+    /**
+     * @return ASCII字符串的小写副本
+     */
+    std::string lowercaseAscii(std::string text) {
+        for (char& c : text) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return text;
+    }
+
+    /**
+     * @brief 取出列表中文件名的最后一段，并判断它是否表示目录（以分隔符结尾）
+     */
+    std::string listingBaseName(const std::string& fileName, bool& directory) {
+        auto separator = [](char c) { return c == '/' || c == '\\'; };
+        size_t end = fileName.size();
+        directory = end > 0 && separator(fileName[end - 1]);
+        while (end > 0 && separator(fileName[end - 1])) --end;
+        size_t start = end;
+        while (start > 0 && !separator(fileName[start - 1])) --start;
+        return fileName.substr(start, end - start);
+    }
+}
+
+#ifndef _WIN32
+
+namespace {
+
+    /**
+     * @brief XDG数据目录，优先级高的在前：XDG_DATA_HOME（~/.local/share），然后是XDG_DATA_DIRS（/usr/local/share:/usr/share）
+     */
+    std::vector<std::string> xdgDataDirectories() {
+        std::vector<std::string> directories;
+        const char* home = getenv("HOME");
+        const char* dataHome = getenv("XDG_DATA_HOME");
+        if (dataHome && *dataHome) {
+            directories.push_back(dataHome);
+        } else if (home && *home) {
+            directories.push_back(std::string(home) + "/.local/share");
+        }
+
+        const char* dataDirs = getenv("XDG_DATA_DIRS");
+        std::string list = dataDirs && *dataDirs ? dataDirs : "/usr/local/share:/usr/share";
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = list.find(':', start);
+            if (end == std::string::npos) end = list.size();
+            if (end > start) directories.push_back(list.substr(start, end - start));
+            start = end + 1;
+        }
+        return directories;
+    }
+
+    /**
+     * @brief 文件开头是否像文本：没有NUL字节、控制字符或无效的UTF8
+     */
+    bool looksLikeText(const unsigned char* data, size_t size) {
+        const unsigned char* p = data;
+        const unsigned char* end = data + size;
+        while (p < end) {
+            const unsigned char* start = p;
+            uint32_t c = nextCodePoint(p, end);
+            // 被样本末尾截断的序列不算错误
+            if (c == 0xFFFD && end - start < 4 && (*start & 0xC0) == 0xC0) break;
+            if (c == 0xFFFD || (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\b' && c != 0x1B) || c == 0x7F) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief 以MIME类型表示的文件对话框过滤器，参见mimeDatabase::translateFilters
+ */
+struct mimeFilter {
+    std::string description;
+    std::vector<std::string> mimeTypes;   // 以其中某个模式为通配的类型
+    std::vector<std::string> patterns;    // 没有类型对应的模式，保留为通配，如"*"或"report_*.txt"
+};
+
+/**
+ * @brief shared-mime-info数据库中的文件类型（仅POSIX）
+ *
+ * 读取update-mime-database在globs2和magic旁编译生成的mime.cache文件，只读映射并原地使用：
+ * 名称在其字面量列表和反向后缀树中查找，内容在其magic匹配树中查找，因此对文件列表分类
+ * 不启动进程也不解析XML。会查询所有XDG数据目录的缓存，用户的优先。
+ * 数据库构造后不再改变，所有方法都可以在多个线程中同时调用
+ */
+class mimeDatabase {
+public:
+    /**
+     * @brief 映射每个XDG数据目录中存在的mime/mime.cache
+     */
+    mimeDatabase() {
+        for (const auto& directory : xdgDataDirectories()) addCache(directory + "/mime/mime.cache");
+    }
+
+    /**
+     * @param cacheFiles mime.cache文件，优先级高的在前
+     */
+    explicit mimeDatabase(const std::vector<std::string>& cacheFiles) {
+        for (const auto& path : cacheFiles) addCache(path);
+    }
+
+    /**
+     * @brief 是否没有映射到任何缓存，此时所有查找都返回空
+     */
+    bool empty() const {
+        return m_caches.empty();
+    }
+
+    /**
+     * @brief 仅根据名称得出文件类型
+     * @param fileName 名称或路径（UTF8编码）
+     * @return 最佳匹配通配的类型，没有匹配时为空字符串
+     */
+    std::string typeOfName(const std::string& fileName) const {
+        bool directory;
+        std::vector<mimeGlobMatch> matches;
+        nameMatches(listingBaseName(fileName, directory), matches);
+        return matches.empty() ? std::string() : matches.front().type;
+    }
+
+    /**
+     * @brief 根据文件开头的字节得出文件类型，参见magicExtent
+     * @return 第一条匹配的magic规则的类型，没有匹配时为空字符串
+     */
+    std::string typeOfData(const void* data, size_t size) const {
+        for (const auto& cache : m_caches) {
+            const char* type = cache.magicMatch(static_cast<const unsigned char*>(data), size);
+            if (type) return type;
+        }
+        return std::string();
+    }
+
+    /**
+     * @brief 按xdgmime的方式确定文件类型：先按名称，只有在没有通配匹配或有多个同权重的
+     * 通配匹配时才读取内容
+     * @param path 文件路径（UTF8编码）
+     * @return 类型，目录为"inode/directory"，设备、管道和套接字为相应的inode/类型且从不打开。名称和内容都无法识别时
+     * 为"text/plain"（空文件也是）或"application/octet-stream"
+     */
+    std::string typeOfFile(const std::string& path) const {
+        struct stat st;
+        bool exists = stat(path.c_str(), &st) == 0;
+        if (exists) {
+            // 只读取普通文件，读取管道或终端可能会永远阻塞
+            if (S_ISDIR(st.st_mode)) return "inode/directory";
+            if (S_ISCHR(st.st_mode)) return "inode/chardevice";
+            if (S_ISBLK(st.st_mode)) return "inode/blockdevice";
+            if (S_ISFIFO(st.st_mode)) return "inode/fifo";
+            if (S_ISSOCK(st.st_mode)) return "inode/socket";
+        }
+
+        bool directory;
+        std::vector<mimeGlobMatch> matches;
+        nameMatches(listingBaseName(path, directory), matches);
+        bool ambiguous = matches.size() > 1 && matches[1].weight == matches[0].weight && std::strcmp(matches[1].type, matches[0].type) != 0;
+        if ((!matches.empty() && !ambiguous) || !exists) return matches.empty() ? "application/octet-stream" : matches.front().type;
+
+        std::vector<unsigned char> head(std::max<size_t>(magicExtent(), 256));
+        // 使用O_NONBLOCK，以防文件在stat之后被替换为管道
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOCTTY);
+        if (fd < 0) return matches.empty() ? "application/octet-stream" : matches.front().type;
+        ssize_t got = read(fd, head.data(), head.size());
+        close(fd);
+        if (got < 0) return matches.empty() ? "application/octet-stream" : matches.front().type;
+
+        std::string type = typeOfData(head.data(), static_cast<size_t>(got));
+        if (!type.empty()) return type;
+        if (!matches.empty()) return matches.front().type;
+        return looksLikeText(head.data(), static_cast<size_t>(std::min<ssize_t>(got, 256))) ? "text/plain" : "application/octet-stream";
+    }
+
+    /**
+     * @brief 整个列表中各条目的类型
+     * @param fileNames 名称或路径（UTF8编码），以'/'或'\\'结尾表示目录
+     * @param readContent 用typeOfFile分类，会对每个条目调用stat，并读取名称无法确定类型的条目；
+     * 否则仅按名称分类，未知名称为"application/octet-stream"，目录必须带结尾分隔符
+     */
+    std::vector<std::string> classify(const std::vector<std::string>& fileNames, bool readContent = false) const {
+        std::vector<std::string> types;
+        types.reserve(fileNames.size());
+        std::vector<mimeGlobMatch> matches;
+        for (const auto& fileName : fileNames) {
+            bool directory;
+            std::string name = listingBaseName(fileName, directory);
+            if (readContent && !directory) {
+                types.push_back(typeOfFile(fileName));
+                continue;
+            }
+            matches.clear();
+            if (!directory) nameMatches(name, matches);
+            types.push_back(directory ? "inode/directory" : matches.empty() ? "application/octet-stream" : matches.front().type);
+        }
+        return types;
+    }
+
+    /**
+     * @brief 将文件对话框过滤器转换为MIME类型
+     *
+     * 模式转换为以它为通配的类型（"*.htm"得到text/html）。按类型过滤的选择器还会接受
+     * 该类型的其他通配和子类（.html文件、application/xhtml+xml）；没有类型对应的模式
+     * 保留为通配，因此过滤器可以同时以两种形式传递
+     * @param filters 与getOpenFileName格式相同的过滤器列表，每个元素为"描述|模式;模式"
+     * @throw std::invalid_argument 过滤器格式错误时抛出
+     */
+    std::vector<mimeFilter> translateFilters(const std::vector<std::string>& filters) const {
+        std::vector<mimeFilter> translated;
+        for (const auto& filter : filters) {
+            size_t pipePos = filter.find('|');
+            if (pipePos == std::string::npos) {
+                throw std::invalid_argument(
+                    "Invalid filter format: '" + filter +
+                    "'. Use 'description|filter pattern' (e.g., 'Text Files(*.txt)|*.txt')"
+                );
+            }
+
+            mimeFilter entry;
+            entry.description = filter.substr(0, pipePos);
+            size_t start = pipePos + 1;
+            while (start <= filter.size()) {
+                size_t end = filter.find(';', start);
+                if (end == std::string::npos) end = filter.size();
+                size_t first = filter.find_first_not_of(' ', start);
+                size_t last = filter.find_last_not_of(' ', end == 0 ? 0 : end - 1);
+                start = end + 1;
+                if (first == std::string::npos || first >= end || last < first) continue;
+
+                std::string pattern = filter.substr(first, last - first + 1);
+                std::vector<std::string> types = pattern == "*" || pattern == "*.*" ? std::vector<std::string>() : typesOfGlob(pattern);
+                if (types.empty() && std::find(entry.patterns.begin(), entry.patterns.end(), pattern) == entry.patterns.end()) {
+                    entry.patterns.push_back(pattern);
+                }
+                for (const auto& type : types) {
+                    if (std::find(entry.mimeTypes.begin(), entry.mimeTypes.end(), type) == entry.mimeTypes.end()) entry.mimeTypes.push_back(type);
+                }
+            }
+            translated.push_back(std::move(entry));
+        }
+        return translated;
+    }
+
+    /**
+     * @brief 恰好以此为通配的类型，如"*.txt"或"Makefile"。除非通配区分大小写，否则忽略大小写
+     */
+    std::vector<std::string> typesOfGlob(const std::string& pattern) const {
+        std::vector<std::string> types;
+        if (pattern.empty()) return types;
+        for (const auto& cache : m_caches) {
+            std::vector<mimeGlobMatch> matches;
+            cache.globTypes(pattern, matches);
+            for (const auto& match : matches) {
+                if (std::find(types.begin(), types.end(), match.type) == types.end()) types.push_back(match.type);
+            }
+        }
+        return types;
+    }
+
+    /**
+     * @brief 类型的规范名称，不是别名时为类型本身
+     */
+    std::string unalias(const std::string& type) const {
+        for (const auto& cache : m_caches) {
+            const char* canonical = cache.canonicalType(type);
+            if (canonical) return canonical;
+        }
+        return type;
+    }
+
+    /**
+     * @brief 类型是否为另一类型或派生自它（sub-class-of），例如application/x-compressed-tar属于application/gzip。
+     * 所有text/类型都属于text/plain，除inode/类型外所有类型都属于application/octet-stream
+     */
+    bool isA(const std::string& type, const std::string& ancestor) const {
+        std::string target = unalias(ancestor);
+        std::vector<std::string> pending(1, unalias(type));
+        std::unordered_set<std::string> seen(pending.begin(), pending.end());
+        if (target == "application/octet-stream" && pending[0].compare(0, 6, "inode/") != 0) return true;
+        if (target == "text/plain" && pending[0].compare(0, 5, "text/") == 0) return true;
+
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (pending[i] == target) return true;
+            std::vector<std::string> parents;
+            for (const auto& cache : m_caches) {
+                cache.parentTypes(pending[i], parents);
+                if (!parents.empty()) break;
+            }
+            for (auto& parent : parents) {
+                parent = unalias(parent);
+                if (seen.insert(parent).second) pending.push_back(parent);
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 数据库为类型指定的图标名，没有指定时为空字符串
+     * @param generic 是否查找通用图标（如"x-office-document"）而不是具体图标
+     */
+    std::string iconName(const std::string& type, bool generic = false) const {
+        for (const auto& cache : m_caches) {
+            const char* name = cache.iconName(type, generic);
+            if (name) return name;
+        }
+        return std::string();
+    }
+
+    /**
+     * @brief magic规则检查的文件开头字节数
+     */
+    size_t magicExtent() const {
+        size_t extent = 0;
+        for (const auto& cache : m_caches) extent = std::max(extent, cache.magicExtent());
+        return extent;
+    }
+
+private:
+    /**
+     * @brief 与文件名匹配的通配
+     */
+    struct mimeGlobMatch {
+        const char* type;
+        int weight;
+    };
+
+    /**
+     * @brief update-mime-database写出的shared-mime-info缓存（"mime.cache"，1.x版本）的只读视图。
+     * 各列表是按偏移寻址的已排序大端表；"*后缀"形式的通配构成反向后缀树，
+     * magic规则构成匹配项树。每个偏移都做边界检查，越界读取得到0，从而结束列表
+     */
+    class mimeCacheView {
+    public:
+        mimeCacheView(std::shared_ptr<const unsigned char> data, size_t size) : m_data(std::move(data)), m_size(size) {
+            if (m_size < 40 || (word(0) >> 16) != 1) {
+                m_data.reset();
+                return;
+            }
+            m_aliases = word(4);
+            m_parents = word(8);
+            m_literals = word(12);
+            m_suffixes = word(16);
+            m_globs = word(20);
+            m_magic = word(24);
+            m_icons = word(32);
+            m_genericIcons = word(36);
+        }
+
+        bool valid() const {
+            return m_data != nullptr;
+        }
+
+        /**
+         * @brief magic规则检查的文件开头字节数
+         */
+        size_t magicExtent() const {
+            return word(m_magic + 4);
+        }
+
+        /**
+         * @brief 通配与文件名匹配的类型，按xdgmime的顺序：字面量名称，然后是最长后缀，然后是
+         * 其他通配。不区分大小写的通配先用小写名称尝试
+         */
+        void globMatches(const std::string& name, std::vector<mimeGlobMatch>& matches) const {
+            std::string folded = lowercaseAscii(name);
+            if (literalMatches(name, true, matches) || (folded != name && literalMatches(folded, false, matches))) return;
+
+            if (suffixMatches(folded, false, false, matches) || suffixMatches(name, true, false, matches)) return;
+
+            uint32_t count = word(m_globs);
+            if (!fits(m_globs + 4, count, 12)) return;
+            for (uint32_t i = 0; i < count; ++i) {
+                size_t entry = m_globs + 4 + i * 12;
+                const char* glob = text(word(entry));
+                const char* type = text(word(entry + 4));
+                uint32_t flags = word(entry + 8);
+                bool caseSensitive = (flags & 0x100) != 0;
+                if (glob && type && fnmatch(glob, caseSensitive ? name.c_str() : folded.c_str(), 0) == 0) {
+                    matches.push_back({type, static_cast<int>(flags & 0xFF)});
+                }
+            }
+        }
+
+        /**
+         * @brief 恰好以此为通配的类型，如"*.txt"、"Makefile"或"*.so.[0-9]*"
+         */
+        void globTypes(const std::string& pattern, std::vector<mimeGlobMatch>& matches) const {
+            std::string folded = lowercaseAscii(pattern);
+            if (pattern.find_first_of("*?[") == std::string::npos) {
+                if (!literalMatches(folded, false, matches)) literalMatches(pattern, true, matches);
+                return;
+            }
+            if (pattern[0] == '*' && pattern.find_first_of("*?[", 1) == std::string::npos) {
+                if (!suffixMatches(folded.substr(1), false, true, matches)) suffixMatches(pattern.substr(1), true, true, matches);
+                return;
+            }
+
+            uint32_t count = word(m_globs);
+            if (!fits(m_globs + 4, count, 12)) return;
+            for (uint32_t i = 0; i < count; ++i) {
+                size_t entry = m_globs + 4 + i * 12;
+                const char* glob = text(word(entry));
+                const char* type = text(word(entry + 4));
+                uint32_t flags = word(entry + 8);
+                if (glob && type && (pattern == glob || (!(flags & 0x100) && folded == glob))) {
+                    matches.push_back({type, static_cast<int>(flags & 0xFF)});
+                }
+            }
+        }
+
+        /**
+         * @brief 与文件开头匹配的第一条magic规则（优先级高的在前）的类型
+         * @return 没有匹配时为nullptr
+         */
+        const char* magicMatch(const unsigned char* data, size_t size) const {
+            uint32_t count = word(m_magic);
+            size_t first = word(m_magic + 8);
+            if (!fits(first, count, 16)) return nullptr;
+            // 有效的缓存每个匹配项只访问一次，损坏的缓存也不能让遍历比这更久
+            size_t budget = m_size / 32;
+            for (uint32_t i = 0; i < count; ++i) {
+                size_t match = first + i * 16;
+                uint32_t matchlets = word(match + 8);
+                size_t firstMatchlet = word(match + 12);
+                if (!fits(firstMatchlet, matchlets, 32)) continue;
+                for (uint32_t j = 0; j < matchlets; ++j) {
+                    if (matchletMatches(firstMatchlet + j * 32, data, size, 0, budget)) return text(word(match + 4));
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief 别名的规范类型，不是别名时为nullptr
+         */
+        const char* canonicalType(const std::string& type) const {
+            size_t entry = findSorted(m_aliases, 8, type);
+            return entry ? text(word(entry + 4)) : nullptr;
+        }
+
+        /**
+         * @brief 追加类型的直接父类型（sub-class-of）
+         */
+        void parentTypes(const std::string& type, std::vector<std::string>& out) const {
+            size_t entry = findSorted(m_parents, 8, type);
+            if (!entry) return;
+            size_t list = word(entry + 4);
+            uint32_t count = word(list);
+            if (!fits(list + 4, count, 4)) return;
+            for (uint32_t i = 0; i < count; ++i) {
+                const char* parent = text(word(list + 4 + i * 4));
+                if (parent) out.push_back(parent);
+            }
+        }
+
+        /**
+         * @brief 为类型列出的图标名（其"icon"或"generic-icon"元素），没有时为nullptr
+         */
+        const char* iconName(const std::string& type, bool generic) const {
+            size_t entry = findSorted(generic ? m_genericIcons : m_icons, 8, type);
+            return entry ? text(word(entry + 4)) : nullptr;
+        }
+
+    private:
+        uint32_t word(size_t offset) const {
+            return offset <= m_size && m_size - offset >= 4 ? readBigEndian32(m_data.get() + offset) : 0;
+        }
+
+        bool fits(size_t offset, uint32_t count, size_t entrySize) const {
+            return offset <= m_size && count <= (m_size - offset) / entrySize;
+        }
+
+        /**
+         * @return 偏移处以NUL结尾的字符串，超出末尾时为nullptr
+         */
+        const char* text(size_t offset) const {
+            if (offset == 0 || offset >= m_size || !std::memchr(m_data.get() + offset, 0, m_size - offset)) return nullptr;
+            return reinterpret_cast<const char*>(m_data.get() + offset);
+        }
+
+        /**
+         * @brief 在按条目开头字符串排序的列表中二分查找
+         * @return 条目的偏移，未列出时为0
+         */
+        size_t findSorted(size_t list, size_t entrySize, const std::string& key) const {
+            uint32_t count = word(list);
+            if (!fits(list + 4, count, entrySize)) return 0;
+            size_t low = 0, high = count;
+            while (low < high) {
+                size_t middle = (low + high) / 2;
+                size_t entry = list + 4 + middle * entrySize;
+                const char* name = text(word(entry));
+                int order = name ? std::strcmp(name, key.c_str()) : -1;
+                if (order == 0) return entry;
+                if (order < 0) low = middle + 1;
+                else high = middle;
+            }
+            return 0;
+        }
+
+        /**
+         * @brief 解码在p之前结束的UTF8序列，并将p移到其开头。不是有效序列结尾的字节
+         * 单独解码为U+FFFD
+         */
+        static uint32_t previousCodePoint(const unsigned char* begin, const unsigned char*& p) {
+            const unsigned char* start = p - 1;
+            while (start > begin && p - start < 4 && (*start & 0xC0) == 0x80) --start;
+            const unsigned char* next = start;
+            uint32_t c = nextCodePoint(next, p);
+            if (next != p) {
+                start = p - 1;
+                c = 0xFFFD;
+            }
+            p = start;
+            return c;
+        }
+
+        /**
+         * @param anyCase 区分大小写的通配是否可以匹配，小写名称时为false
+         */
+        bool literalMatches(const std::string& name, bool anyCase, std::vector<mimeGlobMatch>& matches) const {
+            size_t entry = findSorted(m_literals, 12, name);
+            if (!entry) return false;
+            const char* type = text(word(entry + 4));
+            uint32_t flags = word(entry + 8);
+            if (!type || (!anyCase && (flags & 0x100))) return false;
+            matches.push_back({type, static_cast<int>(flags & 0xFF)});
+            return true;
+        }
+
+        /**
+         * @brief 从最后一个字符开始遍历反向后缀树。节点下的叶子（字符0）是
+         * 在该处结束的通配，最深的有叶子的节点胜出
+         * @param whole 只在所有字符都消耗完后取叶子，用于查找通配而不是名称
+         */
+        bool suffixMatches(const std::string& name, bool anyCase, bool whole, std::vector<mimeGlobMatch>& matches) const {
+            const unsigned char* begin = reinterpret_cast<const unsigned char*>(name.data());
+            const unsigned char* p = begin + name.size();
+            uint32_t count = word(m_suffixes);
+            size_t nodes = word(m_suffixes + 4);
+            uint32_t deepestCount = 0;
+            size_t deepest = 0;
+            while (p > begin && fits(nodes, count, 12)) {
+                uint32_t c = previousCodePoint(begin, p);
+                size_t low = 0, high = count, node = 0;
+                while (low < high) {
+                    size_t middle = (low + high) / 2;
+                    uint32_t nodeChar = word(nodes + middle * 12);
+                    if (nodeChar == c) {
+                        node = nodes + middle * 12;
+                        break;
+                    }
+                    if (nodeChar < c) low = middle + 1;
+                    else high = middle;
+                }
+                if (!node) break;
+
+                count = word(node + 4);
+                nodes = word(node + 8);
+                if ((whole && p > begin) || !fits(nodes, count, 12)) continue;
+                for (uint32_t i = 0; i < count && word(nodes + i * 12) == 0; ++i) {
+                    if (anyCase || !(word(nodes + i * 12 + 8) & 0x100)) {
+                        deepest = nodes;
+                        deepestCount = count;
+                        break;
+                    }
+                }
+            }
+
+            size_t before = matches.size();
+            for (uint32_t i = 0; i < deepestCount && word(deepest + i * 12) == 0; ++i) {
+                const char* type = text(word(deepest + i * 12 + 4));
+                uint32_t flags = word(deepest + i * 12 + 8);
+                if (type && (anyCase || !(flags & 0x100))) matches.push_back({type, static_cast<int>(flags & 0xFF)});
+            }
+            return matches.size() > before;
+        }
+
+        /**
+         * @brief 匹配项是否在其范围内的某个偏移处匹配，并且（如有子项）某个子项也匹配
+         */
+        bool matchletMatches(size_t matchlet, const unsigned char* data, size_t size, int depth, size_t& budget) const {
+            uint32_t rangeStart = word(matchlet);
+            uint32_t rangeLength = word(matchlet + 4);
+            uint32_t valueLength = word(matchlet + 12);
+            size_t value = word(matchlet + 16);
+            size_t mask = word(matchlet + 20);
+            if (budget == 0 || depth > 32 || !fits(value, valueLength, 1) || (mask && !fits(mask, valueLength, 1))) return false;
+
+            --budget;
+            const unsigned char* expected = m_data.get() + value;
+            bool matched = false;
+            for (size_t at = rangeStart; !matched && at < static_cast<size_t>(rangeStart) + rangeLength && at + valueLength <= size; ++at) {
+                if (!mask) {
+                    matched = std::memcmp(data + at, expected, valueLength) == 0;
+                    continue;
+                }
+                matched = true;
+                for (uint32_t i = 0; matched && i < valueLength; ++i) {
+                    matched = (data[at + i] & m_data.get()[mask + i]) == (expected[i] & m_data.get()[mask + i]);
+                }
+            }
+            if (!matched) return false;
+
+            uint32_t children = word(matchlet + 24);
+            size_t firstChild = word(matchlet + 28);
+            if (children == 0) return true;
+            if (!fits(firstChild, children, 32)) return false;
+            for (uint32_t i = 0; i < children; ++i) {
+                if (matchletMatches(firstChild + i * 32, data, size, depth + 1, budget)) return true;
+            }
+            return false;
+        }
+
+        std::shared_ptr<const unsigned char> m_data;
+        size_t m_size;
+        uint32_t m_aliases = 0;
+        uint32_t m_parents = 0;
+        uint32_t m_literals = 0;
+        uint32_t m_suffixes = 0;
+        uint32_t m_globs = 0;
+        uint32_t m_magic = 0;
+        uint32_t m_icons = 0;
+        uint32_t m_genericIcons = 0;
+    };
+
+    void addCache(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            view = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (view == MAP_FAILED) return;
+
+        size_t size = static_cast<size_t>(st.st_size);
+        std::shared_ptr<const unsigned char> data(static_cast<const unsigned char*>(view), [size](const unsigned char* p) {
+            munmap(const_cast<unsigned char*>(p), size);
+        });
+        mimeCacheView cache(chargedBuffer(memoryMimeCaches, std::move(data), size), size);
+        if (cache.valid()) m_caches.push_back(std::move(cache));
+    }
+
+    /**
+     * @brief 第一个有匹配的缓存中的通配匹配，权重高的在前
+     */
+    void nameMatches(const std::string& name, std::vector<mimeGlobMatch>& matches) const {
+        if (name.empty()) return;
+        for (const auto& cache : m_caches) {
+            cache.globMatches(name, matches);
+            if (!matches.empty()) break;
+        }
+        if (matches.size() < 2) return;
+        std::stable_sort(matches.begin(), matches.end(), [](const mimeGlobMatch& a, const mimeGlobMatch& b) {
+            return a.weight > b.weight;
+        });
+    }
+
+    std::vector<mimeCacheView> m_caches;   // 优先级高的在前
+};
+
+#endif
+
+#pragma endregion
+
+#pragma region 图标解析
+// 为文件列表的条目解析图标，按文件类型和尺寸各解析一次，而不是每个文件一次
+
+#ifndef __GCOMMDLG_ICON_FILE_MAX
+#define __GCOMMDLG_ICON_FILE_MAX (4u << 20)  // 读取的图标文件的最大字节数
+#endif
+
+/**
+ * @brief 一种文件类型的图标
+ */
+struct iconImage {
+    std::string type;                   // 所代表的文件类型：Linux上为MIME类型，Windows上为".ext"、"folder"或"file"
+    std::string path;                   // 主题中的图标文件，来自Windows外壳的图标为空
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;  // width * height个RGBA像素（SDL_PIXELFORMAT_RGBA32），非预乘alpha。SVG和XPM文件只定位不解码，像素为空
+};
+
+namespace {
+
+    /**
+     * @brief 解压内存中完整的zlib流（RFC 1950），不校验末尾的Adler-32
+     * @param limit 输出大小上限，输出缓冲区按此预先分配
+     * @return 流是否在上限内完整解码
+     */
+    bool inflateZlib(const unsigned char* data, size_t size, std::vector<unsigned char>& out, size_t limit) {
+        out.clear();
+        if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) return false;
+        out.reserve(limit);
+
+        deflateBitReader reader(data + 2, size - 2);
+        inflateHuffman fixedLength, fixedDist, dynamicLength, dynamicDist;
+        bool fixedReady = false;
+        try {
+            bool last = false;
+            while (!last) {
+                last = reader.bits(1) != 0;
+                unsigned type = reader.bits(2);
+                if (type == 0) {
+                    reader.alignToByte();
+                    unsigned length = reader.bits(16);
+                    if ((length ^ 0xFFFF) != reader.bits(16) || out.size() + length > limit) return false;
+                    while (length--) out.push_back(static_cast<unsigned char>(reader.bits(8)));
+                    continue;
+                }
+
+                const inflateHuffman* lengthCode = &dynamicLength;
+                const inflateHuffman* distCode = &dynamicDist;
+                if (type == 1) {
+                    if (!fixedReady) buildFixedInflateTables(fixedLength, fixedDist);
+                    fixedReady = true;
+                    lengthCode = &fixedLength;
+                    distCode = &fixedDist;
+                } else if (type == 2) {
+                    readDynamicInflateTables(reader, dynamicLength, dynamicDist);
+                } else {
+                    return false;
+                }
+
+                while (true) {
+                    int symbol = reader.decode(*lengthCode);
+                    if (symbol < 256) {
+                        if (out.size() == limit) return false;
+                        out.push_back(static_cast<unsigned char>(symbol));
+                        continue;
+                    }
+                    if (symbol == 256) break;
+                    symbol -= 257;
+                    if (symbol >= 29) return false;
+                    size_t length = g_inflateLengthBase[symbol] + reader.bits(g_inflateLengthExtra[symbol]);
+                    int distSymbol = reader.decode(*distCode);
+                    if (distSymbol >= 30) return false;
+                    size_t distance = g_inflateDistBase[distSymbol] + reader.bits(g_inflateDistExtra[distSymbol]);
+                    if (distance > out.size() || out.size() + length > limit) return false;
+                    for (size_t from = out.size() - distance; length > 0; --length) out.push_back(out[from++]);
+                }
+            }
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 将PNG文件解码为RGBA像素。支持所有颜色类型和位深，不支持隔行扫描图像
+     * @return 图像是否解码成功
+     */
+    bool decodePng(const std::vector<unsigned char>& file, iconImage& image) {
+        static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        if (file.size() < 8 + 25 || std::memcmp(file.data(), signature, 8) != 0) return false;
+
+        uint32_t width = 0, height = 0;
+        int depth = 0, color = 0, interlace = 0;
+        std::vector<unsigned char> compressed, palette, transparency;
+        for (size_t at = 8; at + 12 <= file.size();) {
+            size_t length = readBigEndian32(&file[at]);
+            if (length > file.size() - at - 12) return false;
+            const unsigned char* type = &file[at + 4];
+            const unsigned char* data = &file[at + 8];
+            if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+                width = readBigEndian32(data);
+                height = readBigEndian32(data + 4);
+                depth = data[8];
+                color = data[9];
+                interlace = data[12];
+            } else if (std::memcmp(type, "PLTE", 4) == 0) {
+                palette.assign(data, data + length);
+            } else if (std::memcmp(type, "tRNS", 4) == 0) {
+                transparency.assign(data, data + length);
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                compressed.insert(compressed.end(), data, data + length);
+            } else if (std::memcmp(type, "IEND", 4) == 0) {
+                break;
+            }
+            at += 12 + length;
+        }
+
+        int channels = color == 0 ? 1 : color == 2 ? 3 : color == 3 ? 1 : color == 4 ? 2 : color == 6 ? 4 : 0;
+        bool validDepth = depth == 8 || (depth == 16 && color != 3) || ((depth == 1 || depth == 2 || depth == 4) && (color == 0 || color == 3));
+        if (channels == 0 || !validDepth || interlace != 0 || width == 0 || height == 0 || width > 4096 || height > 4096) return false;
+
+        size_t bitsPerPixel = static_cast<size_t>(channels) * depth;
+        size_t stride = (width * bitsPerPixel + 7) / 8;
+        size_t step = std::max<size_t>(bitsPerPixel / 8, 1);
+        std::vector<unsigned char> raw;
+        if (!inflateZlib(compressed.data(), compressed.size(), raw, (stride + 1) * height) || raw.size() != (stride + 1) * height) {
+            return false;
+        }
+
+        // 原地还原行过滤
+        for (size_t y = 0; y < height; ++y) {
+            unsigned char* row = &raw[y * (stride + 1) + 1];
+            const unsigned char* prior = y > 0 ? row - (stride + 1) : nullptr;
+            int filter = row[-1];
+            for (size_t i = 0; i < stride; ++i) {
+                int a = i >= step ? row[i - step] : 0;
+                int b = prior ? prior[i] : 0;
+                int c = prior && i >= step ? prior[i - step] : 0;
+                int predicted;
+                switch (filter) {
+                    case 0: predicted = 0; break;
+                    case 1: predicted = a; break;
+                    case 2: predicted = b; break;
+                    case 3: predicted = (a + b) / 2; break;
+                    case 4: {
+                        int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+                        predicted = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+                        break;
+                    }
+                    default: return false;
+                }
+                row[i] = static_cast<unsigned char>(row[i] + predicted);
+            }
+        }
+
+        image.width = static_cast<int>(width);
+        image.height = static_cast<int>(height);
+        image.pixels.resize(static_cast<size_t>(width) * height * 4);
+        unsigned maximum = (1u << depth) - 1;
+        for (size_t y = 0; y < height; ++y) {
+            const unsigned char* row = &raw[y * (stride + 1) + 1];
+            unsigned char* out = &image.pixels[y * width * 4];
+            for (size_t x = 0; x < width; ++x, out += 4) {
+                // 未缩放的采样值，用于调色板索引和tRNS比较
+                unsigned samples[4] = {0, 0, 0, 0};
+                for (int k = 0; k < channels; ++k) {
+                    size_t index = x * channels + k;
+                    if (depth == 16) samples[k] = (row[index * 2] << 8) | row[index * 2 + 1];
+                    else if (depth == 8) samples[k] = row[index];
+                    else samples[k] = (row[index * depth / 8] >> (8 - depth - index * depth % 8)) & maximum;
+                }
+                auto scaled = [&](int k) { return static_cast<unsigned char>(depth == 16 ? samples[k] >> 8 : samples[k] * 255 / maximum); };
+
+                if (color == 3) {
+                    if (samples[0] * 3 + 2 >= palette.size()) return false;
+                    std::memcpy(out, &palette[samples[0] * 3], 3);
+                    out[3] = samples[0] < transparency.size() ? transparency[samples[0]] : 255;
+                } else if (color == 0 || color == 4) {
+                    out[0] = out[1] = out[2] = scaled(0);
+                    out[3] = color == 4 ? scaled(1)
+                           : transparency.size() >= 2 && samples[0] == readBigEndian16(transparency.data()) ? 0 : 255;
+                } else {
+                    out[0] = scaled(0);
+                    out[1] = scaled(1);
+                    out[2] = scaled(2);
+                    out[3] = color == 6 ? scaled(3)
+                           : transparency.size() >= 6 && samples[0] == readBigEndian16(transparency.data()) &&
+                             samples[1] == readBigEndian16(transparency.data() + 2) &&
+                             samples[2] == readBigEndian16(transparency.data() + 4) ? 0 : 255;
+                }
+            }
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief 读取整个文件，不超过上限
+     * @return 文件是否读取成功
+     */
+    bool readFileContents(const std::string& path, std::string& contents, size_t limit) {
+        FILE* file = openFileForRead(path);
+        if (!file) return false;
+        contents.clear();
+        char buffer[65536];
+        size_t got;
+        while (contents.size() < limit && (got = fread(buffer, 1, std::min(sizeof(buffer), limit - contents.size()), file)) > 0) {
+            contents.append(buffer, got);
+        }
+        bool failed = ferror(file) != 0;
+        fclose(file);
+        return !failed;
+    }
+
+    /**
+     * @brief 将index.theme这类ini格式文件解析为 节 -> 键 -> 值。本地化的键（"Name[de]"）原样保留
+     */
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> parseIniText(const std::string& text) {
+        std::unordered_map<std::string, std::unordered_map<std::string, std::string>> sections;
+        std::unordered_map<std::string, std::string>* section = nullptr;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            std::string line = text.substr(start, end - start);
+            start = end + 1;
+
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#' || line[first] == ';') continue;
+            size_t last = line.find_last_not_of(" \t\r");
+            line = line.substr(first, last - first + 1);
+            if (line[0] == '[') {
+                section = &sections[line.substr(1, line.find(']') - 1)];
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (!section || equals == std::string::npos) continue;
+            size_t keyEnd = line.find_last_not_of(" \t", equals == 0 ? 0 : equals - 1);
+            size_t valueStart = line.find_first_not_of(" \t", equals + 1);
+            (*section)[line.substr(0, keyEnd == std::string::npos ? 0 : keyEnd + 1)] =
+                valueStart == std::string::npos ? std::string() : line.substr(valueStart);
+        }
+        return sections;
+    }
+
+    /**
+     * @brief 拆分ini值中以逗号分隔的列表，如Inherits和Directories
+     */
+    std::vector<std::string> splitIniList(const std::string& value) {
+        std::vector<std::string> items;
+        size_t start = 0;
+        while (start <= value.size()) {
+            size_t end = value.find(',', start);
+            if (end == std::string::npos) end = value.size();
+            size_t first = value.find_first_not_of(" \t", start);
+            size_t last = value.find_last_not_of(" \t", end == 0 ? 0 : end - 1);
+            if (first != std::string::npos && first < end && last >= first) items.push_back(value.substr(first, last - first + 1));
+            start = end + 1;
+        }
+        return items;
+    }
+
+    int iniInteger(const std::unordered_map<std::string, std::string>& section, const char* key, int fallback) {
+        auto it = section.find(key);
+        return it == section.end() || it->second.empty() ? fallback : std::atoi(it->second.c_str());
+    }
+
+#else
+    /**
+     * @brief 将图标句柄转换为RGBA像素。没有alpha通道的图标从掩码取得透明度
+     * @return 图标是否有彩色位图
+     */
+    bool decodeIconHandle(HICON icon, iconImage& image) {
+        ICONINFO info;
+        if (!GetIconInfo(icon, &info)) return false;
+
+        bool decoded = false;
+        BITMAP bitmap;
+        if (info.hbmColor && GetObjectW(info.hbmColor, sizeof(bitmap), &bitmap) && bitmap.bmWidth > 0 && bitmap.bmHeight > 0) {
+            int width = bitmap.bmWidth, height = bitmap.bmHeight;
+            BITMAPINFO format = {};
+            format.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+            format.bmiHeader.biWidth = width;
+            format.bmiHeader.biHeight = -height;   // 自上而下的行顺序
+            format.bmiHeader.biPlanes = 1;
+            format.bmiHeader.biBitCount = 32;
+            format.bmiHeader.biCompression = BI_RGB;
+
+            std::vector<unsigned char> color(static_cast<size_t>(width) * height * 4), mask(color.size());
+            HDC screen = GetDC(NULL);
+            decoded = GetDIBits(screen, info.hbmColor, 0, height, color.data(), &format, DIB_RGB_COLORS) == height;
+            bool hasAlpha = false;
+            for (size_t i = 3; i < color.size(); i += 4) hasAlpha |= color[i] != 0;
+            if (decoded && !hasAlpha) {
+                decoded = GetDIBits(screen, info.hbmMask, 0, height, mask.data(), &format, DIB_RGB_COLORS) == height;
+            }
+            ReleaseDC(NULL, screen);
+
+            if (decoded) {
+                image.width = width;
+                image.height = height;
+                image.pixels.resize(color.size());
+                for (size_t i = 0; i < color.size(); i += 4) {
+                    image.pixels[i] = color[i + 2];
+                    image.pixels[i + 1] = color[i + 1];
+                    image.pixels[i + 2] = color[i];
+                    image.pixels[i + 3] = hasAlpha ? color[i + 3] : mask[i] ? 0 : 255;
+                }
+            }
+        }
+        if (info.hbmColor) DeleteObject(info.hbmColor);
+        if (info.hbmMask) DeleteObject(info.hbmMask);
+        return decoded;
+    }
+#endif
+}
+
+/**
+ * @brief 按文件类型解析文件列表条目的图标
+ *
+ * Linux上图标主题（index.theme、其继承的主题以及hicolor）只读取一次，各尺寸目录中的文件名
+ * 放入哈希索引；文件类型及其图标名来自mimeDatabase。Windows上
+ * 用SHGFI_USEFILEATTRIBUTES按扩展名获取外壳图标，不访问文件本身。两种情况下
+ * 每个条目只需在内存中查一次扩展名，每个图标按（类型, 尺寸）定位、读取、解码一次，之后共享。
+ * 不考虑可执行文件和快捷方式各自的图标。Windows上调用线程应已初始化COM。
+ * 缓存的图标计入缓存预算（参见budgetedCache）。
+ */
+class iconResolver : public budgetedCache {
+public:
+    /**
+     * @param themeName Linux图标主题，为空时取gtk-3.0/settings.ini中的主题，没有则用hicolor。Windows上忽略
+     */
+    explicit iconResolver(const std::string& themeName = "") {
+#ifndef _WIN32
+        loadTheme(themeName.empty() ? defaultThemeName() : themeName);
+#else
+        (void)themeName;
+#endif
+    }
+
+    ~iconResolver() {
+        budgetLeave();
+        chargeMemory(memoryIconThemes, -static_cast<long long>(m_themeBytes), m_themeBytes ? -1 : 0);
+        chargeMemory(memoryIconImages, -static_cast<long long>(m_cacheBytes), -static_cast<long long>(m_cache.size()));
+    }
+
+    iconResolver(const iconResolver&) = delete;
+    iconResolver& operator=(const iconResolver&) = delete;
+
+    /**
+     * @brief 仅根据名称得出列表条目的文件类型
+     * @param fileName 名称或路径（UTF8编码），以'/'或'\\'结尾表示目录
+     * @return Linux上为MIME类型（目录为"inode/directory"，未知为"application/octet-stream"），
+     * Windows上为".ext"（目录为"folder"，无扩展名为"file"）
+     */
+    std::string typeOf(const std::string& fileName) const {
+        bool directory;
+        std::string name = listingBaseName(fileName, directory);
+#ifndef _WIN32
+        if (directory) return "inode/directory";
+        std::string type = m_mime.typeOfName(name);
+        return type.empty() ? "application/octet-stream" : type;
+#else
+        if (directory) return "folder";
+        size_t dot = name.rfind('.');
+        return dot == std::string::npos || dot + 1 == name.size() ? "file" : lowercaseAscii(name.substr(dot));
+#endif
+    }
+
+    /**
+     * @brief 一个列表条目的图标
+     * @param fileName 名称或路径（UTF8编码），以'/'或'\\'结尾表示目录
+     * @param size 图标尺寸（像素）
+     * @return 图标，未找到或无法解码时像素为空
+     */
+    std::shared_ptr<const iconImage> resolve(const std::string& fileName, int size) {
+        std::string type = typeOf(fileName);
+        std::shared_ptr<const iconImage> icon;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            icon = resolveType(type, size);
+        }
+        enforceCacheBudget();
+        return icon;
+    }
+
+    /**
+     * @brief 整个列表的图标，每个条目一个，参见resolve
+     */
+    std::vector<std::shared_ptr<const iconImage>> resolve(const std::vector<std::string>& fileNames, int size) {
+        std::vector<std::shared_ptr<const iconImage>> icons;
+        icons.reserve(fileNames.size());
+        std::unordered_map<std::string, std::shared_ptr<const iconImage>> byType;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& fileName : fileNames) {
+                std::string type = typeOf(fileName);
+                std::shared_ptr<const iconImage>& icon = byType[type];
+                if (!icon) icon = resolveType(type, size);
+                icons.push_back(icon);
+            }
+        }
+        enforceCacheBudget();
+        return icons;
+    }
+
+    /**
+     * @brief 已加载的（类型, 尺寸）图标数量
+     */
+    size_t cachedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_cache.size();
+    }
+
+    void evictEntry(const std::string& key) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_cache.find(key);
+        if (it == m_cache.end()) return;
+        size_t bytes = cacheEntryBytes(key, *it->second);
+        m_cacheBytes -= bytes;
+        chargeMemory(memoryIconImages, -static_cast<long long>(bytes), -1);
+        m_cache.erase(it);
+    }
+
+private:
+#ifndef _WIN32
+    /**
+     * @brief 图标主题的一个尺寸目录（某个基础目录下index.theme中"Directories"的一项）
+     */
+    struct iconThemeDirectory {
+        std::string path;
+        size_t theme;   // 所属主题在继承链中的位置，请求的主题为0
+        char type;      // 'F' Fixed、'S' Scalable或'T' Threshold
+        int size;
+        int minSize;
+        int maxSize;
+        int threshold;
+    };
+
+    /**
+     * @brief 在主题目录中找到的图标文件
+     */
+    struct iconThemeFile {
+        uint32_t directory;
+        unsigned char format;   // 0 .png、1 .svg、2 .xpm，即图标主题规范中的优先顺序
+    };
+
+    /**
+     * @brief 目录的图标尺寸与请求尺寸之间的距离，按图标主题规范计算
+     */
+    static int iconSizeDistance(const iconThemeDirectory& directory, int size) {
+        switch (directory.type) {
+            case 'F':
+                return std::abs(directory.size - size);
+            case 'S':
+                return size < directory.minSize ? directory.minSize - size : size > directory.maxSize ? size - directory.maxSize : 0;
+            default:
+                return size < directory.size - directory.threshold ? directory.size - directory.threshold - size
+                     : size > directory.size + directory.threshold ? size - directory.size - directory.threshold : 0;
+        }
+    }
+#endif
+
+    std::shared_ptr<const iconImage> resolveType(const std::string& type, int size) {
+        std::string key = type + '\n' + std::to_string(size);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            budgetUse(key);
+            return it->second;
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        size_t buckets = bucketBytes(m_cache);
+        std::shared_ptr<const iconImage> icon = loadIcon(type, size);
+        m_cache.emplace(key, icon);
+        size_t bytes = cacheEntryBytes(key, *icon);
+        m_cacheBytes += bytes + bucketBytes(m_cache) - buckets;
+        chargeMemory(memoryIconImages, static_cast<long long>(bytes + bucketBytes(m_cache) - buckets), 1);
+        budgetStore(key, bytes, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+        return icon;
+    }
+
+    /**
+     * @brief 一个缓存的图标及其表节点持有的字节数
+     */
+    size_t cacheEntryBytes(const std::string& key, const iconImage& icon) const {
+        return hashNodeBytes(m_cache, key) + sizeof(iconImage) + heapBytes(icon.type) + heapBytes(icon.path) + heapBytes(icon.pixels);
+    }
+
+#ifndef _WIN32
+    static std::string defaultThemeName() {
+        const char* home = getenv("HOME");
+        const char* configHome = getenv("XDG_CONFIG_HOME");
+        std::string config = configHome && *configHome ? configHome : home && *home ? std::string(home) + "/.config" : "";
+        std::string text;
+        if (!config.empty() && readFileContents(config + "/gtk-3.0/settings.ini", text, 1 << 20)) {
+            auto sections = parseIniText(text);
+            auto it = sections["Settings"].find("gtk-icon-theme-name");
+            if (it != sections["Settings"].end() && !it->second.empty()) return it->second;
+        }
+        return "hicolor";
+    }
+
+    /**
+     * @brief 读取主题及其继承的主题，然后将各尺寸目录各列举一次
+     */
+    void loadTheme(const std::string& themeName) {
+        std::vector<std::string> bases;
+        const char* home = getenv("HOME");
+        if (home && *home) bases.push_back(std::string(home) + "/.icons");
+        for (const auto& data : xdgDataDirectories()) bases.push_back(data + "/icons");
+
+        // 按广度优先排列的继承链，hicolor在最后
+        std::vector<std::string> chain(1, themeName);
+        for (size_t i = 0; i < chain.size(); ++i) {
+            std::string text;
+            for (const auto& base : bases) {
+                if (readFileContents(base + "/" + chain[i] + "/index.theme", text, 1 << 20)) break;
+                text.clear();
+            }
+            auto sections = parseIniText(text);
+            const auto& header = sections["Icon Theme"];
+            auto inherits = header.find("Inherits");
+            if (inherits != header.end()) {
+                for (const auto& parent : splitIniList(inherits->second)) {
+                    if (parent != "hicolor" && std::find(chain.begin(), chain.end(), parent) == chain.end()) chain.push_back(parent);
+                }
+            }
+
+            auto listed = header.find("Directories");
+            for (const auto& name : listed == header.end() ? std::vector<std::string>() : splitIniList(listed->second)) {
+                const auto& section = sections[name];
+                auto context = section.find("Context");
+                if (context != section.end() && context->second != "MimeTypes" && context->second != "Places") continue;
+                if (iniInteger(section, "Scale", 1) != 1) continue;
+
+                iconThemeDirectory directory;
+                directory.theme = i;
+                directory.size = iniInteger(section, "Size", 0);
+                directory.minSize = iniInteger(section, "MinSize", directory.size);
+                directory.maxSize = iniInteger(section, "MaxSize", directory.size);
+                directory.threshold = iniInteger(section, "Threshold", 2);
+                auto type = section.find("Type");
+                directory.type = type == section.end() || type->second == "Threshold" ? 'T' : type->second == "Fixed" ? 'F' : 'S';
+                for (const auto& base : bases) {
+                    directory.path = base + "/" + chain[i] + "/" + name;
+                    addThemeDirectory(directory);
+                }
+            }
+            if (i + 1 == chain.size() && chain.back() != "hicolor") chain.push_back("hicolor");
+        }
+
+        // 不属于主题的图标，适用任意尺寸
+        iconThemeDirectory pixmaps = {"/usr/share/pixmaps", chain.size(), 'S', 0, 0, 1 << 30, 0};
+        addThemeDirectory(pixmaps);
+        m_themeCount = chain.size() + 1;
+
+        m_themeBytes = m_directories.capacity() * sizeof(iconThemeDirectory) + heapBytes(m_icons);
+        for (const auto& directory : m_directories) m_themeBytes += heapBytes(directory.path);
+        chargeMemory(memoryIconThemes, static_cast<long long>(m_themeBytes), 1);
+    }
+
+    void addThemeDirectory(const iconThemeDirectory& directory) {
+        DIR* dir = opendir(directory.path.c_str());
+        if (!dir) return;
+        uint32_t index = static_cast<uint32_t>(m_directories.size());
+        m_directories.push_back(directory);
+        while (struct dirent* entry = readdir(dir)) {
+            size_t length = strlen(entry->d_name);
+            if (length < 5 || entry->d_name[length - 4] != '.') continue;
+            const char* extension = entry->d_name + length - 3;
+            unsigned char format = strcmp(extension, "png") == 0 ? 0 : strcmp(extension, "svg") == 0 ? 1 : strcmp(extension, "xpm") == 0 ? 2 : 3;
+            if (format == 3) continue;
+            iconThemeFile file = {index, format};
+            m_icons[std::string(entry->d_name, length - 4)].push_back(file);
+        }
+        closedir(dir);
+    }
+
+    /**
+     * @brief MIME类型的图标名，按shared-mime-info规范的顺序
+     */
+    std::vector<std::string> iconNames(const std::string& type) const {
+        std::vector<std::string> names;
+        if (type == "inode/directory") names.push_back("folder");
+        std::string named = m_mime.iconName(type);
+        if (!named.empty()) names.push_back(named);
+        std::string dashed = type;
+        std::replace(dashed.begin(), dashed.end(), '/', '-');
+        names.push_back(dashed);
+        std::string generic = m_mime.iconName(type, true);
+        if (!generic.empty()) names.push_back(generic);
+        names.push_back(type.substr(0, type.find('/')) + "-x-generic");
+        return names;
+    }
+
+    /**
+     * @brief 沿继承链查找，在第一个拥有其中某个图标名的主题里取尺寸最接近的文件
+     * @return 该文件，没有主题拥有这些名称时为nullptr
+     */
+    const iconThemeFile* findThemeIcon(const std::vector<std::string>& names, int size, const std::string*& iconName) const {
+        // 主题在最外层循环，因此请求的主题中的图标优先于继承主题中更具体的名称
+        const iconThemeFile* best = nullptr;
+        int bestScore = 0;
+        for (size_t theme = 0; theme < m_themeCount; ++theme) {
+            for (const auto& name : names) {
+                auto found = m_icons.find(name);
+                if (found == m_icons.end()) continue;
+                for (const auto& file : found->second) {
+                    const iconThemeDirectory& directory = m_directories[file.directory];
+                    if (directory.theme != theme) continue;
+                    int score = iconSizeDistance(directory, size) * 4 + file.format;
+                    if (!best || score < bestScore) {
+                        best = &file;
+                        iconName = &found->first;
+                        bestScore = score;
+                    }
+                }
+                if (best) return best;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<const iconImage> loadIcon(const std::string& type, int size) const {
+        auto image = std::make_shared<iconImage>();
+        image->type = type;
+
+        // 只有在所有主题都没有该类型自己的图标时才用通用图标
+        static const std::vector<std::string> fallbacks = {"application-x-generic", "unknown"};
+        const std::string* bestName = nullptr;
+        const iconThemeFile* best = findThemeIcon(iconNames(type), size, bestName);
+        if (!best) best = findThemeIcon(fallbacks, size, bestName);
+        if (!best) return image;
+
+        static const char* const extensions[3] = {".png", ".svg", ".xpm"};
+        image->path = m_directories[best->directory].path + "/" + *bestName + extensions[best->format];
+        std::string contents;
+        if (best->format == 0 && readFileContents(image->path, contents, __GCOMMDLG_ICON_FILE_MAX)) {
+            iconImage decoded;
+            if (decodePng(std::vector<unsigned char>(contents.begin(), contents.end()), decoded)) {
+                image->width = decoded.width;
+                image->height = decoded.height;
+                image->pixels = std::move(decoded.pixels);
+            }
+        }
+        return image;
+    }
+
+    std::vector<iconThemeDirectory> m_directories;
+    std::unordered_map<std::string, std::vector<iconThemeFile>> m_icons;        // 图标名 -> 所有主题目录中的文件
+    mimeDatabase m_mime;
+    size_t m_themeCount = 0;
+#else
+    std::shared_ptr<const iconImage> loadIcon(const std::string& type, int size) const {
+        auto image = std::make_shared<iconImage>();
+        image->type = type;
+
+        std::wstring name = type == "folder" ? L"folder" : type == "file" ? L"file" : L"file" + utf8ToWide(type);
+        DWORD attributes = type == "folder" ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+        SHFILEINFOW info = {0};
+        UINT flags = SHGFI_ICON | SHGFI_USEFILEATTRIBUTES | (size <= 16 ? SHGFI_SMALLICON : SHGFI_LARGEICON);
+        if (SHGetFileInfoW(name.c_str(), attributes, &info, sizeof(info), flags) && info.hIcon) {
+            decodeIconHandle(info.hIcon, *image);
+            DestroyIcon(info.hIcon);
+        }
+        return image;
+    }
+#endif
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const iconImage>> m_cache;  // "类型\n尺寸" -> 图标
+    size_t m_themeBytes = 0;    // 已记入memoryIconThemes
+    size_t m_cacheBytes = 0;    // 已记入memoryIconImages
+};
+
+#pragma endregion
+
+#ifndef SDL_pixels_h_
+
+struct SDL_Color{
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+#endif
+
+#pragma region 控件树
+// 输入对话框和消息对话框所用的无窗口控件：每个对话框一棵保留模式的控件树，按锚点布局，在进程内完成命中测试和焦点处理，
+// 并按损坏矩形重绘到同一个表面上。这里不依赖Win32，因此同样的对话框
+// 可以由SDL窗口承载，也可以完全不用窗口来驱动
+
+#ifndef __GCOMMDLG_WIDGET_DAMAGE_RECTS
+#define __GCOMMDLG_WIDGET_DAMAGE_RECTS 8  // 合并为外接矩形之前单独保留的损坏矩形数量
+#endif
+
+/**
+ * @brief 以表面像素为单位的矩形
+ */
+struct widgetRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * @brief 控件在父控件中的位置。每条边等于其锚点乘以父控件的尺寸再加上偏移，因此锚点
+ * {0, 0, 1, 0}加偏移{20, 20, -20, 45}以20像素的边距横跨父控件，锚点{0.5, 1, 0.5, 1}则让按钮
+ * 无论尺寸如何都保持在底部中央
+ */
+struct widgetPlacement {
+    float anchorLeft;
+    float anchorTop;
+    float anchorRight;
+    float anchorBottom;
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+enum widgetKind {
+    widgetPanel,    // 只有背景，用于组织子控件
+    widgetLabel,    // 一行文本，过长时以省略号截断
+    widgetTextBox,  // 单行文本编辑框
+    widgetButton    // 按钮，以其id结束对话框
+};
+
+enum widgetKey {
+    widgetKeyTab,
+    widgetKeyEnter,
+    widgetKeyEscape,
+    widgetKeySpace,
+    widgetKeyLeft,
+    widgetKeyRight,
+    widgetKeyHome,
+    widgetKeyEnd,
+    widgetKeyBackspace,
+    widgetKeyDelete
+};
+
+const size_t widgetNone = static_cast<size_t>(-1);
+
+/**
+ * @brief widgetTree的绘制后端：下面的对话框使用GDI，SDL叠加层中则可以使用例如SDL_RenderFillRect和SDL_ttf
+ */
+class widgetPainter {
+public:
+    virtual ~widgetPainter() {}
+
+    /**
+     * @brief 将绘制限制在一个矩形内，直到下次调用
+     */
+    virtual void setClip(const widgetRect& rect) = 0;
+
+    virtual void fillRect(const widgetRect& rect, const SDL_Color& color) = 0;
+
+    /**
+     * @brief 绘制一行UTF8文本，其左上角位于(x, y)
+     */
+    virtual void drawText(int x, int y, const std::string& text, const SDL_Color& color) = 0;
+
+    /**
+     * @return 一行UTF8文本的步进宽度（像素）
+     */
+    virtual int textWidth(const std::string& text) = 0;
+
+    /**
+     * @return 一行文本的高度（像素）
+     */
+    virtual int lineHeight() = 0;
+};
+
+namespace {
+
+    const SDL_Color g_widgetBackground = {240, 240, 240, 255};
+    const SDL_Color g_widgetText = {0, 0, 0, 255};
+    const SDL_Color g_widgetField = {255, 255, 255, 255};
+    const SDL_Color g_widgetFace = {225, 225, 225, 255};
+    const SDL_Color g_widgetHover = {229, 241, 251, 255};
+    const SDL_Color g_widgetPressed = {204, 228, 247, 255};
+    const SDL_Color g_widgetBorder = {173, 173, 173, 255};
+    const SDL_Color g_widgetAccent = {0, 120, 215, 255};
+
+    bool widgetRectContains(const widgetRect& rect, int x, int y) {
+        return x >= rect.x && y >= rect.y && x < rect.x + rect.width && y < rect.y + rect.height;
+    }
+
+    widgetRect intersectWidgetRects(const widgetRect& a, const widgetRect& b) {
+        int left = std::max(a.x, b.x);
+        int top = std::max(a.y, b.y);
+        int right = std::min(a.x + a.width, b.x + b.width);
+        int bottom = std::min(a.y + a.height, b.y + b.height);
+        widgetRect rect = {left, top, std::max(right - left, 0), std::max(bottom - top, 0)};
+        return rect;
+    }
+
+    widgetRect uniteWidgetRects(const widgetRect& a, const widgetRect& b) {
+        int left = std::min(a.x, b.x);
+        int top = std::min(a.y, b.y);
+        widgetRect rect = {left, top, std::max(a.x + a.width, b.x + b.width) - left, std::max(a.y + a.height, b.y + b.height) - top};
+        return rect;
+    }
+
+    widgetRect insetWidgetRect(const widgetRect& rect, int inset) {
+        widgetRect inner = {rect.x + inset, rect.y + inset, std::max(rect.width - inset * 2, 0), std::max(rect.height - inset * 2, 0)};
+        return inner;
+    }
+
+    /**
+     * @brief 在码位边界处截断UTF8文本并加上省略号，使其适合给定宽度
+     */
+    std::string fitWidgetText(widgetPainter& painter, const std::string& text, int width) {
+        if (painter.textWidth(text) <= width) return text;
+
+        std::vector<size_t> boundaries;
+        const unsigned char* begin = reinterpret_cast<const unsigned char*>(text.data());
+        const unsigned char* end = begin + text.size();
+        for (const unsigned char* p = begin; p < end;) {
+            nextCodePoint(p, end);
+            boundaries.push_back(static_cast<size_t>(p - begin));
+        }
+
+        // 加上省略号后仍能放下的最长前缀，都放不下时为空前缀
+        const std::string ellipsis = "\xE2\x80\xA6";
+        size_t low = 0, high = boundaries.size();
+        while (low < high) {
+            size_t middle = (low + high + 1) / 2;
+            if (painter.textWidth(text.substr(0, boundaries[middle - 1]) + ellipsis) <= width) {
+                low = middle;
+            } else {
+                high = middle - 1;
+            }
+        }
+        return (low == 0 ? std::string() : text.substr(0, boundaries[low - 1])) + ellipsis;
+    }
+}
+
+/**
+ * @brief 绘制到同一个表面上的保留模式无窗口控件树
+ *
+ * 控件按创建顺序保存在一个数组中，父控件在子控件之前，索引0处的根面板覆盖整个
+ * 表面。输入通过pointerMove / pointerDown / pointerUp / keyDown / textInput传入，它们在进程内完成命中测试、移动焦点
+ * 和编辑文本；每个需要重绘的变化都记录为损坏矩形，paint()只重绘
+ * 其下的控件。没有绘制器时控件树照样工作，对话框正是这样无界面运行的。
+ */
+class widgetTree {
+public:
+    widgetTree() {
+        widgetPlacement fill = {0, 0, 1, 1, 0, 0, 0, 0};
+        widgetNode root;
+        root.kind = widgetPanel;
+        root.parent = widgetNone;
+        root.placement = fill;
+        m_widgets.push_back(root);
+    }
+
+    /**
+     * @brief 在已有控件之上添加一个控件
+     * @param kind 控件类型
+     * @param placement 在父控件中的位置
+     * @param text 标签、文本框或按钮的UTF8文本
+     * @param id 控件为按钮且被激活时对话框的结果
+     * @param parent 父控件的索引，根面板为0
+     * @return 新控件的索引
+     * @throw std::invalid_argument 父控件不存在时抛出
+     */
+    size_t add(widgetKind kind, const widgetPlacement& placement, const std::string& text = "", int id = 0, size_t parent = 0) {
+        if (parent >= m_widgets.size()) {
+            throw std::invalid_argument("Widget parent does not exist: " + std::to_string(parent));
+        }
+
+        widgetNode node;
+        node.kind = kind;
+        node.parent = parent;
+        node.placement = placement;
+        node.text = text;
+        node.id = id;
+        node.caret = text.size();
+        m_widgets.push_back(node);
+
+        size_t widget = m_widgets.size() - 1;
+        layout(widget);
+        addDamage(m_widgets[widget].rect);
+        return widget;
+    }
+
+    size_t size() const {
+        return m_widgets.size();
+    }
+
+    widgetKind kind(size_t widget) const {
+        return m_widgets.at(widget).kind;
+    }
+
+    /**
+     * @return 控件布局后的矩形（表面像素）
+     */
+    widgetRect rect(size_t widget) const {
+        return m_widgets.at(widget).rect;
+    }
+
+    const std::string& text(size_t widget) const {
+        return m_widgets.at(widget).text;
+    }
+
+    /**
+     * @brief 替换控件的文本，文本框的光标移到末尾
+     */
+    void setText(size_t widget, const std::string& text) {
+        widgetNode& node = m_widgets.at(widget);
+        node.text = text;
+        node.caret = text.size();
+        addDamage(node.rect);
+    }
+
+    /**
+     * @brief 焦点不在其他按钮上时由Enter激活的按钮
+     */
+    void setDefaultButton(size_t button) {
+        m_default = button;
+        if (button != widgetNone) addDamage(m_widgets.at(button).rect);
+    }
+
+    /**
+     * @brief 由Escape激活的按钮。没有时Escape以结果0结束对话框
+     */
+    void setCancelButton(size_t button) {
+        m_cancel = button;
+    }
+
+    /**
+     * @brief 设置表面尺寸并重新布局控件
+     */
+    void resize(int width, int height) {
+        if (width == m_width && height == m_height) return;
+        m_width = width;
+        m_height = height;
+        for (size_t i = 0; i < m_widgets.size(); ++i) layout(i);
+        invalidate();
+    }
+
+    /**
+     * @return 某点处最上层控件的索引，在表面之外时为widgetNone
+     */
+    size_t hitTest(int x, int y) const {
+        for (size_t i = m_widgets.size(); i-- > 0;) {
+            if (widgetRectContains(m_widgets[i].rect, x, y)) return i;
+        }
+        return widgetNone;
+    }
+
+    /**
+     * @return 接收按键的控件的索引，没有时为widgetNone
+     */
+    size_t focused() const {
+        return m_focused;
+    }
+
+    /**
+     * @brief 将键盘焦点移到文本框或按钮，widgetNone表示清除焦点
+     */
+    void focus(size_t widget) {
+        if (widget == m_focused) return;
+        if (widget != widgetNone && !isFocusable(widget)) return;
+        if (m_focused != widgetNone) addDamage(m_widgets[m_focused].rect);
+        m_focused = widget;
+        if (widget != widgetNone) addDamage(m_widgets[widget].rect);
+
+        // 只有在其他按钮都没有焦点时，默认按钮才绘制为默认样式
+        if (m_default != widgetNone) addDamage(m_widgets[m_default].rect);
+    }
+
+    void pointerMove(int x, int y) {
+        size_t hit = hitTest(x, y);
+        size_t hovered = hit != widgetNone && m_widgets[hit].kind == widgetButton ? hit : widgetNone;
+        if (hovered == m_hovered) return;
+        if (m_hovered != widgetNone) addDamage(m_widgets[m_hovered].rect);
+        m_hovered = hovered;
+        if (hovered != widgetNone) addDamage(m_widgets[hovered].rect);
+    }
+
+    void pointerDown(int x, int y) {
+        pointerMove(x, y);
+        size_t hit = hitTest(x, y);
+        if (hit == widgetNone || !isFocusable(hit)) return;
+        focus(hit);
+
+        widgetNode& node = m_widgets[hit];
+        if (node.kind == widgetButton) {
+            m_pressed = hit;
+            addDamage(node.rect);
+        } else if (!node.stops.empty()) {
+            // 光标放在离点击处最近的码位边界上，按上次绘制时的布局
+            int offset = x - node.textX + node.scroll;
+            size_t nearest = 0;
+            for (size_t i = 1; i < node.stops.size(); ++i) {
+                if (std::abs(node.stops[i].second - offset) < std::abs(node.stops[nearest].second - offset)) nearest = i;
+            }
+            node.caret = node.stops[nearest].first;
+            addDamage(node.rect);
+        } else {
+            node.caret = node.text.size();
+            addDamage(node.rect);
+        }
+    }
+
+    /**
+     * @brief 释放指针，指针仍在按下的按钮上时激活该按钮
+     */
+    void pointerUp(int x, int y) {
+        pointerMove(x, y);
+        size_t pressed = m_pressed;
+        if (pressed == widgetNone) return;
+        m_pressed = widgetNone;
+        addDamage(m_widgets[pressed].rect);
+        if (hitTest(x, y) == pressed) activate(pressed);
+    }
+
+    /**
+     * @brief 处理导航键或编辑键。Tab移动焦点，Enter和Space激活按钮，Escape取消，
+     * 其他按键在有焦点的文本框中移动光标或删除文本
+     * @param shift 是否按住Shift，Shift+Tab反向移动焦点
+     */
+    void keyDown(widgetKey key, bool shift = false) {
+        size_t focused = m_focused;
+        bool onButton = focused != widgetNone && m_widgets[focused].kind == widgetButton;
+        switch (key) {
+            case widgetKeyTab:
+                moveFocus(shift);
+                return;
+            case widgetKeyEnter:
+                if (onButton) activate(focused);
+                else if (m_default != widgetNone) activate(m_default);
+                return;
+            case widgetKeySpace:
+                if (onButton) activate(focused);
+                return;
+            case widgetKeyEscape:
+                if (m_cancel != widgetNone) {
+                    activate(m_cancel);
+                } else {
+                    m_finished = true;
+                    m_result = 0;
+                }
+                return;
+            default:
+                break;
+        }
+        if (focused == widgetNone || m_widgets[focused].kind != widgetTextBox) return;
+
+        widgetNode& node = m_widgets[focused];
+        const unsigned char* begin = reinterpret_cast<const unsigned char*>(node.text.data());
+        const unsigned char* end = begin + node.text.size();
+        size_t next = node.caret;
+        if (next < node.text.size()) {
+            const unsigned char* p = begin + next;
+            nextCodePoint(p, end);
+            next = static_cast<size_t>(p - begin);
+        }
+        size_t previous = node.caret;
+        while (previous > 0 && (begin[--previous] & 0xC0) == 0x80) {}
+
+        switch (key) {
+            case widgetKeyLeft:      node.caret = previous; break;
+            case widgetKeyRight:     node.caret = next; break;
+            case widgetKeyHome:      node.caret = 0; break;
+            case widgetKeyEnd:       node.caret = node.text.size(); break;
+            case widgetKeyBackspace: node.text.erase(previous, node.caret - previous); node.caret = previous; break;
+            case widgetKeyDelete:    node.text.erase(node.caret, next - node.caret); break;
+            default:                 return;
+        }
+        addDamage(node.rect);
+    }
+
+    /**
+     * @brief 在有焦点的文本框的光标处插入键入或粘贴的UTF8文本。控制字符会被丢弃
+     */
+    void textInput(const std::string& text) {
+        if (m_focused == widgetNone || m_widgets[m_focused].kind != widgetTextBox) return;
+
+        std::string printable;
+        printable.reserve(text.size());
+        for (char c : text) {
+            if (static_cast<unsigned char>(c) >= 0x20 && c != 0x7F) printable += c;
+        }
+        if (printable.empty()) return;
+
+        widgetNode& node = m_widgets[m_focused];
+        node.text.insert(node.caret, printable);
+        node.caret += printable.size();
+        addDamage(node.rect);
+    }
+
+    /**
+     * @return 是否有按钮被激活，或Escape结束了对话框
+     */
+    bool finished() const {
+        return m_finished;
+    }
+
+    /**
+     * @return 被激活的按钮的id，Escape结束对话框或对话框尚未结束时为0
+     */
+    int result() const {
+        return m_result;
+    }
+
+    /**
+     * @return 自上次paint()以来需要重绘的区域，供宿主在其窗口中使之无效
+     */
+    const std::vector<widgetRect>& damage() const {
+        return m_damage;
+    }
+
+    /**
+     * @brief 将整个表面标记为需要重绘，例如在宿主丢失后台缓冲区之后
+     */
+    void invalidate() {
+        m_damage.clear();
+        widgetRect surface = {0, 0, m_width, m_height};
+        if (m_width > 0 && m_height > 0) m_damage.push_back(surface);
+    }
+
+    /**
+     * @brief 重绘损坏矩形下的控件并清除这些矩形。表面上的其他内容保持不变
+     */
+    void paint(widgetPainter& painter) {
+        for (const widgetRect& area : m_damage) {
+            for (size_t i = 0; i < m_widgets.size(); ++i) {
+                widgetRect clip = intersectWidgetRects(m_widgets[i].rect, area);
+                if (clip.width > 0 && clip.height > 0) paintWidget(painter, i, clip);
+            }
+        }
+        m_damage.clear();
+    }
+
+private:
+    struct widgetNode {
+        widgetKind kind;
+        size_t parent;
+        widgetPlacement placement;
+        widgetRect rect = {0, 0, 0, 0};
+        std::string text;
+        int id = 0;
+        size_t caret = 0;                               // 文本框中光标的字节偏移
+        int scroll = 0;                                 // 文本框的文本向左滚出的像素数
+        int textX = 0;                                  // 滚动前文本起点在表面上的x坐标
+        std::vector<std::pair<size_t, int>> stops;      // 码位边界及其x偏移，来自上次绘制
+    };
+
+    void layout(size_t widget) {
+        widgetNode& node = m_widgets[widget];
+        widgetRect parent = {0, 0, m_width, m_height};
+        if (node.parent != widgetNone) parent = m_widgets[node.parent].rect;
+
+        const widgetPlacement& p = node.placement;
+        int left = parent.x + static_cast<int>(std::lround(p.anchorLeft * parent.width)) + p.left;
+        int top = parent.y + static_cast<int>(std::lround(p.anchorTop * parent.height)) + p.top;
+        int right = parent.x + static_cast<int>(std::lround(p.anchorRight * parent.width)) + p.right;
+        int bottom = parent.y + static_cast<int>(std::lround(p.anchorBottom * parent.height)) + p.bottom;
+        widgetRect rect = {left, top, std::max(right - left, 0), std::max(bottom - top, 0)};
+        node.rect = rect;
+    }
+
+    void addDamage(const widgetRect& rect) {
+        widgetRect surface = {0, 0, m_width, m_height};
+        widgetRect area = intersectWidgetRects(rect, surface);
+        if (area.width == 0 || area.height == 0) return;
+
+        // 合并到重叠的矩形中，数量过多时合并为全部矩形的外接矩形
+        for (widgetRect& existing : m_damage) {
+            widgetRect overlap = intersectWidgetRects(existing, area);
+            if (overlap.width > 0 && overlap.height > 0) {
+                existing = uniteWidgetRects(existing, area);
+                return;
+            }
+        }
+        if (m_damage.size() < __GCOMMDLG_WIDGET_DAMAGE_RECTS) {
+            m_damage.push_back(area);
+            return;
+        }
+        for (const widgetRect& existing : m_damage) area = uniteWidgetRects(area, existing);
+        m_damage.assign(1, area);
+    }
+
+    bool isFocusable(size_t widget) const {
+        widgetKind kind = m_widgets[widget].kind;
+        return kind == widgetTextBox || kind == widgetButton;
+    }
+
+    void moveFocus(bool backwards) {
+        size_t count = m_widgets.size();
+        size_t start = m_focused == widgetNone ? (backwards ? 0 : count - 1) : m_focused;
+        for (size_t step = 1; step <= count; ++step) {
+            size_t widget = backwards ? (start + count - step) % count : (start + step) % count;
+            if (isFocusable(widget)) {
+                if (m_widgets[widget].kind == widgetTextBox) m_widgets[widget].caret = m_widgets[widget].text.size();
+                focus(widget);
+                return;
+            }
+        }
+    }
+
+    void activate(size_t button) {
+        m_finished = true;
+        m_result = m_widgets[button].id;
+    }
+
+    void paintWidget(widgetPainter& painter, size_t widget, const widgetRect& clip) {
+        widgetNode& node = m_widgets[widget];
+        const widgetRect& rect = node.rect;
+        painter.setClip(clip);
+
+        switch (node.kind) {
+            case widgetPanel:
+                painter.fillRect(rect, g_widgetBackground);
+                break;
+
+            case widgetLabel: {
+                std::string text = fitWidgetText(painter, node.text, rect.width);
+                painter.drawText(rect.x, rect.y + (rect.height - painter.lineHeight()) / 2, text, g_widgetText);
+                break;
+            }
 
-        switch (msg) {
-            case WM_CREATE: {
-                
-                hFont = CreateFontW(
-                    24, 0, 0, 0, FW_NORMAL, 
-                    FALSE, FALSE, FALSE, DEFAULT_CHARSET,
-                    OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-                    CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_DONTCARE,
-                    L"微软雅黑"
-                );
+            case widgetButton: {
+                bool focusedButton = m_focused != widgetNone && m_widgets[m_focused].kind == widgetButton;
+                bool highlighted = widget == m_focused || (widget == m_default && !focusedButton);
+                const SDL_Color& face = widget == m_pressed && widget == m_hovered ? g_widgetPressed
+                                      : widget == m_hovered ? g_widgetHover : g_widgetFace;
+                painter.fillRect(rect, highlighted ? g_widgetAccent : g_widgetBorder);
+                painter.fillRect(insetWidgetRect(rect, highlighted ? 2 : 1), face);
 
-                hStaticMsg = CreateWindowExW(
-                    0,
-                    L"STATIC",
-                    g_msgContent.c_str(),
-                    WS_CHILD | WS_VISIBLE | SS_LEFT | SS_WORDELLIPSIS,
-                    20, 20, 360, 26,
-                    hDlg,
-                    (HMENU)1001,
-                    ((LPCREATESTRUCTW)lParam)->hInstance,
-                    NULL
-                );
+                widgetRect inner = insetWidgetRect(rect, 4);
+                std::string text = fitWidgetText(painter, node.text, inner.width);
+                painter.setClip(intersectWidgetRects(clip, inner));
+                painter.drawText(rect.x + (rect.width - painter.textWidth(text)) / 2,
+                                 rect.y + (rect.height - painter.lineHeight()) / 2, text, g_widgetText);
+                break;
+            }
 
-                hButtons.reserve(g_options.size());
-                for (size_t i = 0; i < g_options.size(); ++i) {
-                    HWND hBtn = CreateWindowExW(
-                        0,
-                        L"BUTTON",
-                        g_options[i].second.c_str(),
-                        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
-                        20, 120, __GCOMMDLG_MSGBOX_BTN_WIDTH, 30,
-                        hDlg,
-                        (HMENU)(__GCOMMMDLG_BTN_START + i),
-                        ((LPCREATESTRUCTW)lParam)->hInstance,
-                        NULL
-                    );
-                    hButtons.push_back(hBtn);
-                }
-
-                if (hFont) {
-                    SendMessage(hStaticMsg, WM_SETFONT, (WPARAM)hFont, TRUE);
-                    for (HWND hBtn : hButtons) {
-                        SendMessage(hBtn, WM_SETFONT, (WPARAM)hFont, TRUE);
-                    }
+            case widgetTextBox: {
+                bool focusedBox = widget == m_focused;
+                painter.fillRect(rect, focusedBox ? g_widgetAccent : g_widgetBorder);
+                painter.fillRect(insetWidgetRect(rect, 1), g_widgetField);
+
+                // 每次绘制时测量一次，以便点击时放置光标，并在输入时让光标保持可见
+                node.stops.clear();
+                node.stops.push_back(std::make_pair(static_cast<size_t>(0), 0));
+                const unsigned char* begin = reinterpret_cast<const unsigned char*>(node.text.data());
+                const unsigned char* end = begin + node.text.size();
+                int x = 0;
+                for (const unsigned char* p = begin; p < end;) {
+                    const unsigned char* start = p;
+                    nextCodePoint(p, end);
+                    x += painter.textWidth(std::string(reinterpret_cast<const char*>(start), static_cast<size_t>(p - start)));
+                    node.stops.push_back(std::make_pair(static_cast<size_t>(p - begin), x));
                 }
 
-                return 0;
+                widgetRect inner = insetWidgetRect(rect, 4);
+                int caretX = 0;
+                for (const auto& stop : node.stops) {
+                    if (stop.first == node.caret) caretX = stop.second;
+                }
+                if (caretX - node.scroll > inner.width - 1) node.scroll = caretX - inner.width + 1;
+                if (caretX < node.scroll) node.scroll = caretX;
+                node.scroll = std::max(std::min(node.scroll, x - inner.width + 1), 0);
+                node.textX = inner.x;
+
+                int y = rect.y + (rect.height - painter.lineHeight()) / 2;
+                painter.setClip(intersectWidgetRects(clip, inner));
+                painter.drawText(inner.x - node.scroll, y, node.text, g_widgetText);
+                if (focusedBox) {
+                    widgetRect caret = {inner.x + caretX - node.scroll, y, 1, painter.lineHeight()};
+                    painter.fillRect(caret, g_widgetText);
+                }
+                break;
             }
+        }
+    }
 
-            case WM_SIZE: {
-                int clientWidth = LOWORD(lParam);
-                int clientHeight = HIWORD(lParam);
-
-                if (hStaticMsg) {
-                    SetWindowPos(hStaticMsg, NULL,
-                        20, 20,
-                        clientWidth - 40, 26,
-                        SWP_NOZORDER);
-                }
-
-                if (!hButtons.empty()) {
-                    const int btnWidth = __GCOMMDLG_MSGBOX_BTN_WIDTH;
-                    const int btnHeight = 30;
-                    const int spacing = 20;
-                    int startX = 20;
-                    int startY = clientHeight - btnHeight - 20;
-
-                    for (size_t i = 0; i < hButtons.size(); ++i) {
-                        SetWindowPos(hButtons[i], NULL,
-                            startX + (i % 3) * (btnWidth + spacing), startY - (i / 3) * 40,
-                            btnWidth, btnHeight,
-                            SWP_NOZORDER);
-                    }
+    std::vector<widgetNode> m_widgets;
+    std::vector<widgetRect> m_damage;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_focused = widgetNone;
+    size_t m_hovered = widgetNone;
+    size_t m_pressed = widgetNone;
+    size_t m_default = widgetNone;
+    size_t m_cancel = widgetNone;
+    bool m_finished = false;
+    int m_result = 0;
+};
+
+#define __GCOMMDLG_MSGBOX_BTN_WIDTH 100
+
+/**
+ * @brief 构建promptDialog的控件：提示文本、输入框和确定（id 1）/ 取消（id 0）按钮。输入框
+ * 拥有焦点，Enter确认，Escape取消。在别处承载此控件树，例如SDL叠加层或测试中，得到的是同一个对话框
+ * @param tree 空的控件树
+ * @param message UTF8提示文本
+ * @param defaultContent 输入框的UTF8初始内容
+ * @return 输入框的索引，控件树以结果1结束后，其文本即为用户的输入
+ */
+size_t buildPromptDialog(widgetTree& tree, const std::string& message, const std::string& defaultContent = "") {
+    widgetPlacement label = {0, 0, 1, 0, 20, 20, -20, 45};
+    widgetPlacement input = {0, 0, 1, 0, 20, 55, -20, 85};
+    widgetPlacement ok = {0.5f, 1, 0.5f, 1, -90, -45, -10, -15};
+    widgetPlacement cancel = {0.5f, 1, 0.5f, 1, 10, -45, 90, -15};
+
+    tree.add(widgetLabel, label, message);
+    size_t inputBox = tree.add(widgetTextBox, input, defaultContent);
+    tree.setDefaultButton(tree.add(widgetButton, ok, "OK", 1));
+    tree.setCancelButton(tree.add(widgetButton, cancel, "Cancel", 0));
+    tree.focus(inputBox);
+    return inputBox;
+}
+
+/**
+ * @brief 构建messageBox的控件：提示文本和每个选项一个按钮，每行三个，自下而上排列，
+ * 焦点在第一个按钮上
+ * @param tree 空的控件树
+ * @param message UTF8提示文本
+ * @param options 选项集合（键为结果，值为UTF8按钮文本）
+ */
+void buildMessageBox(widgetTree& tree, const std::string& message, const std::vector<std::pair<int, std::string>>& options) {
+    widgetPlacement label = {0, 0, 1, 0, 20, 20, -20, 46};
+    tree.add(widgetLabel, label, message);
+
+    for (size_t i = 0; i < options.size(); ++i) {
+        int x = 20 + static_cast<int>(i % 3) * (__GCOMMDLG_MSGBOX_BTN_WIDTH + 20);
+        int y = -50 - static_cast<int>(i / 3) * 40;
+        widgetPlacement button = {0, 1, 0, 1, x, y, x + __GCOMMDLG_MSGBOX_BTN_WIDTH, y + 30};
+        size_t widget = tree.add(widgetButton, button, options[i].second, options[i].first);
+        if (i == 0) tree.focus(widget);
+    }
+}
+
+#pragma endregion
+
+#ifdef _WIN32
+
+/**
+ * @brief 显示颜色选择对话框，让用户选择一个颜色
+ * 
+ * @param selectedColor 用户所选的颜色
+ * @param hwndParent 颜色选择对话框的父窗口句柄
+ */
+void chooseColor(SDL_Color& selectedColor, HWND hwndParent = NULL)
+{
+    dialogProbe probe("chooseColor");
+    static COLORREF customColors[16] = {0};
+    
+    CHOOSECOLORW cc = {0};
+    cc.lStructSize = sizeof(cc);
+    cc.hwndOwner = hwndParent;
+    cc.lpCustColors = customColors;
+    cc.Flags = CC_RGBINIT | CC_FULLOPEN;
+    
+    COLORREF initialColor = RGB(
+        selectedColor.r,
+        selectedColor.g,
+        selectedColor.b
+    );
+    cc.rgbResult = initialColor;
+	
+    if (!ChooseColorW(&cc))
+    {
+        DWORD err = CommDlgExtendedError();
+        if (err != 0) {
+            throw std::runtime_error("Choose color dialog failed: " + std::to_string(err));
+        }
+    }
+
+    selectedColor.r = GetRValue(cc.rgbResult);
+    selectedColor.g = GetGValue(cc.rgbResult);
+    selectedColor.b = GetBValue(cc.rgbResult);
+    selectedColor.a = 255;
+}
+
+#endif
+
+struct chooseFontInfo{
+    std::string fontFaceName;
+    std::string fontPath;
+    int fontPointSize;
+    unsigned fontFaceIndex;                        // 字体在字体集合（.ttc）中的索引，否则为0
+    int fontWeight;                                // 100到900，400为常规
+    bool fontItalic;
+    std::vector<fontVariationAxis> fontVariation;  // 可变字体需要应用的轴坐标，静态字体为空
+};
+
+#ifdef _WIN32
+
+/**
+ * @brief 显示字体选择对话框，让用户选择系统上所安装的字体
+ * 
+ * @param cfi 输出参数。fontPath、fontFaceIndex和fontVariation为渲染器定位所选字体（含字重和斜体），通过getSystemFontIndex查找。注意，不保证一定可以找到选择的字体的路径，但大概率可以找到。若没找到，fontPath为空字符串。
+ * @param hwndParent 颜色选择对话框的父窗口句柄
+ */
+void chooseFont(chooseFontInfo& cfi, HWND hwndParent = NULL){
+    dialogProbe probe("chooseFont");
+    CHOOSEFONTW cf = {0};
+    LOGFONTW lf = {0};
+    cf.lStructSize = sizeof(CHOOSEFONTW);
+    cf.hwndOwner = hwndParent;
+    cf.lpLogFont = &lf;
+    cf.Flags = CF_SCREENFONTS | CF_NOVERTFONTS | CF_TTONLY;
+    if (!ChooseFontW(&cf)) {
+        DWORD err = CommDlgExtendedError();
+        if (err != 0) {
+            throw std::runtime_error("Choose font dialog failed: " + std::to_string(err));
+        }
+    }
+    cfi.fontFaceName = wideToUtf8(lf.lfFaceName);
+    cfi.fontPointSize = cf.iPointSize / 10;
+    cfi.fontWeight = lf.lfWeight > 0 ? lf.lfWeight : 400;
+    cfi.fontItalic = lf.lfItalic != 0;
+    cfi.fontFaceIndex = 0;
+    cfi.fontVariation.clear();
+
+    // 通过字体索引解析，使所选的字重和斜体对应到正确的文件或可变字体实例，注册表搜索作为后备
+    fontFaceInfo face;
+    std::shared_ptr<const fontIndex> fonts = getSystemFontIndex();
+    if (fonts->matchFace(cfi.fontFaceName, cfi.fontWeight, cfi.fontItalic, 5, face)) {
+        cfi.fontPath = face.path;
+        cfi.fontFaceIndex = face.faceIndex;
+        cfi.fontVariation = face.variation;
+    } else {
+        cfi.fontPath = wideToUtf8(FindFontFile(lf.lfFaceName));
+    }
+}
+
+#pragma region 非Win32原生对话框
+// 使用原始的方法轻量级实现一些commdlg.h没有实现的对话框，比如prompt。
+// 每个对话框都是承载一棵widgetTree的单个窗口，不创建子控件
+
+namespace{
+
+    /**
+     * @brief 用GDI绘制到设备上下文的widgetPainter
+     */
+    class gdiWidgetPainter : public widgetPainter {
+    public:
+        explicit gdiWidgetPainter(HDC hdc) : m_hdc(hdc) {
+            SetBkMode(hdc, TRANSPARENT);
+            TEXTMETRICW metrics;
+            m_lineHeight = GetTextMetricsW(hdc, &metrics) ? metrics.tmHeight : 16;
+        }
+
+        void setClip(const widgetRect& rect) override {
+            SelectClipRgn(m_hdc, NULL);
+            IntersectClipRect(m_hdc, rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
+        }
+
+        void fillRect(const widgetRect& rect, const SDL_Color& color) override {
+            RECT area = {rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+            SetDCBrushColor(m_hdc, RGB(color.r, color.g, color.b));
+            FillRect(m_hdc, &area, (HBRUSH)GetStockObject(DC_BRUSH));
+        }
+
+        void drawText(int x, int y, const std::string& text, const SDL_Color& color) override {
+            std::wstring wide = utf8ToWide(text);
+            SetTextColor(m_hdc, RGB(color.r, color.g, color.b));
+            TextOutW(m_hdc, x, y, wide.c_str(), static_cast<int>(wide.size()));
+        }
+
+        int textWidth(const std::string& text) override {
+            std::wstring wide = utf8ToWide(text);
+            SIZE size = {0, 0};
+            GetTextExtentPoint32W(m_hdc, wide.c_str(), static_cast<int>(wide.size()), &size);
+            return size.cx;
+        }
+
+        int lineHeight() override {
+            return m_lineHeight;
+        }
+
+    private:
+        HDC m_hdc;
+        int m_lineHeight;
+    };
+
+    /**
+     * @brief 对话框窗口的状态：其控件树和控件树绘制到的后台缓冲区
+     */
+    struct widgetDialogHost {
+        widgetTree tree;
+        HFONT font = NULL;
+        HDC surface = NULL;          // 在两次绘制之间保留上一帧的内存设备上下文
+        HBITMAP bitmap = NULL;
+        HGDIOBJ previousBitmap = NULL;
+        HGDIOBJ previousFont = NULL;
+        bool trackingLeave = false;
+        std::vector<std::pair<size_t, HWND>> edits;     // 覆盖在每个文本框控件上的原生EDIT控件
+        WNDPROC editProc = NULL;                        // EDIT类的窗口过程，由WidgetEditProc调用
+    };
+
+    /**
+     * @brief 把键盘焦点交给获得焦点的文本框的EDIT控件，控件树焦点在别处时交给对话框窗口
+     */
+    void syncWidgetEditFocus(HWND hDlg, widgetDialogHost& host) {
+        HWND target = hDlg;
+        for (const auto& edit : host.edits) {
+            if (edit.first == host.tree.focused()) target = edit.second;
+        }
+        if (GetFocus() != target) SetFocus(target);
+    }
+
+    void releaseWidgetSurface(widgetDialogHost& host) {
+        if (!host.surface) return;
+        SelectObject(host.surface, host.previousFont);
+        SelectObject(host.surface, host.previousBitmap);
+        DeleteObject(host.bitmap);
+        DeleteDC(host.surface);
+        host.surface = NULL;
+        host.bitmap = NULL;
+    }
+
+    /**
+     * @brief 控件树结束后关闭对话框，否则使上次输入损坏的区域无效
+     */
+    LRESULT afterWidgetInput(HWND hDlg, widgetDialogHost& host) {
+        if (host.tree.finished()) {
+            DestroyWindow(hDlg);
+            return 0;
+        }
+        for (const widgetRect& area : host.tree.damage()) {
+            RECT rect = {area.x, area.y, area.x + area.width, area.y + area.height};
+            InvalidateRect(hDlg, &rect, FALSE);
+        }
+        syncWidgetEditFocus(hDlg, host);
+        return 0;
+    }
+
+    /**
+     * @brief 原生EDIT控件的子类过程：让控件树的焦点跟随键盘焦点，并把Tab、Enter和Escape交给控件树
+     */
+    LRESULT CALLBACK WidgetEditProc(HWND hEdit, UINT msg, WPARAM wParam, LPARAM lParam) {
+        HWND hDlg = GetParent(hEdit);
+        widgetDialogHost* host = reinterpret_cast<widgetDialogHost*>(GetWindowLongPtrW(hDlg, GWLP_USERDATA));
+        size_t widget = static_cast<size_t>(GetWindowLongPtrW(hEdit, GWLP_USERDATA));
+
+        switch (msg) {
+            case WM_SETFOCUS:
+                host->tree.focus(widget);
+                afterWidgetInput(hDlg, *host);
+                break;
+
+            case WM_KEYDOWN:
+                if (wParam == VK_TAB || wParam == VK_RETURN || wParam == VK_ESCAPE) {
+                    host->tree.keyDown(wParam == VK_TAB ? widgetKeyTab : wParam == VK_RETURN ? widgetKeyEnter : widgetKeyEscape,
+                                       GetKeyState(VK_SHIFT) < 0);
+                    return afterWidgetInput(hDlg, *host);
                 }
+                break;
+
+            case WM_CHAR:
+                // 已作为按键处理，交给EDIT只会发出提示音
+                if (wParam == '\t' || wParam == '\r' || wParam == 0x1B) return 0;
+                break;
+
+            default:
+                break;
+        }
+        return CallWindowProcW(host->editProc, hEdit, msg, wParam, lParam);
+    }
+
+    void placeWidgetEdits(widgetDialogHost& host) {
+        for (const auto& edit : host.edits) {
+            // 位于控件树绘制的边框之内，使文本框的焦点颜色保持可见
+            widgetRect inner = insetWidgetRect(host.tree.rect(edit.first), 3);
+            SetWindowPos(edit.second, NULL, inner.x, inner.y, inner.width, inner.height, SWP_NOZORDER | SWP_NOACTIVATE);
+        }
+    }
+
+    /**
+     * @brief 在每个文本框控件上创建原生EDIT控件，使文本输入具备Windows文本框的选择、剪贴板、撤销、输入法定位和无障碍支持
+     * @return 所有控件是否都已创建
+     */
+    bool createWidgetEdits(HWND hDlg, widgetDialogHost& host) {
+        for (size_t widget = 0; widget < host.tree.size(); ++widget) {
+            if (host.tree.kind(widget) != widgetTextBox) continue;
+
+            HWND hEdit = CreateWindowExW(0, L"EDIT", utf8ToWide(host.tree.text(widget)).c_str(), WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
+                                         0, 0, 0, 0, hDlg, NULL, GetModuleHandleW(NULL), NULL);
+            if (!hEdit) return false;
+            SetWindowLongPtrW(hEdit, GWLP_USERDATA, static_cast<LONG_PTR>(widget));
+            host.editProc = reinterpret_cast<WNDPROC>(SetWindowLongPtrW(hEdit, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(WidgetEditProc)));
+            SendMessageW(hEdit, WM_SETFONT, (WPARAM)host.font, FALSE);
+            SendMessageW(hEdit, EM_SETSEL, 0, -1);
+            host.edits.push_back(std::make_pair(widget, hEdit));
+        }
+        placeWidgetEdits(host);
+        return true;
+    }
+
+    LRESULT CALLBACK WidgetDialogProc(HWND hDlg, UINT msg, WPARAM wParam, LPARAM lParam) {
+
+        widgetDialogHost* host = reinterpret_cast<widgetDialogHost*>(GetWindowLongPtrW(hDlg, GWLP_USERDATA));
+        if (!host) {
+            if (msg == WM_NCCREATE) {
+                SetWindowLongPtrW(hDlg, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(((LPCREATESTRUCTW)lParam)->lpCreateParams));
+            }
+            return DefWindowProcW(hDlg, msg, wParam, lParam);
+        }
+
+        switch (msg) {
+            case WM_CREATE: {
+                RECT client;
+                GetClientRect(hDlg, &client);
+                host->tree.resize(client.right, client.bottom);
+                return createWidgetEdits(hDlg, *host) ? 0 : -1;
+            }
+
+            case WM_SIZE: {
+                releaseWidgetSurface(*host);
+                host->tree.resize(LOWORD(lParam), HIWORD(lParam));
+                placeWidgetEdits(*host);
+                InvalidateRect(hDlg, NULL, FALSE);
                 return 0;
             }
 
+            case WM_SETFOCUS:
+                syncWidgetEditFocus(hDlg, *host);
+                return 0;
+
             case WM_COMMAND: {
-                int btnId = LOWORD(wParam);
-                if (btnId >= __GCOMMMDLG_BTN_START && btnId < __GCOMMMDLG_BTN_START + (int)g_options.size()) {
-                    size_t index = btnId - __GCOMMMDLG_BTN_START;
-                    g_selectedId = g_options[index].first;
-                    DestroyWindow(hDlg);
+                if (HIWORD(wParam) != EN_CHANGE) break;
+                HWND hEdit = reinterpret_cast<HWND>(lParam);
+                for (const auto& edit : host->edits) {
+                    if (edit.second != hEdit) continue;
+                    std::wstring text(static_cast<size_t>(GetWindowTextLengthW(hEdit)) + 1, L'\0');
+                    text.resize(static_cast<size_t>(GetWindowTextW(hEdit, &text[0], static_cast<int>(text.size()))));
+                    host->tree.setText(edit.first, wideToUtf8(text));
                 }
                 return 0;
             }
 
-            case WM_CLOSE: {
-                g_selectedId = 0;
-                DestroyWindow(hDlg);
+            case WM_PAINT: {
+                PAINTSTRUCT ps;
+                HDC hdc = BeginPaint(hDlg, &ps);
+                if (!host->surface) {
+                    RECT client;
+                    GetClientRect(hDlg, &client);
+                    host->surface = CreateCompatibleDC(hdc);
+                    host->bitmap = CreateCompatibleBitmap(hdc, std::max<LONG>(client.right, 1), std::max<LONG>(client.bottom, 1));
+                    host->previousBitmap = SelectObject(host->surface, host->bitmap);
+                    host->previousFont = SelectObject(host->surface, host->font);
+                    host->tree.invalidate();
+                }
+
+                // 只有损坏的控件会绘制到后台缓冲区，窗口得到它请求的区域
+                gdiWidgetPainter painter(host->surface);
+                host->tree.paint(painter);
+                BitBlt(hdc, ps.rcPaint.left, ps.rcPaint.top, ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top,
+                       host->surface, ps.rcPaint.left, ps.rcPaint.top, SRCCOPY);
+                EndPaint(hDlg, &ps);
                 return 0;
             }
 
-            case WM_DESTROY: {
-                
-                if (hFont) {
-                    DeleteObject(hFont);
-                    hFont = NULL;
+            case WM_ERASEBKGND:
+                return TRUE;
+
+            case WM_SETCURSOR: {
+                if (LOWORD(lParam) != HTCLIENT) break;
+                POINT point;
+                GetCursorPos(&point);
+                ScreenToClient(hDlg, &point);
+                size_t widget = host->tree.hitTest(point.x, point.y);
+                bool text = widget != widgetNone && host->tree.kind(widget) == widgetTextBox;
+                SetCursor(LoadCursorW(NULL, text ? IDC_IBEAM : IDC_ARROW));
+                return TRUE;
+            }
+
+            case WM_MOUSEMOVE: {
+                if (!host->trackingLeave) {
+                    TRACKMOUSEEVENT track = {sizeof(TRACKMOUSEEVENT), TME_LEAVE, hDlg, 0};
+                    host->trackingLeave = TrackMouseEvent(&track) != FALSE;
                 }
-                hButtons.clear();
-                PostQuitMessage(0);
-                return 0;
+                host->tree.pointerMove((short)LOWORD(lParam), (short)HIWORD(lParam));
+                return afterWidgetInput(hDlg, *host);
             }
 
-            case WM_CTLCOLORSTATIC:
-            case WM_CTLCOLORBTN: {
-                HDC hdc = (HDC)wParam;
-                SetBkColor(hdc, RGB(240, 240, 240));
-                SetTextColor(hdc, RGB(0, 0, 0));
-                return (LRESULT)hDefaultBrush;
+            case WM_MOUSELEAVE: {
+                host->trackingLeave = false;
+                host->tree.pointerMove(-1, -1);
+                return afterWidgetInput(hDlg, *host);
             }
 
-            case WM_ERASEBKGND: {
-                HDC hdc = (HDC)wParam;
-                RECT rect;
-                GetClientRect(hDlg, &rect);
-                FillRect(hdc, &rect, hDefaultBrush);
-                return TRUE;
+            case WM_LBUTTONDOWN: {
+                SetCapture(hDlg);
+                host->tree.pointerDown((short)LOWORD(lParam), (short)HIWORD(lParam));
+                return afterWidgetInput(hDlg, *host);
+            }
+
+            case WM_LBUTTONUP: {
+                ReleaseCapture();
+                host->tree.pointerUp((short)LOWORD(lParam), (short)HIWORD(lParam));
+                return afterWidgetInput(hDlg, *host);
+            }
+
+            case WM_KEYDOWN: {
+                // 只在焦点位于按钮或无焦点时到达这里，文本框由其EDIT控件编辑
+                widgetKey key;
+                switch (wParam) {
+                    case VK_TAB:    key = widgetKeyTab; break;
+                    case VK_RETURN: key = widgetKeyEnter; break;
+                    case VK_ESCAPE: key = widgetKeyEscape; break;
+                    case VK_SPACE:  key = widgetKeySpace; break;
+                    default:        return 0;
+                }
+                host->tree.keyDown(key, GetKeyState(VK_SHIFT) < 0);
+                return afterWidgetInput(hDlg, *host);
+            }
+
+            case WM_CLOSE:
+                DestroyWindow(hDlg);
+                return 0;
+
+            case WM_DESTROY: {
+                releaseWidgetSurface(*host);
+                PostQuitMessage(0);
+                return 0;
             }
 
             default:
-                return DefWindowProcW(hDlg, msg, wParam, lParam);
+                break;
+        }
+        return DefWindowProcW(hDlg, msg, wParam, lParam);
+    }
+
+    /**
+     * @brief 在屏幕中央显示承载控件树的对话框窗口，窗口关闭后返回
+     * @return 窗口能否创建
+     */
+    bool runWidgetDialog(widgetDialogHost& host, const wchar_t* className, const std::string& title, int width, int height, HWND hParent) {
+        WNDCLASSEXW wc = {0};
+        wc.cbSize        = sizeof(WNDCLASSEXW);
+        wc.lpfnWndProc   = WidgetDialogProc;
+        wc.hInstance     = GetModuleHandleW(NULL);
+        wc.hCursor       = LoadCursorW(NULL, IDC_ARROW);
+        wc.lpszClassName = className;
+
+        if (!RegisterClassExW(&wc)) {
+            return false;
+        }
+
+        host.font = CreateFontW(
+            24, 0, 0, 0, FW_NORMAL,
+            FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+            OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_DONTCARE,
+            L"Microsoft YaHei"
+        );
+
+        int x = (GetSystemMetrics(SM_CXSCREEN) - width) / 2;
+        int y = (GetSystemMetrics(SM_CYSCREEN) - height) / 2;
+
+        HWND hDlg = CreateWindowExW(
+            0,
+            className,
+            utf8ToWide(title).c_str(),
+            WS_POPUP | WS_CAPTION | WS_SYSMENU | DS_MODALFRAME | WS_CLIPCHILDREN,
+            x, y, width, height,
+            hParent,
+            NULL,
+            GetModuleHandleW(NULL),
+            &host
+        );
+
+        if (hDlg) {
+            ShowWindow(hDlg, SW_SHOW);
+            UpdateWindow(hDlg);
+
+            MSG msg;
+            while (GetMessageW(&msg, NULL, 0, 0)) {
+                TranslateMessage(&msg);
+                DispatchMessageW(&msg);
+            }
         }
+
+        UnregisterClassW(className, GetModuleHandleW(NULL));
+        if (host.font) DeleteObject(host.font);
+        return hDlg != NULL;
+    }
+}
+
+/**
+ * @brief 显示输入对话框，用于让用户输入一段字符串
+ * 
+ * @param title 输入对话框的标题
+ * @param message 输入对话框内显示的提示文本
+ * @param output 输出用户输入的内容
+ * @param defaultContent 输入栏内的默认内容
+ * @param hParent 输入对话框的父窗口句柄
+ * @return 用户是否确认了输入
+ *
+ * @note 输入栏是覆盖在文本框控件上的原生EDIT控件，选择、剪贴板、撤销和输入法与其他Windows文本框一致
+ */
+bool promptDialog(std::string title,std::string message,std::string& output,std::string defaultContent = "",HWND hParent = NULL) {
+    dialogProbe probe("promptDialog");
+
+    widgetDialogHost host;
+    size_t input = buildPromptDialog(host.tree, message, defaultContent);
+    runWidgetDialog(host, L"PromptDialogClass", title, 400, 180, hParent);
+
+    if (!host.tree.finished() || host.tree.result() != 1) {
+        output = "";
+        return false;
     }
+
+    output = host.tree.text(input);
+    return true;
 }
 
 /**
@@ -1058,64 +11477,20 @@ namespace {
  * @return 选中的选项ID（关闭窗口返回0，要是你传入的options没有元素则返回-1以告知失败）
  */
 int messageBox(std::string title, std::string message, const std::vector<std::pair<int, std::string>>& options, HWND hParent = NULL) {
+    dialogProbe probe("messageBox");
 
     if(options.empty()) return -1;
-    
-    g_options.clear();
-    for (const auto& opt : options) {
-        g_options.emplace_back(opt.first, utf8ToWide(opt.second));
-    }
-    g_msgContent = utf8ToWide(message);
-    g_boxTitle = utf8ToWide(title);
-    g_selectedId = 0;
-
-    WNDCLASSEXW wc = {0};
-    wc.cbSize = sizeof(WNDCLASSEXW);
-    wc.lpfnWndProc = MessageBoxDialogProc;
-    wc.hInstance = GetModuleHandleW(NULL);
-    wc.lpszClassName = L"CustomMessageBoxClass";
-    wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-    wc.style = CS_HREDRAW | CS_VREDRAW;
-
-    if (!RegisterClassExW(&wc)) {
-        return 0;
-    }
 
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
+    widgetDialogHost host;
+    buildMessageBox(host.tree, message, options);
+
     int windowWidth = (__GCOMMDLG_MSGBOX_BTN_WIDTH + 20) * 3 + 20;
     int windowHeight = 140 + 40 * ((options.size() - 1) / 3);
-    int x = (screenWidth - windowWidth) / 2;
-    int y = (screenHeight - windowHeight) / 2;
-
-    HWND hDlg = CreateWindowExW(
-        0,
-        L"CustomMessageBoxClass",
-        g_boxTitle.c_str(),
-        WS_POPUP | WS_CAPTION | WS_SYSMENU | DS_MODALFRAME,
-        x, y, windowWidth, windowHeight,
-        hParent,
-        NULL,
-        GetModuleHandleW(NULL),
-        NULL
-    );
-
-    if (hDlg) {
-        ShowWindow(hDlg, SW_SHOW);
-        UpdateWindow(hDlg);
-
-        MSG msg;
-        while (GetMessageW(&msg, NULL, 0, 0)) {
-            TranslateMessage(&msg);
-            DispatchMessageW(&msg);
-        }
-    }
-
-    UnregisterClassW(L"CustomMessageBoxClass", GetModuleHandleW(NULL));
-    g_options.clear();
+    runWidgetDialog(host, L"CustomMessageBoxClass", title, windowWidth, windowHeight, hParent);
 
-    return g_selectedId;
+    return host.tree.finished() ? host.tree.result() : 0;
 }
 
-
 #endif
+
+#endif
\ No newline at end of file